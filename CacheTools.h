@@ -0,0 +1,92 @@
+/*
+ * CacheTools.h
+ *
+ * Helpers shared by the modules that key, read and store files of their own: the FNV-1a hash
+ * used for cache keys and content hashes, whole-file reads, and removal of cache files that a
+ * newer build has superseded. Cache files that can be superseded are named
+ * "<identity>-<version>.<extension>" with both halves as 16 hex digits, so every version of
+ * one cached item shares the first 17 characters of its name.
+ */
+#ifndef CACHETOOLS_H
+#define CACHETOOLS_H
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+// Function:    HashBytes
+// ----------------------
+// 64 bit FNV-1a hash, continuing from a previous hash value
+//
+// void* bytes:     data to hash
+// size_t size:     number of bytes
+// uint64_t hash:   hash of the preceding data, the FNV offset basis to start a new hash
+//
+// Returns the hash of everything hashed so far
+inline uint64_t HashBytes(const void* bytes, size_t size, uint64_t hash = 14695981039346656037ull)
+{
+    const unsigned char* p = (const unsigned char*)bytes;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Function:    ReadWholeFile
+// --------------------------
+// Reads a file from disk into memory; an empty file reads as empty data
+//
+// string path:         file to read
+// vector outData:      receives the file contents
+//
+// Returns true if the whole file was read
+inline bool ReadWholeFile(const std::string& path, std::vector<unsigned char>& outData)
+{
+    FILE* f = fopen(path.c_str(), "rb");
+    if (f == NULL)
+        return false;
+    fseek(f, 0, SEEK_END);
+    long file_size = ftell(f);
+    if (file_size < 0)
+    {
+        fclose(f);
+        return false;
+    }
+    fseek(f, 0, SEEK_SET);
+    outData.resize((size_t)file_size);
+    size_t read = fread(outData.data(), 1, outData.size(), f);
+    fclose(f);
+    return read == outData.size();
+}
+
+// Function:    RemoveStaleCaches
+// ------------------------------
+// Deletes the other versions of a cache file, those in its directory with the same extension
+// whose names share its first 17 characters. Files still open elsewhere are left for a later
+// build to remove.
+//
+// string cachePath:    cache file just written, which is kept
+inline void RemoveStaleCaches(const std::string& cachePath)
+{
+    const std::filesystem::path current(cachePath);
+    const std::string currentName = current.filename().string();
+    const std::string prefix = currentName.substr(0, 17);
+
+    std::error_code error;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(current.parent_path(), error))
+    {
+        const std::filesystem::path& candidate = entry.path();
+        const std::string name = candidate.filename().string();
+        if (candidate.extension() == current.extension() && name != currentName && name.compare(0, prefix.size(), prefix) == 0)
+        {
+            std::error_code removeError;
+            std::filesystem::remove(candidate, removeError);
+        }
+    }
+}
+
+#endif //CACHETOOLS_H
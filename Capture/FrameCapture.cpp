@@ -0,0 +1,542 @@
+/*
+ * FrameCapture.cpp
+ *
+ * Source file implementation of the frame capture format. A capture starts with a fixed header,
+ * followed by the data blocks, then the texture and draw list tables, and ends with a trailer
+ * holding the offsets of both tables. Each block is 16 byte aligned so a memory mapped file can
+ * be handed to a renderer without copying. Texture pixels are read back from GL once per
+ * distinct texture and stored only once, even when several ids share the same contents.
+ */
+#include "FrameCapture.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <unordered_map>
+
+#include <GL/gl.h>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../CacheTools.h"
+
+#include "imgui_internal.h"
+
+namespace Capture
+{
+    namespace
+    {
+        constexpr char FileMagic[8] = { 'I', 'M', 'C', 'A', 'P', 'T', 'U', 'R' };
+        constexpr uint32_t FileVersion = 1;
+        constexpr size_t BlockAlignment = 16;
+
+        struct FileHeader
+        {
+            char magic[8];
+            uint32_t version;
+            uint32_t vertexSize;
+            uint32_t indexSize;
+            uint32_t listCount;
+            uint32_t textureCount;
+            uint32_t reserved;
+            float displayPos[2];
+            float displaySize[2];
+            float framebufferScale[2];
+        };
+
+        struct TextureEntry
+        {
+            uint64_t hash;
+            int32_t width;
+            int32_t height;
+            uint64_t pixelOffset;
+            uint64_t pixelSize;
+        };
+
+        struct ListEntry
+        {
+            uint64_t commandOffset;
+            uint64_t vertexOffset;
+            uint64_t indexOffset;
+            uint32_t commandCount;
+            uint32_t vertexCount;
+            uint32_t indexCount;
+            uint32_t reserved;
+        };
+
+        struct PendingCapture
+        {
+            bool requested = false;
+            bool embedTextures = true;
+            std::string path;
+        };
+
+        PendingCapture pending;
+    }
+
+    // Helper Function:    AlignSize
+    // -----------------------------
+    // Rounds a file offset up to the block alignment
+    static size_t AlignSize(size_t offset)
+    {
+        return (offset + BlockAlignment - 1) & ~(BlockAlignment - 1);
+    }
+
+    // Helper Function:    AppendBlock
+    // -------------------------------
+    // Appends an aligned block to the file image and returns its offset
+    static uint64_t AppendBlock(std::vector<unsigned char>& file, const void* bytes, size_t size)
+    {
+        size_t offset = AlignSize(file.size());
+        file.resize(offset + size);
+        if (size > 0)
+            std::memcpy(file.data() + offset, bytes, size);
+        return offset;
+    }
+
+    // Helper Function:    ReadTexturePixels
+    // -------------------------------------
+    // Reads the base level of a GL texture back as RGBA, leaving the GL binding untouched
+    //
+    // Returns false if the texture has no storage
+    static bool ReadTexturePixels(ImTextureID textureId, int& outWidth, int& outHeight, std::vector<unsigned char>& outPixels)
+    {
+        GLint previousTexture = 0;
+        GLint previousAlignment = 4;
+        glGetIntegerv(GL_TEXTURE_BINDING_2D, &previousTexture);
+        glGetIntegerv(GL_PACK_ALIGNMENT, &previousAlignment);
+
+        glBindTexture(GL_TEXTURE_2D, (GLuint)(intptr_t)textureId);
+        GLint width = 0;
+        GLint height = 0;
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_WIDTH, &width);
+        glGetTexLevelParameteriv(GL_TEXTURE_2D, 0, GL_TEXTURE_HEIGHT, &height);
+
+        bool read = width > 0 && height > 0;
+        if (read)
+        {
+            outPixels.resize((size_t)width * height * 4);
+            glPixelStorei(GL_PACK_ALIGNMENT, 1);
+            glGetTexImage(GL_TEXTURE_2D, 0, GL_RGBA, GL_UNSIGNED_BYTE, outPixels.data());
+        }
+
+        glPixelStorei(GL_PACK_ALIGNMENT, previousAlignment);
+        glBindTexture(GL_TEXTURE_2D, (GLuint)previousTexture);
+
+        outWidth = read ? width : 0;
+        outHeight = read ? height : 0;
+        return read;
+    }
+
+    // Function:    SaveFrame
+    // ----------------------
+    // Writes the draw lists, commands and referenced textures of a rendered frame to a capture file
+    // Must be called on the GL thread after ImGui::Render, before the frame's textures change.
+    // Commands with a user callback are skipped, since the callback cannot be replayed.
+    //
+    // ImDrawData drawData:     frame to capture, usually ImGui::GetDrawData()
+    // string path:             file to write
+    // bool embedTextures:      stores texture pixels, otherwise only their hashes and sizes
+    //
+    // Returns false if the frame is invalid or the file could not be written
+    bool SaveFrame(const ImDrawData* drawData, const std::string& path, bool embedTextures)
+    {
+        if (drawData == nullptr || !drawData->Valid)
+            return false;
+
+        std::vector<TextureEntry> textureTable;
+        std::vector<ListEntry> listTable(drawData->CmdListsCount);
+        std::unordered_map<ImTextureID, uint32_t> textureIndices;
+        std::unordered_map<uint64_t, uint32_t> hashIndices;
+        std::vector<CapturedCommand> commands;
+        std::vector<unsigned char> pixels;
+
+        // Tables are written once every block offset is known
+        std::vector<unsigned char> file(sizeof(FileHeader));
+
+        for (int l = 0; l < drawData->CmdListsCount; l++)
+        {
+            const ImDrawList* list = drawData->CmdLists[l];
+            commands.clear();
+
+            for (const ImDrawCmd& cmd : list->CmdBuffer)
+            {
+                if (cmd.UserCallback != nullptr || cmd.ElemCount == 0)
+                    continue;
+
+                auto known = textureIndices.find(cmd.GetTexID());
+                uint32_t textureIndex;
+                if (known != textureIndices.end())
+                {
+                    textureIndex = known->second;
+                }
+                else
+                {
+                    TextureEntry entry = {};
+                    int width = 0;
+                    int height = 0;
+                    ImTextureID id = cmd.GetTexID();
+                    if (ReadTexturePixels(id, width, height, pixels))
+                        entry.hash = HashBytes(pixels.data(), pixels.size(), HashBytes(&width, sizeof(width), HashBytes(&height, sizeof(height))));
+                    else
+                        entry.hash = HashBytes(&id, sizeof(id));
+                    entry.width = width;
+                    entry.height = height;
+
+                    // Different ids holding the same image share one entry
+                    auto same = hashIndices.find(entry.hash);
+                    if (same != hashIndices.end())
+                    {
+                        textureIndex = same->second;
+                    }
+                    else
+                    {
+                        if (embedTextures && width > 0)
+                        {
+                            entry.pixelOffset = AppendBlock(file, pixels.data(), pixels.size());
+                            entry.pixelSize = pixels.size();
+                        }
+                        textureIndex = (uint32_t)textureTable.size();
+                        textureTable.push_back(entry);
+                        hashIndices[entry.hash] = textureIndex;
+                    }
+                    textureIndices[id] = textureIndex;
+                }
+
+                commands.push_back(CapturedCommand{
+                    { cmd.ClipRect.x, cmd.ClipRect.y, cmd.ClipRect.z, cmd.ClipRect.w },
+                    textureIndex,
+                    cmd.VtxOffset,
+                    cmd.IdxOffset,
+                    cmd.ElemCount
+                });
+            }
+
+            ListEntry& entry = listTable[l];
+            entry.commandCount = (uint32_t)commands.size();
+            entry.vertexCount = (uint32_t)list->VtxBuffer.Size;
+            entry.indexCount = (uint32_t)list->IdxBuffer.Size;
+            entry.commandOffset = AppendBlock(file, commands.data(), commands.size() * sizeof(CapturedCommand));
+            entry.vertexOffset = AppendBlock(file, list->VtxBuffer.Data, list->VtxBuffer.size_in_bytes());
+            entry.indexOffset = AppendBlock(file, list->IdxBuffer.Data, list->IdxBuffer.size_in_bytes());
+        }
+
+        FileHeader header = {};
+        std::memcpy(header.magic, FileMagic, sizeof(FileMagic));
+        header.version = FileVersion;
+        header.vertexSize = sizeof(ImDrawVert);
+        header.indexSize = sizeof(ImDrawIdx);
+        header.listCount = (uint32_t)listTable.size();
+        header.textureCount = (uint32_t)textureTable.size();
+        header.displayPos[0] = drawData->DisplayPos.x;
+        header.displayPos[1] = drawData->DisplayPos.y;
+        header.displaySize[0] = drawData->DisplaySize.x;
+        header.displaySize[1] = drawData->DisplaySize.y;
+        header.framebufferScale[0] = drawData->FramebufferScale.x;
+        header.framebufferScale[1] = drawData->FramebufferScale.y;
+
+        // The tables go at the end, where they no longer shift the data blocks
+        uint64_t textureTableOffset = AppendBlock(file, textureTable.data(), textureTable.size() * sizeof(TextureEntry));
+        uint64_t listTableOffset = AppendBlock(file, listTable.data(), listTable.size() * sizeof(ListEntry));
+        std::memcpy(file.data(), &header, sizeof(header));
+
+        // Trailer locating the tables
+        uint64_t trailer[2] = { textureTableOffset, listTableOffset };
+        AppendBlock(file, trailer, sizeof(trailer));
+
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        if (!out)
+            return false;
+        out.write((const char*)file.data(), (std::streamsize)file.size());
+        return (bool)out;
+    }
+
+    // Function:    RequestCapture
+    // ---------------------------
+    // Marks the next frame passed to CaptureIfRequested for capture
+    //
+    // string path:             file to write
+    // bool embedTextures:      stores texture pixels in the capture
+    void RequestCapture(const std::string& path, bool embedTextures)
+    {
+        pending.requested = true;
+        pending.embedTextures = embedTextures;
+        pending.path = path;
+    }
+
+    // Function:    CaptureOnKey
+    // -------------------------
+    // Requests a capture named after the current time when a key is pressed
+    //
+    // ImGuiKey key:            key that triggers a capture
+    // string directory:        folder receiving captures, created if missing
+    void CaptureOnKey(ImGuiKey key, const std::string& directory)
+    {
+        if (!ImGui::IsKeyPressed(key, false))
+            return;
+
+        auto now = std::chrono::system_clock::now();
+        std::time_t seconds = std::chrono::system_clock::to_time_t(now);
+        int milliseconds = (int)(std::chrono::duration_cast<std::chrono::milliseconds>(now.time_since_epoch()).count() % 1000);
+
+        char name[64];
+        size_t length = std::strftime(name, sizeof(name), "frame_%Y%m%d_%H%M%S", std::localtime(&seconds));
+        std::snprintf(name + length, sizeof(name) - length, "_%03d.imcap", milliseconds);
+
+        RequestCapture((std::filesystem::path(directory) / name).string());
+    }
+
+    // Function:    CaptureIfRequested
+    // -------------------------------
+    // Saves a frame if a capture was requested since the last call
+    //
+    // ImDrawData drawData:     frame just rendered, usually ImGui::GetDrawData()
+    //
+    // Returns true if a capture was written
+    bool CaptureIfRequested(const ImDrawData* drawData)
+    {
+        if (!pending.requested)
+            return false;
+        pending.requested = false;
+
+        std::filesystem::path parent = std::filesystem::path(pending.path).parent_path();
+        std::error_code error;
+        if (!parent.empty())
+            std::filesystem::create_directories(parent, error);
+
+        bool saved = SaveFrame(drawData, pending.path, pending.embedTextures);
+        if (!saved)
+            std::fprintf(stderr, "Failed to write frame capture %s\n", pending.path.c_str());
+        return saved;
+    }
+
+    // Destructor:  CaptureFile
+    // ------------------------
+    // Unmaps the file
+    CaptureFile::~CaptureFile()
+    {
+        Close();
+    }
+
+    // Function:    CaptureFile::Open
+    // ------------------------------
+    // Maps a capture file read-only and checks that every table and block lies inside it and that
+    // every drawn index names a vertex of its list
+    //
+    // string path:             capture file to open
+    //
+    // Returns false if the file is missing, truncated, or written with a different vertex or index layout
+    bool CaptureFile::Open(const std::string& path)
+    {
+        Close();
+
+#ifdef _WIN32
+        HANDLE handle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        if (handle == INVALID_HANDLE_VALUE)
+            return false;
+        LARGE_INTEGER fileSize;
+        if (!GetFileSizeEx(handle, &fileSize) || fileSize.QuadPart == 0)
+        {
+            CloseHandle(handle);
+            return false;
+        }
+        HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+        CloseHandle(handle);
+        if (mapping == nullptr)
+            return false;
+        void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        CloseHandle(mapping);
+        if (view == nullptr)
+            return false;
+        data = (const unsigned char*)view;
+        size = (size_t)fileSize.QuadPart;
+#else
+        int descriptor = open(path.c_str(), O_RDONLY);
+        if (descriptor < 0)
+            return false;
+        struct stat info;
+        if (fstat(descriptor, &info) != 0 || info.st_size == 0)
+        {
+            close(descriptor);
+            return false;
+        }
+        void* view = mmap(nullptr, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, descriptor, 0);
+        close(descriptor);
+        if (view == MAP_FAILED)
+            return false;
+        data = (const unsigned char*)view;
+        size = (size_t)info.st_size;
+#endif
+
+        auto inside = [this](uint64_t offset, uint64_t bytes) {
+            return offset % BlockAlignment == 0 && offset <= size && bytes <= size - offset;
+        };
+
+        FileHeader header;
+        uint64_t trailer[2];
+        if (size < sizeof(FileHeader) + sizeof(trailer))
+        {
+            Close();
+            return false;
+        }
+        std::memcpy(&header, data, sizeof(header));
+        std::memcpy(trailer, data + size - sizeof(trailer), sizeof(trailer));
+
+        if (std::memcmp(header.magic, FileMagic, sizeof(FileMagic)) != 0 || header.version != FileVersion ||
+            header.vertexSize != sizeof(ImDrawVert) || header.indexSize != sizeof(ImDrawIdx) ||
+            !inside(trailer[0], (uint64_t)header.textureCount * sizeof(TextureEntry)) ||
+            !inside(trailer[1], (uint64_t)header.listCount * sizeof(ListEntry)))
+        {
+            Close();
+            return false;
+        }
+
+        displayPos = ImVec2(header.displayPos[0], header.displayPos[1]);
+        displaySize = ImVec2(header.displaySize[0], header.displaySize[1]);
+        framebufferScale = ImVec2(header.framebufferScale[0], header.framebufferScale[1]);
+
+        const TextureEntry* textureTable = (const TextureEntry*)(data + trailer[0]);
+        textures.resize(header.textureCount);
+        for (uint32_t t = 0; t < header.textureCount; t++)
+        {
+            const TextureEntry& entry = textureTable[t];
+            CapturedTexture& texture = textures[t];
+            texture.hash = entry.hash;
+            texture.width = entry.width;
+            texture.height = entry.height;
+            if (entry.pixelSize > 0)
+            {
+                if (entry.width <= 0 || entry.height <= 0 || entry.pixelSize != (uint64_t)entry.width * entry.height * 4 || !inside(entry.pixelOffset, entry.pixelSize))
+                {
+                    Close();
+                    return false;
+                }
+                texture.pixels = data + entry.pixelOffset;
+            }
+        }
+
+        const ListEntry* listTable = (const ListEntry*)(data + trailer[1]);
+        drawLists.resize(header.listCount);
+        for (uint32_t l = 0; l < header.listCount; l++)
+        {
+            const ListEntry& entry = listTable[l];
+            if (!inside(entry.commandOffset, (uint64_t)entry.commandCount * sizeof(CapturedCommand)) ||
+                !inside(entry.vertexOffset, (uint64_t)entry.vertexCount * sizeof(ImDrawVert)) ||
+                !inside(entry.indexOffset, (uint64_t)entry.indexCount * sizeof(ImDrawIdx)))
+            {
+                Close();
+                return false;
+            }
+
+            CapturedDrawList& list = drawLists[l];
+            list.commands = (const CapturedCommand*)(data + entry.commandOffset);
+            list.commandCount = (int)entry.commandCount;
+            list.vertices = (const ImDrawVert*)(data + entry.vertexOffset);
+            list.vertexCount = (int)entry.vertexCount;
+            list.indices = (const ImDrawIdx*)(data + entry.indexOffset);
+            list.indexCount = (int)entry.indexCount;
+
+            // Commands must stay inside their list's buffers and texture table, and every index they
+            // draw must name a vertex of the list once the command's vertex offset is added
+            for (int c = 0; c < list.commandCount; c++)
+            {
+                const CapturedCommand& cmd = list.commands[c];
+                if (cmd.textureIndex >= header.textureCount || cmd.vtxOffset > entry.vertexCount ||
+                    (uint64_t)cmd.idxOffset + cmd.elemCount > entry.indexCount)
+                {
+                    Close();
+                    return false;
+                }
+
+                const uint32_t vertexLimit = entry.vertexCount - cmd.vtxOffset;
+                const ImDrawIdx* first = list.indices + cmd.idxOffset;
+                if (std::any_of(first, first + cmd.elemCount, [vertexLimit](ImDrawIdx index) { return (uint32_t)index >= vertexLimit; }))
+                {
+                    Close();
+                    return false;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Function:    CaptureFile::Close
+    // -------------------------------
+    // Unmaps the file and clears its tables
+    void CaptureFile::Close()
+    {
+        if (data != nullptr)
+        {
+#ifdef _WIN32
+            UnmapViewOfFile(data);
+#else
+            munmap((void*)data, size);
+#endif
+        }
+        data = nullptr;
+        size = 0;
+        textures.clear();
+        drawLists.clear();
+    }
+
+    // Function:    CaptureFile::BuildDrawData
+    // ---------------------------------------
+    // Rebuilds the captured frame as ImGui draw lists, ready for a renderer backend's RenderDrawData
+    // Requires a current ImGui context, whose shared draw list data the lists are created with.
+    //
+    // vector textureIds:       backend texture id for each entry of Textures()
+    // vector outLists:         receives the draw lists, which must outlive outDrawData
+    // ImDrawData outDrawData:  receives the frame
+    void CaptureFile::BuildDrawData(const std::vector<ImTextureID>& textureIds, std::vector<std::unique_ptr<ImDrawList>>& outLists, ImDrawData& outDrawData) const
+    {
+        outLists.clear();
+        outDrawData.Clear();
+        outDrawData.Valid = true;
+        outDrawData.DisplayPos = displayPos;
+        outDrawData.DisplaySize = displaySize;
+        outDrawData.FramebufferScale = framebufferScale;
+
+        for (const CapturedDrawList& captured : drawLists)
+        {
+            auto list = std::make_unique<ImDrawList>(ImGui::GetDrawListSharedData());
+            list->Flags = ImDrawListFlags_AllowVtxOffset;
+
+            list->VtxBuffer.resize(captured.vertexCount);
+            if (captured.vertexCount > 0)
+                std::memcpy(list->VtxBuffer.Data, captured.vertices, (size_t)captured.vertexCount * sizeof(ImDrawVert));
+            list->IdxBuffer.resize(captured.indexCount);
+            if (captured.indexCount > 0)
+                std::memcpy(list->IdxBuffer.Data, captured.indices, (size_t)captured.indexCount * sizeof(ImDrawIdx));
+
+            list->CmdBuffer.reserve(captured.commandCount);
+            for (int c = 0; c < captured.commandCount; c++)
+            {
+                const CapturedCommand& capturedCmd = captured.commands[c];
+                ImDrawCmd cmd;
+                cmd.ClipRect = ImVec4(capturedCmd.clipRect[0], capturedCmd.clipRect[1], capturedCmd.clipRect[2], capturedCmd.clipRect[3]);
+                cmd.TextureId = capturedCmd.textureIndex < textureIds.size() ? textureIds[capturedCmd.textureIndex] : (ImTextureID)0;
+                cmd.VtxOffset = capturedCmd.vtxOffset;
+                cmd.IdxOffset = capturedCmd.idxOffset;
+                cmd.ElemCount = capturedCmd.elemCount;
+                list->CmdBuffer.push_back(cmd);
+            }
+
+            if (!list->CmdBuffer.empty())
+                outDrawData.AddDrawList(list.get());
+            outLists.push_back(std::move(list));
+        }
+    }
+}
@@ -0,0 +1,119 @@
+/*
+ * FrameCapture.h
+ *
+ * Header of a capture facility that saves a rendered frame's ImDrawData to a compact binary file,
+ * so heavy frames seen in the field can be replayed offline as renderer benchmarks. Draw lists
+ * keep their exact vertices, indices, commands and clip rects. Each texture is identified by a
+ * hash of its contents instead of its GL id, and its pixels can be embedded so replays sample
+ * the same images. Every array in the file is aligned for direct use once the file is memory
+ * mapped; see Tools/ReplayCapture.cpp.
+ */
+#ifndef FRAMECAPTURE_H
+#define FRAMECAPTURE_H
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+
+// Structure:   CapturedCommand
+// ----------------------------
+// One draw command as stored in a capture file
+//
+// float clipRect:          clip rectangle (x1, y1, x2, y2) in display coordinates
+// uint32_t textureIndex:   index into the capture's texture table
+// uint32_t vtxOffset:      first vertex used by the command
+// uint32_t idxOffset:      first index used by the command
+// uint32_t elemCount:      number of indices drawn
+struct CapturedCommand
+{
+    float clipRect[4];
+    uint32_t textureIndex;
+    uint32_t vtxOffset;
+    uint32_t idxOffset;
+    uint32_t elemCount;
+};
+
+// Structure:   CapturedTexture
+// ----------------------------
+// A texture referenced by a captured frame
+//
+// uint64_t hash:           hash of the RGBA pixels, so equal images match across captures
+// int width:               width in pixels, 0 if the texture could not be read back
+// int height:              height in pixels
+// const unsigned char* pixels: RGBA pixels inside the mapped file, null when not embedded
+struct CapturedTexture
+{
+    uint64_t hash = 0;
+    int width = 0;
+    int height = 0;
+    const unsigned char* pixels = nullptr;
+};
+
+// Structure:   CapturedDrawList
+// -----------------------------
+// One draw list of a captured frame, pointing into the mapped file
+struct CapturedDrawList
+{
+    const CapturedCommand* commands = nullptr;
+    int commandCount = 0;
+    const ImDrawVert* vertices = nullptr;
+    int vertexCount = 0;
+    const ImDrawIdx* indices = nullptr;
+    int indexCount = 0;
+};
+
+namespace Capture
+{
+    // Write a rendered frame's draw data to a capture file, on the GL thread
+    bool SaveFrame(const ImDrawData* drawData, const std::string& path, bool embedTextures = true);
+
+    // Ask for the next frame handed to CaptureIfRequested to be saved to a file
+    void RequestCapture(const std::string& path, bool embedTextures = true);
+
+    // Request a capture into a directory whenever a key is pressed, call between NewFrame and Render
+    void CaptureOnKey(ImGuiKey key, const std::string& directory);
+
+    // Save the draw data if a capture was requested, call after ImGui::Render
+    bool CaptureIfRequested(const ImDrawData* drawData);
+
+    // Class:   CaptureFile
+    // --------------------
+    // Read-only view of a capture file mapped into memory
+    class CaptureFile {
+    public:
+        CaptureFile() = default;
+        ~CaptureFile();
+
+        CaptureFile(const CaptureFile&) = delete;
+        CaptureFile& operator=(const CaptureFile&) = delete;
+
+        // Maps a capture file and validates its tables and indices
+        bool Open(const std::string& path);
+
+        // Unmaps the file; pointers handed out earlier become invalid
+        void Close();
+
+        ImVec2 DisplayPos() const { return displayPos; }
+        ImVec2 DisplaySize() const { return displaySize; }
+        ImVec2 FramebufferScale() const { return framebufferScale; }
+        const std::vector<CapturedTexture>& Textures() const { return textures; }
+        const std::vector<CapturedDrawList>& DrawLists() const { return drawLists; }
+
+        // Rebuilds the frame for a renderer backend, mapping texture table entries to backend texture ids
+        void BuildDrawData(const std::vector<ImTextureID>& textureIds, std::vector<std::unique_ptr<ImDrawList>>& outLists, ImDrawData& outDrawData) const;
+
+    private:
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+        ImVec2 displayPos;
+        ImVec2 displaySize;
+        ImVec2 framebufferScale;
+        std::vector<CapturedTexture> textures;
+        std::vector<CapturedDrawList> drawLists;
+    };
+}
+
+#endif //FRAMECAPTURE_H
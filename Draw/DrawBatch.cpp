@@ -0,0 +1,266 @@
+/*
+ * DrawBatch.cpp
+ * Source file implementation of a deferred shape builder that collects rectangles, rounded
+ * rectangles and boxes over the course of a frame and submits them to an ImDrawList in a single pass.
+ */
+#include "DrawBatch.h"
+
+#include "ColorTools.h"
+#include "DrawPrimitives.h"
+#include "../ImVec2Operators.h"
+
+#include "imgui_internal.h"
+
+namespace Draw {
+    // Constructor: Batch
+    // -------------------
+    // Creates an empty batch, optionally pre-sizing its buffers
+    //
+    // int expectedShapes:  number of shapes expected per frame
+    Batch::Batch(int expectedShapes)
+    {
+        if (expectedShapes <= 0)
+            return;
+
+        types.reserve(expectedShapes);
+        mins.reserve(expectedShapes);
+        maxs.reserve(expectedShapes);
+        colors.reserve(expectedShapes);
+        roundings.reserve(expectedShapes);
+        widths.reserve(expectedShapes);
+        flags.reserve(expectedShapes);
+        clipIndices.reserve(expectedShapes);
+    }
+
+    // Function:    FilledRectangle
+    // ----------------------------
+    // Queues a filled rectangle of a specific color and transparency at a specified position
+    //
+    // ImU32 color:             background color of the rectangle
+    // float transparency:      opacity of the rectangle
+    // ImVec2 position:         coordinates rectangle's upper left corner
+    // ImVec2 rectangleSize:    size of rectangle to be drawn
+    void Batch::FilledRectangle(ImU32 color, float transparency, ImVec2 position, ImVec2 rectangleSize)
+    {
+        push(ShapeType::FilledRectangle, position, position + rectangleSize, Color::WithAlpha(color, transparency), 0.0f, 0.0f, 0);
+    }
+
+    // Function:    FilledRoundedRectangle
+    // -----------------------------------
+    // Queues a filled rounded rectangle of a specific color and transparency at a specified position
+    //
+    // ImU32 color:             background color of the rectangle
+    // float transparency:      opacity of the rectangle
+    // ImVec2 position:         coordinates rectangle's upper left corner
+    // ImVec2 rectangleSize:    size of rectangle to be drawn
+    // float rounding:          radius for corner rounding (in pixels)
+    void Batch::FilledRoundedRectangle(ImU32 color, float transparency, ImVec2 position, ImVec2 rectangleSize, float rounding)
+    {
+        push(ShapeType::FilledRoundedRectangle, position, position + rectangleSize, Color::WithAlpha(color, transparency), rounding, 0.0f, ImDrawFlags_RoundCornersAll);
+    }
+
+    // Function:    BoxAround
+    // ----------------------
+    // Queues a rectangular outline around a provided set of coordinates of a set thickness
+    //
+    // ImVec2 size:                 size of the space being enclosed with a box
+    // ImVec2 position:             coordinates to upper left corner of the space being enclosed
+    // float width:                 width of the box in pixels
+    // ImU32 color:                 color of the box
+    // float transparency:          opacity of the box
+    // float rounding:              filleting radius of the box edges
+    // ImDrawFlags rectangleFlags:  ImGui-specific flags for rectangle formatting
+    void Batch::BoxAround(ImVec2 size, ImVec2 position, float width, ImU32 color, float transparency, float rounding, ImDrawFlags rectangleFlags)
+    {
+        ImVec2 p_min = position - ImVec2(width, width);
+        ImVec2 p_max = position + size + ImVec2(width, width);
+
+        push(ShapeType::Box, p_min, p_max, Color::WithAlpha(color, transparency), rounding, width, rectangleFlags);
+    }
+
+    // Function:    Flush
+    // ------------------
+    // Emits every queued shape and empties the batch
+    // Shape indices are bucketed by clip group with a stable counting sort. Each run of unrounded
+    // shapes within a group reserves its exact vertex/index count once and is written with PrimRect
+    // and PrimRectRing;
+    // rounded shapes are handed to ImGui's path API in place so that draw order is kept.
+    // A clip group whose shapes all miss its clip rectangle is skipped, and counted once in Stats().
+    //
+    // ImDrawList* drawList:    destination draw list, the current window's when null
+    void Batch::Flush(ImDrawList* drawList)
+    {
+        const int shapeCount = Size();
+        if (shapeCount == 0)
+            return;
+
+        if (drawList == nullptr)
+            drawList = ImGui::GetWindowDrawList();
+
+        // Bucket shapes by clip group while keeping insertion order within each bucket
+        const int groupCount = (int)clipRects.size();
+        std::vector<int> groupStart(groupCount + 1, 0);
+        for (int clipIndex : clipIndices)
+            groupStart[clipIndex + 1]++;
+        for (int group = 1; group <= groupCount; group++)
+            groupStart[group] += groupStart[group - 1];
+
+        std::vector<int> order(shapeCount);
+        std::vector<int> cursor(groupStart.begin(), groupStart.end() - 1);
+        for (int shape = 0; shape < shapeCount; shape++)
+            order[cursor[clipIndices[shape]]++] = shape;
+
+        for (int group = 0; group < groupCount; group++)
+        {
+            const ImVec4& clip = clipRects[group];
+            drawList->PushClipRect(ImVec2(clip.x, clip.y), ImVec2(clip.z, clip.w));
+            const ImVec4& bounds = clipBounds[group];
+            if (!ClipTest(drawList, TraceCall::BatchFlush, ImVec2(bounds.x, bounds.y), ImVec2(bounds.z, bounds.w)))
+            {
+                drawList->PopClipRect();
+                continue;
+            }
+
+            int current = groupStart[group];
+            const int groupEnd = groupStart[group + 1];
+            while (current < groupEnd)
+            {
+                int shape = order[current];
+
+                // Rounded shapes need ImGui's corner tessellation
+                if (IsRounded(roundings[shape], flags[shape]))
+                {
+                    if (types[shape] == ShapeType::Box)
+                        drawList->AddRect(mins[shape], maxs[shape], colors[shape], roundings[shape], flags[shape], widths[shape]);
+                    else
+                        drawList->AddRectFilled(mins[shape], maxs[shape], colors[shape], roundings[shape], flags[shape]);
+                    current++;
+                    continue;
+                }
+
+                // Measure the run of solid shapes that follows, up to what the indices can address
+                const int vertexBudget = VertexBudget(drawList);
+                int runEnd = current;
+                int vertexCount = 0;
+                int indexCount = 0;
+                while (runEnd < groupEnd && !IsRounded(roundings[order[runEnd]], flags[order[runEnd]]))
+                {
+                    const bool box = types[order[runEnd]] == ShapeType::Box;
+                    if (vertexCount + (box ? 8 : 4) > vertexBudget)
+                        break;
+                    vertexCount += box ? 8 : 4;
+                    indexCount += box ? 24 : 6;
+                    runEnd++;
+                }
+
+                // Reserve once, then write the run with a tight loop
+                if (runEnd == current || ReserveItems(drawList, 1, vertexCount, indexCount) == 0)
+                {
+                    Stats().droppedItems += groupEnd - current;
+                    break;
+                }
+                for (; current < runEnd; current++)
+                {
+                    shape = order[current];
+                    const ImVec2& a = mins[shape];
+                    const ImVec2& c = maxs[shape];
+                    const ImU32 color = colors[shape];
+
+                    if (types[shape] != ShapeType::Box)
+                    {
+                        drawList->PrimRect(a, c, color);
+                        continue;
+                    }
+
+                    // Match AddRect's stroke, which is centered on a path inset by half a pixel
+                    const float halfWidth = widths[shape] * 0.5f;
+                    const ImVec2 outerMin = a + ImVec2(0.5f - halfWidth, 0.5f - halfWidth);
+                    const ImVec2 outerMax = c - ImVec2(0.5f - halfWidth, 0.5f - halfWidth);
+                    const ImVec2 innerMin = a + ImVec2(0.5f + halfWidth, 0.5f + halfWidth);
+                    const ImVec2 innerMax = c - ImVec2(0.5f + halfWidth, 0.5f + halfWidth);
+
+                    PrimRectRing(drawList, outerMin, outerMax, innerMin, innerMax, color);
+                }
+            }
+
+            drawList->PopClipRect();
+        }
+
+        Clear();
+    }
+
+    // Function:    Clear
+    // ------------------
+    // Discards every queued shape while keeping buffer capacity for the next frame
+    void Batch::Clear()
+    {
+        types.clear();
+        mins.clear();
+        maxs.clear();
+        colors.clear();
+        roundings.clear();
+        widths.clear();
+        flags.clear();
+        clipIndices.clear();
+        clipRects.clear();
+        clipBounds.clear();
+    }
+
+    // Function:    Size
+    // -----------------
+    // Returns the number of queued shapes
+    int Batch::Size() const
+    {
+        return (int)types.size();
+    }
+
+    // Helper Function:    push
+    // -------------------------
+    // Appends one shape instance to every attribute array
+    void Batch::push(ShapeType type, ImVec2 min, ImVec2 max, ImU32 color, float rounding, float width, ImDrawFlags rectangleFlags)
+    {
+        types.push_back(type);
+        mins.push_back(min);
+        maxs.push_back(max);
+        colors.push_back(color);
+        roundings.push_back(rounding);
+        widths.push_back(width);
+        flags.push_back(rectangleFlags);
+
+        // A box's stroke reaches at most half its width past its corners
+        const int clipIndex = currentClipIndex();
+        const ImVec4 shapeBounds = ImVec4(min.x - width * 0.5f, min.y - width * 0.5f, max.x + width * 0.5f, max.y + width * 0.5f);
+        if (clipIndex == (int)clipBounds.size())
+            clipBounds.push_back(shapeBounds);
+        else
+        {
+            ImVec4& bounds = clipBounds[clipIndex];
+            bounds = ImVec4(ImMin(bounds.x, shapeBounds.x), ImMin(bounds.y, shapeBounds.y), ImMax(bounds.z, shapeBounds.z), ImMax(bounds.w, shapeBounds.w));
+        }
+        clipIndices.push_back(clipIndex);
+    }
+
+    // Helper Function:    currentClipIndex
+    // -------------------------------------
+    // Looks up (or registers) the clip rectangle active on the current window's draw list
+    //
+    // Returns the index of the clip rectangle within clipRects
+    int Batch::currentClipIndex()
+    {
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        ImVec2 clipMin = drawList->GetClipRectMin();
+        ImVec2 clipMax = drawList->GetClipRectMax();
+
+        // Consecutive shapes almost always share a clip rectangle, so search from the back
+        for (int i = (int)clipRects.size() - 1; i >= 0; i--)
+        {
+            const ImVec4& clip = clipRects[i];
+            if (clip.x == clipMin.x && clip.y == clipMin.y && clip.z == clipMax.x && clip.w == clipMax.y)
+                return i;
+        }
+
+        clipRects.push_back(ImVec4(clipMin.x, clipMin.y, clipMax.x, clipMax.y));
+        return (int)clipRects.size() - 1;
+    }
+
+} // Draw
@@ -0,0 +1,76 @@
+/*
+ * DrawBatch.h
+ * Header of a deferred shape builder that collects rectangles, rounded rectangles and
+ * boxes over the course of a frame and submits them to an ImDrawList in a single pass.
+ * The member functions mirror the signatures of their immediate counterparts in DrawTools
+ * so that heatmap, timeline and Gantt-style panels can swap Draw:: calls for calls on a Batch.
+ */
+#ifndef DRAWBATCH_H
+#define DRAWBATCH_H
+#include <vector>
+
+#include "imgui.h"
+
+namespace Draw {
+
+    // Enum:    ShapeType
+    // ------------------
+    // Kind of shape stored in a Batch
+    enum class ShapeType : unsigned char
+    {
+        FilledRectangle,
+        FilledRoundedRectangle,
+        Box
+    };
+
+    // Class:   Batch
+    // --------------
+    // Collects shape instances in a structure-of-arrays buffer and emits them with exact,
+    // up-front vertex/index reservations when flushed
+    //
+    // Shapes are grouped by the clip rectangle that was active when they were added. Draw order
+    // is preserved within each clip group; groups are emitted in the order they were first seen.
+    class Batch {
+    public:
+        explicit Batch(int expectedShapes = 0);
+
+        // Queues a filled rectangle, see Draw::FilledRectangle
+        void FilledRectangle(ImU32 color, float transparency, ImVec2 position, ImVec2 rectangleSize);
+
+        // Queues a filled rectangle with rounded corners, see Draw::FilledRoundedRectangle
+        void FilledRoundedRectangle(ImU32 color, float transparency, ImVec2 position, ImVec2 rectangleSize, float rounding);
+
+        // Queues a box around a given dimensional vector, see Draw::BoxAround
+        void BoxAround(ImVec2 size, ImVec2 position, float width, ImU32 color, float transparency, float rounding, ImDrawFlags rectangleFlags = 0);
+
+        // Emits every queued shape into the draw list (the current window's by default) and clears the batch
+        void Flush(ImDrawList* drawList = nullptr);
+
+        // Discards every queued shape without drawing it
+        void Clear();
+
+        // Number of queued shapes
+        int Size() const;
+
+    private:
+        // Per-shape attributes
+        std::vector<ShapeType> types;
+        std::vector<ImVec2> mins;
+        std::vector<ImVec2> maxs;
+        std::vector<ImU32> colors;
+        std::vector<float> roundings;
+        std::vector<float> widths;
+        std::vector<ImDrawFlags> flags;
+        std::vector<int> clipIndices;
+
+        // Distinct clip rectangles referenced by clipIndices, and the bounds of the shapes queued under each
+        std::vector<ImVec4> clipRects;
+        std::vector<ImVec4> clipBounds;
+
+        void push(ShapeType type, ImVec2 min, ImVec2 max, ImU32 color, float rounding, float width, ImDrawFlags rectangleFlags);
+        int currentClipIndex();
+    };
+
+} // Draw
+
+#endif //DRAWBATCH_H
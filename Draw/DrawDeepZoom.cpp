@@ -0,0 +1,217 @@
+/*
+ * DrawDeepZoom.cpp
+ * Source file implementation of a deep-zoom viewer for tiled images. Each frame is drawn in up to
+ * three passes clipped to the frame. The next coarser level goes underneath, then the level
+ * matching the screen scale fades in over it tile by tile, and after zooming out the previous
+ * finer level fades away on top. Zoom is kept in log2 units so that easing and mouse wheel
+ * steps feel even at every magnification.
+ */
+#include "DrawDeepZoom.h"
+
+#include <cmath>
+#include <vector>
+
+#include "DrawPrimitives.h"
+#include "TiledImage.h"
+#include "../ImVec2Operators.h"
+
+#include "imgui_internal.h"
+
+namespace Draw {
+    // Helper Function:    FitZoom
+    // ---------------------------
+    // Returns the zoom at which the whole image just fits inside a frame
+    static float FitZoom(const Texture::TiledImage& image, ImVec2 frameSize)
+    {
+        return std::log2(ImMin(frameSize.x / image.Width(), frameSize.y / image.Height()));
+    }
+
+    // Helper Function:    DrawDeepZoomTiles
+    // -------------------------------------
+    // Submits one pass of tiles positioned around the view's center
+    //
+    // vector tiles:        tiles returned by TiledImage::CollectLevelTiles
+    // int onlyLevel:       skips stand-in tiles from other levels, -1 draws every tile
+    // float alpha:         opacity of the pass
+    // float fadeSeconds:   fades tiles in over this long after they arrive, 0 to draw them opaque
+    // ImVec2 frameCenter:  screen position of the view's center
+    // ImVec2 center:       image pixel at the view's center
+    // float scale:         screen pixels per image pixel
+    //
+    // Returns the number of quads submitted
+    static int DrawDeepZoomTiles(const std::vector<ImageTile>& tiles, int onlyLevel, float alpha, float fadeSeconds, ImVec2 frameCenter, ImVec2 center, float scale)
+    {
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        int drawn = 0;
+
+        for (const ImageTile& tile : tiles)
+        {
+            if (onlyLevel >= 0 && tile.level != onlyLevel)
+                continue;
+
+            float opacity = alpha;
+            if (fadeSeconds > 0.0f)
+                opacity *= ImMin(1.0f, tile.age / fadeSeconds);
+            if (opacity <= 0.0f)
+                continue;
+
+            drawList->AddImage(
+                (ImTextureID)(intptr_t)tile.texture.id,
+                frameCenter + (ImVec2(tile.x0, tile.y0) - center) * scale,
+                frameCenter + (ImVec2(tile.x1, tile.y1) - center) * scale,
+                ImVec2(tile.u0, tile.v0),
+                ImVec2(tile.u1, tile.v1),
+                IM_COL32(255, 255, 255, (int)(opacity * 255.0f)));
+            drawn++;
+        }
+
+        return drawn;
+    }
+
+    // Function:    DeepZoomFit
+    // ------------------------
+    // Centers the image in the frame at the largest zoom that shows all of it
+    //
+    // DeepZoomView view:   viewer state to change
+    // TiledImage image:    image being viewed, must be Ready
+    // ImVec2 frameSize:    size of the viewer on screen
+    // bool animate:        eases toward the fitted view when true, jumps to it otherwise
+    void DeepZoomFit(DeepZoomView& view, const Texture::TiledImage& image, ImVec2 frameSize, bool animate)
+    {
+        if (!image.Ready())
+            return;
+
+        view.targetZoom = FitZoom(image, frameSize);
+        view.targetCenter = ImVec2(image.Width() * 0.5f, image.Height() * 0.5f);
+        if (!animate || !view.initialized)
+        {
+            view.zoom = view.targetZoom;
+            view.center = view.targetCenter;
+        }
+        view.initialized = true;
+    }
+
+    // Function:    DeepZoomTo
+    // -----------------------
+    // Sets the point and zoom the view eases toward
+    //
+    // DeepZoomView view:   viewer state to change
+    // ImVec2 imagePoint:   image pixel to center on
+    // float zoom:          log2 of screen pixels per image pixel, limited to view.maxZoom
+    void DeepZoomTo(DeepZoomView& view, ImVec2 imagePoint, float zoom)
+    {
+        view.targetCenter = imagePoint;
+        view.targetZoom = ImMin(zoom, view.maxZoom);
+    }
+
+    // Function:    DeepZoom
+    // ---------------------
+    // Draws a tiled image inside a frame at the view's pan and zoom
+    // When interactive, the mouse wheel zooms about the cursor and dragging pans. The view eases
+    // toward its target using the frame's delta time. Tiles are drawn from the pyramid level
+    // matching the eased scale, and level changes are cross-faded over view.fadeSeconds.
+    // Call image.Update once per frame as well, so requested tiles get uploaded.
+    //
+    // TiledImage image:    image to draw, nothing is drawn until it is Ready
+    // DeepZoomView view:   pan and zoom state, updated in place
+    // ImVec2 position:     coordinate location for upper-left-corner of the viewer
+    // ImVec2 frameSize:    size of the viewer on screen
+    // bool interactive:    handles mouse input over the frame when true
+    void DeepZoom(Texture::TiledImage& image, DeepZoomView& view, ImVec2 position, ImVec2 frameSize, bool interactive)
+    {
+        static std::vector<ImageTile> tiles;
+
+        view.tilesDrawn = 0;
+        if (!image.Ready() || frameSize.x <= 0.0f || frameSize.y <= 0.0f)
+            return;
+        if (!view.initialized)
+            DeepZoomFit(view, image, frameSize, false);
+
+        ImGuiIO& io = ImGui::GetIO();
+        ImVec2 frameCenter = position + frameSize * 0.5f;
+        float minZoom = FitZoom(image, frameSize) - 1.0f;
+
+        if (interactive)
+        {
+            // An invisible item claims the mouse so dragging pans the image instead of the window
+            ImVec2 cursor = ImGui::GetCursorScreenPos();
+            ImGui::PushID(&view);
+            ImGui::SetCursorScreenPos(position);
+            ImGui::InvisibleButton("##DeepZoom", frameSize);
+            ImGui::PopID();
+            ImGui::SetCursorScreenPos(cursor);
+
+            if (ImGui::IsItemHovered())
+            {
+                ImGui::SetItemKeyOwner(ImGuiKey_MouseWheelY);
+                if (io.MouseWheel != 0.0f)
+                {
+                    // Keep the image point under the cursor in place
+                    ImVec2 offset = io.MousePos - frameCenter;
+                    ImVec2 anchor = view.targetCenter + offset / std::exp2(view.targetZoom);
+                    view.targetZoom = ImClamp(view.targetZoom + io.MouseWheel * 0.25f, minZoom, view.maxZoom);
+                    view.targetCenter = anchor - offset / std::exp2(view.targetZoom);
+                }
+            }
+
+            if (ImGui::IsItemActive() && ImGui::IsMouseDragging(ImGuiMouseButton_Left, 0.0f))
+            {
+                // Panning follows the cursor directly rather than easing
+                ImVec2 delta = io.MouseDelta / std::exp2(view.zoom);
+                view.center = view.center - delta;
+                view.targetCenter = view.targetCenter - delta;
+            }
+        }
+
+        view.targetCenter = ImClamp(view.targetCenter, ImVec2(0.0f, 0.0f), ImVec2(image.Width(), image.Height()));
+        view.targetZoom = ImClamp(view.targetZoom, minZoom, view.maxZoom);
+
+        // Exponential easing, independent of frame rate
+        float step = 1.0f - std::exp(-view.smoothing * io.DeltaTime);
+        view.zoom += (view.targetZoom - view.zoom) * step;
+        view.center = view.center + (view.targetCenter - view.center) * step;
+
+        float scale = std::exp2(view.zoom);
+        ImVec2 halfExtent = frameSize * (0.5f / scale);
+        ImVec2 regionMin = view.center - halfExtent;
+        ImVec2 regionMax = view.center + halfExtent;
+
+        int level = image.LevelForScale(scale);
+        if (level != view.level)
+        {
+            view.previousLevel = view.level;
+            view.level = level;
+            view.levelBlend = view.previousLevel < 0 ? 1.0f : 0.0f;
+        }
+        view.levelBlend = view.fadeSeconds > 0.0f ? ImMin(1.0f, view.levelBlend + io.DeltaTime / view.fadeSeconds) : 1.0f;
+
+        // A viewer outside the clip rect keeps easing but requests and draws no tiles
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::DeepZoom, position, position + frameSize))
+            return;
+        drawList->PushClipRect(position, position + frameSize, true);
+
+        // The next coarser level underneath, standing in wherever the current level is not loaded
+        bool hasCoarser = level + 1 < image.LevelCount();
+        if (hasCoarser)
+        {
+            image.CollectLevelTiles(regionMin.x, regionMin.y, regionMax.x, regionMax.y, level + 1, tiles);
+            view.tilesDrawn += DrawDeepZoomTiles(tiles, -1, 1.0f, 0.0f, frameCenter, view.center, scale);
+        }
+
+        // The current level, each tile fading in as it arrives and the whole level fading in after zooming in
+        float levelAlpha = view.previousLevel > level ? view.levelBlend : 1.0f;
+        image.CollectLevelTiles(regionMin.x, regionMin.y, regionMax.x, regionMax.y, level, tiles);
+        view.tilesDrawn += DrawDeepZoomTiles(tiles, hasCoarser ? level : -1, levelAlpha, view.fadeSeconds, frameCenter, view.center, scale);
+
+        // After zooming out, the finer level fades away on top of its replacement
+        if (view.previousLevel >= 0 && view.previousLevel < level && view.levelBlend < 1.0f)
+        {
+            image.CollectLevelTiles(regionMin.x, regionMin.y, regionMax.x, regionMax.y, view.previousLevel, tiles, false);
+            view.tilesDrawn += DrawDeepZoomTiles(tiles, view.previousLevel, 1.0f - view.levelBlend, 0.0f, frameCenter, view.center, scale);
+        }
+
+        drawList->PopClipRect();
+    }
+
+} // Draw
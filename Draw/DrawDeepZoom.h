@@ -0,0 +1,60 @@
+/*
+ * DrawDeepZoom.h
+ * Header of a deep-zoom viewer for tiled images. Unlike Draw::Image, which crops around the
+ * center of one full resolution texture, the viewer keeps a pan position and a continuous zoom.
+ * It eases both toward their targets every frame, draws each frame from the pyramid level
+ * matching the on-screen scale, and cross-fades between levels as tiles arrive. Work per frame
+ * is bounded by the tiles covering the frame, whatever the size of the image.
+ */
+#ifndef DRAWDEEPZOOM_H
+#define DRAWDEEPZOOM_H
+#include "imgui.h"
+
+namespace Texture { class TiledImage; }
+
+namespace Draw {
+
+    // Structure:   DeepZoomView
+    // -------------------------
+    // Pan and zoom state of one deep-zoom viewer, kept by the caller between frames
+    //
+    // ImVec2 center:       image pixel shown at the center of the frame
+    // float zoom:          log2 of screen pixels per image pixel, 0 is 1:1
+    // ImVec2 targetCenter: center being eased toward
+    // float targetZoom:    zoom being eased toward
+    // float maxZoom:       closest zoom allowed, log2 of screen pixels per image pixel
+    // float smoothing:     how quickly the view approaches its target, per second
+    // float fadeSeconds:   duration of tile fade-ins and level cross-fades
+    // bool initialized:    false until the view has been fitted to its first image
+    // int level:           pyramid level drawn last frame
+    // int previousLevel:   level being faded out after a level change
+    // float levelBlend:    progress of the cross-fade from previousLevel, 1 when complete
+    // int tilesDrawn:      quads submitted last frame
+    struct DeepZoomView
+    {
+        ImVec2 center = ImVec2(0.0f, 0.0f);
+        float zoom = 0.0f;
+        ImVec2 targetCenter = ImVec2(0.0f, 0.0f);
+        float targetZoom = 0.0f;
+        float maxZoom = 3.0f;
+        float smoothing = 12.0f;
+        float fadeSeconds = 0.25f;
+        bool initialized = false;
+        int level = -1;
+        int previousLevel = -1;
+        float levelBlend = 1.0f;
+        int tilesDrawn = 0;
+    };
+
+    // Fits the whole image inside a frame, immediately or by easing toward it
+    void DeepZoomFit(DeepZoomView& view, const Texture::TiledImage& image, ImVec2 frameSize, bool animate = true);
+
+    // Eases the view toward an image point at a zoom level
+    void DeepZoomTo(DeepZoomView& view, ImVec2 imagePoint, float zoom);
+
+    // Draws a tiled image with pan and zoom, handling mouse wheel zoom and drag panning when interactive
+    void DeepZoom(Texture::TiledImage& image, DeepZoomView& view, ImVec2 position, ImVec2 frameSize, bool interactive = true);
+
+} // Draw
+
+#endif //DRAWDEEPZOOM_H
@@ -0,0 +1,478 @@
+/*
+ * DrawGlyphCache.cpp
+ * Source file implementation of the dynamic glyph atlas. Glyphs are keyed by codepoint and
+ * whole pixel size, rasterized with the stb_truetype copy that ships with Dear ImGui and packed
+ * on shelves: a row grows left to right and a new row opens below it when the glyph no longer
+ * fits. Pages keep the frame they were last drawn in; the oldest page not drawn this frame is
+ * the one cleared when a glyph finds no room, so glyphs already laid out this frame stay valid.
+ */
+#include "DrawGlyphCache.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <iterator>
+
+#include "../CacheTools.h"
+
+#include "imgui_internal.h"
+
+// Private copy of stb_truetype, compiled the same way imgui_draw.cpp compiles its own
+#ifndef STB_TRUETYPE_IMPLEMENTATION
+#define STBTT_STATIC
+#define STB_TRUETYPE_IMPLEMENTATION
+#endif
+#ifdef IMGUI_STB_TRUETYPE_FILENAME
+#include IMGUI_STB_TRUETYPE_FILENAME
+#else
+#include "imstb_truetype.h"
+#endif
+
+namespace Draw {
+
+    // Empty pixels kept right of and below each glyph, so filtering never samples a neighbour
+    static constexpr int GlyphPadding = 1;
+
+    static std::vector<std::pair<const ImFont*, GlyphCache*>> attachedCaches;
+    static int generation = 0;
+
+    // Helper Function:    GlyphKey
+    // ----------------------------
+    // Combines a codepoint and a whole pixel size into a cache key
+    static uint64_t GlyphKey(ImWchar codepoint, float fontSize)
+    {
+        const uint64_t pixelSize = (uint64_t)ImMax(1, (int)(fontSize + 0.5f));
+        return pixelSize << 32 | (uint64_t)codepoint;
+    }
+
+    // Helper Function:    PlaceOnShelf
+    // --------------------------------
+    // Reserves a region on a page's open shelf, opening a new shelf below when the row is full
+    //
+    // Returns false if the page has no room left for the region
+    static bool PlaceOnShelf(int& shelfX, int& shelfY, int& shelfHeight, int pageSize, int width, int height, int& x, int& y)
+    {
+        if (width > pageSize || height > pageSize)
+            return false;
+        if (shelfX + width > pageSize)
+        {
+            shelfY += shelfHeight;
+            shelfX = 0;
+            shelfHeight = 0;
+        }
+        if (shelfY + height > pageSize)
+            return false;
+
+        x = shelfX;
+        y = shelfY;
+        shelfX += width;
+        shelfHeight = ImMax(shelfHeight, height);
+        return true;
+    }
+
+    // Constructor: GlyphCache
+    // -----------------------
+    // Creates an empty cache, Load must succeed before it serves glyphs
+    GlyphCache::GlyphCache()
+        : fontInfo(std::make_unique<stbtt_fontinfo>())
+    {
+    }
+
+    // Destructor:  GlyphCache
+    // -----------------------
+    // Joins the prewarm thread, deletes the page textures and detaches the cache from its fonts
+    GlyphCache::~GlyphCache()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        prewarmCondition.notify_all();
+        if (prewarmThread.joinable())
+            prewarmThread.join();
+
+        for (const Page& page : pages)
+            Texture::DestroyDynamic(page.texture);
+
+        attachedCaches.erase(std::remove_if(attachedCaches.begin(), attachedCaches.end(),
+                                            [&](const std::pair<const ImFont*, GlyphCache*>& entry) { return entry.second == this; }),
+                             attachedCaches.end());
+        generation++;
+    }
+
+    // Function:    Load
+    // -----------------
+    // Reads a TrueType or OpenType file; no pixels are rasterized until glyphs are requested
+    //
+    // string path:         font file to read, kept in memory for the life of the cache
+    // int pageSize:        width and height of each atlas page in pixels
+    // int maxPages:        pages allocated before the least recently drawn one is reused
+    // int fontIndex:       font within a .ttc collection
+    //
+    // Returns false if the file cannot be read or parsed, or the cache is already loaded
+    bool GlyphCache::Load(const std::string& path, int pageSize, int maxPages, int fontIndex)
+    {
+        if (loaded || !ReadWholeFile(path, fontData) || fontData.empty())
+            return false;
+
+        const int offset = stbtt_GetFontOffsetForIndex(fontData.data(), fontIndex);
+        if (offset < 0 || !stbtt_InitFont(fontInfo.get(), fontData.data(), offset))
+        {
+            fontData.clear();
+            return false;
+        }
+
+        this->pageSize = ImMax(64, pageSize);
+        this->maxPages = ImMax(1, maxPages);
+        loaded = true;
+        return true;
+    }
+
+    // Function:    Find
+    // -----------------
+    // Returns a glyph at a pixel size, rasterizing and uploading it on first use
+    // The first call of a frame also packs up to GlyphPrewarmPerFrame prewarmed glyphs.
+    //
+    // ImWchar codepoint:   character to look up
+    // float fontSize:      pixel size, rounded to a whole pixel
+    //
+    // Returns null if the font lacks the character or every page was drawn this frame and is full
+    const CachedGlyph* GlyphCache::Find(ImWchar codepoint, float fontSize)
+    {
+        if (!loaded)
+            return nullptr;
+
+        const int frame = ImGui::GetFrameCount();
+        if (frame != insertedFrame)
+        {
+            insertedFrame = frame;
+            insertPrewarmed(GlyphPrewarmPerFrame);
+        }
+
+        const uint64_t key = GlyphKey(codepoint, fontSize);
+        auto it = glyphs.find(key);
+        if (it == glyphs.end())
+        {
+            if (missing.count(key) != 0)
+                return nullptr;
+
+            stats.rasterized++;
+            if (!insert(rasterize(key), true))
+            {
+                stats.rejected++;
+                return nullptr;
+            }
+            it = glyphs.find(key);
+            if (it == glyphs.end())
+                return nullptr;
+        }
+
+        CachedGlyph& cached = it->second;
+        if (cached.page >= 0)
+            pages[cached.page].lastFrame = frame;
+        return &cached;
+    }
+
+    // Function:    Prewarm
+    // --------------------
+    // Queues every character of a set of ranges for rasterization on the prewarm thread
+    // Prewarmed glyphs fill free page space only; they never evict glyphs already cached.
+    //
+    // ImWchar* ranges:     inclusive pairs of codepoints ending in 0, as ImFontAtlas::GetGlyphRanges* return
+    // float fontSize:      pixel size to rasterize at
+    void GlyphCache::Prewarm(const ImWchar* ranges, float fontSize)
+    {
+        if (!loaded || ranges == nullptr)
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (; ranges[0] != 0 && ranges[1] != 0; ranges += 2)
+                for (unsigned int c = ranges[0]; c <= ranges[1]; c++)
+                {
+                    const uint64_t key = GlyphKey((ImWchar)c, fontSize);
+                    if (glyphs.count(key) == 0 && missing.count(key) == 0)
+                        prewarmQueue.push_back(key);
+                }
+        }
+
+        if (!prewarmThread.joinable())
+            prewarmThread = std::thread(&GlyphCache::prewarmLoop, this);
+        prewarmCondition.notify_one();
+    }
+
+    // Function:    MarkDrawn
+    // ----------------------
+    // Records that glyphs of a page were drawn this frame, so eviction passes over it
+    //
+    // ImTextureID texture:     page texture, ignored if this cache does not own it
+    void GlyphCache::MarkDrawn(ImTextureID texture)
+    {
+        for (Page& page : pages)
+            if (page.id == texture)
+                page.lastFrame = ImGui::GetFrameCount();
+    }
+
+    // Function:    Stats
+    // ------------------
+    // Returns the cache's counters, including prewarm requests still outstanding
+    GlyphCacheStats GlyphCache::Stats() const
+    {
+        GlyphCacheStats result = stats;
+        result.glyphs = (int)glyphs.size();
+        result.pages = (int)pages.size();
+
+        std::lock_guard<std::mutex> lock(mutex);
+        result.pendingPrewarm = (int)(prewarmQueue.size() + prewarmed.size());
+        return result;
+    }
+
+    // Helper Function:    rasterize
+    // -----------------------------
+    // Renders one glyph to an 8 bit coverage bitmap; reads the font only, so any thread may call it
+    //
+    // uint64_t key:        pixel size and codepoint, see GlyphKey
+    //
+    // Returns the bitmap, with found cleared if the font has no glyph for the codepoint
+    GlyphCache::GlyphBitmap GlyphCache::rasterize(uint64_t key) const
+    {
+        GlyphBitmap bitmap;
+        bitmap.key = key;
+
+        const int glyphIndex = stbtt_FindGlyphIndex(fontInfo.get(), (int)(key & 0xFFFFFFFF));
+        if (glyphIndex == 0)
+            return bitmap;
+        bitmap.found = true;
+
+        // Scaled by pixel height as ImFontAtlas scales its fonts, so sizes match atlas glyphs
+        const float scale = stbtt_ScaleForPixelHeight(fontInfo.get(), (float)(key >> 32));
+        int advance = 0;
+        int bearing = 0;
+        stbtt_GetGlyphHMetrics(fontInfo.get(), glyphIndex, &advance, &bearing);
+        bitmap.advance = advance * scale;
+
+        int x1 = 0;
+        int y1 = 0;
+        stbtt_GetGlyphBitmapBox(fontInfo.get(), glyphIndex, scale, scale, &bitmap.x0, &bitmap.y0, &x1, &y1);
+        bitmap.width = x1 - bitmap.x0;
+        bitmap.height = y1 - bitmap.y0;
+        if (bitmap.width > 0 && bitmap.height > 0)
+        {
+            bitmap.alpha.resize((size_t)bitmap.width * bitmap.height);
+            stbtt_MakeGlyphBitmap(fontInfo.get(), bitmap.alpha.data(), bitmap.width, bitmap.height, bitmap.width, scale, scale, glyphIndex);
+        }
+        return bitmap;
+    }
+
+    // Helper Function:    insert
+    // --------------------------
+    // Packs a rasterized glyph into a page and uploads only its region
+    // Pixels are white with the coverage in alpha, as in the RGBA32 ImFont atlas. The region is
+    // uploaded before the glyph is returned, outside the dynamic texture budget, so a glyph is
+    // never drawn over the pixels of one evicted from the same spot.
+    //
+    // GlyphBitmap bitmap:      glyph to add, ignored if already cached
+    // bool allowEviction:      whether a full cache may clear its least recently drawn page
+    //
+    // Returns false if no page had room
+    bool GlyphCache::insert(const GlyphBitmap& bitmap, bool allowEviction)
+    {
+        if (glyphs.count(bitmap.key) != 0 || missing.count(bitmap.key) != 0)
+            return true;
+        if (!bitmap.found)
+        {
+            missing.insert(bitmap.key);
+            return true;
+        }
+
+        CachedGlyph cached;
+        cached.size = (float)(bitmap.key >> 32);
+        ImFontGlyph& glyph = cached.glyph;
+        glyph.Codepoint = (unsigned int)(bitmap.key & 0xFFFFFFFF);
+        glyph.Visible = bitmap.width > 0 && bitmap.height > 0;
+        glyph.AdvanceX = bitmap.advance;
+
+        if (glyph.Visible)
+        {
+            const int width = bitmap.width + GlyphPadding;
+            const int height = bitmap.height + GlyphPadding;
+            int x = 0;
+            int y = 0;
+            const int page = allocate(width, height, allowEviction, x, y);
+            if (page < 0)
+                return false;
+
+            static std::vector<ImU32> pixels;
+            pixels.assign((size_t)width * height, IM_COL32(255, 255, 255, 0));
+            for (int row = 0; row < bitmap.height; row++)
+                for (int column = 0; column < bitmap.width; column++)
+                    pixels[(size_t)row * width + column] = IM_COL32(255, 255, 255, bitmap.alpha[(size_t)row * bitmap.width + column]);
+            Texture::UpdateImmediate(pages[page].texture, pixels.data(), TextureRect{ x, y, width, height });
+
+            const float texel = 1.0f / (float)pageSize;
+            glyph.X0 = (float)bitmap.x0;
+            glyph.Y0 = (float)bitmap.y0;
+            glyph.X1 = (float)(bitmap.x0 + bitmap.width);
+            glyph.Y1 = (float)(bitmap.y0 + bitmap.height);
+            glyph.U0 = x * texel;
+            glyph.V0 = y * texel;
+            glyph.U1 = (x + bitmap.width) * texel;
+            glyph.V1 = (y + bitmap.height) * texel;
+            cached.page = page;
+            cached.texture = pages[page].id;
+        }
+
+        glyphs.emplace(bitmap.key, cached);
+        return true;
+    }
+
+    // Helper Function:    allocate
+    // ----------------------------
+    // Finds room for a glyph, opening a new page while under the page limit
+    //
+    // int width, height:       size of the region including padding
+    // bool allowEviction:      whether the least recently drawn page may be cleared for it
+    // int x, y:                upper left corner of the reserved region
+    //
+    // Returns the page index, or -1 if there is no room
+    int GlyphCache::allocate(int width, int height, bool allowEviction, int& x, int& y)
+    {
+        for (int i = 0; i < (int)pages.size(); i++)
+            if (PlaceOnShelf(pages[i].shelfX, pages[i].shelfY, pages[i].shelfHeight, pageSize, width, height, x, y))
+                return i;
+
+        if ((int)pages.size() < maxPages)
+        {
+            Page page;
+            page.texture = Texture::CreateDynamic(pageSize, pageSize, TextureFormat::RGBA8, 1);
+            page.id = (ImTextureID)(intptr_t)Texture::Get(page.texture).id;
+            pages.push_back(page);
+            Page& added = pages.back();
+            return PlaceOnShelf(added.shelfX, added.shelfY, added.shelfHeight, pageSize, width, height, x, y) ? (int)pages.size() - 1 : -1;
+        }
+
+        if (!allowEviction)
+            return -1;
+
+        // Least recently drawn page, skipping pages whose glyphs may already be laid out this frame
+        const int frame = ImGui::GetFrameCount();
+        int oldest = -1;
+        for (int i = 0; i < (int)pages.size(); i++)
+            if (pages[i].lastFrame < frame && (oldest < 0 || pages[i].lastFrame < pages[oldest].lastFrame))
+                oldest = i;
+        if (oldest < 0)
+            return -1;
+
+        evictPage(oldest);
+        Page& page = pages[oldest];
+        return PlaceOnShelf(page.shelfX, page.shelfY, page.shelfHeight, pageSize, width, height, x, y) ? oldest : -1;
+    }
+
+    // Helper Function:    evictPage
+    // -----------------------------
+    // Drops every glyph of a page and reopens it empty; new glyphs overwrite the old pixels
+    void GlyphCache::evictPage(int index)
+    {
+        for (auto it = glyphs.begin(); it != glyphs.end();)
+            it = it->second.page == index ? glyphs.erase(it) : std::next(it);
+
+        Page& page = pages[index];
+        page.shelfX = 0;
+        page.shelfY = 0;
+        page.shelfHeight = 0;
+        stats.evictedPages++;
+        generation++;
+    }
+
+    // Helper Function:    insertPrewarmed
+    // -----------------------------------
+    // Packs glyphs finished by the prewarm thread into free page space
+    //
+    // int maxGlyphs:       most glyphs to pack in this call
+    void GlyphCache::insertPrewarmed(int maxGlyphs)
+    {
+        static std::vector<GlyphBitmap> batch;
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            const int count = ImMin(maxGlyphs, (int)prewarmed.size());
+            std::move(prewarmed.end() - count, prewarmed.end(), std::back_inserter(batch));
+            prewarmed.resize(prewarmed.size() - count);
+        }
+
+        for (const GlyphBitmap& bitmap : batch)
+            if (insert(bitmap, false))
+                stats.prewarmed++;
+    }
+
+    // Helper Function:    prewarmLoop
+    // -------------------------------
+    // Body of the prewarm thread, rasterizing queued glyphs until the cache is destroyed
+    void GlyphCache::prewarmLoop()
+    {
+        for (;;)
+        {
+            uint64_t key = 0;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                prewarmCondition.wait(lock, [&] { return stopping || !prewarmQueue.empty(); });
+                if (stopping)
+                    return;
+                key = prewarmQueue.front();
+                prewarmQueue.pop_front();
+            }
+
+            GlyphBitmap bitmap = rasterize(key);
+
+            std::lock_guard<std::mutex> lock(mutex);
+            prewarmed.push_back(std::move(bitmap));
+        }
+    }
+
+    // Function:    AttachGlyphCache
+    // -----------------------------
+    // Makes LayoutText, and so every Draw:: text function, take characters the font's atlas lacks from a cache
+    // Cached glyphs sit on the font's baseline; a cache may serve several fonts.
+    //
+    // ImFont* font:        font whose missing characters the cache supplies
+    // GlyphCache* cache:   cache to attach, null to detach the current one
+    void AttachGlyphCache(ImFont* font, GlyphCache* cache)
+    {
+        attachedCaches.erase(std::remove_if(attachedCaches.begin(), attachedCaches.end(),
+                                            [&](const std::pair<const ImFont*, GlyphCache*>& entry) { return entry.first == font; }),
+                             attachedCaches.end());
+        if (cache != nullptr)
+            attachedCaches.push_back({ font, cache });
+        generation++;
+    }
+
+    // Function:    FindGlyphCache
+    // ---------------------------
+    // Returns the glyph cache attached to a font, or null
+    GlyphCache* FindGlyphCache(const ImFont* font)
+    {
+        for (const std::pair<const ImFont*, GlyphCache*>& entry : attachedCaches)
+            if (entry.first == font)
+                return entry.second;
+        return nullptr;
+    }
+
+    // Function:    MarkGlyphTextureDrawn
+    // ----------------------------------
+    // Marks a page as drawn this frame in every attached cache, for EmitGlyphs
+    //
+    // ImTextureID texture:     texture the glyphs were drawn from
+    void MarkGlyphTextureDrawn(ImTextureID texture)
+    {
+        for (const std::pair<const ImFont*, GlyphCache*>& entry : attachedCaches)
+            entry.second->MarkDrawn(texture);
+    }
+
+    // Function:    GlyphCacheGeneration
+    // ---------------------------------
+    // Returns a counter bumped whenever cached glyphs are dropped or a cache is attached or detached
+    int GlyphCacheGeneration()
+    {
+        return generation;
+    }
+
+} // Draw
@@ -0,0 +1,167 @@
+/*
+ * DrawGlyphCache.h
+ * Header of a dynamic glyph atlas for large character sets such as CJK. Instead of baking
+ * whole ranges into the ImFont atlas at startup, glyphs are rasterized from a TrueType file
+ * the first time they are drawn and packed into a few dynamic texture pages, of which only
+ * the new glyph's region is uploaded. When every page is full, the page drawn least recently
+ * is cleared and reused. Common glyphs can be rasterized ahead of time on a background thread.
+ *
+ * A cache attached to an ImFont serves every character that font's atlas lacks, so the Draw::
+ * text functions use it without any change at the call site. Its pages are dynamic textures
+ * with a single buffer, and each glyph's region is uploaded as soon as it is packed, outside the
+ * per-frame upload budget, so glyph pixels are on the GPU before the glyph can be drawn.
+ */
+#ifndef DRAWGLYPHCACHE_H
+#define DRAWGLYPHCACHE_H
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "imgui.h"
+#include "DynamicTexture.h"
+
+struct stbtt_fontinfo;
+
+// Structure:   CachedGlyph
+// ------------------------
+// A glyph rasterized into a page of a glyph cache
+//
+// ImFontGlyph glyph:   metrics at the rasterized size, Y relative to the baseline, and UVs in its page
+// float size:          pixel size the glyph was rasterized at
+// ImTextureID texture: page texture holding the glyph
+// int page:            index of the page, -1 for glyphs without pixels such as spaces
+struct CachedGlyph
+{
+    ImFontGlyph glyph = {};
+    float size = 0.0f;
+    ImTextureID texture = 0;
+    int page = -1;
+};
+
+// Structure:   GlyphCacheStats
+// ----------------------------
+// Activity of a glyph cache since it was loaded
+//
+// int glyphs:          glyphs currently cached
+// int pages:           atlas pages allocated
+// int rasterized:      glyphs rasterized on first use by the render thread
+// int prewarmed:       glyphs rasterized by the background thread and packed
+// int evictedPages:    pages cleared to make room, dropping their glyphs
+// int rejected:        glyphs that found no room because every page was drawn this frame
+// int pendingPrewarm:  prewarm requests not yet packed
+struct GlyphCacheStats
+{
+    int glyphs = 0;
+    int pages = 0;
+    int rasterized = 0;
+    int prewarmed = 0;
+    int evictedPages = 0;
+    int rejected = 0;
+    int pendingPrewarm = 0;
+};
+
+namespace Draw {
+
+    // Prewarmed glyphs packed per frame, so a large prewarm does not stall one frame with uploads
+    constexpr int GlyphPrewarmPerFrame = 64;
+
+    // Class:   GlyphCache
+    // -------------------
+    // Rasterizes glyphs of one TrueType font on demand into LRU-managed dynamic texture pages
+    // Find, Prewarm and the destructor must be called on the render thread.
+    class GlyphCache {
+    public:
+        GlyphCache();
+
+        // Stops the prewarm thread, releases the pages and detaches the cache from any font
+        ~GlyphCache();
+
+        GlyphCache(const GlyphCache&) = delete;
+        GlyphCache& operator=(const GlyphCache&) = delete;
+
+        // Reads a .ttf/.otf file, pages are square and created as glyphs need them
+        bool Load(const std::string& path, int pageSize = 1024, int maxPages = 4, int fontIndex = 0);
+
+        // Returns a glyph at a pixel size, rasterizing it on first use, or null if the font lacks it or no page has room
+        const CachedGlyph* Find(ImWchar codepoint, float fontSize);
+
+        // Queues ImGui-style glyph ranges, pairs ending in 0, for rasterization on a background thread
+        void Prewarm(const ImWchar* ranges, float fontSize);
+
+        // Keeps the page using a texture from being evicted this frame, for glyphs drawn from a stored layout
+        void MarkDrawn(ImTextureID texture);
+
+        // Current cache counters
+        GlyphCacheStats Stats() const;
+
+    private:
+        struct GlyphBitmap
+        {
+            uint64_t key = 0;
+            bool found = false;
+            int x0 = 0;
+            int y0 = 0;
+            int width = 0;
+            int height = 0;
+            float advance = 0.0f;
+            std::vector<unsigned char> alpha;
+        };
+
+        struct Page
+        {
+            Texture::DynamicHandle texture = -1;
+            ImTextureID id = 0;
+            int shelfX = 0;
+            int shelfY = 0;
+            int shelfHeight = 0;
+            int lastFrame = -1;
+        };
+
+        GlyphBitmap rasterize(uint64_t key) const;
+        bool insert(const GlyphBitmap& bitmap, bool allowEviction);
+        int allocate(int width, int height, bool allowEviction, int& x, int& y);
+        void evictPage(int index);
+        void insertPrewarmed(int maxGlyphs);
+        void prewarmLoop();
+
+        std::vector<unsigned char> fontData;
+        std::unique_ptr<stbtt_fontinfo> fontInfo;
+        bool loaded = false;
+        int pageSize = 0;
+        int maxPages = 0;
+        int insertedFrame = -1;
+        std::vector<Page> pages;
+        std::unordered_map<uint64_t, CachedGlyph> glyphs;
+        std::unordered_set<uint64_t> missing;
+        GlyphCacheStats stats;
+
+        mutable std::mutex mutex;
+        std::condition_variable prewarmCondition;
+        std::deque<uint64_t> prewarmQueue;
+        std::vector<GlyphBitmap> prewarmed;
+        std::thread prewarmThread;
+        bool stopping = false;
+    };
+
+    // Serves characters missing from a font's atlas from a glyph cache, null detaches the font's cache
+    void AttachGlyphCache(ImFont* font, GlyphCache* cache);
+
+    // The glyph cache attached to a font, or null
+    GlyphCache* FindGlyphCache(const ImFont* font);
+
+    // Marks a glyph cache page as drawn this frame in whichever attached cache owns the texture
+    void MarkGlyphTextureDrawn(ImTextureID texture);
+
+    // Changes whenever cached glyphs are dropped, so layouts kept across frames know to lay out again
+    int GlyphCacheGeneration();
+
+} // Draw
+
+#endif //DRAWGLYPHCACHE_H
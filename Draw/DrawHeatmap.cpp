@@ -0,0 +1,278 @@
+/*
+ * DrawHeatmap.cpp
+ * Source file implementation of a matrix renderer that draws a grid of scalar values as colored
+ * cells. Colors come from a 256-entry gradient lookup table that is sampled four values at a time
+ * with SSE2 or NEON where available, and geometry is written straight into the draw list.
+ */
+#include "DrawHeatmap.h"
+
+#include <vector>
+
+#include "ColorTools.h"
+#include "DrawPrimitives.h"
+#include "../ImVec2Operators.h"
+
+#include "imgui_internal.h"
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HEATMAP_SSE2
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#define HEATMAP_NEON
+#endif
+
+namespace Draw {
+    // Function:    MakeHeatmapGradient
+    // --------------------------------
+    // Samples Color's default indigo to blue-green gradient into a lookup table
+    //
+    // Returns a HeatmapGradient covering the full gradient
+    HeatmapGradient MakeHeatmapGradient()
+    {
+        HeatmapGradient gradient;
+        for (int i = 0; i < 256; i++)
+            gradient.colors[i] = Color::GetInterpolatedColorU32(i / 255.0f);
+        return gradient;
+    }
+
+    // Function:    MakeHeatmapGradient
+    // --------------------------------
+    // Samples a gradient between two RGB colors into a lookup table
+    //
+    // float r1, g1, b1:    RGB values for the color of the lowest value
+    // float r2, g2, b2:    RGB values for the color of the highest value
+    //
+    // Returns a HeatmapGradient covering the full gradient
+    HeatmapGradient MakeHeatmapGradient(float r1, float g1, float b1, float r2, float g2, float b2)
+    {
+        HeatmapGradient gradient;
+        for (int i = 0; i < 256; i++)
+            gradient.colors[i] = Color::GetInterpolatedColorU32(i / 255.0f, r1, g1, b1, r2, g2, b2);
+        return gradient;
+    }
+
+    // Function:    MapHeatmapColors
+    // -----------------------------
+    // Normalizes each value into [0, 255], clamps it and looks its color up in the gradient
+    // NaN values map to the low end of the gradient
+    //
+    // const float* values:         values to map
+    // int count:                   number of values
+    // float minValue:              value mapped to the low end of the gradient
+    // float maxValue:              value mapped to the high end of the gradient
+    // HeatmapGradient gradient:    color lookup table
+    // ImU32* outColors:            destination, count entries
+    void MapHeatmapColors(const float* values, int count, float minValue, float maxValue, const HeatmapGradient& gradient, ImU32* outColors)
+    {
+        const float range = maxValue - minValue;
+        const float scale = range != 0.0f ? 255.0f / range : 0.0f;
+        const ImU32* lut = gradient.colors;
+        int i = 0;
+
+#if defined(HEATMAP_SSE2)
+        const __m128 minimum = _mm_set1_ps(minValue);
+        const __m128 factor = _mm_set1_ps(scale);
+        const __m128 low = _mm_setzero_ps();
+        const __m128 high = _mm_set1_ps(255.0f);
+        alignas(16) int lanes[4];
+        for (; i + 4 <= count; i += 4)
+        {
+            __m128 v = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(values + i), minimum), factor);
+            v = _mm_min_ps(_mm_max_ps(v, low), high); // max() returns its second operand for NaN
+            _mm_store_si128((__m128i*)lanes, _mm_cvttps_epi32(v));
+            outColors[i + 0] = lut[lanes[0]];
+            outColors[i + 1] = lut[lanes[1]];
+            outColors[i + 2] = lut[lanes[2]];
+            outColors[i + 3] = lut[lanes[3]];
+        }
+#elif defined(HEATMAP_NEON)
+        const float32x4_t minimum = vdupq_n_f32(minValue);
+        const float32x4_t factor = vdupq_n_f32(scale);
+        const float32x4_t low = vdupq_n_f32(0.0f);
+        const float32x4_t high = vdupq_n_f32(255.0f);
+        int lanes[4];
+        for (; i + 4 <= count; i += 4)
+        {
+            float32x4_t v = vmulq_f32(vsubq_f32(vld1q_f32(values + i), minimum), factor);
+            v = vminq_f32(vmaxq_f32(v, low), high);
+            vst1q_s32(lanes, vcvtq_s32_f32(v)); // NaN converts to 0
+            outColors[i + 0] = lut[lanes[0]];
+            outColors[i + 1] = lut[lanes[1]];
+            outColors[i + 2] = lut[lanes[2]];
+            outColors[i + 3] = lut[lanes[3]];
+        }
+#endif
+
+        // Scalar tail, or the whole range without SIMD support
+        for (; i < count; i++)
+        {
+            float v = (values[i] - minValue) * scale;
+            if (!(v > 0.0f))
+                v = 0.0f;
+            if (v > 255.0f)
+                v = 255.0f;
+            outColors[i] = lut[(int)v];
+        }
+    }
+
+    // Helper Function:    HeatmapFlat
+    // --------------------------------
+    // Writes one solid quad per cell, reserving as many cells as the index type allows at a time
+    static void HeatmapFlat(ImDrawList* drawList, const ImU32* colors, int rows, int columns, ImVec2 origin, ImVec2 cellSize)
+    {
+        const int cellCount = rows * columns;
+
+        for (int chunkStart = 0; chunkStart < cellCount;)
+        {
+            const int chunkCells = ReserveItems(drawList, cellCount - chunkStart, 4, 6);
+            if (chunkCells == 0)
+            {
+                Stats().droppedItems += cellCount - chunkStart;
+                return;
+            }
+            const int chunkEnd = chunkStart + chunkCells;
+
+            for (int cell = chunkStart; cell < chunkEnd; cell++)
+            {
+                ImVec2 topLeft = origin + ImVec2((cell % columns) * cellSize.x, (cell / columns) * cellSize.y);
+                drawList->PrimRect(topLeft, topLeft + cellSize, colors[cell]);
+            }
+            chunkStart = chunkEnd;
+        }
+    }
+
+    // Helper Function:    HeatmapSmooth
+    // ----------------------------------
+    // Writes a lattice of (rows + 1) x (columns + 1) shared vertices colored by the average of the
+    // cells around each corner, indexed as two triangles per cell
+    // The lattice is emitted in horizontal bands small enough for a single reservation each
+    static void HeatmapSmooth(ImDrawList* drawList, const ImU32* cornerColors, int rows, int columns, ImVec2 origin, ImVec2 cellSize)
+    {
+        const int stride = columns + 1;
+        const int rowsPerBand = MaxVerticesPerReserve / stride - 1;
+        IM_ASSERT(rowsPerBand >= 1 && "Draw::Heatmap: too many columns for smooth mode with 16-bit indices");
+        if (rowsPerBand < 1)
+            return;
+
+        const ImVec2 uv = drawList->_Data->TexUvWhitePixel;
+
+        for (int bandStart = 0; bandStart < rows;)
+        {
+            // Without VtxOffset support a band must also fit the index space left in the list
+            const int bandRows = ImMin(ImMin(rowsPerBand, rows - bandStart), VertexBudget(drawList) / stride - 1);
+            if (bandRows < 1)
+            {
+                IM_ASSERT(false && "Draw::Heatmap: ran out of 16-bit indices, set ImGuiBackendFlags_RendererHasVtxOffset in the renderer");
+                Stats().droppedItems += (rows - bandStart) * columns;
+                return;
+            }
+            const unsigned int vtxOffset = drawList->_CmdHeader.VtxOffset;
+            drawList->PrimReserve(bandRows * columns * 6, (bandRows + 1) * stride);
+            if (drawList->_CmdHeader.VtxOffset != vtxOffset)
+                Stats().vtxOffsetSplits++;
+
+            // Indices are relative to the first vertex of the band, read after PrimReserve in case it started a new VtxOffset
+            const unsigned int base = drawList->_VtxCurrentIdx;
+
+            for (int row = bandStart; row <= bandStart + bandRows; row++)
+                for (int column = 0; column <= columns; column++)
+                    drawList->PrimWriteVtx(origin + ImVec2(column * cellSize.x, row * cellSize.y), uv, cornerColors[row * stride + column]);
+
+            for (int row = 0; row < bandRows; row++)
+            {
+                for (int column = 0; column < columns; column++)
+                {
+                    const unsigned int topLeft = base + row * stride + column;
+                    drawList->PrimWriteIdx((ImDrawIdx)topLeft);
+                    drawList->PrimWriteIdx((ImDrawIdx)(topLeft + 1));
+                    drawList->PrimWriteIdx((ImDrawIdx)(topLeft + stride + 1));
+                    drawList->PrimWriteIdx((ImDrawIdx)topLeft);
+                    drawList->PrimWriteIdx((ImDrawIdx)(topLeft + stride + 1));
+                    drawList->PrimWriteIdx((ImDrawIdx)(topLeft + stride));
+                }
+            }
+            bandStart += bandRows;
+        }
+    }
+
+    // Function:    Heatmap
+    // --------------------
+    // Draws a row-major matrix of values as a grid of colored cells
+    // Flat mode gives every cell a solid color. Smooth mode shares vertices between neighbouring
+    // cells and interpolates between them. Matrices larger than HeatmapTextureThreshold are drawn
+    // as a single image when a fallback texture is supplied; the texture is created or resized on
+    // demand and belongs to the caller. A heatmap outside the clip rect maps and uploads nothing.
+    //
+    // const float* values:         rows * columns values, row-major
+    // int rows:                    number of rows in the matrix
+    // int columns:                 number of columns in the matrix
+    // ImVec2 origin:               coordinates of upper left corner of the heatmap
+    // ImVec2 cellSize:             size of each cell in pixels
+    // float minValue:              value mapped to the low end of the gradient
+    // float maxValue:              value mapped to the high end of the gradient
+    // HeatmapGradient gradient:    color lookup table
+    // bool smooth:                 interpolates colors between neighbouring cells
+    // TextureData fallbackTexture: texture used above the size threshold, or null to always emit geometry
+    void Heatmap(const float* values, int rows, int columns, ImVec2 origin, ImVec2 cellSize, float minValue, float maxValue, const HeatmapGradient& gradient, bool smooth, TextureData* fallbackTexture)
+    {
+        if (rows <= 0 || columns <= 0)
+            return;
+
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::Heatmap, origin, origin + ImVec2(cellSize.x * columns, cellSize.y * rows)))
+            return;
+        const int cellCount = rows * columns;
+
+        // Scratch buffers are kept between calls to avoid a per-frame allocation
+        static std::vector<ImU32> colors;
+        static std::vector<float> corners;
+
+        if (fallbackTexture != nullptr && cellCount > HeatmapTextureThreshold)
+        {
+            colors.resize(cellCount);
+            MapHeatmapColors(values, cellCount, minValue, maxValue, gradient, colors.data());
+
+            if (fallbackTexture->id == 0 || fallbackTexture->width != columns || fallbackTexture->height != rows)
+            {
+                if (fallbackTexture->id != 0)
+                    glDeleteTextures(1, &fallbackTexture->id);
+                *fallbackTexture = Texture::FromPixels(colors.data(), columns, rows, smooth);
+            }
+            else
+                Texture::UpdatePixels(*fallbackTexture, colors.data());
+
+            drawList->AddImage((ImTextureID)(intptr_t)fallbackTexture->id, origin, origin + ImVec2(cellSize.x * columns, cellSize.y * rows));
+            return;
+        }
+
+        if (!smooth)
+        {
+            colors.resize(cellCount);
+            MapHeatmapColors(values, cellCount, minValue, maxValue, gradient, colors.data());
+            HeatmapFlat(drawList, colors.data(), rows, columns, origin, cellSize);
+            return;
+        }
+
+        // Average the (up to) four cells touching each lattice corner
+        const int stride = columns + 1;
+        corners.resize((rows + 1) * stride);
+        for (int row = 0; row <= rows; row++)
+        {
+            const int rowAbove = ImMax(row - 1, 0);
+            const int rowBelow = ImMin(row, rows - 1);
+            for (int column = 0; column <= columns; column++)
+            {
+                const int columnLeft = ImMax(column - 1, 0);
+                const int columnRight = ImMin(column, columns - 1);
+                corners[row * stride + column] = 0.25f * (values[rowAbove * columns + columnLeft] + values[rowAbove * columns + columnRight]
+                                                        + values[rowBelow * columns + columnLeft] + values[rowBelow * columns + columnRight]);
+            }
+        }
+
+        colors.resize(corners.size());
+        MapHeatmapColors(corners.data(), (int)corners.size(), minValue, maxValue, gradient, colors.data());
+        HeatmapSmooth(drawList, colors.data(), rows, columns, origin, cellSize);
+    }
+
+} // Draw
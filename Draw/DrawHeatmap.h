@@ -0,0 +1,42 @@
+/*
+ * DrawHeatmap.h
+ * Header of a matrix renderer that draws a grid of scalar values as colored cells.
+ * Values are mapped through a precomputed gradient lookup table and written to the draw list
+ * as raw quads, so a 512x512 matrix costs one pass over the data rather than one
+ * Draw::FilledRectangle call per cell.
+ */
+#ifndef DRAWHEATMAP_H
+#define DRAWHEATMAP_H
+#include "imgui.h"
+#include "TextureTools.h"
+
+namespace Draw {
+
+    // Matrices with more cells than this are uploaded as a texture when a fallback texture is supplied
+    constexpr int HeatmapTextureThreshold = 256 * 256;
+
+    // Structure:   HeatmapGradient
+    // ----------------------------
+    // 256-entry color lookup table sampled by Heatmap
+    //
+    // ImU32 colors:    solid colors from the low end (0) to the high end (255) of the gradient
+    struct HeatmapGradient
+    {
+        ImU32 colors[256];
+    };
+
+    // Builds a lookup table from Color's default gradient
+    HeatmapGradient MakeHeatmapGradient();
+
+    // Builds a lookup table between two RGB colors
+    HeatmapGradient MakeHeatmapGradient(float r1, float g1, float b1, float r2, float g2, float b2);
+
+    // Maps a row-major block of values to gradient colors
+    void MapHeatmapColors(const float* values, int count, float minValue, float maxValue, const HeatmapGradient& gradient, ImU32* outColors);
+
+    // Draws a row-major matrix of values as a grid of colored cells
+    void Heatmap(const float* values, int rows, int columns, ImVec2 origin, ImVec2 cellSize, float minValue, float maxValue, const HeatmapGradient& gradient, bool smooth = false, TextureData* fallbackTexture = nullptr);
+
+} // Draw
+
+#endif //DRAWHEATMAP_H
@@ -0,0 +1,354 @@
+/*
+ * DrawNumbers.cpp
+ * Source file implementation of numeric labels. Each label is formatted into a stack buffer,
+ * laid out into the shared glyph buffer from the font's cached digit table, and written with
+ * EmitGlyphs, so drawing a changing value costs no allocation once the buffers have grown.
+ */
+#include "DrawNumbers.h"
+
+#include <charconv>
+#include <cstring>
+#include <vector>
+
+#include "../ImVec2Operators.h"
+
+#include "DrawGlyphCache.h"
+#include "DrawPrimitives.h"
+#include "DrawTextLayout.h"
+#include "DrawTrace.h"
+#include "imgui_internal.h"
+
+namespace Draw {
+
+    // Fonts and sizes whose digit glyphs are kept, most recently used first
+    static constexpr int MaxDigitTables = 16;
+
+    // Structure:   DigitTable
+    // -----------------------
+    // Digit glyphs of one font at one size
+    // The glyph pointers point into the font's glyph array, so a table is also keyed on that array
+    // and on the atlas texture, which both change when the atlas is rebuilt.
+    //
+    // ImFont* font:            font the glyphs belong to
+    // ImFontGlyph* glyphData:  the font's glyph array when the table was built
+    // int glyphCount:          number of glyphs in that array
+    // ImTextureID texture:     texture of the font's atlas when the table was built
+    // float fontSize:          size the advance is scaled to
+    // ImFontGlyph* digits:     glyphs of '0' to '9'
+    // ImFontGlyph* minus:      glyph of '-'
+    // ImFontGlyph* point:      glyph of '.'
+    // float digitAdvance:      advance of the widest digit, shared by every digit
+    struct DigitTable
+    {
+        ImFont* font = nullptr;
+        const ImFontGlyph* glyphData = nullptr;
+        int glyphCount = 0;
+        ImTextureID texture = (ImTextureID)0;
+        float fontSize = 0.0f;
+        const ImFontGlyph* digits[10] = {};
+        const ImFontGlyph* minus = nullptr;
+        const ImFontGlyph* point = nullptr;
+        float digitAdvance = 0.0f;
+    };
+
+    static std::vector<DigitTable> digitTables;
+    static TextLayout numberLayout;
+
+    // Helper Function:    FindDigitTable
+    // ----------------------------------
+    // Returns the digit table of a font and size, looking the glyphs up on first use and again after
+    // the font's atlas is rebuilt
+    static const DigitTable& FindDigitTable(ImFont* font, float fontSize)
+    {
+        const ImTextureID texture = font->ContainerAtlas != nullptr ? font->ContainerAtlas->TexID : (ImTextureID)0;
+        for (size_t i = 0; i < digitTables.size(); i++)
+        {
+            const DigitTable& cached = digitTables[i];
+            if (cached.font == font && cached.fontSize == fontSize && cached.glyphData == font->Glyphs.Data
+                && cached.glyphCount == font->Glyphs.Size && cached.texture == texture)
+            {
+                if (i > 0)
+                    std::swap(digitTables[i], digitTables[0]);
+                return digitTables[0];
+            }
+        }
+
+        // A table of the same font and size built before a rebuild can never match again
+        for (size_t i = 0; i < digitTables.size(); i++)
+        {
+            if (digitTables[i].font == font && digitTables[i].fontSize == fontSize)
+            {
+                digitTables.erase(digitTables.begin() + i);
+                break;
+            }
+        }
+        if ((int)digitTables.size() == MaxDigitTables)
+            digitTables.pop_back();
+
+        DigitTable table;
+        table.font = font;
+        table.glyphData = font->Glyphs.Data;
+        table.glyphCount = font->Glyphs.Size;
+        table.texture = texture;
+        table.fontSize = fontSize;
+        const float scale = fontSize / font->FontSize;
+        for (int digit = 0; digit < 10; digit++)
+        {
+            table.digits[digit] = font->FindGlyph((ImWchar)('0' + digit));
+            if (table.digits[digit] != nullptr)
+                table.digitAdvance = ImMax(table.digitAdvance, table.digits[digit]->AdvanceX * scale);
+        }
+        table.minus = font->FindGlyph((ImWchar)'-');
+        table.point = font->FindGlyph((ImWchar)'.');
+
+        digitTables.insert(digitTables.begin(), table);
+        return digitTables[0];
+    }
+
+    // Helper Function:    FormatNumber
+    // --------------------------------
+    // Writes a number into a buffer with std::to_chars, in fixed notation unless it does not fit
+    //
+    // char* buffer:        destination, not null-terminated
+    // int size:            capacity of the buffer
+    // double value:        number to format
+    // int precision:       fractional digits, or ShortestPrecision for the shortest exact form
+    //
+    // Returns the number of characters written
+    static int FormatNumber(char* buffer, int size, double value, int precision)
+    {
+        precision = ImMin(precision, MaxNumberPrecision);
+        std::to_chars_result result = precision < 0
+            ? std::to_chars(buffer, buffer + size, value, std::chars_format::fixed)
+            : std::to_chars(buffer, buffer + size, value, std::chars_format::fixed, precision);
+        if (result.ec != std::errc())
+            result = precision < 0
+                ? std::to_chars(buffer, buffer + size, value, std::chars_format::scientific)
+                : std::to_chars(buffer, buffer + size, value, std::chars_format::scientific, precision);
+        return result.ec == std::errc() ? (int)(result.ptr - buffer) : 0;
+    }
+
+    // Helper Function:    LayoutNumber
+    // --------------------------------
+    // Formats a labeled number into a stack buffer and lays it out into the shared number layout
+    // Digits come from the digit table and are centered in cells of the widest digit's advance;
+    // the prefix, suffix and any other characters are looked up in the font as LayoutText would.
+    //
+    // ImDrawList* drawList:    draw list supplying the current font and size
+    // char* prefix:            text before the number, may be null
+    // double value:            number to format
+    // int precision:           fractional digits, or ShortestPrecision
+    // char* suffix:            text after the number, may be null
+    // ImFont font:             font style to be used, null for the current font
+    // float fontSize:          point size of font, 0 for the current size
+    //
+    // Returns the laid out label
+    static const TextLayout& LayoutNumber(const ImDrawList* drawList, const char* prefix, double value, int precision, const char* suffix, ImFont* font, float fontSize)
+    {
+        TextLayout& layout = numberLayout;
+        layout.font = font != nullptr ? font : drawList->_Data->Font;
+        layout.fontSize = fontSize > 0.0f ? fontSize : drawList->_Data->FontSize;
+        layout.glyphs.clear();
+        const DigitTable& table = FindDigitTable(layout.font, layout.fontSize);
+        const float scale = layout.fontSize / layout.font->FontSize;
+        const ImTextureID atlasTexture = layout.font->ContainerAtlas->TexID;
+        GlyphCache* cache = FindGlyphCache(layout.font);
+
+        // Prefix, number and suffix share one stack buffer; long affixes are cut short
+        constexpr int NumberCapacity = 64;
+        char text[256];
+        int length = 0;
+        if (prefix != nullptr)
+            for (; *prefix != '\0' && length < (int)sizeof(text) - NumberCapacity; prefix++)
+                text[length++] = *prefix;
+        const int numberBegin = length;
+        length += FormatNumber(text + length, NumberCapacity, value, precision);
+        const int numberEnd = length;
+        if (suffix != nullptr)
+            for (; *suffix != '\0' && length < (int)sizeof(text); suffix++)
+                text[length++] = *suffix;
+
+        float x = 0.0f;
+        for (int i = 0; i < length;)
+        {
+            const int byte = i;
+            const bool inNumber = byte >= numberBegin && byte < numberEnd;
+            GlyphSource source;
+            float cell = 0.0f;
+            unsigned int c = (unsigned char)text[i];
+
+            if (inNumber && c >= '0' && c <= '9')
+            {
+                source = GlyphSource{ table.digits[c - '0'], scale, 0.0f, atlasTexture };
+                cell = table.digitAdvance;
+                i++;
+            }
+            else
+            {
+                if (c < 0x80)
+                    i++;
+                else
+                    i += ImTextCharFromUtf8(&c, text + i, text + length);
+
+                // The number's own signs come from the digit table, the prefix and suffix from the
+                // same lookup as LayoutText so characters of an attached glyph cache are drawn
+                if (inNumber && (c == '-' || c == '.'))
+                    source = GlyphSource{ c == '-' ? table.minus : table.point, scale, 0.0f, atlasTexture };
+                else
+                    source = FindLayoutGlyph(layout.font, cache, layout.fontSize, c);
+                cell = source.glyph != nullptr ? source.glyph->AdvanceX * source.scale : 0.0f;
+            }
+            const ImFontGlyph* glyph = source.glyph;
+            if (glyph == nullptr)
+                continue;
+
+            if (glyph->Visible)
+            {
+                const float left = x + (cell - glyph->AdvanceX * source.scale) * 0.5f;
+                layout.glyphs.push_back({ glyph, ImVec2(left + glyph->X0 * source.scale, source.top + glyph->Y0 * source.scale),
+                                          ImVec2(left + glyph->X1 * source.scale, source.top + glyph->Y1 * source.scale), byte, source.texture });
+            }
+            x += cell;
+        }
+
+        layout.size = ImVec2(IM_TRUNC(x + 0.99999f), layout.fontSize);
+        return layout;
+    }
+
+    // Helper Function:    WithTransparency
+    // ------------------------------------
+    // Replaces a color's alpha with a transparency, as the Draw:: text helpers do
+    static ImU32 WithTransparency(ImU32 color, float transparency)
+    {
+        return (color & 0x00FFFFFF) | (ImU32)(transparency * 255.0f) << 24;
+    }
+
+    // Function:    Number
+    // -------------------
+    // Draws a number with a fixed number of fractional digits
+    //
+    // double value:        number to be written to the screen
+    // int precision:       fractional digits, or ShortestPrecision for the shortest exact form
+    // ImU32 color:         color of text
+    // float transparency:  relative transparency of text
+    // ImVec2 position:     coordinates of upper left of text box
+    // ImFont font:         font style to be used
+    // float fontSize:      point size of font
+    void Number(double value, int precision, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize)
+    {
+        TraceScope trace(TraceCall::Number, value, precision, color, transparency, position, font, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const TextLayout& layout = LayoutNumber(drawList, nullptr, value, precision, nullptr, font, fontSize);
+        if (!ClipTest(drawList, TraceCall::Number, position, position + layout.size))
+            return;
+
+        EmitGlyphs(drawList, layout, position, WithTransparency(color, transparency));
+    }
+
+    // Function:    Formatted
+    // ----------------------
+    // Draws a number between a prefix and a suffix, such as a currency sign or a unit
+    //
+    // char* prefix:        text before the number, may be null
+    // double value:        number to be written to the screen
+    // int precision:       fractional digits, or ShortestPrecision for the shortest exact form
+    // char* suffix:        text after the number, may be null
+    // ImU32 color:         color of text
+    // float transparency:  relative transparency of text
+    // ImVec2 position:     coordinates of upper left of text box
+    // ImFont font:         font style to be used
+    // float fontSize:      point size of font
+    void Formatted(const char* prefix, double value, int precision, const char* suffix, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize)
+    {
+        TraceScope trace(TraceCall::Formatted, prefix, value, precision, suffix, color, transparency, position, font, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const TextLayout& layout = LayoutNumber(drawList, prefix, value, precision, suffix, font, fontSize);
+        if (!ClipTest(drawList, TraceCall::Formatted, position, position + layout.size))
+            return;
+
+        EmitGlyphs(drawList, layout, position, WithTransparency(color, transparency));
+    }
+
+    // Function:    NumberWithStroke
+    // -----------------------------
+    // Draws a number with a stroke around it, redrawing the same glyphs around a circle as TextStroke does
+    //
+    // double value:        number to be written to the screen
+    // int precision:       fractional digits, or ShortestPrecision for the shortest exact form
+    // ImU32 strokeColor:   color of the stroke drawn around the displayed text
+    // ImU32 textColor:     color of the text in the foreground
+    // float transparency:  relative transparency of text
+    // float strokeWidth:   thickness of the stroke in pixels
+    // ImVec2 position:     coordinates of upper left of text box
+    // ImFont font:         font style to be used
+    // float fontSize:      point size of font
+    void NumberWithStroke(double value, int precision, ImU32 strokeColor, ImU32 textColor, float transparency, float strokeWidth, ImVec2 position, ImFont* font, float fontSize)
+    {
+        TraceScope trace(TraceCall::NumberWithStroke, value, precision, strokeColor, textColor, transparency, strokeWidth, position, font, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const TextLayout& layout = LayoutNumber(drawList, nullptr, value, precision, nullptr, font, fontSize);
+        const ImVec2 stroke = ImVec2(strokeWidth, strokeWidth);
+        if (!ClipTest(drawList, TraceCall::NumberWithStroke, position - stroke, position + layout.size + stroke))
+            return;
+
+        constexpr int segments = 32;
+        const float step = 2.0f * IM_PI / segments;
+        const ImU32 strokeWithAlpha = WithTransparency(strokeColor, transparency);
+        for (int i = 0; i < segments; i++)
+            EmitGlyphs(drawList, layout, position + ImVec2(cosf(step * i), sinf(step * i)) * strokeWidth, strokeWithAlpha);
+        EmitGlyphs(drawList, layout, position, WithTransparency(textColor, transparency));
+    }
+
+    // Function:    NumberWithHighlight
+    // --------------------------------
+    // Draws a number with a highlight box behind it
+    //
+    // double value:                number to be written to the screen
+    // int precision:               fractional digits, or ShortestPrecision for the shortest exact form
+    // ImFont font:                 font style
+    // float highlightWidth:        width of outer gap between outside of text box and inside of rectangle
+    // ImU32 textColor:             color of text
+    // ImU32 highlightColor:        color of the highlight
+    // float textTransparency:      opacity of the text
+    // float highlightTransparency: opacity of the highlight
+    // ImVec2 position:             coordinates of text box's upper left corner
+    // float fontSize:              size of the font
+    void NumberWithHighlight(double value, int precision, ImFont* font, float highlightWidth, ImU32 textColor, ImU32 highlightColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize)
+    {
+        TraceScope trace(TraceCall::NumberWithHighlight, value, precision, font, highlightWidth, textColor, highlightColor, textTransparency, highlightTransparency, position, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const TextLayout& layout = LayoutNumber(drawList, nullptr, value, precision, nullptr, font, fontSize);
+        const ImVec2 margin = ImVec2(highlightWidth, highlightWidth);
+        if (!ClipTest(drawList, TraceCall::NumberWithHighlight, position - margin, position + layout.size + margin))
+            return;
+
+        drawList->AddRectFilled(position - margin, position + layout.size + margin, WithTransparency(highlightColor, highlightTransparency));
+        EmitGlyphs(drawList, layout, position, WithTransparency(textColor, textTransparency));
+    }
+
+    // Function:    NumberSize
+    // -----------------------
+    // Measures a number as Number or Formatted would draw it
+    //
+    // char* prefix:        text before the number, may be null
+    // double value:        number to measure
+    // int precision:       fractional digits, or ShortestPrecision for the shortest exact form
+    // char* suffix:        text after the number, may be null
+    // ImFont font:         font style to be used, null for the current font
+    // float fontSize:      point size of font, 0 for the current size
+    //
+    // Returns the size of the label
+    ImVec2 NumberSize(const char* prefix, double value, int precision, const char* suffix, ImFont* font, float fontSize)
+    {
+        return LayoutNumber(ImGui::GetWindowDrawList(), prefix, value, precision, suffix, font, fontSize).size;
+    }
+
+    // Function:    ClearNumberCache
+    // -----------------------------
+    // Releases every digit table, whose glyphs point into the font atlas
+    void ClearNumberCache()
+    {
+        digitTables.clear();
+    }
+
+} // Draw
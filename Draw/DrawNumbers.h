@@ -0,0 +1,38 @@
+/*
+ * DrawNumbers.h
+ * Header of numeric labels for live counters. Values are formatted with std::to_chars into a
+ * stack buffer, so a dashboard of changing numbers builds no strings per frame, and drawn from
+ * a cached table of each font's digit glyphs. Digits share the widest digit's advance, so a
+ * counter keeps its width and alignment as its value changes.
+ */
+#ifndef DRAWNUMBERS_H
+#define DRAWNUMBERS_H
+#include "imgui.h"
+
+namespace Draw {
+
+    // Largest number of fractional digits a label formats, and the precision that selects the shortest exact form
+    constexpr int MaxNumberPrecision = 17;
+    constexpr int ShortestPrecision = -1;
+
+    // Draws a number with a fixed number of fractional digits, or its shortest exact form for ShortestPrecision
+    void Number(double value, int precision, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize = 0.0f);
+
+    // Draws a number between a prefix and a suffix, such as a currency sign or a unit
+    void Formatted(const char* prefix, double value, int precision, const char* suffix, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize = 0.0f);
+
+    // Draws a number with a stroke around it, see TextWithStroke
+    void NumberWithStroke(double value, int precision, ImU32 strokeColor, ImU32 textColor, float transparency, float strokeWidth, ImVec2 position, ImFont* font, float fontSize = 0.0f);
+
+    // Draws a number with a highlight behind it, see TextWithHighlight
+    void NumberWithHighlight(double value, int precision, ImFont* font, float highlightWidth, ImU32 textColor, ImU32 highlightColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize = 0.0f);
+
+    // Size of a number as Number or Formatted would draw it
+    ImVec2 NumberSize(const char* prefix, double value, int precision, const char* suffix, ImFont* font = nullptr, float fontSize = 0.0f);
+
+    // Releases every cached digit table, call after the font atlas is rebuilt
+    void ClearNumberCache();
+
+} // Draw
+
+#endif //DRAWNUMBERS_H
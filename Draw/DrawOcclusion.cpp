@@ -0,0 +1,457 @@
+/*
+ * DrawOcclusion.cpp
+ * Source file implementation of the opaque-occlusion post-pass. Draw lists are walked from the
+ * last triangle of the frame to the first, so every occluder found is drawn after everything
+ * still to be visited. Occluders are taken from fans of solid opaque triangles, the shape both
+ * PrimRect quads and ImGui's convex fills produce. Hidden triangles are removed by compacting
+ * each command's indices in place; vertices are left where they are.
+ */
+#include "DrawOcclusion.h"
+
+#include <cfloat>
+#include <vector>
+
+#include "../ImVec2Operators.h"
+
+#include "imgui_internal.h"
+
+namespace Draw {
+
+    // Most occluders tracked at once, the smallest is replaced when a larger one is found
+    static constexpr int MaxOccluders = 64;
+
+    // Axis-aligned screen rectangle known to be painted over by opaque geometry drawn later
+    struct Occluder
+    {
+        ImVec2 min;
+        ImVec2 max;
+    };
+
+    // Run of triangles sharing their first vertex, each continuing from the last edge of the previous
+    struct Fan
+    {
+        int firstTriangle;
+        int triangleCount;
+    };
+
+    static float Area(const ImVec2& min, const ImVec2& max)
+    {
+        return ImMax(0.0f, max.x - min.x) * ImMax(0.0f, max.y - min.y);
+    }
+
+    static float Cross(const ImVec2& a, const ImVec2& b)
+    {
+        return a.x * b.y - a.y * b.x;
+    }
+
+    // Helper Function:    Covered
+    // ---------------------------
+    // Tests whether any tracked occluder contains a rectangle
+    //
+    // vector occluders:    occluders drawn after the rectangle
+    // ImVec2 min:          upper left corner of the rectangle
+    // ImVec2 max:          lower right corner of the rectangle
+    //
+    // Returns true if the rectangle is hidden
+    static bool Covered(const std::vector<Occluder>& occluders, const ImVec2& min, const ImVec2& max)
+    {
+        for (const Occluder& occluder : occluders)
+        {
+            if (min.x >= occluder.min.x && min.y >= occluder.min.y && max.x <= occluder.max.x && max.y <= occluder.max.y)
+                return true;
+        }
+        return false;
+    }
+
+    // Helper Function:    AddOccluder
+    // -------------------------------
+    // Tracks a new occluder unless one already contains it, replacing the smallest when the list is full
+    //
+    // vector occluders:    occluders tracked so far
+    // Occluder occluder:   rectangle to add
+    // OcclusionStats stats: report to count the occluder in
+    static void AddOccluder(std::vector<Occluder>& occluders, const Occluder& occluder, OcclusionStats& stats)
+    {
+        if (Covered(occluders, occluder.min, occluder.max))
+            return;
+
+        stats.occluders++;
+        if ((int)occluders.size() < MaxOccluders)
+        {
+            occluders.push_back(occluder);
+            return;
+        }
+
+        int smallest = 0;
+        for (int i = 1; i < (int)occluders.size(); i++)
+        {
+            if (Area(occluders[i].min, occluders[i].max) < Area(occluders[smallest].min, occluders[smallest].max))
+                smallest = i;
+        }
+        if (Area(occluder.min, occluder.max) > Area(occluders[smallest].min, occluders[smallest].max))
+            occluders[smallest] = occluder;
+    }
+
+    // Helper Function:    FindFans
+    // ----------------------------
+    // Splits a command's triangles into fans of one color
+    // ImGui's convex fills emit their solid interior as a fan ahead of the anti-aliased fringe,
+    // whose transparent vertices end the fan; a PrimRect quad is a fan of two triangles.
+    //
+    // ImDrawVert* vertices:    vertex buffer seen from the command's VtxOffset
+    // ImDrawIdx* indices:      the command's indices
+    // int triangleCount:       number of triangles in the command
+    // vector fans:             receives the fans in draw order
+    static void FindFans(const ImDrawVert* vertices, const ImDrawIdx* indices, int triangleCount, std::vector<Fan>& fans)
+    {
+        fans.clear();
+        int triangle = 0;
+        while (triangle < triangleCount)
+        {
+            const ImDrawIdx* first = indices + triangle * 3;
+            int end = triangle + 1;
+            while (end < triangleCount)
+            {
+                const ImDrawIdx* next = indices + end * 3;
+                if (next[0] != first[0] || next[1] != next[-1] || vertices[next[2]].col != vertices[first[0]].col)
+                    break;
+                end++;
+            }
+
+            fans.push_back({ triangle, end - triangle });
+            triangle = end;
+        }
+    }
+
+    // Helper Function:    IsSolidFan
+    // ------------------------------
+    // Tests whether every vertex of a fan is opaque and samples the font atlas white pixel
+    //
+    // ImDrawVert* vertices:    vertex buffer seen from the command's VtxOffset
+    // ImDrawIdx* indices:      the command's indices
+    // Fan fan:                 fan to test
+    // ImVec2 whitePixel:       texture coordinate of the atlas white pixel
+    //
+    // Returns true if the fan paints its whole area with an opaque color
+    static bool IsSolidFan(const ImDrawVert* vertices, const ImDrawIdx* indices, const Fan& fan, const ImVec2& whitePixel)
+    {
+        const ImDrawIdx* triangle = indices + fan.firstTriangle * 3;
+        for (int i = 0; i < fan.triangleCount * 3; i++)
+        {
+            const ImDrawVert& vertex = vertices[triangle[i]];
+            if ((vertex.col & IM_COL32_A_MASK) != IM_COL32_A_MASK || vertex.uv.x != whitePixel.x || vertex.uv.y != whitePixel.y)
+                return false;
+        }
+        return true;
+    }
+
+    // Helper Function:    InscribedRect
+    // ---------------------------------
+    // Finds an axis-aligned rectangle inside the polygon a solid fan covers, such as a rounded panel
+    // The corner radius is read off the vertices lying on the bounding box edges, and the box is
+    // inset to the point where a circular corner crosses the diagonal, plus a pixel for tessellation.
+    // All four corners of the result are then checked against the polygon's edges.
+    //
+    // ImDrawVert* vertices:    vertex buffer seen from the command's VtxOffset
+    // ImDrawIdx* indices:      the command's indices
+    // Fan fan:                 solid fan of at least two triangles
+    // Occluder rect:           receives the rectangle
+    //
+    // Returns true if a non-empty rectangle was found
+    static bool InscribedRect(const ImDrawVert* vertices, const ImDrawIdx* indices, const Fan& fan, Occluder& rect)
+    {
+        static std::vector<ImVec2> polygon;
+        const ImDrawIdx* triangles = indices + fan.firstTriangle * 3;
+        polygon.clear();
+        polygon.push_back(vertices[triangles[0]].pos);
+        polygon.push_back(vertices[triangles[1]].pos);
+        for (int i = 0; i < fan.triangleCount; i++)
+            polygon.push_back(vertices[triangles[i * 3 + 2]].pos);
+
+        ImVec2 min = polygon[0];
+        ImVec2 max = polygon[0];
+        for (const ImVec2& point : polygon)
+        {
+            min = ImMin(min, point);
+            max = ImMax(max, point);
+        }
+
+        // Span of the vertices touching each edge of the bounding box
+        constexpr float edgeTolerance = 0.01f;
+        ImVec2 top = ImVec2(FLT_MAX, -FLT_MAX), bottom = top, left = top, right = top;
+        for (const ImVec2& point : polygon)
+        {
+            if (point.y <= min.y + edgeTolerance) { top.x = ImMin(top.x, point.x); top.y = ImMax(top.y, point.x); }
+            if (point.y >= max.y - edgeTolerance) { bottom.x = ImMin(bottom.x, point.x); bottom.y = ImMax(bottom.y, point.x); }
+            if (point.x <= min.x + edgeTolerance) { left.x = ImMin(left.x, point.y); left.y = ImMax(left.y, point.y); }
+            if (point.x >= max.x - edgeTolerance) { right.x = ImMin(right.x, point.y); right.y = ImMax(right.y, point.y); }
+        }
+        if (top.x > top.y || bottom.x > bottom.y || left.x > left.y || right.x > right.y)
+            return false;
+
+        float radius = ImMax(ImMax(top.x - min.x, max.x - top.y), ImMax(bottom.x - min.x, max.x - bottom.y));
+        radius = ImMax(radius, ImMax(ImMax(left.x - min.y, max.y - left.y), ImMax(right.x - min.y, max.y - right.y)));
+        const float inset = radius > edgeTolerance ? radius * (1.0f - 0.70710678f) + 1.0f : 0.0f;
+
+        rect.min = min + ImVec2(inset, inset);
+        rect.max = max - ImVec2(inset, inset);
+        if (rect.min.x >= rect.max.x || rect.min.y >= rect.max.y)
+            return false;
+
+        // Every corner must lie on the inner side of every edge, whichever way the fan winds
+        float winding = 0.0f;
+        for (size_t i = 0; i < polygon.size(); i++)
+            winding += Cross(polygon[i], polygon[(i + 1) % polygon.size()]);
+
+        const ImVec2 corners[4] = { rect.min, ImVec2(rect.max.x, rect.min.y), rect.max, ImVec2(rect.min.x, rect.max.y) };
+        for (size_t i = 0; i < polygon.size(); i++)
+        {
+            const ImVec2 a = polygon[i];
+            const ImVec2 edge = polygon[(i + 1) % polygon.size()] - a;
+            const float length = ImSqrt(ImLengthSqr(edge));
+            if (length <= 0.0f)
+                continue;
+            for (const ImVec2& corner : corners)
+            {
+                if (Cross(edge, corner - a) * (winding < 0.0f ? -1.0f : 1.0f) < -edgeTolerance * length)
+                    return false;
+            }
+        }
+        return true;
+    }
+
+    // Helper Function:    IsQuad
+    // --------------------------
+    // Tests whether a fan is a single axis-aligned quad written by PrimRect or PrimRectUV
+    // Such a quad owns its four vertices, so it can be trimmed in place.
+    //
+    // ImDrawVert* vertices:    vertex buffer seen from the command's VtxOffset
+    // ImDrawIdx* indices:      the command's indices
+    // Fan fan:                 fan to test
+    //
+    // Returns true if the fan is a trimmable quad
+    static bool IsQuad(const ImDrawVert* vertices, const ImDrawIdx* indices, const Fan& fan)
+    {
+        if (fan.triangleCount != 2)
+            return false;
+
+        const ImDrawIdx* index = indices + fan.firstTriangle * 3;
+        const ImDrawIdx a = index[0];
+        if (index[1] != a + 1 || index[2] != a + 2 || index[3] != a || index[4] != a + 2 || index[5] != a + 3)
+            return false;
+
+        const ImDrawVert* v = vertices + a;
+        return v[0].pos.y == v[1].pos.y && v[1].pos.x == v[2].pos.x && v[2].pos.y == v[3].pos.y && v[3].pos.x == v[0].pos.x
+            && v[0].pos.x < v[1].pos.x && v[0].pos.y < v[3].pos.y
+            && v[0].uv.y == v[1].uv.y && v[1].uv.x == v[2].uv.x && v[2].uv.y == v[3].uv.y && v[3].uv.x == v[0].uv.x
+            && v[0].col == v[1].col && v[0].col == v[2].col && v[0].col == v[3].col;
+    }
+
+    // Helper Function:    TrimQuad
+    // ----------------------------
+    // Shrinks the visible part of a quad by occluders that cover a whole side of it
+    //
+    // vector occluders:    occluders drawn after the quad
+    // ImVec2 min:          upper left corner of the quad's visible part, updated in place
+    // ImVec2 max:          lower right corner of the quad's visible part, updated in place
+    //
+    // Returns true if the visible part changed
+    static bool TrimQuad(const std::vector<Occluder>& occluders, ImVec2& min, ImVec2& max)
+    {
+        bool trimmed = false;
+        for (const Occluder& occluder : occluders)
+        {
+            if (occluder.min.y <= min.y && occluder.max.y >= max.y)
+            {
+                if (occluder.min.x <= min.x && occluder.max.x > min.x) { min.x = occluder.max.x; trimmed = true; }
+                if (occluder.max.x >= max.x && occluder.min.x < max.x) { max.x = occluder.min.x; trimmed = true; }
+            }
+            if (occluder.min.x <= min.x && occluder.max.x >= max.x)
+            {
+                if (occluder.min.y <= min.y && occluder.max.y > min.y) { min.y = occluder.max.y; trimmed = true; }
+                if (occluder.max.y >= max.y && occluder.min.y < max.y) { max.y = occluder.min.y; trimmed = true; }
+            }
+        }
+        return trimmed;
+    }
+
+    // Helper Function:    MoveQuad
+    // ----------------------------
+    // Moves a quad's corners to a smaller rectangle, interpolating its texture coordinates
+    //
+    // ImDrawVert* quad:    the quad's four vertices, clockwise from the upper left
+    // ImVec2 min:          new upper left corner
+    // ImVec2 max:          new lower right corner
+    static void MoveQuad(ImDrawVert* quad, const ImVec2& min, const ImVec2& max)
+    {
+        const ImVec2 oldMin = quad[0].pos;
+        const ImVec2 oldSize = quad[2].pos - oldMin;
+        const ImVec2 uvMin = quad[0].uv;
+        const ImVec2 uvSize = quad[2].uv - uvMin;
+
+        const ImVec2 uvA = uvMin + ImVec2((min.x - oldMin.x) / oldSize.x * uvSize.x, (min.y - oldMin.y) / oldSize.y * uvSize.y);
+        const ImVec2 uvB = uvMin + ImVec2((max.x - oldMin.x) / oldSize.x * uvSize.x, (max.y - oldMin.y) / oldSize.y * uvSize.y);
+
+        quad[0].pos = min;                      quad[0].uv = uvA;
+        quad[1].pos = ImVec2(max.x, min.y);     quad[1].uv = ImVec2(uvB.x, uvA.y);
+        quad[2].pos = max;                      quad[2].uv = uvB;
+        quad[3].pos = ImVec2(min.x, max.y);     quad[3].uv = ImVec2(uvA.x, uvB.y);
+    }
+
+    // Helper Function:    Compact
+    // ---------------------------
+    // Removes dropped triangles from a draw list's indices and rewrites its commands' offsets
+    //
+    // ImDrawList* list:        draw list to compact
+    // vector keep:             per triangle of the list, 0 when dropped
+    static void Compact(ImDrawList* list, const std::vector<unsigned char>& keep)
+    {
+        ImDrawIdx* indices = list->IdxBuffer.Data;
+        unsigned int write = 0;
+        for (ImDrawCmd& cmd : list->CmdBuffer)
+        {
+            const unsigned int first = cmd.IdxOffset;
+            unsigned int count = 0;
+            for (unsigned int i = 0; i < cmd.ElemCount; i += 3)
+            {
+                if (!keep[(first + i) / 3])
+                    continue;
+                indices[write + count] = indices[first + i];
+                indices[write + count + 1] = indices[first + i + 1];
+                indices[write + count + 2] = indices[first + i + 2];
+                count += 3;
+            }
+            cmd.IdxOffset = write;
+            cmd.ElemCount = count;
+            write += count;
+        }
+        list->IdxBuffer.resize((int)write);
+    }
+
+    // Function:    CullOccluded
+    // -------------------------
+    // Removes or trims geometry hidden behind opaque rectangles drawn later in the frame
+    // Triangles whose visible bounds lie inside an occluder are dropped, as are triangles entirely
+    // outside their clip rect. Quads partly covered along a whole side are shrunk to the rest.
+    // User callbacks may change render state, so occluders are forgotten when one is passed.
+    //
+    // ImDrawData* drawData:    frame to process, typically ImGui::GetDrawData()
+    // float minOccluderArea:   smallest visible area, in pixels, worth tracking as an occluder
+    //
+    // Returns a report of the geometry removed and the fill area saved
+    OcclusionStats CullOccluded(ImDrawData* drawData, float minOccluderArea)
+    {
+        OcclusionStats stats;
+        if (drawData == nullptr || !drawData->Valid)
+            return stats;
+
+        const ImFontAtlas* atlas = ImGui::GetIO().Fonts;
+        const ImTextureID atlasTexture = atlas->TexID;
+        const ImVec2 whitePixel = atlas->TexUvWhitePixel;
+
+        std::vector<Occluder> occluders;
+        std::vector<Fan> fans;
+        std::vector<unsigned char> keep;
+
+        for (int listIndex = drawData->CmdListsCount - 1; listIndex >= 0; listIndex--)
+        {
+            ImDrawList* list = drawData->CmdLists[listIndex];
+            keep.assign(list->IdxBuffer.Size / 3, 1);
+            int dropped = 0;
+
+            for (int cmdIndex = list->CmdBuffer.Size - 1; cmdIndex >= 0; cmdIndex--)
+            {
+                const ImDrawCmd& cmd = list->CmdBuffer[cmdIndex];
+                if (cmd.UserCallback != nullptr)
+                {
+                    occluders.clear();
+                    continue;
+                }
+
+                ImDrawVert* vertices = list->VtxBuffer.Data + cmd.VtxOffset;
+                const ImDrawIdx* indices = list->IdxBuffer.Data + cmd.IdxOffset;
+                const int firstTriangle = (int)cmd.IdxOffset / 3;
+                const ImVec2 clipMin = ImVec2(cmd.ClipRect.x, cmd.ClipRect.y);
+                const ImVec2 clipMax = ImVec2(cmd.ClipRect.z, cmd.ClipRect.w);
+                FindFans(vertices, indices, (int)cmd.ElemCount / 3, fans);
+
+                for (int fanIndex = (int)fans.size() - 1; fanIndex >= 0; fanIndex--)
+                {
+                    const Fan& fan = fans[fanIndex];
+
+                    if (IsQuad(vertices, indices, fan))
+                    {
+                        // Quads are dropped or trimmed as a unit
+                        ImDrawVert* quad = vertices + indices[fan.firstTriangle * 3];
+                        ImVec2 visibleMin = ImMax(quad[0].pos, clipMin);
+                        ImVec2 visibleMax = ImMin(quad[2].pos, clipMax);
+                        const float visibleArea = Area(visibleMin, visibleMax);
+                        stats.areaSubmitted += visibleArea;
+
+                        const bool hidden = visibleArea <= 0.0f || Covered(occluders, visibleMin, visibleMax);
+                        const bool trimmed = !hidden && TrimQuad(occluders, visibleMin, visibleMax);
+                        if (hidden || (trimmed && Area(visibleMin, visibleMax) <= 0.0f))
+                        {
+                            keep[firstTriangle + fan.firstTriangle] = 0;
+                            keep[firstTriangle + fan.firstTriangle + 1] = 0;
+                            dropped += 2;
+                            stats.areaSaved += visibleArea;
+                        }
+                        else if (trimmed)
+                        {
+                            MoveQuad(quad, visibleMin, visibleMax);
+                            stats.quadsTrimmed++;
+                            stats.areaSaved += visibleArea - Area(visibleMin, visibleMax);
+                        }
+                    }
+                    else
+                    {
+                        for (int triangle = fan.firstTriangle + fan.triangleCount - 1; triangle >= fan.firstTriangle; triangle--)
+                        {
+                            const ImVec2& a = vertices[indices[triangle * 3]].pos;
+                            const ImVec2& b = vertices[indices[triangle * 3 + 1]].pos;
+                            const ImVec2& c = vertices[indices[triangle * 3 + 2]].pos;
+                            const ImVec2 boundsMin = ImMin(ImMin(a, b), c);
+                            const ImVec2 boundsMax = ImMax(ImMax(a, b), c);
+                            const ImVec2 visibleMin = ImMax(boundsMin, clipMin);
+                            const ImVec2 visibleMax = ImMin(boundsMax, clipMax);
+
+                            // Triangle area scaled by the share of its bounds left inside the clip rect
+                            const float boundsArea = Area(boundsMin, boundsMax);
+                            const float visibleArea = boundsArea > 0.0f ? ImFabs(Cross(b - a, c - a)) * 0.5f * Area(visibleMin, visibleMax) / boundsArea : 0.0f;
+                            stats.areaSubmitted += visibleArea;
+
+                            if (visibleMin.x >= visibleMax.x || visibleMin.y >= visibleMax.y || Covered(occluders, visibleMin, visibleMax))
+                            {
+                                keep[firstTriangle + triangle] = 0;
+                                dropped++;
+                                stats.areaSaved += visibleArea;
+                            }
+                        }
+                    }
+
+                    // Once its own triangles are visited, an opaque fan hides everything drawn before it
+                    Occluder occluder;
+                    if (cmd.TextureId == atlasTexture && fan.triangleCount >= 2 && IsSolidFan(vertices, indices, fan, whitePixel)
+                        && InscribedRect(vertices, indices, fan, occluder))
+                    {
+                        occluder.min = ImMax(occluder.min, clipMin);
+                        occluder.max = ImMin(occluder.max, clipMax);
+                        if (Area(occluder.min, occluder.max) >= minOccluderArea)
+                            AddOccluder(occluders, occluder, stats);
+                    }
+                }
+            }
+
+            if (dropped > 0)
+            {
+                Compact(list, keep);
+                drawData->TotalIdxCount -= dropped * 3;
+                stats.trianglesDropped += dropped;
+            }
+        }
+
+        return stats;
+    }
+
+} // Draw
@@ -0,0 +1,43 @@
+/*
+ * DrawOcclusion.h
+ * Header of an optional post-pass over a frame's ImDrawData that removes geometry hidden behind
+ * opaque panels. Dashboards stack solid backgrounds and rounded panels over grids, so the same
+ * pixels are shaded several times over. The pass finds large opaque rectangles, drops earlier
+ * triangles they fully cover and trims earlier quads they partly cover, before the frame is
+ * handed to the renderer.
+ */
+#ifndef DRAWOCCLUSION_H
+#define DRAWOCCLUSION_H
+#include "imgui.h"
+
+namespace Draw {
+
+    // Smallest area, in pixels, an opaque rectangle needs to be tracked as an occluder
+    constexpr float DefaultOccluderArea = 64.0f * 64.0f;
+
+    // Structure:   OcclusionStats
+    // ---------------------------
+    // Report of one CullOccluded pass
+    //
+    // int occluders:           opaque rectangles tracked
+    // int trianglesDropped:    triangles removed because they were hidden or fully clipped
+    // int quadsTrimmed:        quads shrunk to the part left uncovered
+    // double areaSubmitted:    pixels covered by every triangle before the pass
+    // double areaSaved:        pixels the removed and trimmed geometry no longer covers
+    struct OcclusionStats
+    {
+        int occluders = 0;
+        int trianglesDropped = 0;
+        int quadsTrimmed = 0;
+        double areaSubmitted = 0.0;
+        double areaSaved = 0.0;
+    };
+
+    // Removes geometry hidden by later opaque rectangles, call between ImGui::Render and the renderer
+    // Occluders are solid-color fills drawn with the font atlas white pixel, such as FilledRectangle,
+    // RoundedRectangleBehind and gridlines. For rounded panels only the inscribed rectangle counts.
+    OcclusionStats CullOccluded(ImDrawData* drawData, float minOccluderArea = DefaultOccluderArea);
+
+} // Draw
+
+#endif //DRAWOCCLUSION_H
@@ -0,0 +1,357 @@
+/*
+ * DrawOverdraw.cpp
+ * Source file implementation of the overdraw view. Triangles are clipped to their command's clip
+ * rect and binned into square tiles of the count buffer. Worker threads then take whole tiles,
+ * so no two threads ever write the same count. Sample centers follow a consistent fill rule, so
+ * a pixel on an edge shared by two triangles is counted once, as a GPU would shade it.
+ */
+#include "DrawOverdraw.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <thread>
+
+#include "ColorTools.h"
+
+#include "imgui_internal.h"
+
+namespace Draw {
+
+    // Samples along each side of a tile handed to a worker
+    static constexpr int OverdrawTileSize = 64;
+
+    // Site index used for geometry written outside any library call
+    static constexpr int OtherSite = (int)TraceCall::Count;
+
+    // A triangle ready for rasterization, wound clockwise on screen
+    struct OverdrawTriangle
+    {
+        ImVec2 a, b, c;
+        int x0, y0, x1, y1; // Inclusive range of samples inside the bounds and clip rect
+        int site;
+    };
+
+    // Whether samples exactly on an edge belong to the triangle, chosen so that the two triangles
+    // sharing an edge, which run along it in opposite directions, never both claim them
+    static bool OwnsEdge(const ImVec2& from, const ImVec2& to)
+    {
+        return to.y > from.y || (to.y == from.y && to.x < from.x);
+    }
+
+    // Helper Function:    RasterizeTile
+    // ---------------------------------
+    // Counts the samples of one tile covered by each triangle binned to it
+    //
+    // vector triangles:        every triangle of the frame
+    // int* bin:                indices of the triangles overlapping the tile, in draw order
+    // int binSize:             number of triangles in the bin
+    // int tileX, tileY:        tile coordinates
+    // OverdrawReport report:   buffer dimensions and sample size
+    // ImVec2 origin:           screen position of the buffer's upper left corner
+    // uint16_t* counts:        count buffer
+    // vector sitePixels:       samples covered per site, accumulated
+    static void RasterizeTile(const std::vector<OverdrawTriangle>& triangles, const int* bin, int binSize, int tileX, int tileY,
+                              const OverdrawReport& report, ImVec2 origin, uint16_t* counts, std::vector<double>& sitePixels)
+    {
+        const float step = (float)report.sampleSize;
+        const int tileX0 = tileX * OverdrawTileSize;
+        const int tileY0 = tileY * OverdrawTileSize;
+        const int tileX1 = ImMin(tileX0 + OverdrawTileSize, report.samplesX) - 1;
+        const int tileY1 = ImMin(tileY0 + OverdrawTileSize, report.samplesY) - 1;
+
+        for (int i = 0; i < binSize; i++)
+        {
+            const OverdrawTriangle& triangle = triangles[bin[i]];
+            const int x0 = ImMax(triangle.x0, tileX0);
+            const int y0 = ImMax(triangle.y0, tileY0);
+            const int x1 = ImMin(triangle.x1, tileX1);
+            const int y1 = ImMin(triangle.y1, tileY1);
+
+            // Edge functions, positive inside, and how they change per sample
+            const ImVec2 vertices[3] = { triangle.a, triangle.b, triangle.c };
+            float rowStart[3], stepX[3], stepY[3];
+            bool owned[3];
+            const ImVec2 first = ImVec2(origin.x + (x0 + 0.5f) * step, origin.y + (y0 + 0.5f) * step);
+            for (int edge = 0; edge < 3; edge++)
+            {
+                const ImVec2& from = vertices[edge];
+                const ImVec2& to = vertices[(edge + 1) % 3];
+                rowStart[edge] = (to.x - from.x) * (first.y - from.y) - (to.y - from.y) * (first.x - from.x);
+                stepX[edge] = -(to.y - from.y) * step;
+                stepY[edge] = (to.x - from.x) * step;
+                owned[edge] = OwnsEdge(from, to);
+            }
+
+            int covered = 0;
+            for (int y = y0; y <= y1; y++)
+            {
+                float w0 = rowStart[0], w1 = rowStart[1], w2 = rowStart[2];
+                uint16_t* row = counts + (size_t)y * report.samplesX;
+                for (int x = x0; x <= x1; x++)
+                {
+                    if ((w0 > 0.0f || (w0 == 0.0f && owned[0])) && (w1 > 0.0f || (w1 == 0.0f && owned[1])) && (w2 > 0.0f || (w2 == 0.0f && owned[2])))
+                    {
+                        if (row[x] < UINT16_MAX)
+                            row[x]++;
+                        covered++;
+                    }
+                    w0 += stepX[0];
+                    w1 += stepX[1];
+                    w2 += stepX[2];
+                }
+                rowStart[0] += stepY[0];
+                rowStart[1] += stepY[1];
+                rowStart[2] += stepY[2];
+            }
+            sitePixels[triangle.site] += covered;
+        }
+    }
+
+    // Function:    BeginFrame
+    // -----------------------
+    // Starts collecting the index ranges written by top-level Draw:: calls for attribution
+    void OverdrawView::BeginFrame()
+    {
+        BeginSpans();
+    }
+
+    // Function:    Analyze
+    // --------------------
+    // Rasterizes every triangle of a frame into the count buffer and summarizes the fill cost
+    // Triangles outside the spans collected since BeginFrame are attributed to TraceCall::Count.
+    //
+    // ImDrawData* drawData:    frame to analyze, typically ImGui::GetDrawData()
+    void OverdrawView::Analyze(const ImDrawData* drawData)
+    {
+        EndSpans();
+        const auto start = std::chrono::steady_clock::now();
+        report = OverdrawReport();
+        if (drawData == nullptr || !drawData->Valid)
+            return;
+
+        const float step = (float)sampleSize;
+        displayPos = drawData->DisplayPos;
+        report.sampleSize = sampleSize;
+        report.samplesX = (int)std::ceil(drawData->DisplaySize.x / step);
+        report.samplesY = (int)std::ceil(drawData->DisplaySize.y / step);
+        if (report.samplesX <= 0 || report.samplesY <= 0)
+            return;
+        counts.assign((size_t)report.samplesX * report.samplesY, 0);
+
+        // Gather triangles with the sample range they can cover and the call that wrote them
+        static std::vector<OverdrawTriangle> triangles;
+        std::vector<int> siteTriangles(OtherSite + 1, 0);
+        const std::vector<TraceSpan>& spans = Spans();
+        triangles.clear();
+
+        for (int listIndex = 0; listIndex < drawData->CmdListsCount; listIndex++)
+        {
+            const ImDrawList* list = drawData->CmdLists[listIndex];
+            if (std::find(overlayLists.begin(), overlayLists.end(), list) != overlayLists.end())
+                continue;
+
+            // Spans of one list are recorded in index order
+            std::vector<const TraceSpan*> listSpans;
+            for (const TraceSpan& span : spans)
+                if (span.drawList == list)
+                    listSpans.push_back(&span);
+            size_t spanCursor = 0;
+
+            for (const ImDrawCmd& cmd : list->CmdBuffer)
+            {
+                if (cmd.UserCallback != nullptr)
+                    continue;
+
+                const ImDrawVert* vertices = list->VtxBuffer.Data + cmd.VtxOffset;
+                const ImDrawIdx* indices = list->IdxBuffer.Data + cmd.IdxOffset;
+                for (unsigned int i = 0; i < cmd.ElemCount; i += 3)
+                {
+                    const unsigned int index = cmd.IdxOffset + i;
+                    while (spanCursor < listSpans.size() && listSpans[spanCursor]->idxEnd <= index)
+                        spanCursor++;
+                    const int site = spanCursor < listSpans.size() && listSpans[spanCursor]->idxBegin <= index ? (int)listSpans[spanCursor]->call : OtherSite;
+
+                    OverdrawTriangle triangle;
+                    triangle.a = vertices[indices[i]].pos;
+                    triangle.b = vertices[indices[i + 1]].pos;
+                    triangle.c = vertices[indices[i + 2]].pos;
+                    const float area = (triangle.b.x - triangle.a.x) * (triangle.c.y - triangle.a.y) - (triangle.b.y - triangle.a.y) * (triangle.c.x - triangle.a.x);
+                    if (area == 0.0f)
+                        continue;
+                    if (area < 0.0f)
+                        std::swap(triangle.b, triangle.c);
+
+                    // Samples whose centers fall inside both the triangle's bounds and the clip rect
+                    const ImVec2 min = ImMax(ImMin(ImMin(triangle.a, triangle.b), triangle.c), ImVec2(cmd.ClipRect.x, cmd.ClipRect.y));
+                    const ImVec2 max = ImMin(ImMax(ImMax(triangle.a, triangle.b), triangle.c), ImVec2(cmd.ClipRect.z, cmd.ClipRect.w));
+                    triangle.x0 = ImMax(0, (int)std::ceil((min.x - displayPos.x) / step - 0.5f));
+                    triangle.y0 = ImMax(0, (int)std::ceil((min.y - displayPos.y) / step - 0.5f));
+                    triangle.x1 = ImMin(report.samplesX - 1, (int)std::floor((max.x - displayPos.x) / step - 0.5f));
+                    triangle.y1 = ImMin(report.samplesY - 1, (int)std::floor((max.y - displayPos.y) / step - 0.5f));
+                    if (triangle.x0 > triangle.x1 || triangle.y0 > triangle.y1)
+                        continue;
+
+                    triangle.site = site;
+                    triangles.push_back(triangle);
+                    siteTriangles[site]++;
+                }
+            }
+        }
+
+        // Bin triangles by tile with a counting sort, keeping draw order within each tile
+        const int tilesX = (report.samplesX + OverdrawTileSize - 1) / OverdrawTileSize;
+        const int tilesY = (report.samplesY + OverdrawTileSize - 1) / OverdrawTileSize;
+        std::vector<int> binStart(tilesX * tilesY + 1, 0);
+        for (const OverdrawTriangle& triangle : triangles)
+            for (int ty = triangle.y0 / OverdrawTileSize; ty <= triangle.y1 / OverdrawTileSize; ty++)
+                for (int tx = triangle.x0 / OverdrawTileSize; tx <= triangle.x1 / OverdrawTileSize; tx++)
+                    binStart[ty * tilesX + tx + 1]++;
+        for (int tile = 1; tile <= tilesX * tilesY; tile++)
+            binStart[tile] += binStart[tile - 1];
+
+        std::vector<int> binned(binStart.back());
+        std::vector<int> cursor(binStart.begin(), binStart.end() - 1);
+        for (int i = 0; i < (int)triangles.size(); i++)
+            for (int ty = triangles[i].y0 / OverdrawTileSize; ty <= triangles[i].y1 / OverdrawTileSize; ty++)
+                for (int tx = triangles[i].x0 / OverdrawTileSize; tx <= triangles[i].x1 / OverdrawTileSize; tx++)
+                    binned[cursor[ty * tilesX + tx]++] = i;
+
+        // Workers take tiles one at a time, each keeping its own per-site totals
+        const int tileCount = tilesX * tilesY;
+        const int workerCount = (int)ImClamp(std::thread::hardware_concurrency(), 1u, (unsigned int)tileCount);
+        std::vector<std::vector<double>> workerPixels(workerCount, std::vector<double>(OtherSite + 1, 0.0));
+        std::atomic<int> nextTile(0);
+
+        auto work = [&](int worker)
+        {
+            for (int tile = nextTile++; tile < tileCount; tile = nextTile++)
+                RasterizeTile(triangles, binned.data() + binStart[tile], binStart[tile + 1] - binStart[tile], tile % tilesX, tile / tilesX,
+                              report, displayPos, counts.data(), workerPixels[worker]);
+        };
+
+        std::vector<std::thread> workers;
+        for (int worker = 1; worker < workerCount; worker++)
+            workers.emplace_back(work, worker);
+        work(0);
+        for (std::thread& worker : workers)
+            worker.join();
+
+        // Totals, in pixels
+        const double pixelsPerSample = (double)sampleSize * sampleSize;
+        for (uint16_t count : counts)
+        {
+            report.pixelsShaded += count;
+            report.pixelsCovered += count > 0 ? 1 : 0;
+            report.maxDepth = ImMax(report.maxDepth, (int)count);
+        }
+        report.pixelsShaded *= pixelsPerSample;
+        report.pixelsCovered *= pixelsPerSample;
+
+        for (int site = 0; site <= OtherSite; site++)
+        {
+            OverdrawSite entry;
+            entry.call = (TraceCall)site;
+            entry.triangles = siteTriangles[site];
+            for (const std::vector<double>& pixels : workerPixels)
+                entry.pixels += pixels[site] * pixelsPerSample;
+            if (entry.pixels > 0.0)
+                report.sites.push_back(entry);
+        }
+        std::sort(report.sites.begin(), report.sites.end(), [](const OverdrawSite& a, const OverdrawSite& b) { return a.pixels > b.pixels; });
+
+        // Mean overdraw per heatmap cell
+        cellColumns = (int)std::ceil(drawData->DisplaySize.x / cellSize);
+        cellRows = (int)std::ceil(drawData->DisplaySize.y / cellSize);
+        cells.assign((size_t)cellColumns * cellRows, 0.0f);
+        std::vector<int> cellSamples(cells.size(), 0);
+        for (int y = 0; y < report.samplesY; y++)
+        {
+            const int cellY = ImMin((int)((y + 0.5f) * step / cellSize), cellRows - 1);
+            for (int x = 0; x < report.samplesX; x++)
+            {
+                const int cell = cellY * cellColumns + ImMin((int)((x + 0.5f) * step / cellSize), cellColumns - 1);
+                cells[cell] += counts[(size_t)y * report.samplesX + x];
+                cellSamples[cell]++;
+            }
+        }
+        for (size_t cell = 0; cell < cells.size(); cell++)
+            if (cellSamples[cell] > 0)
+                cells[cell] /= (float)cellSamples[cell];
+
+        report.milliseconds = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Function:    ShowOverlay
+    // ------------------------
+    // Draws the last analysis over the main viewport and lists the costliest calls in a window
+    // Untouched cells are left clear; the gradient runs from one layer up to the configured depth.
+    void OverdrawView::ShowOverlay()
+    {
+        overlayLists.clear();
+        if (cells.empty())
+            return;
+
+        if (!gradientReady)
+        {
+            gradient = MakeHeatmapGradient();
+            for (int i = 0; i < 256; i++)
+                gradient.colors[i] = i == 0 ? 0 : Color::WithAlpha(Color::GetInterpolatedColorU32(i / 255.0f), 0.6f);
+            gradientReady = true;
+        }
+
+        const ImGuiViewport* viewport = ImGui::GetMainViewport();
+        ImGui::SetNextWindowPos(viewport->Pos);
+        ImGui::SetNextWindowSize(viewport->Size);
+        ImGui::Begin("##OverdrawHeatmap", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoInputs | ImGuiWindowFlags_NoBackground
+                     | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing | ImGuiWindowFlags_NoNav);
+        ImGui::BringWindowToDisplayFront(ImGui::GetCurrentWindow());
+        overlayLists.push_back(ImGui::GetWindowDrawList());
+        Heatmap(cells.data(), cellRows, cellColumns, displayPos, ImVec2(cellSize, cellSize), 0.0f, (float)maxDepth, gradient);
+        ImGui::End();
+
+        ImGui::SetNextWindowBgAlpha(0.85f);
+        ImGui::Begin("Overdraw", nullptr, ImGuiWindowFlags_AlwaysAutoResize | ImGuiWindowFlags_NoSavedSettings | ImGuiWindowFlags_NoFocusOnAppearing);
+        overlayLists.push_back(ImGui::GetWindowDrawList());
+
+        const double coverage = report.pixelsCovered > 0.0 ? report.pixelsShaded / report.pixelsCovered : 0.0;
+        ImGui::Text("%.2f Mpx shaded over %.2f Mpx covered, %.2fx mean, %d deepest", report.pixelsShaded * 1e-6, report.pixelsCovered * 1e-6, coverage, report.maxDepth);
+        ImGui::Text("%dx%d samples of %d px, rasterized in %.2f ms", report.samplesX, report.samplesY, report.sampleSize, report.milliseconds);
+
+        if (ImGui::BeginTable("OverdrawSites", 4, ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV))
+        {
+            ImGui::TableSetupColumn("Call");
+            ImGui::TableSetupColumn("Mpx shaded");
+            ImGui::TableSetupColumn("Share");
+            ImGui::TableSetupColumn("Triangles");
+            ImGui::TableHeadersRow();
+
+            constexpr int shownSites = 12;
+            for (int i = 0; i < (int)report.sites.size() && i < shownSites; i++)
+            {
+                const OverdrawSite& site = report.sites[i];
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(site.call == TraceCall::Count ? "(outside Draw::)" : TraceCallName(site.call));
+                ImGui::TableNextColumn();
+                ImGui::Text("%.3f", site.pixels * 1e-6);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f%%", report.pixelsShaded > 0.0 ? site.pixels * 100.0 / report.pixelsShaded : 0.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%d", site.triangles);
+            }
+            ImGui::EndTable();
+        }
+        ImGui::End();
+    }
+
+    // Accessors
+    const OverdrawReport& OverdrawView::Report() const { return report; }
+
+    // Mutators
+    void OverdrawView::SetSampleSize(int pixels) { sampleSize = ImMax(1, pixels); }
+    void OverdrawView::SetCellSize(float pixels) { cellSize = ImMax(1.0f, pixels); }
+    void OverdrawView::SetMaxDepth(int layers) { maxDepth = ImMax(1, layers); }
+
+} // Draw
@@ -0,0 +1,116 @@
+/*
+ * DrawOverdraw.h
+ * Header of a diagnostic view of where a frame's fill rate goes. The frame's triangles are
+ * rasterized on the CPU into a per-pixel count of how many times each pixel is shaded, split
+ * into tiles spread over worker threads. The counts are shown as a heatmap over the viewport,
+ * next to a table of the Draw:: calls whose geometry shaded the most pixels, such as the 33
+ * passes of stroked text or stacked highlights.
+ *
+ * Typical frame:
+ *     overdraw.BeginFrame();
+ *     ... build windows ...
+ *     overdraw.ShowOverlay();
+ *     ImGui::Render();
+ *     overdraw.Analyze(ImGui::GetDrawData());
+ */
+#ifndef DRAWOVERDRAW_H
+#define DRAWOVERDRAW_H
+#include <cstdint>
+#include <vector>
+
+#include "imgui.h"
+#include "DrawHeatmap.h"
+#include "DrawTrace.h"
+
+namespace Draw {
+
+    // Structure:   OverdrawSite
+    // -------------------------
+    // Fill cost of one kind of Draw:: call in an analyzed frame
+    //
+    // TraceCall call:      the call, TraceCall::Count for geometry written outside any library call
+    // double pixels:       pixels shaded by the call's triangles, counting every layer
+    // int triangles:       triangles the call submitted
+    struct OverdrawSite
+    {
+        TraceCall call = TraceCall::Count;
+        double pixels = 0.0;
+        int triangles = 0;
+    };
+
+    // Structure:   OverdrawReport
+    // ---------------------------
+    // Summary of the last analyzed frame
+    //
+    // int samplesX, samplesY:      size of the count buffer
+    // int sampleSize:              pixels per sample along each axis
+    // double pixelsShaded:         pixels shaded, counting every layer
+    // double pixelsCovered:        pixels shaded at least once
+    // int maxDepth:                most layers shaded at a single sample
+    // double milliseconds:         time spent rasterizing
+    // vector sites:                calls that shaded pixels, costliest first
+    struct OverdrawReport
+    {
+        int samplesX = 0;
+        int samplesY = 0;
+        int sampleSize = 1;
+        double pixelsShaded = 0.0;
+        double pixelsCovered = 0.0;
+        int maxDepth = 0;
+        double milliseconds = 0.0;
+        std::vector<OverdrawSite> sites;
+    };
+
+    // Class:   OverdrawView
+    // ---------------------
+    // Measures and displays per-pixel overdraw of whole frames
+    // Geometry is attributed to calls through the index ranges TraceScope collects while spans are on.
+    class OverdrawView {
+    public:
+        // Starts attributing geometry to Draw:: calls, call before the frame's windows are built
+        void BeginFrame();
+
+        // Rasterizes the frame into the count buffer, call after ImGui::Render
+        void Analyze(const ImDrawData* drawData);
+
+        // Draws the last analysis as a heatmap over the main viewport with a table of the costliest calls
+        // Call last in the frame so the heatmap stays on top; the overlay's own windows are not analyzed.
+        void ShowOverlay();
+
+        // Summary of the last analyzed frame
+        const OverdrawReport& Report() const;
+
+        // Pixels per sample along each axis, 1 to rasterize every pixel
+        void SetSampleSize(int pixels);
+
+        // Size of the heatmap's cells in pixels
+        void SetCellSize(float pixels);
+
+        // Overdraw shown at the hot end of the gradient
+        void SetMaxDepth(int layers);
+
+    private:
+        OverdrawReport report;
+        std::vector<uint16_t> counts;
+
+        // Mean overdraw per heatmap cell, row-major
+        std::vector<float> cells;
+        int cellRows = 0;
+        int cellColumns = 0;
+        ImVec2 displayPos = ImVec2(0.0f, 0.0f);
+
+        // Draw lists of the overlay's own windows, skipped by Analyze
+        std::vector<const ImDrawList*> overlayLists;
+
+        HeatmapGradient gradient;
+        bool gradientReady = false;
+
+        // Tuning
+        int sampleSize = 2;
+        float cellSize = 8.0f;
+        int maxDepth = 8;
+    };
+
+} // Draw
+
+#endif //DRAWOVERDRAW_H
@@ -0,0 +1,130 @@
+/*
+ * DrawPrimitives.h
+ * Internal header of constants and inline helpers shared by the Draw:: bulk emitters
+ * that write vertex and index data straight into an ImDrawList.
+ */
+#ifndef DRAWPRIMITIVES_H
+#define DRAWPRIMITIVES_H
+#include "imgui.h"
+
+#include "DrawStats.h"
+#include "DrawTrace.h"
+#include "imgui_internal.h"
+
+namespace Draw {
+
+    // Largest vertex count a single PrimReserve call may request with the active ImDrawIdx size
+    constexpr int MaxVerticesPerReserve = sizeof(ImDrawIdx) == 2 ? 0xFFFF : 0x3FFFFFFF;
+
+    // Whether PrimReserve may start a new command at a new VtxOffset when 16-bit indices run out
+    // ImGui enables this on every draw list when the renderer sets ImGuiBackendFlags_RendererHasVtxOffset.
+    inline bool SupportsVtxOffset(const ImDrawList* drawList)
+    {
+        return sizeof(ImDrawIdx) > 2 || (drawList->Flags & ImDrawListFlags_AllowVtxOffset) != 0;
+    }
+
+    // Largest vertex count the next PrimReserve on a draw list can take without overflowing its indices
+    // Without VtxOffset support, only the index space left since the list's last command applies.
+    inline int VertexBudget(const ImDrawList* drawList)
+    {
+        if (SupportsVtxOffset(drawList))
+            return MaxVerticesPerReserve;
+        return (1 << 16) - 1 - (int)drawList->_VtxCurrentIdx;
+    }
+
+    // Reserves room for up to count items of a fixed size in one PrimReserve
+    // Large requests are cut into chunks that each start a new VtxOffset when 16-bit indices run out.
+    // With 16-bit indices and no renderer VtxOffset support, callers drop the items that no longer
+    // fit, counting them in Stats().droppedItems, rather than writing wrapped indices.
+    //
+    // Returns the number of items reserved, 0 once nothing more fits
+    inline int ReserveItems(ImDrawList* drawList, int count, int verticesPerItem, int indicesPerItem)
+    {
+        int items = ImMin(count, VertexBudget(drawList) / verticesPerItem);
+        if (items <= 0)
+        {
+            IM_ASSERT(false && "Draw:: ran out of 16-bit indices, set ImGuiBackendFlags_RendererHasVtxOffset in the renderer or build ImGui with '#define ImDrawIdx unsigned int'");
+            return 0;
+        }
+
+        unsigned int vtxOffset = drawList->_CmdHeader.VtxOffset;
+        drawList->PrimReserve(items * indicesPerItem, items * verticesPerItem);
+        if (drawList->_CmdHeader.VtxOffset != vtxOffset)
+            Stats().vtxOffsetSplits++;
+        return items;
+    }
+
+    // Whether bounds overlap the draw list's current clip rect, without counting the test
+    // Used for the parts of a call, such as the cells of a grid, whose call is counted once by ClipTest.
+    inline bool ClipVisible(const ImDrawList* drawList, const ImVec2& min, const ImVec2& max)
+    {
+        const ImVec4& clip = drawList->_CmdHeader.ClipRect;
+        return max.x > clip.x && max.y > clip.y && min.x < clip.z && min.y < clip.w;
+    }
+
+    // Tests a call's bounds against the draw list's current clip rect, counting the outcome for the call
+    // Returns false when nothing inside the bounds can be visible, so the call may skip emission
+    // Only the library call the user made is tested here; the draws it is built from take an internal
+    // path with no test of their own, so each call is counted once.
+    inline bool ClipTest(const ImDrawList* drawList, TraceCall call, const ImVec2& min, const ImVec2& max)
+    {
+        if (!ClipVisible(drawList, min, max))
+        {
+            Stats().culledCalls[(int)call]++;
+            return false;
+        }
+        Stats().emittedCalls[(int)call]++;
+        return true;
+    }
+
+    // Mirrors ImGui's own test for whether a rectangle needs corner tessellation
+    inline bool IsRounded(float rounding, ImDrawFlags rectangleFlags)
+    {
+        return rounding >= 0.5f && (rectangleFlags & ImDrawFlags_RoundCornersMask_) != ImDrawFlags_RoundCornersNone;
+    }
+
+    // Whether a coordinate falls on a framebuffer pixel boundary, where a hard edge needs no anti-aliasing
+    inline bool IsPixelAligned(float coordinate, float framebufferScale)
+    {
+        float pixels = coordinate * framebufferScale;
+        return ImFabs(pixels - ImFloor(pixels + 0.5f)) < 0.01f;
+    }
+
+    // Writes a hard-edged rectangular ring as eight shared vertices and eight triangles, one quad per side
+    // The caller reserves 8 vertices and 24 indices first.
+    inline void PrimRectRing(ImDrawList* drawList, const ImVec2& outerMin, const ImVec2& outerMax, const ImVec2& innerMin, const ImVec2& innerMax, ImU32 color)
+    {
+        const ImVec2 uv = drawList->_Data->TexUvWhitePixel;
+        const ImVec2 corners[8] = {
+            outerMin, ImVec2(outerMax.x, outerMin.y), outerMax, ImVec2(outerMin.x, outerMax.y),
+            innerMin, ImVec2(innerMax.x, innerMin.y), innerMax, ImVec2(innerMin.x, innerMax.y)
+        };
+
+        ImDrawVert* vertex = drawList->_VtxWritePtr;
+        for (const ImVec2& corner : corners)
+        {
+            vertex->pos = corner;
+            vertex->uv = uv;
+            vertex->col = color;
+            vertex++;
+        }
+
+        const ImDrawIdx base = (ImDrawIdx)drawList->_VtxCurrentIdx;
+        ImDrawIdx* index = drawList->_IdxWritePtr;
+        for (int side = 0; side < 4; side++)
+        {
+            const ImDrawIdx outerA = (ImDrawIdx)(base + side);
+            const ImDrawIdx outerB = (ImDrawIdx)(base + (side + 1) % 4);
+            index[0] = outerA; index[1] = outerB; index[2] = (ImDrawIdx)(outerB + 4);
+            index[3] = outerA; index[4] = (ImDrawIdx)(outerB + 4); index[5] = (ImDrawIdx)(outerA + 4);
+            index += 6;
+        }
+
+        drawList->_VtxWritePtr = vertex;
+        drawList->_IdxWritePtr = index;
+        drawList->_VtxCurrentIdx += 8;
+    }
+
+} // Draw
+
+#endif //DRAWPRIMITIVES_H
@@ -0,0 +1,423 @@
+/*
+ * DrawRichText.cpp
+ * Source file implementation of markup labels. A label is parsed into runs of text sharing
+ * one style, each run is laid out with LayoutText, and the runs are placed left to right on
+ * a shared baseline. The result is cached by a hash of the markup and its default font, so
+ * later frames only emit the cached glyphs: highlights first, then strokes, then the text.
+ * Cached glyphs point into the font's atlas, so a label is laid out again once the atlas is
+ * rebuilt, detected the same way as for the digit tables of DrawNumbers.cpp.
+ */
+#include "DrawRichText.h"
+
+#include <cstdlib>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../CacheTools.h"
+#include "../ImVec2Operators.h"
+
+#include "DrawGlyphCache.h"
+#include "DrawPrimitives.h"
+#include "DrawStats.h"
+#include "DrawTextLayout.h"
+#include "DrawTrace.h"
+#include "imgui_internal.h"
+
+namespace Draw {
+
+    // Structure:   RichStyle
+    // ----------------------
+    // Style of a run of markup text
+    //
+    // ImFont* font:            font of the run
+    // float fontSize:          size of the run in pixels
+    // bool inheritColor:       whether the run takes the color passed to RichText
+    // ImU32 color:             color of the run when not inherited
+    // float strokeWidth:       width of the run's outline, 0 for none
+    // ImU32 strokeColor:       color of the outline
+    // float highlightWidth:    margin of the box behind the run, 0 for none
+    // ImU32 highlightColor:    color of the box, transparent for none
+    struct RichStyle
+    {
+        ImFont* font = nullptr;
+        float fontSize = 0.0f;
+        bool inheritColor = true;
+        ImU32 color = 0;
+        float strokeWidth = 0.0f;
+        ImU32 strokeColor = 0;
+        float highlightWidth = 0.0f;
+        ImU32 highlightColor = 0;
+    };
+
+    // Structure:   RichRun
+    // --------------------
+    // Laid out run of text sharing one style
+    //
+    // RichStyle style:     style of the run
+    // TextLayout layout:   glyphs of the run
+    // ImVec2 offset:       upper left corner of the run relative to the label's position
+    // int line:            line of the label the run is on
+    struct RichRun
+    {
+        RichStyle style;
+        TextLayout layout;
+        ImVec2 offset = ImVec2(0.0f, 0.0f);
+        int line = 0;
+    };
+
+    // Structure:   RichLabel
+    // ----------------------
+    // Cached runs of one markup string in one default font
+    //
+    // string markup:       source of the label, compared on lookup to rule out hash collisions
+    // ImFont* font:        default font the label was laid out with
+    // float fontSize:      default size the label was laid out with
+    // vector runs:         runs in markup order
+    // ImVec2 size:         bounds of the text
+    // ImVec2 min, max:     bounds including strokes and highlights, relative to the label's position
+    // int lastFrame:       frame the label was last drawn or measured
+    // int generation:      glyph cache generation the runs were laid out in
+    // ImFontGlyph* glyphData:  the default font's glyph array when the label was laid out
+    // int glyphCount:          number of glyphs in that array
+    // ImTextureID texture:     texture of the default font's atlas when the label was laid out
+    struct RichLabel
+    {
+        std::string markup;
+        ImFont* font = nullptr;
+        float fontSize = 0.0f;
+        std::vector<RichRun> runs;
+        ImVec2 size = ImVec2(0.0f, 0.0f);
+        ImVec2 min = ImVec2(0.0f, 0.0f);
+        ImVec2 max = ImVec2(0.0f, 0.0f);
+        int lastFrame = 0;
+        int generation = 0;
+        const ImFontGlyph* glyphData = nullptr;
+        int glyphCount = 0;
+        ImTextureID texture = (ImTextureID)0;
+    };
+
+    static std::unordered_map<uint64_t, RichLabel> richLabels;
+    static int prunedFrame = -1;
+
+    // Helper Function:    ParseColor
+    // -----------------------------
+    // Reads a #RRGGBB or #RRGGBBAA color
+    //
+    // string text:     text starting at the '#'
+    // ImU32 color:     parsed color
+    //
+    // Returns false if the text is not a color
+    static bool ParseColor(const std::string& text, ImU32& color)
+    {
+        if (text.size() != 7 && text.size() != 9)
+            return false;
+        if (text[0] != '#' || text.find_first_not_of("0123456789abcdefABCDEF", 1) != std::string::npos)
+            return false;
+
+        const unsigned long value = std::strtoul(text.c_str() + 1, nullptr, 16);
+        const ImU32 alpha = text.size() == 9 ? (ImU32)(value & 0xFF) : 0xFF;
+        const ImU32 rgb = text.size() == 9 ? (ImU32)(value >> 8) : (ImU32)value;
+        color = IM_COL32((rgb >> 16) & 0xFF, (rgb >> 8) & 0xFF, rgb & 0xFF, alpha);
+        return true;
+    }
+
+    // Helper Function:    ParseWidthAndColor
+    // -------------------------------------
+    // Reads the "W #RRGGBB" argument of stroke and highlight tags
+    //
+    // Returns false if the argument is malformed
+    static bool ParseWidthAndColor(const std::string& argument, float& width, ImU32& color)
+    {
+        const size_t space = argument.find(' ');
+        if (space == std::string::npos)
+            return false;
+
+        char* end = nullptr;
+        width = std::strtof(argument.c_str(), &end);
+        return end == argument.c_str() + space && width >= 0.0f && ParseColor(argument.substr(space + 1), color);
+    }
+
+    // Helper Function:    ParseTag
+    // ---------------------------
+    // Applies a tag to the style stack
+    //
+    // string tag:          text between the braces
+    // vector styles:       style stack, its last entry is the current style
+    //
+    // Returns false if the tag is not recognized, so its text is kept as written
+    static bool ParseTag(const std::string& tag, std::vector<RichStyle>& styles)
+    {
+        if (tag == "/")
+        {
+            if (styles.size() > 1)
+                styles.pop_back();
+            return true;
+        }
+
+        RichStyle style = styles.back();
+        const size_t colon = tag.find(':');
+        const std::string name = tag.substr(0, colon);
+        const std::string argument = colon == std::string::npos ? std::string() : tag.substr(colon + 1);
+
+        if (colon == std::string::npos && ParseColor(tag, style.color))
+        {
+            style.inheritColor = false;
+        }
+        else if (name == "font")
+        {
+            const ImVector<ImFont*>& fonts = ImGui::GetIO().Fonts->Fonts;
+            const int index = std::atoi(argument.c_str());
+            if (argument.empty() || index < 0 || index >= fonts.Size)
+                return false;
+            style.font = fonts[index];
+        }
+        else if (name == "size")
+        {
+            style.fontSize = std::strtof(argument.c_str(), nullptr);
+            if (style.fontSize <= 0.0f)
+                return false;
+        }
+        else if (name == "stroke")
+        {
+            if (!ParseWidthAndColor(argument, style.strokeWidth, style.strokeColor))
+                return false;
+        }
+        else if (name == "highlight")
+        {
+            if (!ParseWidthAndColor(argument, style.highlightWidth, style.highlightColor))
+                return false;
+        }
+        else
+        {
+            return false;
+        }
+
+        styles.push_back(style);
+        return true;
+    }
+
+    // Helper Function:    BuildLabel
+    // -----------------------------
+    // Parses markup into runs, lays each run out and places the runs line by line on shared baselines
+    //
+    // RichLabel label:         label to fill, with its markup, font and size set
+    // ImDrawList* drawList:    draw list supplying the current font for LayoutText
+    static void BuildLabel(RichLabel& label, const ImDrawList* drawList)
+    {
+        RichStyle base;
+        base.font = label.font;
+        base.fontSize = label.fontSize;
+        std::vector<RichStyle> styles(1, base);
+
+        // Split the markup into runs of one style and one line
+        std::string pending;
+        int line = 0;
+        auto flush = [&]()
+        {
+            if (pending.empty())
+                return;
+            RichRun& run = label.runs.emplace_back();
+            run.style = styles.back();
+            run.line = line;
+            LayoutText(run.layout, drawList, run.style.font, run.style.fontSize, pending.c_str(), pending.c_str() + pending.size());
+            pending.clear();
+        };
+
+        const std::string& markup = label.markup;
+        for (size_t i = 0; i < markup.size(); i++)
+        {
+            const char c = markup[i];
+            if (c == '{')
+            {
+                if (i + 1 < markup.size() && markup[i + 1] == '{')
+                {
+                    pending += '{';
+                    i++;
+                    continue;
+                }
+
+                const size_t close = markup.find('}', i + 1);
+                if (close != std::string::npos)
+                {
+                    const std::string tag = markup.substr(i + 1, close - i - 1);
+                    std::vector<RichStyle> applied = styles;
+                    if (ParseTag(tag, applied))
+                    {
+                        flush();
+                        styles.swap(applied);
+                        i = close;
+                        continue;
+                    }
+                }
+            }
+            else if (c == '\n')
+            {
+                flush();
+                line++;
+                continue;
+            }
+            pending += c;
+        }
+        flush();
+
+        // Lines are as tall as their largest ascent plus their largest descent, or one default line when empty
+        std::vector<float> ascents(line + 1, 0.0f);
+        std::vector<float> descents(line + 1, 0.0f);
+        for (const RichRun& run : label.runs)
+        {
+            const float ascent = run.layout.font->Ascent * (run.layout.fontSize / run.layout.font->FontSize);
+            ascents[run.line] = ImMax(ascents[run.line], ascent);
+            descents[run.line] = ImMax(descents[run.line], run.layout.size.y - ascent);
+        }
+
+        std::vector<float> tops(line + 1, 0.0f);
+        float top = 0.0f;
+        for (int i = 0; i <= line; i++)
+        {
+            tops[i] = top;
+            top += ascents[i] + descents[i] > 0.0f ? ascents[i] + descents[i] : label.fontSize;
+        }
+
+        // Place runs left to right, aligning their baselines
+        label.size = ImVec2(0.0f, top);
+        label.min = ImVec2(0.0f, 0.0f);
+        label.max = label.size;
+        float x = 0.0f;
+        int currentLine = 0;
+        for (RichRun& run : label.runs)
+        {
+            if (run.line != currentLine)
+            {
+                currentLine = run.line;
+                x = 0.0f;
+            }
+            const float ascent = run.layout.font->Ascent * (run.layout.fontSize / run.layout.font->FontSize);
+            run.offset = ImVec2(x, tops[run.line] + ascents[run.line] - ascent);
+            x += run.layout.size.x;
+            label.size.x = ImMax(label.size.x, x);
+
+            const float margin = ImMax(run.style.strokeWidth, run.style.highlightWidth);
+            label.min = ImMin(label.min, run.offset - ImVec2(margin, margin));
+            label.max = ImMax(label.max, run.offset + run.layout.size + ImVec2(margin, margin));
+        }
+    }
+
+    // Helper Function:    FindLabel
+    // ----------------------------
+    // Returns the cached label for markup in a default font, building it on first use and again after
+    // the font's atlas is rebuilt
+    // Labels left undrawn for RichTextCacheFrames frames are released, checked once per frame.
+    static const RichLabel& FindLabel(std::string_view markup, ImFont* font, float fontSize)
+    {
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        font = font != nullptr ? font : drawList->_Data->Font;
+        fontSize = fontSize > 0.0f ? fontSize : drawList->_Data->FontSize;
+
+        const int frame = ImGui::GetFrameCount();
+        if (frame != prunedFrame)
+        {
+            prunedFrame = frame;
+            for (auto it = richLabels.begin(); it != richLabels.end();)
+                it = frame - it->second.lastFrame > RichTextCacheFrames ? richLabels.erase(it) : std::next(it);
+        }
+
+        const uint64_t key = HashBytes(&fontSize, sizeof(fontSize), HashBytes(&font, sizeof(font), HashBytes(markup.data(), markup.size())));
+        const ImTextureID texture = font->ContainerAtlas != nullptr ? font->ContainerAtlas->TexID : (ImTextureID)0;
+        RichLabel& label = richLabels[key];
+        if (label.font != font || label.fontSize != fontSize || label.markup != markup || label.generation != GlyphCacheGeneration()
+            || label.glyphData != font->Glyphs.Data || label.glyphCount != font->Glyphs.Size || label.texture != texture)
+        {
+            label = RichLabel();
+            label.markup = markup;
+            label.font = font;
+            label.fontSize = fontSize;
+            label.generation = GlyphCacheGeneration();
+            label.glyphData = font->Glyphs.Data;
+            label.glyphCount = font->Glyphs.Size;
+            label.texture = texture;
+            BuildLabel(label, drawList);
+            Stats().richTextLayouts++;
+        }
+        label.lastFrame = frame;
+        return label;
+    }
+
+    // Helper Function:    Fade
+    // -----------------------
+    // Scales a color's alpha by a transparency
+    static ImU32 Fade(ImU32 color, float transparency)
+    {
+        return (color & 0x00FFFFFF) | (ImU32)(((color >> 24) & 0xFF) * transparency) << 24;
+    }
+
+    // Function:    RichText
+    // ---------------------
+    // Draws a label written in inline markup, see DrawRichText.h for the tags
+    // The first call for a string parses and lays it out; later calls emit the cached runs.
+    //
+    // string markup:       label text with inline style tags
+    // ImU32 color:         color of text outside any color tag
+    // float transparency:  relative transparency of the whole label
+    // ImVec2 position:     coordinates of upper left of the label
+    // ImFont font:         font of text outside any font tag, null for the current font
+    // float fontSize:      size of text outside any size tag, 0 for the current size
+    void RichText(std::string_view markup, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize)
+    {
+        TraceScope trace(TraceCall::RichText, markup, color, transparency, position, font, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const RichLabel& label = FindLabel(markup, font, fontSize);
+        if (!ClipTest(drawList, TraceCall::RichText, position + label.min, position + label.max))
+            return;
+
+        const ImU32 baseColor = color | IM_COL32_A_MASK;
+
+        // Highlights sit behind every run's text and strokes
+        for (const RichRun& run : label.runs)
+        {
+            if (run.style.highlightColor & IM_COL32_A_MASK)
+            {
+                const ImVec2 margin = ImVec2(run.style.highlightWidth, run.style.highlightWidth);
+                drawList->AddRectFilled(position + run.offset - margin, position + run.offset + run.layout.size + margin, Fade(run.style.highlightColor, transparency));
+            }
+        }
+
+        // Strokes redraw the run's glyphs around a circle, as TextStroke does
+        constexpr int segments = 32;
+        const float step = 2.0f * IM_PI / segments;
+        for (const RichRun& run : label.runs)
+        {
+            if (run.style.strokeWidth <= 0.0f)
+                continue;
+            const ImU32 strokeColor = Fade(run.style.strokeColor, transparency);
+            for (int i = 0; i < segments; i++)
+                EmitGlyphs(drawList, run.layout, position + run.offset + ImVec2(cosf(step * i), sinf(step * i)) * run.style.strokeWidth, strokeColor);
+        }
+
+        for (const RichRun& run : label.runs)
+            EmitGlyphs(drawList, run.layout, position + run.offset, Fade(run.style.inheritColor ? baseColor : run.style.color, transparency));
+    }
+
+    // Function:    RichTextSize
+    // -------------------------
+    // Measures a markup label as RichText would draw it, from the same cache
+    //
+    // string markup:       label text with inline style tags
+    // ImFont font:         font of text outside any font tag, null for the current font
+    // float fontSize:      size of text outside any size tag, 0 for the current size
+    //
+    // Returns the size of the label's text, not counting strokes and highlights
+    ImVec2 RichTextSize(std::string_view markup, ImFont* font, float fontSize)
+    {
+        return FindLabel(markup, font, fontSize).size;
+    }
+
+    // Function:    ClearRichTextCache
+    // -------------------------------
+    // Releases every cached label, whose glyphs point into the font atlas
+    void ClearRichTextCache()
+    {
+        richLabels.clear();
+    }
+
+} // Draw
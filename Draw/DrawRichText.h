@@ -0,0 +1,43 @@
+/*
+ * DrawRichText.h
+ * Header of styled labels written in a compact inline markup. A label such as a bold number,
+ * a muted unit and a stroked status word is one string instead of several Draw::Text calls
+ * positioned by hand. Each distinct string is parsed and laid out once into a list of runs,
+ * cached by its hash, so redrawing it every frame is a single pass over the cached glyphs.
+ *
+ * Markup:
+ *     {#RRGGBB} or {#RRGGBBAA}     text color
+ *     {font:N}                     font N of the ImGui font atlas
+ *     {size:N}                     font size in pixels
+ *     {stroke:W #RRGGBB}           outline W pixels wide
+ *     {highlight:W #RRGGBB}        filled box W pixels beyond the text
+ *     {/}                          ends the most recent style
+ *     {{                           a literal '{'
+ *
+ * Example:
+ *     "{size:28}{#FFFFFF}42{/}{/}{#909294} ms {/}{stroke:1 #000000}{#8BC63F}OK"
+ */
+#ifndef DRAWRICHTEXT_H
+#define DRAWRICHTEXT_H
+#include <string_view>
+
+#include "imgui.h"
+
+namespace Draw {
+
+    // Frames a cached label may go undrawn before its runs are released
+    constexpr int RichTextCacheFrames = 120;
+
+    // Draws a label written in inline markup, parsing and laying it out only the first time it is seen
+    // Text outside any color tag takes the given color; the transparency scales every color of the label.
+    void RichText(std::string_view markup, ImU32 color, float transparency, ImVec2 position, ImFont* font = nullptr, float fontSize = 0.0f);
+
+    // Size of a markup label as RichText would draw it, not counting strokes and highlights, from the same cache
+    ImVec2 RichTextSize(std::string_view markup, ImFont* font = nullptr, float fontSize = 0.0f);
+
+    // Releases every cached label, call after the font atlas is rebuilt
+    void ClearRichTextCache();
+
+} // Draw
+
+#endif //DRAWRICHTEXT_H
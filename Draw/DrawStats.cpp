@@ -0,0 +1,26 @@
+/*
+ * DrawStats.cpp
+ * Source file implementation of the counters the Draw:: helpers update as they emit geometry.
+ */
+#include "DrawStats.h"
+
+namespace Draw {
+    static DrawStats stats;
+
+    // Function:    Stats
+    // ------------------
+    // Returns a reference to the live counters
+    DrawStats& Stats()
+    {
+        return stats;
+    }
+
+    // Function:    ResetStats
+    // -----------------------
+    // Zeroes every counter, typically once per frame
+    void ResetStats()
+    {
+        stats = DrawStats();
+    }
+
+} // Draw
@@ -0,0 +1,47 @@
+/*
+ * DrawStats.h
+ * Header of the counters the Draw:: helpers update as they emit geometry. They are
+ * meant for profiling overlays and before/after comparisons, not for driving layout.
+ */
+#ifndef DRAWSTATS_H
+#define DRAWSTATS_H
+
+#include "DrawTrace.h"
+
+namespace Draw {
+
+    // Structure:   DrawStats
+    // ----------------------
+    // Running totals collected by the Draw:: helpers until the next ResetStats()
+    //
+    // int gridDrawCommands:    ImDrawCmds added by the most recent populated grid call
+    // int vtxOffsetSplits:     commands started at a new VtxOffset because 16-bit indices ran out
+    // int droppedItems:        shapes skipped because 16-bit indices ran out without VtxOffset support
+    // int snappedBorders:      pixel-aligned unrounded borders drawn as hard-edged rings instead of AddRect
+    // int borderVerticesSaved: vertices those rings saved over the strokes AddRect would have built
+    // int fusedTextCalls:      highlighted labels measured and drawn from a single walk over their glyphs
+    // int richTextLayouts:     markup labels parsed and laid out, every other RichText call drew from the cache
+    // int culledCalls[]:       calls skipped because their bounds missed the clip rect, indexed by TraceCall
+    // int emittedCalls[]:      calls whose bounds overlapped the clip rect, indexed by TraceCall
+    struct DrawStats
+    {
+        int gridDrawCommands = 0;
+        int vtxOffsetSplits = 0;
+        int droppedItems = 0;
+        int snappedBorders = 0;
+        int borderVerticesSaved = 0;
+        int fusedTextCalls = 0;
+        int richTextLayouts = 0;
+        int culledCalls[(int)TraceCall::Count] = {};
+        int emittedCalls[(int)TraceCall::Count] = {};
+    };
+
+    // Returns the live counters
+    DrawStats& Stats();
+
+    // Zeroes every counter
+    void ResetStats();
+
+} // Draw
+
+#endif //DRAWSTATS_H
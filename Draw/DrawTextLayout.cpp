@@ -0,0 +1,259 @@
+/*
+ * DrawTextLayout.cpp
+ * Source file implementation of the single-pass text layout. The walk follows ImFont::RenderText
+ * and ImFont::CalcTextSizeA: '\n' starts a new line one font size down, '\r' is skipped, and
+ * missing characters take the font's fallback glyph, so bounds and glyphs match what AddText and
+ * ImGui::CalcTextSize would produce for the same font and size. A font with a glyph cache attached
+ * takes characters its atlas lacks from the cache before falling back.
+ */
+#include "DrawTextLayout.h"
+
+#include <cstring>
+
+#include "../ImVec2Operators.h"
+
+#include "DrawGlyphCache.h"
+#include "DrawPrimitives.h"
+#include "DrawStats.h"
+#include "imgui_internal.h"
+
+namespace Draw {
+
+    // Function:    FindLayoutGlyph
+    // ----------------------------
+    // Finds the glyph LayoutText draws for a character. A font without a glyph cache behaves as
+    // ImFont::FindGlyph; with one, characters missing from the atlas come from the cache before
+    // the fallback glyph is used.
+    //
+    // ImFont font:             font the character is drawn in
+    // GlyphCache* cache:       cache attached to the font, or null
+    // float fontSize:          size the glyph is laid out at
+    // unsigned int codepoint:  character to look up
+    //
+    // Returns the glyph with its scale, vertical offset and texture
+    GlyphSource FindLayoutGlyph(ImFont* font, GlyphCache* cache, float fontSize, unsigned int codepoint)
+    {
+        GlyphSource source;
+        if (cache != nullptr)
+        {
+            source.glyph = font->FindGlyphNoFallback((ImWchar)codepoint);
+            if (source.glyph == nullptr)
+            {
+                // Cached glyphs are measured from the baseline, placed on the font's ascent as merged atlas fonts are
+                if (const CachedGlyph* cached = cache->Find((ImWchar)codepoint, fontSize))
+                {
+                    source.glyph = &cached->glyph;
+                    source.scale = fontSize / cached->size;
+                    source.top = IM_ROUND(font->Ascent) * (fontSize / font->FontSize);
+                    source.texture = cached->texture;
+                    return source;
+                }
+            }
+        }
+        if (source.glyph == nullptr)
+            source.glyph = font->FindGlyph((ImWchar)codepoint);
+        source.scale = fontSize / font->FontSize;
+        source.texture = font->ContainerAtlas->TexID;
+        return source;
+    }
+
+    // Function:    LayoutText
+    // -----------------------
+    // Lays out a string the way ImDrawList::AddText would draw it, replacing the layout's contents
+    //
+    // TextLayout layout:       layout to fill, its glyph buffer is reused
+    // ImDrawList* drawList:    draw list supplying the current font and size
+    // ImFont font:             font style to be used, null for the current font
+    // float fontSize:          point size of font, 0 for the current size
+    // char* text:              start of the string
+    // char* textEnd:           end of the string, null when it is null-terminated
+    void LayoutText(TextLayout& layout, const ImDrawList* drawList, ImFont* font, float fontSize, const char* text, const char* textEnd)
+    {
+        layout.font = font != nullptr ? font : drawList->_Data->Font;
+        layout.fontSize = fontSize > 0.0f ? fontSize : drawList->_Data->FontSize;
+        layout.glyphs.clear();
+        if (textEnd == nullptr)
+            textEnd = text + strlen(text);
+
+        const float lineHeight = layout.fontSize;
+        GlyphCache* cache = FindGlyphCache(layout.font);
+        float width = 0.0f;
+        float height = 0.0f;
+        float x = 0.0f;
+
+        for (const char* s = text; s < textEnd;)
+        {
+            const int byte = (int)(s - text);
+            unsigned int c = (unsigned int)*s;
+            if (c < 0x80)
+                s += 1;
+            else
+                s += ImTextCharFromUtf8(&c, s, textEnd);
+
+            if (c < 32)
+            {
+                if (c == '\n')
+                {
+                    width = ImMax(width, x);
+                    height += lineHeight;
+                    x = 0.0f;
+                    continue;
+                }
+                if (c == '\r')
+                    continue;
+            }
+
+            const GlyphSource source = FindLayoutGlyph(layout.font, cache, layout.fontSize, c);
+            const ImFontGlyph* glyph = source.glyph;
+            if (glyph == nullptr)
+                continue;
+
+            const float top = height + source.top;
+            if (glyph->Visible)
+                layout.glyphs.push_back({ glyph, ImVec2(x + glyph->X0 * source.scale, top + glyph->Y0 * source.scale),
+                                          ImVec2(x + glyph->X1 * source.scale, top + glyph->Y1 * source.scale), byte, source.texture });
+            x += glyph->AdvanceX * source.scale;
+        }
+
+        // Close the last line as CalcTextSizeA does, then round the width up as ImGui::CalcTextSize does
+        width = ImMax(width, x);
+        if (x > 0.0f || height == 0.0f)
+            height += lineHeight;
+        layout.size = ImVec2(IM_TRUNC(width + 0.99999f), height);
+    }
+
+    // Helper Function:    WriteQuads
+    // ------------------------------
+    // Writes a list of laid out glyphs as quads in the draw list's current texture
+    // Colored glyphs, such as emoji, keep their own colors and only take the alpha, as in AddText.
+    //
+    // ImDrawList* drawList:    draw list to write to
+    // TextLayout layout:       glyphs laid out by LayoutText
+    // ImVec2 origin:           pixel-aligned upper left of the text box
+    // ImU32 color:             color of every glyph, when no edge colors are given
+    // ImU32* edgeColors:       left and right edge colors per glyph of the layout, or null
+    // vector indices:          glyphs to write
+    static void WriteQuads(ImDrawList* drawList, const TextLayout& layout, ImVec2 origin, ImU32 color, const ImU32* edgeColors, const std::vector<int>& indices)
+    {
+        const int glyphTotal = (int)indices.size();
+        for (int chunkStart = 0; chunkStart < glyphTotal;)
+        {
+            const int chunkGlyphs = ReserveItems(drawList, glyphTotal - chunkStart, 4, 6);
+            if (chunkGlyphs == 0)
+            {
+                Stats().droppedItems += glyphTotal - chunkStart;
+                return;
+            }
+            const int chunkEnd = chunkStart + chunkGlyphs;
+
+            for (int i = chunkStart; i < chunkEnd; i++)
+            {
+                const int index = indices[i];
+                const LaidGlyph& laid = layout.glyphs[index];
+                const ImFontGlyph* glyph = laid.glyph;
+                ImU32 left = edgeColors != nullptr ? edgeColors[index * 2] : color;
+                ImU32 right = edgeColors != nullptr ? edgeColors[index * 2 + 1] : color;
+                if (glyph->Colored)
+                {
+                    left |= ~IM_COL32_A_MASK;
+                    right |= ~IM_COL32_A_MASK;
+                }
+
+                const ImVec2 min = origin + laid.min;
+                const ImVec2 max = origin + laid.max;
+                const ImDrawIdx base = (ImDrawIdx)drawList->_VtxCurrentIdx;
+                drawList->PrimWriteIdx(base); drawList->PrimWriteIdx((ImDrawIdx)(base + 1)); drawList->PrimWriteIdx((ImDrawIdx)(base + 2));
+                drawList->PrimWriteIdx(base); drawList->PrimWriteIdx((ImDrawIdx)(base + 2)); drawList->PrimWriteIdx((ImDrawIdx)(base + 3));
+                drawList->PrimWriteVtx(min, ImVec2(glyph->U0, glyph->V0), left);
+                drawList->PrimWriteVtx(ImVec2(max.x, min.y), ImVec2(glyph->U1, glyph->V0), right);
+                drawList->PrimWriteVtx(max, ImVec2(glyph->U1, glyph->V1), right);
+                drawList->PrimWriteVtx(ImVec2(min.x, max.y), ImVec2(glyph->U0, glyph->V1), left);
+            }
+            chunkStart = chunkEnd;
+        }
+    }
+
+    // Helper Function:    EmitRange
+    // -----------------------------
+    // Writes laid out glyphs from first up to end, skipping those outside the clip rect
+    // Glyphs in the current texture, normally the font atlas, are written first. Glyphs from glyph
+    // cache pages follow, one texture at a time, so a label costs one draw command per texture.
+    //
+    // ImDrawList* drawList:    draw list to write to
+    // TextLayout layout:       glyphs laid out by LayoutText
+    // ImVec2 position:         coordinates of upper left of text box
+    // ImU32 color:             color of every glyph, when no edge colors are given
+    // ImU32* edgeColors:       left and right edge colors per glyph of the layout, or null
+    // int first, end:          range of glyphs to write
+    static void EmitRange(ImDrawList* drawList, const TextLayout& layout, ImVec2 position, ImU32 color, const ImU32* edgeColors, int first, int end)
+    {
+        const ImVec4& clip = drawList->_CmdHeader.ClipRect;
+        const ImTextureID current = drawList->_CmdHeader.TextureId;
+
+        // Align to whole pixels as AddText does
+        const ImVec2 origin = ImVec2(IM_TRUNC(position.x), IM_TRUNC(position.y));
+
+        // Sort the glyphs that survive clipping by texture so each reservation is exact
+        static std::vector<int> visible;
+        static std::vector<int> deferred;
+        static std::vector<int> group;
+        visible.clear();
+        deferred.clear();
+        for (int i = first; i < end; i++)
+        {
+            const LaidGlyph& laid = layout.glyphs[i];
+            if (origin.x + laid.min.x <= clip.z && origin.x + laid.max.x >= clip.x && origin.y + laid.min.y <= clip.w && origin.y + laid.max.y >= clip.y)
+                (laid.texture == current ? visible : deferred).push_back(i);
+        }
+        WriteQuads(drawList, layout, origin, color, edgeColors, visible);
+
+        while (!deferred.empty())
+        {
+            const ImTextureID texture = layout.glyphs[deferred[0]].texture;
+            group.clear();
+            visible.clear();
+            for (int index : deferred)
+                (layout.glyphs[index].texture == texture ? group : visible).push_back(index);
+
+            // Layouts kept across frames, such as rich text labels, do not look their glyphs up again
+            MarkGlyphTextureDrawn(texture);
+            drawList->PushTextureID(texture);
+            WriteQuads(drawList, layout, origin, color, edgeColors, group);
+            drawList->PopTextureID();
+            deferred.swap(visible);
+        }
+    }
+
+    // Function:    EmitGlyphs
+    // -----------------------
+    // Writes a range of laid out glyphs to the draw list in one color, skipping those outside the clip rect
+    //
+    // ImDrawList* drawList:    draw list to write to
+    // TextLayout layout:       glyphs laid out by LayoutText
+    // ImVec2 position:         coordinates of upper left of text box
+    // ImU32 color:             color of the text
+    // int firstGlyph:          index of the first glyph to write
+    // int glyphCount:          number of glyphs to write, -1 for the rest of the layout
+    void EmitGlyphs(ImDrawList* drawList, const TextLayout& layout, ImVec2 position, ImU32 color, int firstGlyph, int glyphCount)
+    {
+        if ((color & IM_COL32_A_MASK) == 0)
+            return;
+
+        const int end = glyphCount < 0 ? (int)layout.glyphs.size() : ImMin(firstGlyph + glyphCount, (int)layout.glyphs.size());
+        EmitRange(drawList, layout, position, color, nullptr, firstGlyph, end);
+    }
+
+    // Function:    EmitGlyphs
+    // -----------------------
+    // Writes every laid out glyph with its own colors, skipping those outside the clip rect
+    //
+    // ImDrawList* drawList:    draw list to write to
+    // TextLayout layout:       glyphs laid out by LayoutText
+    // ImVec2 position:         coordinates of upper left of text box
+    // ImU32* edgeColors:       left and right edge colors of each glyph, two entries per glyph
+    void EmitGlyphs(ImDrawList* drawList, const TextLayout& layout, ImVec2 position, const ImU32* edgeColors)
+    {
+        EmitRange(drawList, layout, position, 0, edgeColors, 0, (int)layout.glyphs.size());
+    }
+
+} // Draw
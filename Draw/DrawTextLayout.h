@@ -0,0 +1,84 @@
+/*
+ * DrawTextLayout.h
+ * Header of a single-pass text layout shared by the Draw:: text helpers. A string is walked
+ * once, looking up each glyph in the requested font and size, which yields both its exact
+ * bounds and the glyph quads. Helpers that need the size before drawing, such as highlighted
+ * labels, can then emit the glyphs without walking the string a second time inside AddText.
+ */
+#ifndef DRAWTEXTLAYOUT_H
+#define DRAWTEXTLAYOUT_H
+#include <vector>
+
+#include "imgui.h"
+
+namespace Draw {
+
+    class GlyphCache;
+
+    // Structure:   LaidGlyph
+    // ----------------------
+    // One visible glyph of a laid out string
+    //
+    // ImFontGlyph* glyph:  atlas entry supplying the texture coordinates
+    // ImVec2 min, max:     corners of the glyph quad relative to the text's upper left corner
+    // int byte:            offset of the glyph's first byte in the string
+    // ImTextureID texture: texture holding the glyph, the font atlas or a glyph cache page
+    struct LaidGlyph
+    {
+        const ImFontGlyph* glyph;
+        ImVec2 min, max;
+        int byte;
+        ImTextureID texture;
+    };
+
+    // Structure:   TextLayout
+    // -----------------------
+    // Glyph quads and bounds of a string in one font and size, reused between calls as a scratch buffer
+    //
+    // ImFont* font:        font the string was laid out in
+    // float fontSize:      size the string was laid out at
+    // ImVec2 size:         bounds of the text as ImGui::CalcTextSize reports them
+    // vector glyphs:       visible glyphs in string order
+    struct TextLayout
+    {
+        ImFont* font = nullptr;
+        float fontSize = 0.0f;
+        ImVec2 size = ImVec2(0.0f, 0.0f);
+        std::vector<LaidGlyph> glyphs;
+    };
+
+    // Structure:   GlyphSource
+    // ------------------------
+    // Where one character's glyph comes from and how it is placed
+    //
+    // ImFontGlyph* glyph:  atlas or glyph cache entry, null when the font cannot draw the character
+    // float scale:         factor from the glyph's metrics to the requested size
+    // float top:           offset added to the glyph's Y, the font's ascent for cached glyphs measured from the baseline
+    // ImTextureID texture: texture holding the glyph
+    struct GlyphSource
+    {
+        const ImFontGlyph* glyph = nullptr;
+        float scale = 1.0f;
+        float top = 0.0f;
+        ImTextureID texture = (ImTextureID)0;
+    };
+
+    // Finds a character's glyph as LayoutText does: the font's atlas, then the attached glyph cache, then the fallback glyph
+    GlyphSource FindLayoutGlyph(ImFont* font, GlyphCache* cache, float fontSize, unsigned int codepoint);
+
+    // Lays out a string the way ImDrawList::AddText would draw it, replacing the layout's contents
+    // A null font or zero size falls back to the draw list's current font and size, as AddText does.
+    // Characters missing from the font's atlas come from its attached glyph cache, if any.
+    void LayoutText(TextLayout& layout, const ImDrawList* drawList, ImFont* font, float fontSize, const char* text, const char* textEnd = nullptr);
+
+    // Writes a range of laid out glyphs to the draw list in one color, skipping those outside the clip rect
+    // Glyphs in the current texture are written first, then those of each other texture under PushTextureID.
+    void EmitGlyphs(ImDrawList* drawList, const TextLayout& layout, ImVec2 position, ImU32 color, int firstGlyph = 0, int glyphCount = -1);
+
+    // Writes every laid out glyph with its own colors, two per glyph for its left and right edges
+    // Colors are interpolated across each quad, so a gradient sampled at glyph edges stays continuous.
+    void EmitGlyphs(ImDrawList* drawList, const TextLayout& layout, ImVec2 position, const ImU32* edgeColors);
+
+} // Draw
+
+#endif //DRAWTEXTLAYOUT_H
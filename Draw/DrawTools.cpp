@@ -2,20 +2,97 @@
  * DrawTools.cpp
  * Source file implementation of procedural helper functions used to draw common
  * objects (textures, shapes, text) to the window using Dear ImGui conventions.
+ * Each helper first tests the bounds it is about to cover against the current clip rect, estimated
+ * from sizes it already has, and returns without emitting anything when they miss it. The outcome
+ * is counted per function in Stats().culledCalls and Stats().emittedCalls. Helpers built from other
+ * helpers, such as strokes and highlights, draw their parts through the static Emit functions,
+ * which neither test nor count, so every call is counted once.
  */
 #include "DrawTools.h"
 #include "imgui.h"
+#include <algorithm>
+#include <deque>
 #include <iomanip>
 #include <vector>
 
 #include "ColorTools.h"
 #include "../ImVec2Operators.h"
 
+#include "DrawGlyphCache.h"
+#include "DrawPrimitives.h"
+#include "DrawStats.h"
+#include "DrawTextLayout.h"
+#include "DrawTrace.h"
 #include "imgui_internal.h"
 #include "PositionTools.h"
+#include "TextureStreaming.h"
+#include "TiledImage.h"
 #include "Window.h"
 
 namespace Draw {
+    // Glyph buffer reused by the helpers that measure text before drawing it
+    static TextLayout scratchLayout;
+
+    // Helper Function:    TextVisible
+    // -------------------------------
+    // Clip tests text from an upper bound of its size, without measuring its glyphs
+    // Each byte is taken to advance at most one em and each line to be one em tall, which holds
+    // for Latin and CJK fonts alike, so text is only culled when it cannot be visible.
+    //
+    // ImDrawList* drawList:    draw list the text would be added to
+    // TraceCall call:          library call the outcome is counted for
+    // string text:             text to be written to the screen
+    // ImVec2 position:         coordinates of upper left of text box
+    // float fontSize:          point size of font, 0 for the current font's size
+    // float margin:            extra space around the text covered by strokes or highlights
+    //
+    // Returns true if the text may overlap the clip rect
+    static bool TextVisible(ImDrawList* drawList, TraceCall call, const std::string_view text, ImVec2 position, float fontSize, float margin)
+    {
+        const float em = fontSize > 0.0f ? fontSize : drawList->_Data->FontSize;
+        const int lines = 1 + (int)std::count(text.begin(), text.end(), '\n');
+        const ImVec2 extent = ImVec2((float)text.size() * em, (float)lines * em);
+        return ClipTest(drawList, call, position - ImVec2(margin, margin), position + extent + ImVec2(margin, margin));
+    }
+
+    // Helper Function:    EmitText
+    // ----------------------------
+    // Writes text to a draw list without a clip test, for Text and the helpers that draw text as a part
+    // Fonts with a glyph cache draw through the shared layout, which knows the cache's pages.
+    static void EmitText(ImDrawList* drawList, std::string_view text, ImU32 colorWithAlpha, ImVec2 position, ImFont* font, float fontSize)
+    {
+        if (FindGlyphCache(font != nullptr ? font : drawList->_Data->Font) != nullptr)
+        {
+            LayoutText(scratchLayout, drawList, font, fontSize, text.data(), text.data() + text.size());
+            EmitGlyphs(drawList, scratchLayout, position, colorWithAlpha);
+            return;
+        }
+
+        drawList->AddText(
+            font,
+            fontSize,
+            position,
+            colorWithAlpha,
+            text.data(),
+            text.data() + text.size()
+        );
+    }
+
+    // Helper Function:    EmitTextStroke
+    // ----------------------------------
+    // Writes text at 32 offsets around a circle without a clip test, producing a stroke/outline effect
+    static void EmitTextStroke(ImDrawList* drawList, std::string_view text, ImU32 strokeWithAlpha, float strokeWidth, ImVec2 position, ImFont* font, float fontSize)
+    {
+        constexpr int segments = 32;
+        float step = 2.0f * IM_PI / segments;
+
+        for (int i = 0; i < segments; ++i) {
+            float angle = step * i;
+            ImVec2 offset = ImVec2(cosf(angle), sinf(angle)) * strokeWidth;
+            EmitText(drawList, text, strokeWithAlpha, position + offset, font, fontSize);
+        }
+    }
+
     // Function:    Text
     // -----------------
     // Draws colored text to the screen of a set transparency
@@ -26,21 +103,15 @@ namespace Draw {
     // ImVec2 position:     coordinates of upper left of text box
     // ImFont font:         font style to be used
     // float fontSize:      point size of font
-    void Text(std::string& text, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize)
+    void Text(std::string_view text, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize)
     {
+        TraceScope trace(TraceCall::Text, text, color, transparency, position, font, fontSize);
         ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!TextVisible(drawList, TraceCall::Text, text, position, fontSize, 0.0f))
+            return;
 
         // Apply transparency to the input color
-        ImU32 colorWithAlpha = (color & 0x00FFFFFF) | (ImU32)(transparency * 255.0f) << 24;
-
-        // Draw the text
-        drawList->AddText(
-            font,
-            fontSize,
-            position,
-            colorWithAlpha,
-            text.c_str()
-        );
+        EmitText(drawList, text, Color::WithAlpha(color, transparency), position, font, fontSize);
     }
 
     // Function:    TextStroke
@@ -54,17 +125,14 @@ namespace Draw {
     // ImVec2 position:     coordinates of upper left of text box
     // ImFont font:         font style to be used
     // float fontSize:      point size of font
-    void TextStroke(std::string& text, ImU32 strokeColor, float transparency, float strokeWidth, ImVec2 position, ImFont* font, float fontSize)
+    void TextStroke(std::string_view text, ImU32 strokeColor, float transparency, float strokeWidth, ImVec2 position, ImFont* font, float fontSize)
     {
-        constexpr int segments = 32;
-        float step = 2.0f * IM_PI / segments;
-
-        for (int i = 0; i < segments; ++i) {
-            float angle = step * i;
-            ImVec2 offset = ImVec2(cosf(angle), sinf(angle)) * strokeWidth;
-            Text(text, strokeColor, transparency, position + offset, font, fontSize);
-        }
+        TraceScope trace(TraceCall::TextStroke, text, strokeColor, transparency, strokeWidth, position, font, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!TextVisible(drawList, TraceCall::TextStroke, text, position, fontSize, strokeWidth))
+            return;
 
+        EmitTextStroke(drawList, text, Color::WithAlpha(strokeColor, transparency), strokeWidth, position, font, fontSize);
     }
 
     // Function:    TextWithStroke
@@ -79,10 +147,31 @@ namespace Draw {
     // ImVec2 position:     coordinates of upper left of text box
     // ImFont font:         font style to be used
     // float fontSize:      point size of font
-    void TextWithStroke(std::string& text, ImU32 strokeColor, ImU32 textColor, float transparency, float strokeWidth, ImVec2 position, ImFont* font, float fontSize)
+    void TextWithStroke(std::string_view text, ImU32 strokeColor, ImU32 textColor, float transparency, float strokeWidth, ImVec2 position, ImFont* font, float fontSize)
     {
-        TextStroke(text, strokeColor, transparency, strokeWidth, position, font, fontSize);
-        Text(text, textColor, transparency, position, font, fontSize);
+        TraceScope trace(TraceCall::TextWithStroke, text, strokeColor, textColor, transparency, strokeWidth, position, font, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!TextVisible(drawList, TraceCall::TextWithStroke, text, position, fontSize, strokeWidth))
+            return;
+
+        EmitTextStroke(drawList, text, Color::WithAlpha(strokeColor, transparency), strokeWidth, position, font, fontSize);
+        EmitText(drawList, text, Color::WithAlpha(textColor, transparency), position, font, fontSize);
+    }
+
+    // Function:    TextSize
+    // ---------------------
+    // Measures text with the same layout the text functions draw from, so characters served by an
+    // attached glyph cache are measured at their cached advance rather than the fallback glyph's
+    //
+    // string text:         text to measure
+    // ImFont font:         font style to be used, null for the current font
+    // float fontSize:      point size of font, 0 for the current size
+    //
+    // Returns the size of the text as ImGui::CalcTextSize would report it for the atlas's glyphs
+    ImVec2 TextSize(std::string_view text, ImFont* font, float fontSize)
+    {
+        LayoutText(scratchLayout, ImGui::GetWindowDrawList(), font, fontSize, text.data(), text.data() + text.size());
+        return scratchLayout.size;
     }
 
     // Function:    SolidRectangle
@@ -95,8 +184,11 @@ namespace Draw {
     // ImVec2 rectangleSize:    size of rectangle to be drawn
     void FilledRectangle(ImU32 color, float transparency, ImVec2 position, ImVec2 rectangleSize)
     {
+        TraceScope trace(TraceCall::FilledRectangle, color, transparency, position, rectangleSize);
         // Pull Rendering Information
         ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::FilledRectangle, position, position + rectangleSize))
+            return;
 
         // Apply transparency to the input color
         ImU32 colorWithAlpha = color & 0x00FFFFFF; // mask out existing alpha
@@ -121,7 +213,10 @@ namespace Draw {
     // float rounding:          radius for corner rounding (in pixels)
     void FilledRoundedRectangle(ImU32 color, float transparency, ImVec2 position, ImVec2 rectangleSize, float rounding)
     {
+        TraceScope trace(TraceCall::FilledRoundedRectangle, color, transparency, position, rectangleSize, rounding);
         ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::FilledRoundedRectangle, position, position + rectangleSize))
+            return;
 
         // Apply transparency to the input color
         ImU32 colorWithAlpha = color & 0x00FFFFFF; // mask out existing alpha
@@ -149,8 +244,14 @@ namespace Draw {
     // float strokeWidth:       width of stroke outline in pixels
     void FilledRectangleWithStroke(ImU32 color, ImU32 strokeColor, float transparency, ImVec2 position, ImVec2 rectangleSize, float strokeWidth)
     {
-        FilledRectangle(strokeColor, transparency, ImVec2(position.x - strokeWidth, position.y - strokeWidth), rectangleSize + ImVec2(strokeWidth * 2, strokeWidth *2));
-        FilledRectangle(color, transparency, position, rectangleSize);
+        TraceScope trace(TraceCall::FilledRectangleWithStroke, color, strokeColor, transparency, position, rectangleSize, strokeWidth);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const ImVec2 stroke = ImVec2(strokeWidth, strokeWidth);
+        if (!ClipTest(drawList, TraceCall::FilledRectangleWithStroke, position - stroke, position + rectangleSize + stroke))
+            return;
+
+        drawList->AddRectFilled(position - stroke, position + rectangleSize + stroke, Color::WithAlpha(strokeColor, transparency));
+        drawList->AddRectFilled(position, position + rectangleSize, Color::WithAlpha(color, transparency));
     }
 
     // Function:    Highlight
@@ -164,18 +265,23 @@ namespace Draw {
     // float transparency:      opacity of the highlight
     // ImVec2 position:         coordinates of text box's upper left corner
     // float fontSize:          size of the font
-    void Highlight(std::string& text, ImFont* font, float width, ImU32 color, float transparency, ImVec2 position, float fontSize)
+    void Highlight(std::string_view text, ImFont* font, float width, ImU32 color, float transparency, ImVec2 position, float fontSize)
     {
-        // Calculate text size for a specific font size
-        //ImVec2 textSize = font->CalcTextSizeA(fontSize, FLT_MAX, 0.0f, text.c_str());
-        ImVec2 textSize = ImGui::CalcTextSize(text.c_str());
+        TraceScope trace(TraceCall::Highlight, text, font, width, color, transparency, position, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!TextVisible(drawList, TraceCall::Highlight, text, position, fontSize, width))
+            return;
+
+        // Calculate text size for the given font and size
+        LayoutText(scratchLayout, drawList, font, fontSize, text.data(), text.data() + text.size());
+        ImVec2 textSize = scratchLayout.size;
 
         // Determine size of rectangle
         ImVec2 highlightOffset = position - ImVec2(width, width);
         ImVec2 rectangleSize = textSize + ImVec2(2 * width, 2 * width);
 
         // Draw Background
-        FilledRectangle(color, transparency, highlightOffset, rectangleSize);
+        drawList->AddRectFilled(highlightOffset, highlightOffset + rectangleSize, Color::WithAlpha(color, transparency));
     }
 
     // Function:    HighlightRounded
@@ -190,19 +296,23 @@ namespace Draw {
     // ImVec2 position:         coordinates of text box's upper left corner
     // float fontSize:          size of the font
     // float rounding:          radius for corner rounding
-    void HighlightRounded(std::string& text, ImFont* font, float width, ImU32 color, float transparency, ImVec2 position, float fontSize, float rounding)
+    void HighlightRounded(std::string_view text, ImFont* font, float width, ImU32 color, float transparency, ImVec2 position, float fontSize, float rounding)
     {
-        // Calculate text size for the given font
-        ImGui::PushFont(font);
-        ImVec2 textSize = ImGui::CalcTextSize(text.c_str());
-        ImGui::PopFont();
+        TraceScope trace(TraceCall::HighlightRounded, text, font, width, color, transparency, position, fontSize, rounding);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!TextVisible(drawList, TraceCall::HighlightRounded, text, position, fontSize, width))
+            return;
+
+        // Calculate text size for the given font and size
+        LayoutText(scratchLayout, drawList, font, fontSize, text.data(), text.data() + text.size());
+        ImVec2 textSize = scratchLayout.size;
 
         // Determine size of rectangle
         ImVec2 highlightOffset = position - ImVec2(width, width);
         ImVec2 rectangleSize   = textSize + ImVec2(2 * width, 2 * width);
 
         // Draw background highlight with rounded corners
-        FilledRoundedRectangle(color, transparency, highlightOffset, rectangleSize, rounding);
+        drawList->AddRectFilled(highlightOffset, highlightOffset + rectangleSize, Color::WithAlpha(color, transparency), rounding, ImDrawFlags_RoundCornersAll);
     }
 
     // Function:    TextWithHighlight
@@ -218,14 +328,23 @@ namespace Draw {
     // float highlightTransparency: opacity of the highlight
     // ImVec2 position:             coordinates of text box's upper left corner
     // float fontSize:              size of the font
-    void TextWithHighlight(std::string& text, ImFont* font, float highlightWidth, ImU32 textColor, ImU32 highlightColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize)
+    void TextWithHighlight(std::string_view text, ImFont* font, float highlightWidth, ImU32 textColor, ImU32 highlightColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize)
     {
-        Highlight(text, font, highlightWidth, highlightColor, highlightTransparency, position, fontSize);
-        Text(text, textColor, textTransparency, position, font, fontSize);
+        TraceScope trace(TraceCall::TextWithHighlight, text, font, highlightWidth, textColor, highlightColor, textTransparency, highlightTransparency, position, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!TextVisible(drawList, TraceCall::TextWithHighlight, text, position, fontSize, highlightWidth))
+            return;
+
+        // Walk the glyphs once for both the highlight's size and the text's quads
+        LayoutText(scratchLayout, drawList, font, fontSize, text.data(), text.data() + text.size());
+        const ImVec2 margin = ImVec2(highlightWidth, highlightWidth);
+        drawList->AddRectFilled(position - margin, position + scratchLayout.size + margin, Color::WithAlpha(highlightColor, highlightTransparency));
+        EmitGlyphs(drawList, scratchLayout, position, (textColor & 0x00FFFFFF) | (ImU32)(textTransparency * 255.0f) << 24);
+        Stats().fusedTextCalls++;
     }
 
     // Function:    TextWithHighlightRounded
-    // --------------------------------------
+    // -------------------------------------
     // Draws text with a rounded highlight box behind it
     //
     // string text:                 content of the drawn text
@@ -238,10 +357,19 @@ namespace Draw {
     // float highlightTransparency: opacity of the highlight
     // ImVec2 position:             coordinates of text box's upper left corner
     // float fontSize:              size of the font
-    void TextWithRoundedHighlight(std::string& text, ImFont* font, float highlightWidth, ImU32 textColor, ImU32 highlightColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize, float rounding)
+    void TextWithRoundedHighlight(std::string_view text, ImFont* font, float highlightWidth, ImU32 textColor, ImU32 highlightColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize, float rounding)
     {
-        HighlightRounded(text, font, highlightWidth, highlightColor,highlightTransparency, position, fontSize, rounding);
-        Text(text, textColor, textTransparency, position, font, fontSize);
+        TraceScope trace(TraceCall::TextWithRoundedHighlight, text, font, highlightWidth, textColor, highlightColor, textTransparency, highlightTransparency, position, fontSize, rounding);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!TextVisible(drawList, TraceCall::TextWithRoundedHighlight, text, position, fontSize, highlightWidth))
+            return;
+
+        // Walk the glyphs once for both the highlight's size and the text's quads
+        LayoutText(scratchLayout, drawList, font, fontSize, text.data(), text.data() + text.size());
+        const ImVec2 margin = ImVec2(highlightWidth, highlightWidth);
+        drawList->AddRectFilled(position - margin, position + scratchLayout.size + margin, Color::WithAlpha(highlightColor, highlightTransparency), rounding, ImDrawFlags_RoundCornersAll);
+        EmitGlyphs(drawList, scratchLayout, position, (textColor & 0x00FFFFFF) | (ImU32)(textTransparency * 255.0f) << 24);
+        Stats().fusedTextCalls++;
     }
 
 
@@ -260,16 +388,270 @@ namespace Draw {
     // float highlightTransparency: opacity of the highlight
     // ImVec2 position:             coordinates of text box's upper left corner
     // float fontSize:              size of the font
-    void StrokedTextWithHighlight(std::string& text, ImFont* font, float highlightWidth, float strokeWidth, ImU32 textColor, ImU32 highlightColor, ImU32 strokeColor, float textTransparency, float highlightTransparency, ImVec2 position, float
+    void StrokedTextWithHighlight(std::string_view text, ImFont* font, float highlightWidth, float strokeWidth, ImU32 textColor, ImU32 highlightColor, ImU32 strokeColor, float textTransparency, float highlightTransparency, ImVec2 position, float
                                   fontSize)
     {
-        Highlight(text, font, highlightWidth, highlightColor, highlightTransparency, position, 0);
-        TextWithStroke(text, strokeColor, textColor, textTransparency, strokeWidth, position, font, 0);
+        TraceScope trace(TraceCall::StrokedTextWithHighlight, text, font, highlightWidth, strokeWidth, textColor, highlightColor, strokeColor, textTransparency, highlightTransparency, position, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!TextVisible(drawList, TraceCall::StrokedTextWithHighlight, text, position, 0.0f, ImMax(highlightWidth, strokeWidth)))
+            return;
+
+        LayoutText(scratchLayout, drawList, font, 0.0f, text.data(), text.data() + text.size());
+        const ImVec2 margin = ImVec2(highlightWidth, highlightWidth);
+        drawList->AddRectFilled(position - margin, position + scratchLayout.size + margin, Color::WithAlpha(highlightColor, highlightTransparency));
+        EmitTextStroke(drawList, text, Color::WithAlpha(strokeColor, textTransparency), strokeWidth, position, font, 0.0f);
+        EmitText(drawList, text, Color::WithAlpha(textColor, textTransparency), position, font, 0.0f);
+    }
+
+    // Function:    GradientText
+    // -------------------------
+    // Draws text shaded left to right along Color's default gradient
+    // Each glyph's left and right edges take the gradient's color at their position across the text,
+    // so the whole label is one pass over its glyphs, with no draw call per character.
+    //
+    // string text:             text to be written to the screen
+    // float transparency:      relative transparency of text
+    // ImVec2 position:         coordinates of upper left of text box
+    // ImFont font:             font style to be used
+    // float fontSize:          point size of font
+    // float startPercentage:   point on the gradient at the left edge of the text
+    // float endPercentage:     point on the gradient at the right edge of the text
+    void GradientText(std::string_view text, float transparency, ImVec2 position, ImFont* font, float fontSize, float startPercentage, float endPercentage)
+    {
+        TraceScope trace(TraceCall::GradientText, text, transparency, position, font, fontSize, startPercentage, endPercentage);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!TextVisible(drawList, TraceCall::GradientText, text, position, fontSize, 0.0f))
+            return;
+
+        const ImU32 alpha = (ImU32)(transparency * 255.0f) << 24;
+        if (alpha == 0)
+            return;
+        LayoutText(scratchLayout, drawList, font, fontSize, text.data(), text.data() + text.size());
+        const float width = ImMax(scratchLayout.size.x, 1.0f);
+
+        static std::vector<ImU32> edgeColors;
+        edgeColors.resize(scratchLayout.glyphs.size() * 2);
+        for (size_t i = 0; i < scratchLayout.glyphs.size(); i++)
+        {
+            const LaidGlyph& glyph = scratchLayout.glyphs[i];
+            edgeColors[i * 2] = (Color::GetInterpolatedColorU32(ImLerp(startPercentage, endPercentage, glyph.min.x / width)) & 0x00FFFFFF) | alpha;
+            edgeColors[i * 2 + 1] = (Color::GetInterpolatedColorU32(ImLerp(startPercentage, endPercentage, glyph.max.x / width)) & 0x00FFFFFF) | alpha;
+        }
+        EmitGlyphs(drawList, scratchLayout, position, edgeColors.data());
+    }
+
+    // Function:    TextWithColorSpans
+    // -------------------------------
+    // Draws text whose byte ranges take the colors of a span table, in one pass over the glyphs
+    // Glyphs outside every span take the default color.
+    //
+    // string text:         text to be written to the screen
+    // vector spans:        colored byte ranges, in order and not overlapping
+    // ImU32 color:         color of text outside the spans
+    // float transparency:  relative transparency of text, applied to every color
+    // ImVec2 position:     coordinates of upper left of text box
+    // ImFont font:         font style to be used
+    // float fontSize:      point size of font
+    void TextWithColorSpans(std::string_view text, const std::vector<TextColorSpan>& spans, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize)
+    {
+        TraceScope trace(TraceCall::TextWithColorSpans, text, spans, color, transparency, position, font, fontSize);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!TextVisible(drawList, TraceCall::TextWithColorSpans, text, position, fontSize, 0.0f))
+            return;
+
+        const ImU32 alpha = (ImU32)(transparency * 255.0f) << 24;
+        if (alpha == 0)
+            return;
+        LayoutText(scratchLayout, drawList, font, fontSize, text.data(), text.data() + text.size());
+
+        // Glyphs are in byte order, so a single cursor walks the spans alongside them
+        static std::vector<ImU32> edgeColors;
+        edgeColors.resize(scratchLayout.glyphs.size() * 2);
+        size_t span = 0;
+        for (size_t i = 0; i < scratchLayout.glyphs.size(); i++)
+        {
+            const int byte = scratchLayout.glyphs[i].byte;
+            while (span < spans.size() && spans[span].end <= byte)
+                span++;
+            const ImU32 glyphColor = span < spans.size() && spans[span].begin <= byte ? spans[span].color : color;
+            edgeColors[i * 2] = edgeColors[i * 2 + 1] = (glyphColor & 0x00FFFFFF) | alpha;
+        }
+        EmitGlyphs(drawList, scratchLayout, position, edgeColors.data());
+    }
+
+    // Helper Function:    RectStrokeVertexCount
+    // -----------------------------------------
+    // Counts the vertices ImDrawList::AddPolyline builds to stroke a closed rectangle
+    //
+    // ImDrawList* drawList:    draw list whose flags select the stroke style
+    // float thickness:         stroke width in pixels
+    //
+    // Returns the vertex count of the stroke
+    static int RectStrokeVertexCount(const ImDrawList* drawList, float thickness)
+    {
+        if ((drawList->Flags & ImDrawListFlags_AntiAliasedLines) == 0)
+            return 4 * 4;
+
+        const bool thickLine = thickness > drawList->_FringeScale;
+        thickness = ImMax(thickness, 1.0f);
+        const bool useTexture = (drawList->Flags & ImDrawListFlags_AntiAliasedLinesUseTex) != 0
+            && (int)thickness < IM_DRAWLIST_TEX_LINES_WIDTH_MAX
+            && thickness - (float)(int)thickness <= 0.00001f
+            && drawList->_FringeScale == 1.0f;
+        if (useTexture)
+            return 4 * 2;
+        return thickLine ? 4 * 4 : 4 * 3;
+    }
+
+    // Helper Function:    SnappedRing
+    // -------------------------------
+    // Computes the ring AddRect strokes for an unrounded box, centered on a path inset by half a pixel
+    //
+    // ImVec2 p_min:                upper left corner of the box
+    // ImVec2 p_max:                lower right corner of the box
+    // float width:                 stroke width in pixels
+    // float rounding:              filleting radius of the box edges
+    // ImDrawFlags rectangleFlags:  ImGui-specific flags for rectangle formatting
+    // ImVec2 ring[4]:              receives the outer minimum, outer maximum, inner minimum and inner maximum
+    //
+    // Returns true if the box is unrounded and every edge of the ring lands on a framebuffer pixel boundary
+    static bool SnappedRing(ImVec2 p_min, ImVec2 p_max, float width, float rounding, ImDrawFlags rectangleFlags, ImVec2 ring[4])
+    {
+        if (IsRounded(rounding, rectangleFlags) || width <= 0.0f)
+            return false;
+
+        const float halfWidth = width * 0.5f;
+        ring[0] = p_min + ImVec2(0.5f - halfWidth, 0.5f - halfWidth);
+        ring[1] = p_max - ImVec2(0.5f - halfWidth, 0.5f - halfWidth);
+        ring[2] = p_min + ImVec2(0.5f + halfWidth, 0.5f + halfWidth);
+        ring[3] = p_max - ImVec2(0.5f + halfWidth, 0.5f + halfWidth);
+        if (ring[2].x >= ring[3].x || ring[2].y >= ring[3].y)
+            return false;
+
+        const ImVec2 scale = ImGui::GetIO().DisplayFramebufferScale;
+        for (int corner = 0; corner < 4; corner++)
+        {
+            if (!IsPixelAligned(ring[corner].x, scale.x) || !IsPixelAligned(ring[corner].y, scale.y))
+                return false;
+        }
+        return true;
+    }
+
+    // Helper Function:    EmitRing
+    // ----------------------------
+    // Writes a hard-edged ring and credits the vertices saved over an AddRect stroke of the given width
+    //
+    // ImDrawList* drawList:    destination draw list
+    // const ImVec2 ring[4]:    outer minimum, outer maximum, inner minimum and inner maximum
+    // ImU32 color:             color of the ring
+    // float strokeWidth:       width of the AddRect stroke being replaced
+    // int strokes:             number of AddRect strokes the ring replaces
+    static void EmitRing(ImDrawList* drawList, const ImVec2 ring[4], ImU32 color, float strokeWidth, int strokes)
+    {
+        if (ReserveItems(drawList, 1, 8, 24) == 0)
+        {
+            Stats().droppedItems++;
+            return;
+        }
+        PrimRectRing(drawList, ring[0], ring[1], ring[2], ring[3], color);
+
+        Stats().snappedBorders++;
+        Stats().borderVerticesSaved += RectStrokeVertexCount(drawList, strokeWidth) * strokes - 8;
+    }
+
+    // Helper Function:    EmitStrokeBand
+    // ----------------------------------
+    // Writes the outline BoxAroundWithStroke traces around a snapped ring: its outer edge is the ring's
+    // outer rectangle grown by the stroke with corners rounded to the stroke's radius, its inner edge
+    // the ring's inner rectangle shrunk by the stroke, square as the union of offset copies leaves it.
+    // Straight edges stay pixel-aligned and hard; only the corner arcs get an anti-aliased fringe.
+    //
+    // ImDrawList* drawList:    destination draw list
+    // const ImVec2 ring[4]:    outer minimum, outer maximum, inner minimum and inner maximum of the box's ring
+    // float radius:            stroke width in pixels, a whole number of framebuffer pixels
+    // ImU32 color:             opaque color of the stroke
+    // float boxWidth:          width of the box the stroke surrounds
+    // int strokes:             number of AddRect strokes the band replaces
+    static void EmitStrokeBand(ImDrawList* drawList, const ImVec2 ring[4], float radius, ImU32 color, float boxWidth, int strokes)
+    {
+        const float fringe = (drawList->Flags & ImDrawListFlags_AntiAliasedFill) ? drawList->_FringeScale * 0.5f : 0.0f;
+        const int arcSegments = ImMax(2, drawList->_CalcCircleAutoSegmentCount(radius) / 4);
+        const int arcPoints = arcSegments + 1;
+        const int vertexCount = 4 + 8 * arcPoints;
+        const int indexCount = 4 * (arcSegments * 3 + 6 + arcSegments * 6);
+        if (ReserveItems(drawList, 1, vertexCount, indexCount) == 0)
+        {
+            Stats().droppedItems++;
+            return;
+        }
+
+        const ImVec2 uv = drawList->_Data->TexUvWhitePixel;
+        const ImU32 transparent = color & ~IM_COL32_A_MASK;
+        const ImVec2 innerMin = ring[2] + ImVec2(radius, radius);
+        const ImVec2 innerMax = ring[3] - ImVec2(radius, radius);
+        const ImVec2 inner[4] = { innerMin, ImVec2(innerMax.x, innerMin.y), innerMax, ImVec2(innerMin.x, innerMax.y) };
+        const ImVec2 centers[4] = { ring[0], ImVec2(ring[1].x, ring[0].y), ring[1], ImVec2(ring[0].x, ring[1].y) };
+
+        // Inner corners, then each corner's arc clockwise from the top left, then the arcs' fringe
+        const unsigned int base = drawList->_VtxCurrentIdx;
+        for (int corner = 0; corner < 4; corner++)
+            drawList->PrimWriteVtx(inner[corner], uv, color);
+        for (int pass = 0; pass < 2; pass++)
+        {
+            for (int corner = 0; corner < 4; corner++)
+            {
+                for (int point = 0; point < arcPoints; point++)
+                {
+                    const float angle = IM_PI * (1.0f + 0.5f * corner + 0.5f * point / arcSegments);
+                    const bool endpoint = point == 0 || point == arcSegments;
+                    const float distance = endpoint ? radius : (pass == 0 ? radius - fringe : radius + fringe);
+                    drawList->PrimWriteVtx(centers[corner] + ImVec2(cosf(angle), sinf(angle)) * distance, uv, pass == 0 ? color : transparent);
+                }
+            }
+        }
+
+        auto arc = [&](int corner, int point) { return (ImDrawIdx)(base + 4 + corner * arcPoints + point); };
+        auto edge = [&](int corner, int point) { return (ImDrawIdx)(base + 4 + (4 + corner) * arcPoints + point); };
+        for (int corner = 0; corner < 4; corner++)
+        {
+            const int next = (corner + 1) % 4;
+            const ImDrawIdx innerCorner = (ImDrawIdx)(base + corner);
+            const ImDrawIdx innerNext = (ImDrawIdx)(base + next);
+            for (int point = 0; point < arcSegments; point++)
+            {
+                drawList->PrimWriteIdx(innerCorner); drawList->PrimWriteIdx(arc(corner, point)); drawList->PrimWriteIdx(arc(corner, point + 1));
+                drawList->PrimWriteIdx(arc(corner, point)); drawList->PrimWriteIdx(edge(corner, point)); drawList->PrimWriteIdx(edge(corner, point + 1));
+                drawList->PrimWriteIdx(arc(corner, point)); drawList->PrimWriteIdx(edge(corner, point + 1)); drawList->PrimWriteIdx(arc(corner, point + 1));
+            }
+            drawList->PrimWriteIdx(arc(corner, arcSegments)); drawList->PrimWriteIdx(arc(next, 0)); drawList->PrimWriteIdx(innerNext);
+            drawList->PrimWriteIdx(arc(corner, arcSegments)); drawList->PrimWriteIdx(innerNext); drawList->PrimWriteIdx(innerCorner);
+        }
+
+        Stats().snappedBorders++;
+        Stats().borderVerticesSaved += RectStrokeVertexCount(drawList, boxWidth) * strokes - vertexCount;
+    }
+
+    // Helper Function:    EmitBoxAround
+    // ---------------------------------
+    // Writes BoxAround's outline between two corners without a clip test, for BoxAround and its stroke
+    static void EmitBoxAround(ImDrawList* drawList, ImVec2 p_min, ImVec2 p_max, float width, ImU32 colorWithAlpha, float rounding, ImDrawFlags rectangleFlags)
+    {
+        ImVec2 ring[4];
+        if (RectStrokeVertexCount(drawList, width) > 8 && SnappedRing(p_min, p_max, width, rounding, rectangleFlags, ring))
+        {
+            EmitRing(drawList, ring, colorWithAlpha, width, 1);
+            return;
+        }
+
+        drawList->AddRect(p_min, p_max, colorWithAlpha, rounding, rectangleFlags, width);
     }
 
     // Function:    BoxAround
     // ----------------------
     // Draws a rectangular outline around a provided set of coordinates of a set thickness
+    // Unrounded boxes whose edges land on pixel boundaries need no anti-aliasing, and are written
+    // as a hard-edged ring of eight vertices when AddRect's stroke would take more than eight.
+    // With ImGui's default textured lines and a whole-pixel width, AddRect is already eight vertices.
     //
     // ImVec2 size:                 size of the space being enclosed with a box
     // ImVec2 position:             coordinates to upper left corner of the space being enclosed
@@ -280,6 +662,7 @@ namespace Draw {
     // ImDrawFlags rectangleFlags:  ImGui-specific flags for rectangle formatting
     void BoxAround(ImVec2 size, ImVec2 position, float width, ImU32 color, float transparency, float rounding, ImDrawFlags rectangleFlags)
     {
+        TraceScope trace(TraceCall::BoxAround, size, position, width, color, transparency, rounding, rectangleFlags);
         ImDrawList* drawList = ImGui::GetWindowDrawList();
 
         // Apply transparency to the input color
@@ -289,7 +672,12 @@ namespace Draw {
         ImVec2 p_min = position - ImVec2(width, width);
         ImVec2 p_max = position + size + ImVec2(width, width);
 
-        drawList->AddRect(p_min, p_max, colorWithAlpha, rounding, rectangleFlags, width);
+        // AddRect centers its stroke on the box edge, reaching half the width outside it
+        const ImVec2 halfWidth = ImVec2(width, width) * 0.5f;
+        if (!ClipTest(drawList, TraceCall::BoxAround, p_min - halfWidth, p_max + halfWidth))
+            return;
+
+        EmitBoxAround(drawList, p_min, p_max, width, colorWithAlpha, rounding, rectangleFlags);
     }
 
     // Function:    RoundedRectangleBehind
@@ -305,6 +693,7 @@ namespace Draw {
     // ImDrawFlags rectangleFlags:  ImGui-specific flags for rectangle formatting
     void RoundedRectangleBehind(ImVec2 size, ImVec2 position, float width, ImU32 color, float transparency, float rounding)
     {
+        TraceScope trace(TraceCall::RoundedRectangleBehind, size, position, width, color, transparency, rounding);
         ImDrawList* drawList = ImGui::GetWindowDrawList();
 
         // Apply transparency to the input color
@@ -313,6 +702,8 @@ namespace Draw {
 
         ImVec2 p_min = position - ImVec2(width, width);
         ImVec2 p_max = position + size + ImVec2(width, width);
+        if (!ClipTest(drawList, TraceCall::RoundedRectangleBehind, p_min, p_max))
+            return;
 
         // Draw background rectangle with rounded corners
         drawList->AddRectFilled(
@@ -326,6 +717,10 @@ namespace Draw {
     // Function:    BoxAroundWithStroke
     // --------------------------------
     // Draws a rectangular outline around a provided set of coordinates with a stroke outline
+    // The stroke is the box traced at 32 offsets around a circle. For an opaque, pixel-aligned,
+    // unrounded box with a whole-pixel stroke, the union of those copies is the box's ring widened by
+    // the stroke on both sides, with outer corners rounded to the stroke's radius, so the stroke is
+    // written as one band of that shape and the box is drawn once on top
     //
     // ImVec2 size:                 size of the space being enclosed with a box
     // ImVec2 position:             coordinates to upper left corner of the space being enclosed
@@ -336,24 +731,55 @@ namespace Draw {
     // ImDrawFlags rectangleFlags:  ImGui-specific flags for rectangle formatting
     void BoxAroundWithStroke(ImVec2 size, ImVec2 offset, float width, ImU32 color, float strokeWidth, ImU32 strokeColor, float transparency, float rounding, ImDrawFlags rectangleFlags)
     {
+        TraceScope trace(TraceCall::BoxAroundWithStroke, size, offset, width, color, strokeWidth, strokeColor, transparency, rounding, rectangleFlags);
         constexpr int segments = 32;
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+
+        ImVec2 ring[4];
+        const ImVec2 p_min = offset - ImVec2(width, width);
+        const ImVec2 p_max = offset + size + ImVec2(width, width);
+        const ImVec2 reach = ImVec2(width * 0.5f + strokeWidth, width * 0.5f + strokeWidth);
+        if (!ClipTest(drawList, TraceCall::BoxAroundWithStroke, p_min - reach, p_max + reach))
+            return;
+
+        const ImVec2 scale = ImGui::GetIO().DisplayFramebufferScale;
+        if (transparency >= 1.0f && IsPixelAligned(strokeWidth, scale.x) && IsPixelAligned(strokeWidth, scale.y)
+            && SnappedRing(p_min, p_max, width, rounding, rectangleFlags, ring))
+        {
+            const ImVec2 stroke = ImVec2(strokeWidth, strokeWidth);
+            if (ring[2].x + stroke.x < ring[3].x - stroke.x && ring[2].y + stroke.y < ring[3].y - stroke.y)
+            {
+                EmitStrokeBand(drawList, ring, strokeWidth, strokeColor | IM_COL32_A_MASK, width, segments);
+                EmitBoxAround(drawList, p_min, p_max, width, color | IM_COL32_A_MASK, rounding, rectangleFlags);
+                return;
+            }
+        }
+
         float step = 2.0f * IM_PI / segments;
+        const ImU32 strokeWithAlpha = Color::WithAlpha(strokeColor, transparency);
 
         for (int i = 0; i < segments; ++i) {
             float angle = step * i;
             ImVec2 strokeOffset = ImVec2(cosf(angle), sinf(angle)) * strokeWidth;
-            BoxAround(size, offset + strokeOffset, width, strokeColor, transparency, rounding, rectangleFlags);
+            EmitBoxAround(drawList, p_min + strokeOffset, p_max + strokeOffset, width, strokeWithAlpha, rounding, rectangleFlags);
         }
 
         // Draw central rectangle
-        BoxAround(
-            size,
-            offset,
-            width,
-            color,
-            transparency,
-            rounding,
-            rectangleFlags
+        EmitBoxAround(drawList, p_min, p_max, width, Color::WithAlpha(color, transparency), rounding, rectangleFlags);
+    }
+
+    // Helper Function:    EmitSprite
+    // ------------------------------
+    // Writes a texture 1:1 at a position without a clip test, for sprites drawn as part of a grid
+    static void EmitSprite(ImDrawList* drawList, TextureData sprite, ImVec2 position, ImU32 tintColor)
+    {
+        drawList->AddImage(
+            (ImTextureID)(intptr_t)sprite.id,
+            position,
+            position + ImVec2(sprite.width, sprite.height),
+            ImVec2(0.0f, 0.0f),
+            ImVec2(1.0f, 1.0f),
+            tintColor
             );
     }
 
@@ -366,7 +792,11 @@ namespace Draw {
     // float transparency:  relative opacity of the rendered sprite
     void Sprite(TextureData sprite, ImVec2 position, float transparency)
     {
+        TraceScope trace(TraceCall::Sprite, sprite, position, transparency);
         ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::Sprite, position, position + ImVec2(sprite.width, sprite.height)))
+            return;
+
         ImU32 tintColor = IM_COL32(255.0, 255.0, 255.0, transparency * 255.0);
         drawList->AddImage(
             (ImTextureID)(intptr_t)sprite.id,
@@ -389,7 +819,10 @@ namespace Draw {
     // float transparency:      relative opacity of the rendered sprite
     void TintedSprite(TextureData sprite, ImVec2 position, ImU32 tintColor, float transparency)
     {
+        TraceScope trace(TraceCall::TintedSprite, sprite, position, tintColor, transparency);
         ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::TintedSprite, position, position + ImVec2(sprite.width, sprite.height)))
+            return;
 
         ImU32 colorWithAlpha = Color::WithAlpha(tintColor, transparency); // mask out existing alpha
 
@@ -417,12 +850,15 @@ namespace Draw {
     // float transparency:  relative opacity of the rendered sprite
     void SpriteSubsection(TextureData sprite, ImVec2 position, ImVec2 startFraction, ImVec2 endFraction)
     {
+        TraceScope trace(TraceCall::SpriteSubsection, sprite, position, startFraction, endFraction);
         ImDrawList* drawList = ImGui::GetWindowDrawList();
 
         ImVec2 spriteSize(sprite.width, sprite.height);
 
         ImVec2 topLeft = position + ImVec2(startFraction.x * spriteSize.x, startFraction.y * spriteSize.y);
         ImVec2 bottomRight = position + ImVec2(endFraction.x * spriteSize.x, endFraction.y * spriteSize.y);
+        if (!ClipTest(drawList, TraceCall::SpriteSubsection, ImMin(topLeft, bottomRight), ImMax(topLeft, bottomRight)))
+            return;
 
         drawList->AddImage(
             (ImTextureID)(intptr_t)sprite.id,
@@ -446,8 +882,11 @@ namespace Draw {
     // float scale:         zoom level
     void Image(TextureData sprite, ImVec2 position, ImVec2 frameSize, float scale)
     {
+        TraceScope trace(TraceCall::Image, sprite, position, frameSize, scale);
         float trueScale = std::pow(2.0f, scale * 4.0f); // Exponential scaling for even zoom
         ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::Image, position, position + frameSize))
+            return;
 
         ImVec2 topLeft = position;
         ImVec2 bottomRight = position + frameSize;
@@ -473,7 +912,10 @@ namespace Draw {
     // Renders a cropped subsection of an image within a specific frame
     void Crop(TextureData sprite, ImVec2 position, ImVec2 cropPosition, ImVec2 cropSize, ImVec2 frameSize)
     {
+        TraceScope trace(TraceCall::Crop, sprite, position, cropPosition, cropSize, frameSize);
         ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::Crop, position, position + frameSize))
+            return;
 
         ImVec2 topLeft = position;
         ImVec2 bottomRight = position + frameSize;
@@ -491,20 +933,12 @@ namespace Draw {
             IM_COL32_WHITE);
     }
 
-    // Function:        RoundedImage
-    // -----------------------------
-    // Renders an image with rounded edges
-    //
-    // Texture sprite:      a pre-rasterized texture
-    // ImVec2 position:     coordinate location for upper-left-corner of the sprite
-    // ImVec2 frameSize:    the size of the image as it is displayed
-    // float scale:         zoom level
-    // float rouding:       the rounding radius of the corners
-    void RoundedImage(TextureData sprite, ImVec2 position, ImVec2 frameSize, float scale, float rounding)
+    // Helper Function:    EmitRoundedImage
+    // ------------------------------------
+    // Writes RoundedImage's quad without a clip test, for RoundedImage and the grids built from it
+    static void EmitRoundedImage(ImDrawList* drawList, TextureData sprite, ImVec2 position, ImVec2 frameSize, float scale, float rounding)
     {
         float trueScale = std::pow(2.0f, scale * 4.0f);
-        ImDrawList* drawList = ImGui::GetWindowDrawList();
-
         ImVec2 topLeft = position;
         ImVec2 bottomRight = position + frameSize;
         scale = ImClamp(trueScale, 1.001f, 100.0f);
@@ -524,11 +958,108 @@ namespace Draw {
             rounding  // radius for rounded corners
         );
     }
+
+    // Function:        RoundedImage
+    // -----------------------------
+    // Renders an image with rounded edges
+    //
+    // Texture sprite:      a pre-rasterized texture
+    // ImVec2 position:     coordinate location for upper-left-corner of the sprite
+    // ImVec2 frameSize:    the size of the image as it is displayed
+    // float scale:         zoom level
+    // float rouding:       the rounding radius of the corners
+    void RoundedImage(TextureData sprite, ImVec2 position, ImVec2 frameSize, float scale, float rounding)
+    {
+        TraceScope trace(TraceCall::RoundedImage, sprite, position, frameSize, scale, rounding);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::RoundedImage, position, position + frameSize))
+            return;
+
+        EmitRoundedImage(drawList, sprite, position, frameSize, scale, rounding);
+    }
+
+    // Helper Function:    TiledRegion
+    // -------------------------------
+    // Draws a region of a tiled image stretched over a frame, one quad per tile
+    // The screen scale picks the pyramid level, and tiles still loading are covered by coarser ones.
+    //
+    // TiledImage image:    large image to draw
+    // ImVec2 position:     coordinate location for upper-left-corner of the frame
+    // ImVec2 frameSize:    the size of the region as it is displayed
+    // ImVec2 regionMin:    upper left corner of the region, in image pixels
+    // ImVec2 regionMax:    lower right corner of the region, in image pixels
+    static void TiledRegion(Texture::TiledImage& image, ImVec2 position, ImVec2 frameSize, ImVec2 regionMin, ImVec2 regionMax)
+    {
+        static std::vector<ImageTile> tiles;
+
+        ImVec2 regionSize = regionMax - regionMin;
+        if (regionSize.x <= 0.0f || regionSize.y <= 0.0f)
+            return;
+
+        ImVec2 screenScale = ImVec2(frameSize.x / regionSize.x, frameSize.y / regionSize.y);
+        image.CollectTiles(regionMin.x, regionMin.y, regionMax.x, regionMax.y, ImMax(screenScale.x, screenScale.y), tiles);
+
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        for (const ImageTile& tile : tiles)
+        {
+            drawList->AddImage(
+                (ImTextureID)(intptr_t)tile.texture.id,
+                position + ImVec2((tile.x0 - regionMin.x) * screenScale.x, (tile.y0 - regionMin.y) * screenScale.y),
+                position + ImVec2((tile.x1 - regionMin.x) * screenScale.x, (tile.y1 - regionMin.y) * screenScale.y),
+                ImVec2(tile.u0, tile.v0),
+                ImVec2(tile.u1, tile.v1),
+                IM_COL32_WHITE);
+        }
+    }
+
+    // Function:        Image
+    // ----------------------
+    // Renders a large tiled image to scale into fixed dimensions at a set zoom level
+    // Zooms exactly like Image for a single texture, but only the tiles inside the frame are
+    // loaded, at the resolution the zoom level needs. Draws nothing until the image is Ready.
+    //
+    // TiledImage image:    large image to draw
+    // ImVec2 position:     coordinate location for upper-left-corner of the image
+    // ImVec2 frameSize:    the size of the image as it is displayed
+    // float scale:         zoom level
+    void Image(Texture::TiledImage& image, ImVec2 position, ImVec2 frameSize, float scale)
+    {
+        if (!ClipTest(ImGui::GetWindowDrawList(), TraceCall::Image, position, position + frameSize))
+            return;
+
+        float trueScale = std::pow(2.0f, scale * 4.0f); // Exponential scaling for even zoom
+        scale = ImClamp(trueScale, 1.001f, 100.0f);
+
+        float margin = (1.0f - 1.0f / scale) / 2.0f;
+        ImVec2 imageSize = ImVec2(image.Width(), image.Height());
+
+        TiledRegion(image, position, frameSize, imageSize * margin, imageSize * (1.0f - margin));
+    }
+
+    // Function:    Crop
+    // -----------------
+    // Renders a cropped subsection of a large tiled image within a specific frame
+    // Only the tiles under the crop are loaded, at the resolution the frame needs.
+    //
+    // TiledImage image:    large image to draw
+    // ImVec2 position:     coordinate location for upper-left-corner of the frame
+    // ImVec2 cropPosition: upper left corner of the crop, in image pixels
+    // ImVec2 cropSize:     size of the crop, in image pixels
+    // ImVec2 frameSize:    the size of the crop as it is displayed
+    void Crop(Texture::TiledImage& image, ImVec2 position, ImVec2 cropPosition, ImVec2 cropSize, ImVec2 frameSize)
+    {
+        if (!ClipTest(ImGui::GetWindowDrawList(), TraceCall::Crop, position, position + frameSize))
+            return;
+
+        TiledRegion(image, position, frameSize, cropPosition, cropPosition + cropSize);
+    }
+
     // Function:        Grid
     // ---------------------
     // Generates an empty grid divided by solid rectangular gridlines
     // Gridlines divide each cell into rows and columns, as well as produce a border around the canvas
     // This is used to generate gallery displays
+    // Gridlines are written as raw quads, split into VtxOffset commands when 16-bit indices run out
     //
     // ImVec2 origin:       coordinates of upper left corner of the canvas
     // int columns:         number of columns in the grid
@@ -539,9 +1070,14 @@ namespace Draw {
     // ImU32 gridlineColor: gridline color
     void Grid(ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float gridlineWidth, ImU32 gridlineColor)
     {
+        TraceScope trace(TraceCall::Grid, origin, columns, rows, cellWidth, cellHeight, gridlineWidth, gridlineColor);
         float documentWidth = (columns + 1) * gridlineWidth + cellWidth * columns;
         float documentHeight = (rows + 1) * gridlineWidth + cellHeight * rows;
 
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::Grid, origin, origin + ImVec2(documentWidth, documentHeight)))
+            return;
+
         // Dimensions of individual gridlines
         ImVec2 horizontalGridlineSize = ImVec2(documentWidth, gridlineWidth);
         ImVec2 verticalGridlineSize = ImVec2(gridlineWidth, documentHeight);
@@ -549,18 +1085,33 @@ namespace Draw {
         float horizontalCellDisplacement = cellWidth + gridlineWidth;
         float verticalCellDisplacement = cellHeight + gridlineWidth;
 
-        // Draw the vertical gridlines
-        for (int currentColumn = 0; currentColumn <= columns; currentColumn++)
-        {
-            ImVec2 anchor = origin + ImVec2(horizontalCellDisplacement * currentColumn, 0);
-            FilledRectangle(gridlineColor, 1.0f, anchor, verticalGridlineSize);
-        }
+        ImU32 opaqueColor = gridlineColor | IM_COL32_A_MASK;
 
-        // Draw the horizontal gridlines
-        for (int currentRow = 0; currentRow <= rows; currentRow++)
+        // Vertical gridlines come first, then horizontal ones, written in as few reservations as the indices allow
+        const int lineCount = (columns + 1) + (rows + 1);
+        int line = 0;
+        while (line < lineCount)
         {
-            ImVec2 anchor = origin + ImVec2(0, verticalCellDisplacement * currentRow);
-            FilledRectangle(gridlineColor, 1.0f, anchor, horizontalGridlineSize);
+            int chunk = ReserveItems(drawList, lineCount - line, 4, 6);
+            if (chunk == 0)
+            {
+                Stats().droppedItems += lineCount - line;
+                return;
+            }
+
+            for (int chunkEnd = line + chunk; line < chunkEnd; line++)
+            {
+                if (line <= columns)
+                {
+                    ImVec2 anchor = origin + ImVec2(horizontalCellDisplacement * line, 0);
+                    drawList->PrimRect(anchor, anchor + verticalGridlineSize, opaqueColor);
+                }
+                else
+                {
+                    ImVec2 anchor = origin + ImVec2(0, verticalCellDisplacement * (line - columns - 1));
+                    drawList->PrimRect(anchor, anchor + horizontalGridlineSize, opaqueColor);
+                }
+            }
         }
     }
 
@@ -570,6 +1121,8 @@ namespace Draw {
     // Takes a collection of textures and fills the grid up to the capacity of the vector
     // If the size of the grid exceeds the number of textures in the vector, the remaining cells are left empty
     // The gaps between the cells are indicated by the gridline thickness
+    // Cells are written as raw quads with one command per run of a texture, split into VtxOffset
+    // commands when 16-bit indices run out, so grids of a million cells stay valid
     //
     // vector images:       textures used to populate the grid
     // ImVec2 origin:       coordinates of upper left corner of the canvas
@@ -580,27 +1133,49 @@ namespace Draw {
     // float gridlineWidth: thickness of the gridlines in pixels
     void PopulateGrid(std::vector<TextureData> images, ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float gridlineWidth)
     {
+        TraceScope trace(TraceCall::PopulateGrid, images, origin, columns, rows, cellWidth, cellHeight, gridlineWidth);
         origin = origin + ImVec2(gridlineWidth, gridlineWidth);
 
         float horizontalCellDisplacement = cellWidth + gridlineWidth;
         float verticalCellDisplacement = cellHeight + gridlineWidth;
 
         ImVec2 cellFrameSize = ImVec2(cellWidth, cellHeight);
-        int imageCount = images.size();
-        int cellIndex = 0;
+        int cellCount = ImMin((int)images.size(), columns * rows);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::PopulateGrid, origin, origin + ImVec2(columns * horizontalCellDisplacement, rows * verticalCellDisplacement)))
+            return;
 
-        for (int currentRow = 0; currentRow < rows; currentRow++)
+        // Same crop as Image at zoom level 0
+        float margin = (1.0f - 1.0f / 1.001f) / 2.0f;
+        ImVec2 startFraction = ImVec2(margin, margin);
+        ImVec2 endFraction = ImVec2(1.0f - margin, 1.0f - margin);
+
+        // Consecutive cells sharing a texture form one run, written with as few reservations as the indices allow
+        int cellIndex = 0;
+        while (cellIndex < cellCount)
         {
-            for (int currentColumn = 0; currentColumn < columns; currentColumn++)
+            int runEnd = cellIndex + 1;
+            while (runEnd < cellCount && images[runEnd].id == images[cellIndex].id)
+                runEnd++;
+
+            drawList->PushTextureID((ImTextureID)(intptr_t)images[cellIndex].id);
+            while (cellIndex < runEnd)
             {
-                if (cellIndex >= imageCount)
+                int chunk = ReserveItems(drawList, runEnd - cellIndex, 4, 6);
+                if (chunk == 0)
+                {
+                    Stats().droppedItems += cellCount - cellIndex;
+                    drawList->PopTextureID();
                     return;
+                }
 
-                ImVec2 anchor = origin + ImVec2(currentColumn * horizontalCellDisplacement, currentRow * verticalCellDisplacement);
-                Image(images[currentRow * columns + currentColumn], anchor, cellFrameSize, 0.0f);
-
-                cellIndex++;
+                for (int chunkEnd = cellIndex + chunk; cellIndex < chunkEnd; cellIndex++)
+                {
+                    ImVec2 anchor = origin + ImVec2((cellIndex % columns) * horizontalCellDisplacement, (cellIndex / columns) * verticalCellDisplacement);
+                    drawList->PrimRectUV(anchor, anchor + cellFrameSize, startFraction, endFraction, IM_COL32_WHITE);
+                }
             }
+            drawList->PopTextureID();
         }
     }
 
@@ -620,6 +1195,7 @@ namespace Draw {
     // float gridlineWidth: thickness of the gridlines in pixels
     void PopulateSparseRoundedGrid(std::vector<TextureData> images, ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float spacing, float rounding)
     {
+        TraceScope trace(TraceCall::PopulateSparseRoundedGrid, images, origin, columns, rows, cellWidth, cellHeight, spacing, rounding);
         origin = origin + ImVec2(spacing, spacing);
 
         float horizontalCellDisplacement = cellWidth + spacing;
@@ -628,6 +1204,9 @@ namespace Draw {
         ImVec2 cellFrameSize = ImVec2(cellWidth, cellHeight);
         int imageCount = images.size();
         int cellIndex = 0;
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        if (!ClipTest(drawList, TraceCall::PopulateSparseRoundedGrid, origin, origin + ImVec2(columns * horizontalCellDisplacement, rows * verticalCellDisplacement)))
+            return;
 
         for (int currentRow = 0; currentRow < rows; currentRow++)
         {
@@ -636,19 +1215,101 @@ namespace Draw {
                 if (cellIndex >= imageCount)
                     return;
 
+                // Cells are parts of this call, so they are tested without being counted
                 ImVec2 anchor = origin + ImVec2(currentColumn * horizontalCellDisplacement, currentRow * verticalCellDisplacement);
-                RoundedImage(images[currentRow * columns + currentColumn], anchor, cellFrameSize, 0.0f, rounding);
+                if (ClipVisible(drawList, anchor, anchor + cellFrameSize))
+                    EmitRoundedImage(drawList, images[currentRow * columns + currentColumn], anchor, cellFrameSize, 0.0f, rounding);
                 cellIndex++;
             }
         }
     }
 
-    // Function:        PopulateGrid
-    // -----------------------------
-    // Scales and positions each image within a vector into a grid configuration
-    // Takes a collection of textures and fills the grid up to the capacity of the vector
+    // Function:        VisibleGridCells
+    // ---------------------------------
+    // Finds the whole rows of a spaced-out grid that overlap the window's current clip rectangle
+    // Cells are laid out as in PopulateSparseRoundedGrid, row by row.
+    //
+    // ImVec2 origin:       coordinates of upper left corner of the canvas
+    // int columns:         number of columns in the grid
+    // int rows:            number of rows
+    // float cellHeight:    height of each cell in pixels
+    // float spacing:       distance between cells in pixels
+    // int first:           receives the index of the first visible cell
+    // int last:            receives one past the index of the last visible cell
+    void VisibleGridCells(ImVec2 origin, int columns, int rows, float cellHeight, float spacing, int& first, int& last)
+    {
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const float top = origin.y + spacing;
+        const float rowPitch = cellHeight + spacing;
+
+        int firstRow = (int)std::floor((drawList->GetClipRectMin().y - top) / rowPitch);
+        int lastRow = (int)std::floor((drawList->GetClipRectMax().y - top) / rowPitch) + 1;
+        firstRow = ImClamp(firstRow, 0, rows);
+        lastRow = ImClamp(lastRow, firstRow, rows);
+
+        first = firstRow * columns;
+        last = lastRow * columns;
+    }
+
+    // Function:        PopulateSparseRoundedGrid
+    // ------------------------------------------
+    // Draws the visible cells of a spaced-out grid of rounded images held by a streaming manager
+    // The visible range is reported to the streamer, which loads those cells first on its next
+    // Update. Cells whose texture has not arrived yet are left empty; cells the streamer has
+    // downgraded are drawn from their reduced copy.
+    //
+    // StreamingManager streamer:   source of the textures, one per cell
+    // ImVec2 origin:       coordinates of upper left corner of the canvas
+    // int columns:         number of columns in the grid
+    // int rows:            number of rows
+    // float cellWidth:     width of each cell in pixels
+    // float cellHeight:    height of each cell in pixels
+    // float spacing:       distance between cells in pixels
+    // float rounding:      rounding radius of each image's corners
+    void PopulateSparseRoundedGrid(Texture::StreamingManager& streamer, ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float spacing, float rounding)
+    {
+        int first, last;
+        VisibleGridCells(origin, columns, rows, cellHeight, spacing, first, last);
+        last = ImMin(last, streamer.Count());
+        streamer.SetVisibleRange(first, last);
+
+        origin = origin + ImVec2(spacing, spacing);
+        const ImVec2 cellFrameSize = ImVec2(cellWidth, cellHeight);
+
+        for (int cellIndex = first; cellIndex < last; cellIndex++)
+        {
+            TextureData texture = streamer.Get(cellIndex);
+            if (texture.id == 0)
+                continue;
+
+            ImVec2 anchor = origin + ImVec2((cellIndex % columns) * (cellWidth + spacing), (cellIndex / columns) * (cellHeight + spacing));
+            RoundedImage(texture, anchor, cellFrameSize, 0.0f, rounding);
+        }
+    }
+
+    // Enum:    GridChannel
+    // --------------------
+    // Draw list channels used when a populated grid groups its output by texture kind
+    // Channels are merged in declaration order, so each layer is drawn over the previous one
+    enum GridChannel
+    {
+        GridChannel_Images,     // Photos and icons, one texture per cell
+        GridChannel_Highlights, // Date highlights, font atlas white pixel
+        GridChannel_Text,       // Date labels, font atlas glyphs
+        GridChannel_Count
+    };
+
+    // Function:        PopulateSparseRoundedGridWithDates
+    // ---------------------------------------------------
+    // Scales and positions each image within a vector into a spaced-out grid of rounded images
+    // Cells with a date are drawn as rounded screenshots labelled in the bottom left corner, cells
+    // without one are drawn as centered icons
     // If the size of the grid exceeds the number of textures in the vector, the remaining cells are left empty
-    // The gaps between the cells are indicated by the gridline thickness
+    //
+    // When grouped, every cell writes its image, highlight and label to separate ImDrawListSplitter
+    // channels. After merging, all images go out first, followed by all highlights and all labels
+    // sharing the font atlas, instead of alternating textures once per cell. Draw order within each
+    // layer is unchanged. The number of ImDrawCmds added is written to Stats().gridDrawCommands.
     //
     // vector images:       textures used to populate the grid
     // ImVec2 origin:       coordinates of upper left corner of the canvas
@@ -656,59 +1317,102 @@ namespace Draw {
     // int rows:            number of rows
     // float cellWidth:     width of each cell in pixels
     // float cellHeight:    height of each cell in pixels
-    // float gridlineWidth: thickness of the gridlines in pixels
-    void PopulateSparseRoundedGridWithDates(std::vector<TextureData> images, ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float spacing, float rounding, std::vector<std::string> dates, ImFont* font, bool& exitSelected)
+    // float spacing:       distance between cells in pixels
+    // float rounding:      rounding radius of each image's corners
+    // vector dates:        date label per cell, empty for icon cells
+    // ImFont font:         font style of the date labels
+    // bool exitSelected:   draws icons untinted when true
+    // bool groupByTexture: submits the grid in texture-grouped channels, off by default
+    void PopulateSparseRoundedGridWithDates(std::vector<TextureData> images, ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float spacing, float rounding, std::vector<std::string> dates, ImFont* font, bool& exitSelected, bool groupByTexture)
     {
+        TraceScope trace(TraceCall::PopulateSparseRoundedGridWithDates, images, origin, columns, rows, cellWidth, cellHeight, spacing, rounding, dates, font, exitSelected, groupByTexture);
+        ImDrawList* drawList = ImGui::GetWindowDrawList();
+        const int commandsBefore = drawList->CmdBuffer.Size;
+        const ImVec2 gridSize = ImVec2(columns * (cellWidth + spacing), rows * (cellHeight + spacing)) + ImVec2(spacing, spacing);
+        if (!ClipTest(drawList, TraceCall::PopulateSparseRoundedGridWithDates, origin, origin + gridSize))
+        {
+            Stats().gridDrawCommands = 0;
+            return;
+        }
+
+        // One splitter per active call, so a grid drawn while another is still split gets its own.
+        // The splitters are kept across calls so channel buffers keep their capacity between frames
+        static std::deque<ImDrawListSplitter> splitters;
+        static int activeSplitters = 0;
+        ImDrawListSplitter* splitter = nullptr;
+        if (groupByTexture)
+        {
+            if (activeSplitters == (int)splitters.size())
+                splitters.emplace_back();
+            splitter = &splitters[activeSplitters++];
+            splitter->Split(drawList, GridChannel_Count);
+        }
+
         origin = origin + ImVec2(spacing, spacing);
 
         float horizontalCellDisplacement = cellWidth + spacing;
         float verticalCellDisplacement = cellHeight + spacing;
 
         ImVec2 cellFrameSize = ImVec2(cellWidth, cellHeight);
-        int imageCount = images.size();
-        int cellIndex = 0;
+        int cellCount = ImMin(rows * columns, (int)images.size());
 
-        for (int currentRow = 0; currentRow < rows; currentRow++)
+        for (int currentIndex = 0; currentIndex < cellCount; currentIndex++)
         {
-            for (int currentColumn = 0; currentColumn < columns; currentColumn++)
-            {
-                if (cellIndex >= imageCount)
-                    return;
+            int currentRow = currentIndex / columns;
+            int currentColumn = currentIndex % columns;
 
-                int currentIndex = currentRow * columns + currentColumn;
+            ImVec2 anchor = origin + ImVec2(currentColumn * horizontalCellDisplacement, currentRow * verticalCellDisplacement);
 
-                // Draw the font
-                ImVec2 anchor = origin + ImVec2(currentColumn * horizontalCellDisplacement, currentRow * verticalCellDisplacement);
+            // Cells are parts of this call, so they are tested without being counted. The label's
+            // highlight reaches DEFAULT_HIGHLIGHT_WIDTH past the cell when the cell is small.
+            const ImVec2 highlightReach = ImVec2(DEFAULT_HIGHLIGHT_WIDTH, DEFAULT_HIGHLIGHT_WIDTH);
+            if (!ClipVisible(drawList, anchor - highlightReach, anchor + cellFrameSize + highlightReach))
+                continue;
 
-                // If the date indicates that the cell represents a screenshot
-                if (dates[currentIndex] != "")
-                {
-                    Draw::RoundedImage(images[currentIndex], anchor, cellFrameSize, 0.0f, rounding);
+            if (groupByTexture)
+                splitter->SetCurrentChannel(drawList, GridChannel_Images);
 
-                    ImGui::PushFont(font);
-                    ImVec2 fontSize = ImGui::CalcTextSize(dates[currentIndex].c_str());
-                    ImVec2 fontPosition = Position::InnerAlignBottomLeft(anchor, cellFrameSize, fontSize, DEFAULT_GRAPHICS_GAP);
+            // If the date indicates that the cell represents a screenshot
+            if (dates[currentIndex] != "")
+            {
+                EmitRoundedImage(drawList, images[currentIndex], anchor, cellFrameSize, 0.0f, rounding);
 
-                    TextWithRoundedHighlight(dates[currentIndex], font, DEFAULT_HIGHLIGHT_WIDTH, DEFAULT_FONT_COLOR, IM_COL32_WHITE, 1.0f, 1.0f, fontPosition, 0.0f, DEFAULT_WINDOW_ROUNDING);
-                    ImGui::PopFont();
-                }
-                // If the cell represents an icon
-                else
-                {
-                    ImVec2 iconSize = ImVec2(images[currentIndex].width, images[currentIndex].height);
-                    ImVec2 iconPosition = Position::Center2D(
-                        anchor,
-                        cellFrameSize,
-                        iconSize);
-
-                    if (exitSelected)
-                        Draw::Sprite(images[currentIndex], iconPosition);
-                    else
-                        Draw::TintedSprite(images[currentIndex], iconPosition, Color::RGBtoImU32(DEFAULT_UNSELECTED_ACTIVE_COLOR, 1.0f));
-                }
+                ImGui::PushFont(font);
+                const std::string& date = dates[currentIndex];
+                LayoutText(scratchLayout, drawList, font, 0.0f, date.data(), date.data() + date.size());
+                ImVec2 fontPosition = Position::InnerAlignBottomLeft(anchor, cellFrameSize, scratchLayout.size, DEFAULT_GRAPHICS_GAP);
 
-                cellIndex++;
+                if (groupByTexture)
+                    splitter->SetCurrentChannel(drawList, GridChannel_Highlights);
+                drawList->AddRectFilled(fontPosition - highlightReach, fontPosition + scratchLayout.size + highlightReach, IM_COL32_WHITE, DEFAULT_WINDOW_ROUNDING, ImDrawFlags_RoundCornersAll);
+
+                if (groupByTexture)
+                    splitter->SetCurrentChannel(drawList, GridChannel_Text);
+                EmitGlyphs(drawList, scratchLayout, fontPosition, DEFAULT_FONT_COLOR);
+                ImGui::PopFont();
+            }
+            // If the cell represents an icon
+            else
+            {
+                ImVec2 iconSize = ImVec2(images[currentIndex].width, images[currentIndex].height);
+                ImVec2 iconPosition = Position::Center2D(
+                    anchor,
+                    cellFrameSize,
+                    iconSize);
+
+                if (exitSelected)
+                    EmitSprite(drawList, images[currentIndex], iconPosition, IM_COL32_WHITE);
+                else
+                    EmitSprite(drawList, images[currentIndex], iconPosition, Color::RGBtoImU32(DEFAULT_UNSELECTED_ACTIVE_COLOR, 1.0f));
             }
         }
+
+        if (groupByTexture)
+        {
+            splitter->Merge(drawList);
+            activeSplitters--;
+        }
+
+        Stats().gridDrawCommands = drawList->CmdBuffer.Size - commandsBefore;
     }
 } // Draw
\ No newline at end of file
@@ -7,21 +7,27 @@
 #ifndef DRAWTOOLS_H
 #define DRAWTOOLS_H
 #include <string>
+#include <string_view>
 #include <vector>
 
 #include "imgui.h"
 #include "TextureTools.h"
 
+namespace Texture { class StreamingManager; class TiledImage; }
+
 namespace Draw {
 
     // Draws text to the screen
-    void Text(std::string& text, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize = 0.0f);
+    void Text(std::string_view text, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize = 0.0f);
 
     // Draws a stroke for a supplied sample of text
-    void TextStroke(std::string& text, ImU32 strokeColor, float transparency, float strokeWidth, ImVec2 position, ImFont* font, float fontSize = 0.0f);
+    void TextStroke(std::string_view text, ImU32 strokeColor, float transparency, float strokeWidth, ImVec2 position, ImFont* font, float fontSize = 0.0f);
 
     // Draws text with a stroke around it
-    void TextWithStroke(std::string& text, ImU32 strokeColor, ImU32 textColor, float transparency, float strokeWidth, ImVec2 position, ImFont* font, float fontSize = 0.0f);
+    void TextWithStroke(std::string_view text, ImU32 strokeColor, ImU32 textColor, float transparency, float strokeWidth, ImVec2 position, ImFont* font, float fontSize = 0.0f);
+
+    // Size of text as the text functions lay it out, including characters from an attached glyph cache
+    ImVec2 TextSize(std::string_view text, ImFont* font = nullptr, float fontSize = 0.0f);
 
     // Draws a filled rectangle
     void FilledRectangle(ImU32 color, float transparency, ImVec2 position, ImVec2 rectangleSize);
@@ -33,19 +39,39 @@ namespace Draw {
     void FilledRectangleWithStroke(ImU32 color, ImU32 strokeColor, float transparency, ImVec2 position, ImVec2 rectangleSize, float strokeWidth);
 
     // Draws a filled rectangle based on the size of a text draw
-    void Highlight(std::string& text, ImFont* font, float width, ImU32 color, float transparency, ImVec2 position, float fontSize = 0.0f);
+    void Highlight(std::string_view text, ImFont* font, float width, ImU32 color, float transparency, ImVec2 position, float fontSize = 0.0f);
 
     // Draws a rounded filled rectangle behind text
-    void HighlightRounded(std::string& text, ImFont* font, float width, ImU32 color, float transparency, ImVec2 position, float fontSize = 0.0f, float rounding = 0.0f);
+    void HighlightRounded(std::string_view text, ImFont* font, float width, ImU32 color, float transparency, ImVec2 position, float fontSize = 0.0f, float rounding = 0.0f);
 
     // Draws text with highlight behind it
-    void TextWithHighlight(std::string& text, ImFont* font, float highlightWidth, ImU32 textColor, ImU32 highlightColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize = 0.0f);
+    void TextWithHighlight(std::string_view text, ImFont* font, float highlightWidth, ImU32 textColor, ImU32 highlightColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize = 0.0f);
 
     // Draws text with a rounded highlight behind it
-    void TextWithRoundedHighlight(std::string& text, ImFont* font, float highlightWidth, ImU32 textColor, ImU32 highlightColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize, float rounding);
+    void TextWithRoundedHighlight(std::string_view text, ImFont* font, float highlightWidth, ImU32 textColor, ImU32 highlightColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize, float rounding);
 
     // Draws stroked text with highlight behind it
-    void StrokedTextWithHighlight(std::string& text, ImFont* font, float highlightWidth, float strokeWidth, ImU32 textColor, ImU32 highlightColor, ImU32 strokeColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize = 0.0f);
+    void StrokedTextWithHighlight(std::string_view text, ImFont* font, float highlightWidth, float strokeWidth, ImU32 textColor, ImU32 highlightColor, ImU32 strokeColor, float textTransparency, float highlightTransparency, ImVec2 position, float fontSize = 0.0f);
+
+    // Structure:   TextColorSpan
+    // --------------------------
+    // Color of a byte range of a string drawn by TextWithColorSpans
+    //
+    // int begin:       offset of the first byte in the span
+    // int end:         offset one past the last byte in the span
+    // ImU32 color:     color of the glyphs in the span
+    struct TextColorSpan
+    {
+        int begin = 0;
+        int end = 0;
+        ImU32 color = 0;
+    };
+
+    // Draws text shaded left to right along Color's default gradient, between two percentages of it
+    void GradientText(std::string_view text, float transparency, ImVec2 position, ImFont* font, float fontSize = 0.0f, float startPercentage = 0.0f, float endPercentage = 1.0f);
+
+    // Draws text whose byte ranges take the colors of a span table, in one pass over the glyphs
+    void TextWithColorSpans(std::string_view text, const std::vector<TextColorSpan>& spans, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize = 0.0f);
 
     // Draws a box around a given dimensional vector
     void BoxAround(ImVec2 size, ImVec2 position, float width, ImU32 color, float transparency, float rounding, ImDrawFlags rectangleFlags = 0);
@@ -74,6 +100,12 @@ namespace Draw {
     // Draws an image with rounded edges
     void RoundedImage(TextureData sprite, ImVec2 position, ImVec2 frameSize, float scale, float rounding);
 
+    // Draws a large tiled image within a fixed frame at a certain zoom/scale level, loading only the tiles on screen
+    void Image(Texture::TiledImage& image, ImVec2 position, ImVec2 frameSize, float scale);
+
+    // Draws a subsection of a large tiled image, loading only the tiles on screen
+    void Crop(Texture::TiledImage& image, ImVec2 position, ImVec2 cropPosition, ImVec2 cropSize, ImVec2 frameSize);
+
     // Draws an empty grid
     void Grid(ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float gridlineWidth, ImU32 gridlineColor);
 
@@ -83,8 +115,14 @@ namespace Draw {
     // Creates a spaced-out grid of rounded images
     void PopulateSparseRoundedGrid(std::vector<TextureData> images, ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float spacing, float rounding);
 
-    // Creates spaced-out grid with dates in the bottom left corner
-    void PopulateSparseRoundedGridWithDates(std::vector<TextureData> images, ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float spacing, float rounding, std::vector<std::string> dates, ImFont* font, bool& exitSelected);
+    // Finds the cells of a spaced-out grid that intersect the current clip rectangle, first inclusive and last exclusive
+    void VisibleGridCells(ImVec2 origin, int columns, int rows, float cellHeight, float spacing, int& first, int& last);
+
+    // Creates a spaced-out grid of rounded images streamed on demand, drawing only the cells on screen
+    void PopulateSparseRoundedGrid(Texture::StreamingManager& streamer, ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float spacing, float rounding);
+
+    // Creates spaced-out grid with dates in the bottom left corner, optionally grouping draw commands by texture kind
+    void PopulateSparseRoundedGridWithDates(std::vector<TextureData> images, ImVec2 origin, int columns, int rows, float cellWidth, float cellHeight, float spacing, float rounding, std::vector<std::string> dates, ImFont* font, bool& exitSelected, bool groupByTexture = false);
 
 } // Draw
 
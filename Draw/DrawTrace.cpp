@@ -0,0 +1,623 @@
+/*
+ * DrawTrace.cpp
+ * Source file implementation of the library call recorder and its replay. A trace file starts
+ * with a header listing the font sizes of the recording application. Each call follows as a
+ * record: a call id, the payload size, then the arguments in declaration order. Fonts are
+ * stored as their index in the font atlas and textures by id and size, so a trace replays
+ * without the original assets. A record with no payload marks the start of each ImGui frame.
+ */
+#include "DrawTrace.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <tuple>
+#include <type_traits>
+
+#include "DrawNumbers.h"
+#include "DrawRichText.h"
+#include "DrawTools.h"
+#include "PositionTools.h"
+#include "imgui_internal.h"
+
+namespace Draw {
+    static constexpr char TraceMagic[8] = { 'I', 'M', 'T', 'R', 'A', 'C', 'E', '1' };
+    static constexpr uint32_t TraceVersion = 1;
+    static constexpr size_t TraceFlushBytes = 1024 * 1024;
+
+    static FILE* traceFile = nullptr;
+    static std::vector<unsigned char> traceBuffer;
+    static size_t recordStart = 0;
+    static int recordedFrame = -1;
+
+    static const char* traceCallNames[] = {
+        "FrameBoundary", "Text", "TextStroke", "TextWithStroke", "FilledRectangle", "FilledRoundedRectangle",
+        "FilledRectangleWithStroke", "Highlight", "HighlightRounded", "TextWithHighlight", "TextWithRoundedHighlight",
+        "StrokedTextWithHighlight", "BoxAround", "RoundedRectangleBehind", "BoxAroundWithStroke", "Sprite",
+        "TintedSprite", "SpriteSubsection", "Image", "Crop", "RoundedImage", "Grid", "PopulateGrid",
+        "PopulateSparseRoundedGrid", "PopulateSparseRoundedGridWithDates", "Position::RightAlign",
+        "Position::CenterAlign", "Position::LeftAlign", "Position::Center2D", "Position::TopAlignOnRightSide",
+        "Position::BottomAlignOnRightSide", "Position::CenterOnLeftSide", "Position::CenterOnRightSide",
+        "Position::CenterAbove", "Position::InnerAlignCenterLeft", "Position::InnerAlignCenterRight",
+        "Position::InnerAlignBottomRight", "Position::InnerAlignBottomLeft", "Position::InnerAlignTopLeft",
+        "Position::InnerAlignBottomCenter", "Position::GridTranslocatedOrigin", "Position::FrameWithin", "GradientText",
+        "TextWithColorSpans", "RichText", "Number", "Formatted", "NumberWithStroke", "NumberWithHighlight",
+        "Heatmap", "Batch::Flush", "DeepZoom"
+    };
+    static_assert(sizeof(traceCallNames) / sizeof(traceCallNames[0]) == (size_t)TraceCall::Count, "every TraceCall needs a name");
+
+    // Helper Function:    PutBytes
+    // ----------------------------
+    // Appends raw bytes to a record
+    static void PutBytes(std::vector<unsigned char>& out, const void* bytes, size_t size)
+    {
+        const unsigned char* p = (const unsigned char*)bytes;
+        out.insert(out.end(), p, p + size);
+    }
+
+    // Helper Function:    FlushTrace
+    // ------------------------------
+    // Writes buffered records to the trace file
+    static void FlushTrace()
+    {
+        if (traceFile != nullptr && !traceBuffer.empty())
+            fwrite(traceBuffer.data(), 1, traceBuffer.size(), traceFile);
+        traceBuffer.clear();
+    }
+
+    // Function:    TraceCallName
+    // --------------------------
+    // Returns the function name of a recorded call, for reports
+    const char* TraceCallName(TraceCall call)
+    {
+        return call < TraceCall::Count ? traceCallNames[(size_t)call] : "Unknown";
+    }
+
+    // Function:    BeginTrace
+    // -----------------------
+    // Opens a trace file and starts recording top-level library calls
+    // The sizes of the fonts in the current atlas are stored so a replay can build a matching atlas.
+    //
+    // string path:     file to write
+    //
+    // Returns false if the file could not be created
+    bool BeginTrace(const std::string& path)
+    {
+        EndTrace();
+
+        traceFile = fopen(path.c_str(), "wb");
+        if (traceFile == nullptr)
+            return false;
+
+        std::vector<float> fontSizes;
+        if (ImGui::GetCurrentContext() != nullptr && ImGui::GetIO().Fonts != nullptr)
+            for (const ImFont* font : ImGui::GetIO().Fonts->Fonts)
+                fontSizes.push_back(font->FontSize);
+
+        uint32_t fontCount = (uint32_t)fontSizes.size();
+        PutBytes(traceBuffer, TraceMagic, sizeof(TraceMagic));
+        PutBytes(traceBuffer, &TraceVersion, sizeof(TraceVersion));
+        PutBytes(traceBuffer, &fontCount, sizeof(fontCount));
+        PutBytes(traceBuffer, fontSizes.data(), fontSizes.size() * sizeof(float));
+
+        recordedFrame = -1;
+        TraceDetail::depth = 0;
+        TraceDetail::recording = true;
+        return true;
+    }
+
+    // Function:    EndTrace
+    // ---------------------
+    // Stops recording and closes the trace file
+    void EndTrace()
+    {
+        TraceDetail::recording = false;
+        FlushTrace();
+        if (traceFile != nullptr)
+            fclose(traceFile);
+        traceFile = nullptr;
+    }
+
+    // Function:    TraceRecording
+    // ---------------------------
+    // Returns whether library calls are being recorded
+    bool TraceRecording()
+    {
+        return TraceDetail::recording;
+    }
+
+    // Spans of the calls made since BeginSpans, and whether the last one is still open
+    static std::vector<TraceSpan> spans;
+    static bool spanOpen = false;
+
+    // Function:    BeginSpans
+    // -----------------------
+    // Starts collecting the index range each top-level library call writes to its window's draw list
+    // Spans let diagnostics attribute a frame's geometry to the calls that produced it.
+    void BeginSpans()
+    {
+        spans.clear();
+        spanOpen = false;
+        TraceDetail::spanning = true;
+    }
+
+    // Function:    EndSpans
+    // ---------------------
+    // Stops collecting spans, keeping those collected so far
+    void EndSpans()
+    {
+        TraceDetail::spanning = false;
+        spanOpen = false;
+    }
+
+    // Function:    Spans
+    // ------------------
+    // Returns the spans collected since BeginSpans
+    const std::vector<TraceSpan>& Spans()
+    {
+        return spans;
+    }
+
+    namespace TraceDetail {
+        // Function:    BeginSpan
+        // ----------------------
+        // Opens a span at the current end of the window's draw list, when a window is being built
+        void BeginSpan(TraceCall call)
+        {
+            if (ImGui::GetCurrentWindowRead() == nullptr)
+                return;
+
+            const ImDrawList* drawList = ImGui::GetWindowDrawList();
+            spans.push_back({ drawList, (unsigned int)drawList->IdxBuffer.Size, (unsigned int)drawList->IdxBuffer.Size, call });
+            spanOpen = true;
+        }
+
+        // Function:    EndSpan
+        // --------------------
+        // Closes the open span, dropping it when the call wrote no indices
+        void EndSpan()
+        {
+            if (!spanOpen)
+                return;
+            spanOpen = false;
+
+            TraceSpan& span = spans.back();
+            span.idxEnd = (unsigned int)span.drawList->IdxBuffer.Size;
+            if (span.idxEnd == span.idxBegin)
+                spans.pop_back();
+        }
+
+        // Function:    BeginRecord
+        // ------------------------
+        // Starts a call record, preceded by a frame marker when ImGui has moved on to a new frame
+        //
+        // Returns the buffer the arguments are appended to
+        std::vector<unsigned char>& BeginRecord(TraceCall call)
+        {
+            int frame = ImGui::GetFrameCount();
+            if (frame != recordedFrame)
+            {
+                uint16_t marker = (uint16_t)TraceCall::FrameBoundary;
+                uint32_t empty = 0;
+                PutBytes(traceBuffer, &marker, sizeof(marker));
+                PutBytes(traceBuffer, &empty, sizeof(empty));
+                recordedFrame = frame;
+            }
+
+            uint16_t id = (uint16_t)call;
+            uint32_t size = 0;
+            PutBytes(traceBuffer, &id, sizeof(id));
+            recordStart = traceBuffer.size();
+            PutBytes(traceBuffer, &size, sizeof(size));
+            return traceBuffer;
+        }
+
+        // Function:    EndRecord
+        // ----------------------
+        // Completes the record's payload size and flushes the buffer once it is large
+        void EndRecord()
+        {
+            uint32_t size = (uint32_t)(traceBuffer.size() - recordStart - sizeof(uint32_t));
+            std::memcpy(traceBuffer.data() + recordStart, &size, sizeof(size));
+            if (traceBuffer.size() >= TraceFlushBytes)
+                FlushTrace();
+        }
+
+        void Put(std::vector<unsigned char>& out, float value) { PutBytes(out, &value, sizeof(value)); }
+        void Put(std::vector<unsigned char>& out, double value) { PutBytes(out, &value, sizeof(value)); }
+        void Put(std::vector<unsigned char>& out, int value) { PutBytes(out, &value, sizeof(value)); }
+        void Put(std::vector<unsigned char>& out, ImU32 value) { PutBytes(out, &value, sizeof(value)); }
+        void Put(std::vector<unsigned char>& out, bool value) { out.push_back(value ? 1 : 0); }
+        void Put(std::vector<unsigned char>& out, ImVec2 value) { Put(out, value.x); Put(out, value.y); }
+
+        // Fonts are stored as their index in the atlas, -1 for none or a font outside it
+        void Put(std::vector<unsigned char>& out, ImFont* font)
+        {
+            int index = -1;
+            if (font != nullptr && ImGui::GetIO().Fonts != nullptr)
+            {
+                const ImVector<ImFont*>& fonts = ImGui::GetIO().Fonts->Fonts;
+                for (int i = 0; i < fonts.Size; i++)
+                    if (fonts[i] == font)
+                        index = i;
+            }
+            Put(out, index);
+        }
+
+        void Put(std::vector<unsigned char>& out, std::string_view text)
+        {
+            uint32_t length = (uint32_t)text.size();
+            PutBytes(out, &length, sizeof(length));
+            PutBytes(out, text.data(), text.size());
+        }
+
+        // Null strings are recorded as empty ones
+        void Put(std::vector<unsigned char>& out, const char* text)
+        {
+            uint32_t length = text != nullptr ? (uint32_t)std::strlen(text) : 0;
+            PutBytes(out, &length, sizeof(length));
+            PutBytes(out, text, length);
+        }
+
+        void Put(std::vector<unsigned char>& out, const TextureData& texture)
+        {
+            uint32_t id = texture.id;
+            PutBytes(out, &id, sizeof(id));
+            Put(out, texture.width);
+            Put(out, texture.height);
+        }
+
+        void Put(std::vector<unsigned char>& out, const std::vector<TextureData>& textures)
+        {
+            uint32_t count = (uint32_t)textures.size();
+            PutBytes(out, &count, sizeof(count));
+            for (const TextureData& texture : textures)
+                Put(out, texture);
+        }
+
+        void Put(std::vector<unsigned char>& out, const std::vector<std::string>& texts)
+        {
+            uint32_t count = (uint32_t)texts.size();
+            PutBytes(out, &count, sizeof(count));
+            for (const std::string& text : texts)
+                Put(out, text);
+        }
+
+        void Put(std::vector<unsigned char>& out, const std::vector<TextColorSpan>& spans)
+        {
+            uint32_t count = (uint32_t)spans.size();
+            PutBytes(out, &count, sizeof(count));
+            for (const TextColorSpan& span : spans)
+            {
+                Put(out, span.begin);
+                Put(out, span.end);
+                Put(out, span.color);
+            }
+        }
+    }
+
+    // Structure:   TraceReader
+    // ------------------------
+    // Decodes the arguments of one record, yielding zeroes once the payload is exhausted
+    struct TraceReader
+    {
+        const unsigned char* position;
+        const unsigned char* end;
+        const std::vector<ImFont*>& fonts;
+
+        bool Bytes(void* out, size_t size)
+        {
+            if ((size_t)(end - position) < size)
+            {
+                std::memset(out, 0, size);
+                position = end;
+                return false;
+            }
+            std::memcpy(out, position, size);
+            position += size;
+            return true;
+        }
+
+        void Read(float& value) { Bytes(&value, sizeof(value)); }
+        void Read(double& value) { Bytes(&value, sizeof(value)); }
+        void Read(int& value) { Bytes(&value, sizeof(value)); }
+        void Read(ImU32& value) { Bytes(&value, sizeof(value)); }
+        void Read(ImVec2& value) { Read(value.x); Read(value.y); }
+
+        void Read(bool& value)
+        {
+            unsigned char byte = 0;
+            Bytes(&byte, 1);
+            value = byte != 0;
+        }
+
+        void Read(ImFont*& font)
+        {
+            int index = -1;
+            Read(index);
+            font = index >= 0 && index < (int)fonts.size() ? fonts[index] : nullptr;
+        }
+
+        void Read(std::string& text)
+        {
+            uint32_t length = 0;
+            Bytes(&length, sizeof(length));
+            length = (uint32_t)std::min<size_t>(length, end - position);
+            text.assign((const char*)position, length);
+            position += length;
+        }
+
+        // Views the text in place; the loaded trace outlives the replayed call
+        void Read(std::string_view& text)
+        {
+            uint32_t length = 0;
+            Bytes(&length, sizeof(length));
+            length = (uint32_t)std::min<size_t>(length, end - position);
+            text = std::string_view((const char*)position, length);
+            position += length;
+        }
+
+        void Read(TextureData& texture)
+        {
+            uint32_t id = 0;
+            Bytes(&id, sizeof(id));
+            texture.id = id;
+            Read(texture.width);
+            Read(texture.height);
+        }
+
+        void Read(TextColorSpan& span)
+        {
+            Read(span.begin);
+            Read(span.end);
+            Read(span.color);
+        }
+
+        template<typename T>
+        void Read(std::vector<T>& values)
+        {
+            uint32_t count = 0;
+            Bytes(&count, sizeof(count));
+            values.clear();
+            for (uint32_t i = 0; i < count && position < end; i++)
+            {
+                values.emplace_back();
+                Read(values.back());
+            }
+        }
+    };
+
+    // Helper Function:    Invoke
+    // --------------------------
+    // Decodes a record's arguments in the order of a function's parameters and calls it
+    // Only the call is timed, so decoding strings and vectors does not count against the function.
+    //
+    // Returns the seconds spent in the call
+    template<typename R, typename... P>
+    static double Invoke(TraceReader& reader, R (*function)(P...))
+    {
+        std::tuple<std::decay_t<P>...> args;
+        std::apply([&](auto&... arg) { (reader.Read(arg), ...); }, args);
+
+        // Arguments taken by value are moved in, so copying them is not timed either
+        auto call = [&](auto&... arg) { return function(std::forward<P>(arg)...); };
+
+        auto start = std::chrono::steady_clock::now();
+        if constexpr (std::is_void_v<R>)
+        {
+            std::apply(call, args);
+        }
+        else
+        {
+            // Keeps results of pure positioning calls from being optimized away
+            static volatile float sink;
+            R result = std::apply(call, args);
+            sink = result.x;
+        }
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    // Helper Function:    ReplayFormatted
+    // ----------------------------------
+    // Calls Formatted with affixes decoded into strings, which own the text the record's pointers referred to
+    static void ReplayFormatted(std::string prefix, double value, int precision, std::string suffix, ImU32 color, float transparency, ImVec2 position, ImFont* font, float fontSize)
+    {
+        Formatted(prefix.c_str(), value, precision, suffix.c_str(), color, transparency, position, font, fontSize);
+    }
+
+    // Helper Function:    ReplayCall
+    // ------------------------------
+    // Calls the library function a record was made from
+    //
+    // Returns the seconds spent in the call, excluding argument decoding
+    static double ReplayCall(TraceCall call, TraceReader& reader)
+    {
+        using namespace Position;
+
+        double seconds = 0.0;
+        switch (call)
+        {
+            case TraceCall::Text: seconds = Invoke(reader, &Draw::Text); break;
+            case TraceCall::TextStroke: seconds = Invoke(reader, &TextStroke); break;
+            case TraceCall::TextWithStroke: seconds = Invoke(reader, &TextWithStroke); break;
+            case TraceCall::FilledRectangle: seconds = Invoke(reader, &FilledRectangle); break;
+            case TraceCall::FilledRoundedRectangle: seconds = Invoke(reader, &FilledRoundedRectangle); break;
+            case TraceCall::FilledRectangleWithStroke: seconds = Invoke(reader, &FilledRectangleWithStroke); break;
+            case TraceCall::Highlight: seconds = Invoke(reader, &Highlight); break;
+            case TraceCall::HighlightRounded: seconds = Invoke(reader, &HighlightRounded); break;
+            case TraceCall::TextWithHighlight: seconds = Invoke(reader, &TextWithHighlight); break;
+            case TraceCall::TextWithRoundedHighlight: seconds = Invoke(reader, &TextWithRoundedHighlight); break;
+            case TraceCall::StrokedTextWithHighlight: seconds = Invoke(reader, &StrokedTextWithHighlight); break;
+            case TraceCall::BoxAround: seconds = Invoke(reader, &BoxAround); break;
+            case TraceCall::RoundedRectangleBehind: seconds = Invoke(reader, &RoundedRectangleBehind); break;
+            case TraceCall::BoxAroundWithStroke: seconds = Invoke(reader, &BoxAroundWithStroke); break;
+            case TraceCall::Sprite: seconds = Invoke(reader, &Sprite); break;
+            case TraceCall::TintedSprite: seconds = Invoke(reader, &TintedSprite); break;
+            case TraceCall::SpriteSubsection: seconds = Invoke(reader, &SpriteSubsection); break;
+            case TraceCall::Image: seconds = Invoke(reader, static_cast<void (*)(TextureData, ImVec2, ImVec2, float)>(&Draw::Image)); break;
+            case TraceCall::Crop: seconds = Invoke(reader, static_cast<void (*)(TextureData, ImVec2, ImVec2, ImVec2, ImVec2)>(&Crop)); break;
+            case TraceCall::RoundedImage: seconds = Invoke(reader, &RoundedImage); break;
+            case TraceCall::Grid: seconds = Invoke(reader, &Grid); break;
+            case TraceCall::PopulateGrid: seconds = Invoke(reader, &PopulateGrid); break;
+            case TraceCall::PopulateSparseRoundedGrid:
+                seconds = Invoke(reader, static_cast<void (*)(std::vector<TextureData>, ImVec2, int, int, float, float, float, float)>(&PopulateSparseRoundedGrid));
+                break;
+            case TraceCall::PopulateSparseRoundedGridWithDates: seconds = Invoke(reader, &PopulateSparseRoundedGridWithDates); break;
+            case TraceCall::RightAlign: seconds = Invoke(reader, &RightAlign); break;
+            case TraceCall::CenterAlign: seconds = Invoke(reader, &CenterAlign); break;
+            case TraceCall::LeftAlign: seconds = Invoke(reader, &LeftAlign); break;
+            case TraceCall::Center2D: seconds = Invoke(reader, &Center2D); break;
+            case TraceCall::TopAlignOnRightSide: seconds = Invoke(reader, &TopAlignOnRightSide); break;
+            case TraceCall::BottomAlignOnRightSide: seconds = Invoke(reader, &BottomAlignOnRightSide); break;
+            case TraceCall::CenterOnLeftSide: seconds = Invoke(reader, &CenterOnLeftSide); break;
+            case TraceCall::CenterOnRightSide: seconds = Invoke(reader, &CenterOnRightSide); break;
+            case TraceCall::CenterAbove: seconds = Invoke(reader, &CenterAbove); break;
+            case TraceCall::InnerAlignCenterLeft: seconds = Invoke(reader, &InnerAlignCenterLeft); break;
+            case TraceCall::InnerAlignCenterRight: seconds = Invoke(reader, &InnerAlignCenterRight); break;
+            case TraceCall::InnerAlignBottomRight: seconds = Invoke(reader, &InnerAlignBottomRight); break;
+            case TraceCall::InnerAlignBottomLeft: seconds = Invoke(reader, &InnerAlignBottomLeft); break;
+            case TraceCall::InnerAlignTopLeft: seconds = Invoke(reader, &InnerAlignTopLeft); break;
+            case TraceCall::InnerAlignBottomCenter: seconds = Invoke(reader, &InnerAlignBottomCenter); break;
+            case TraceCall::GridTranslocatedOrigin: seconds = Invoke(reader, &GridTranslocatedOrigin); break;
+            case TraceCall::FrameWithin: seconds = Invoke(reader, &FrameWithin); break;
+            case TraceCall::GradientText: seconds = Invoke(reader, &GradientText); break;
+            case TraceCall::TextWithColorSpans: seconds = Invoke(reader, &TextWithColorSpans); break;
+            case TraceCall::RichText: seconds = Invoke(reader, &RichText); break;
+            case TraceCall::Number: seconds = Invoke(reader, &Number); break;
+            case TraceCall::Formatted: seconds = Invoke(reader, &ReplayFormatted); break;
+            case TraceCall::NumberWithStroke: seconds = Invoke(reader, &NumberWithStroke); break;
+            case TraceCall::NumberWithHighlight: seconds = Invoke(reader, &NumberWithHighlight); break;
+            default: break;
+        }
+        return seconds;
+    }
+
+    // Function:    Trace::Load
+    // ------------------------
+    // Reads a trace file and records where each frame starts
+    //
+    // string path:     trace file written by BeginTrace
+    //
+    // Returns false if the file is missing, has a different version or a record runs past its end
+    bool Trace::Load(const std::string& path)
+    {
+        data.clear();
+        frameOffsets.clear();
+        fontSizes.clear();
+        ResetStats();
+
+        std::ifstream stream(path, std::ios::binary);
+        if (!stream)
+            return false;
+        data.assign(std::istreambuf_iterator<char>(stream), std::istreambuf_iterator<char>());
+
+        char magic[sizeof(TraceMagic)];
+        uint32_t version = 0;
+        uint32_t fontCount = 0;
+        size_t offset = sizeof(magic) + sizeof(version) + sizeof(fontCount);
+        if (data.size() < offset)
+            return false;
+        std::memcpy(magic, data.data(), sizeof(magic));
+        std::memcpy(&version, data.data() + sizeof(magic), sizeof(version));
+        std::memcpy(&fontCount, data.data() + sizeof(magic) + sizeof(version), sizeof(fontCount));
+        if (std::memcmp(magic, TraceMagic, sizeof(magic)) != 0 || version != TraceVersion || fontCount > (data.size() - offset) / sizeof(float))
+            return false;
+
+        fontSizes.resize(fontCount);
+        std::memcpy(fontSizes.data(), data.data() + offset, fontCount * sizeof(float));
+        offset += fontCount * sizeof(float);
+
+        while (offset < data.size())
+        {
+            uint16_t call = 0;
+            uint32_t size = 0;
+            if (data.size() - offset < sizeof(call) + sizeof(size))
+                return false;
+            std::memcpy(&call, data.data() + offset, sizeof(call));
+            std::memcpy(&size, data.data() + offset + sizeof(call), sizeof(size));
+            offset += sizeof(call) + sizeof(size);
+            if (size > data.size() - offset)
+                return false;
+            offset += size;
+
+            if ((TraceCall)call == TraceCall::FrameBoundary)
+                frameOffsets.push_back(offset);
+        }
+
+        return true;
+    }
+
+    // Function:    Trace::FrameCount
+    // ------------------------------
+    // Returns the number of frames in the loaded trace
+    int Trace::FrameCount() const
+    {
+        return (int)frameOffsets.size();
+    }
+
+    // Function:    Trace::FontSizes
+    // -----------------------------
+    // Returns the pixel size of each font in the recording application's atlas
+    const std::vector<float>& Trace::FontSizes() const
+    {
+        return fontSizes;
+    }
+
+    // Function:    Trace::ReplayFrame
+    // -------------------------------
+    // Calls every recorded function of a frame with its recorded arguments, timing each call
+    // apart from decoding its arguments
+    // Must be called inside an ImGui window, since drawing calls use the window's draw list.
+    //
+    // int frame:           frame to replay, from 0 to FrameCount() - 1
+    // vector fonts:        fonts standing in for the recorded atlas, by font index
+    void Trace::ReplayFrame(int frame, const std::vector<ImFont*>& fonts)
+    {
+        if (frame < 0 || frame >= FrameCount())
+            return;
+        if (stats.size() != (size_t)TraceCall::Count)
+            ResetStats();
+
+        size_t offset = frameOffsets[frame];
+        while (offset < data.size())
+        {
+            uint16_t call = 0;
+            uint32_t size = 0;
+            std::memcpy(&call, data.data() + offset, sizeof(call));
+            std::memcpy(&size, data.data() + offset + sizeof(call), sizeof(size));
+            offset += sizeof(call) + sizeof(size);
+            if ((TraceCall)call == TraceCall::FrameBoundary)
+                break;
+
+            TraceReader reader{ data.data() + offset, data.data() + offset + size, fonts };
+            offset += size;
+            if ((TraceCall)call >= TraceCall::Count)
+                continue;
+
+            const double seconds = ReplayCall((TraceCall)call, reader);
+            TraceCallStats& callStats = stats[call];
+            callStats.calls++;
+            callStats.seconds += seconds;
+        }
+    }
+
+    // Function:    Trace::Stats
+    // -------------------------
+    // Returns replay timings indexed by TraceCall
+    const std::vector<TraceCallStats>& Trace::Stats() const
+    {
+        return stats;
+    }
+
+    // Function:    Trace::ResetStats
+    // ------------------------------
+    // Zeroes the replay timings
+    void Trace::ResetStats()
+    {
+        stats.assign((size_t)TraceCall::Count, TraceCallStats());
+    }
+
+} // Draw
@@ -0,0 +1,230 @@
+/*
+ * DrawTrace.h
+ * Header of a recorder for the library's own API calls. While a trace is recording, every
+ * top-level Draw:: and Position:: call is written to a file with its arguments, grouped by
+ * ImGui frame. Calls made from inside another library call are not recorded, since replaying
+ * the outer call reproduces them. A trace replayed into a headless ImGui context times the
+ * library code on a real workload, so internal changes can be measured on production frames.
+ */
+#ifndef DRAWTRACE_H
+#define DRAWTRACE_H
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "imgui.h"
+
+struct TextureData;
+
+namespace Draw {
+
+    struct TextColorSpan;
+
+    // Recorded library calls, stored by value in trace files so new entries go before Count
+    enum class TraceCall : uint16_t
+    {
+        FrameBoundary,
+        Text,
+        TextStroke,
+        TextWithStroke,
+        FilledRectangle,
+        FilledRoundedRectangle,
+        FilledRectangleWithStroke,
+        Highlight,
+        HighlightRounded,
+        TextWithHighlight,
+        TextWithRoundedHighlight,
+        StrokedTextWithHighlight,
+        BoxAround,
+        RoundedRectangleBehind,
+        BoxAroundWithStroke,
+        Sprite,
+        TintedSprite,
+        SpriteSubsection,
+        Image,
+        Crop,
+        RoundedImage,
+        Grid,
+        PopulateGrid,
+        PopulateSparseRoundedGrid,
+        PopulateSparseRoundedGridWithDates,
+        RightAlign,
+        CenterAlign,
+        LeftAlign,
+        Center2D,
+        TopAlignOnRightSide,
+        BottomAlignOnRightSide,
+        CenterOnLeftSide,
+        CenterOnRightSide,
+        CenterAbove,
+        InnerAlignCenterLeft,
+        InnerAlignCenterRight,
+        InnerAlignBottomRight,
+        InnerAlignBottomLeft,
+        InnerAlignTopLeft,
+        InnerAlignBottomCenter,
+        GridTranslocatedOrigin,
+        FrameWithin,
+        GradientText,
+        TextWithColorSpans,
+        RichText,
+        Number,
+        Formatted,
+        NumberWithStroke,
+        NumberWithHighlight,
+
+        // Counted for clip culling only, these take pointers or objects and are never recorded
+        Heatmap,
+        BatchFlush,
+        DeepZoom,
+        Count
+    };
+
+    // Structure:   TraceCallStats
+    // ---------------------------
+    // Time spent in one kind of call while replaying a trace
+    //
+    // int calls:           calls replayed
+    // double seconds:      time spent inside them
+    struct TraceCallStats
+    {
+        int calls = 0;
+        double seconds = 0.0;
+    };
+
+    // Returns the function name of a recorded call
+    const char* TraceCallName(TraceCall call);
+
+    // Starts recording top-level library calls to a file, replacing any trace in progress
+    bool BeginTrace(const std::string& path);
+
+    // Flushes and closes the trace being recorded
+    void EndTrace();
+
+    // Whether a trace is being recorded
+    bool TraceRecording();
+
+    // Structure:   TraceSpan
+    // ----------------------
+    // Range of a draw list's indices written by one top-level library call
+    //
+    // ImDrawList* drawList:    draw list the call wrote to
+    // unsigned int idxBegin:   size of the index buffer when the call started
+    // unsigned int idxEnd:     size of the index buffer when the call returned
+    // TraceCall call:          the call
+    struct TraceSpan
+    {
+        const ImDrawList* drawList;
+        unsigned int idxBegin;
+        unsigned int idxEnd;
+        TraceCall call;
+    };
+
+    // Starts collecting the index range each top-level call writes, discarding earlier spans
+    void BeginSpans();
+
+    // Stops collecting spans
+    void EndSpans();
+
+    // Spans collected since BeginSpans, in call order
+    const std::vector<TraceSpan>& Spans();
+
+    // Encoding of recorded arguments, used by TraceScope
+    namespace TraceDetail {
+        inline bool recording = false;
+        inline bool spanning = false;
+        inline int depth = 0;
+
+        std::vector<unsigned char>& BeginRecord(TraceCall call);
+        void EndRecord();
+        void BeginSpan(TraceCall call);
+        void EndSpan();
+
+        void Put(std::vector<unsigned char>& out, float value);
+        void Put(std::vector<unsigned char>& out, double value);
+        void Put(std::vector<unsigned char>& out, int value);
+        void Put(std::vector<unsigned char>& out, ImU32 value);
+        void Put(std::vector<unsigned char>& out, bool value);
+        void Put(std::vector<unsigned char>& out, ImVec2 value);
+        void Put(std::vector<unsigned char>& out, ImFont* font);
+        void Put(std::vector<unsigned char>& out, std::string_view text);
+        void Put(std::vector<unsigned char>& out, const char* text);
+        void Put(std::vector<unsigned char>& out, const TextureData& texture);
+        void Put(std::vector<unsigned char>& out, const std::vector<TextureData>& textures);
+        void Put(std::vector<unsigned char>& out, const std::vector<std::string>& texts);
+        void Put(std::vector<unsigned char>& out, const std::vector<TextColorSpan>& spans);
+    }
+
+    // Class:   TraceScope
+    // -------------------
+    // Placed at the top of a library function, records the call and its arguments when it is the outermost library call,
+    // and the index range it writes while spans are being collected
+    // Costs a single test of two flags while neither is active.
+    class TraceScope {
+    public:
+        template<typename... Args>
+        TraceScope(TraceCall call, const Args&... args)
+        {
+            if (!(TraceDetail::recording | TraceDetail::spanning))
+                return;
+            entered = true;
+            if (TraceDetail::depth++ > 0)
+                return;
+
+            if (TraceDetail::spanning)
+                TraceDetail::BeginSpan(call);
+            if (!TraceDetail::recording)
+                return;
+
+            std::vector<unsigned char>& out = TraceDetail::BeginRecord(call);
+            (TraceDetail::Put(out, args), ...);
+            TraceDetail::EndRecord();
+        }
+
+        ~TraceScope()
+        {
+            if (entered && --TraceDetail::depth == 0 && TraceDetail::spanning)
+                TraceDetail::EndSpan();
+        }
+
+        TraceScope(const TraceScope&) = delete;
+        TraceScope& operator=(const TraceScope&) = delete;
+
+    private:
+        bool entered = false;
+    };
+
+    // Class:   Trace
+    // --------------
+    // A recorded trace loaded for replay, frame by frame, into the current ImGui window
+    class Trace {
+    public:
+        // Reads a trace file and indexes its frames
+        bool Load(const std::string& path);
+
+        // Number of recorded frames
+        int FrameCount() const;
+
+        // Sizes of the fonts in the recording application's atlas, by font index
+        const std::vector<float>& FontSizes() const;
+
+        // Replays one frame's calls, mapping recorded font indices to fonts of the current context
+        void ReplayFrame(int frame, const std::vector<ImFont*>& fonts);
+
+        // Time spent per kind of call since the last ResetStats, indexed by TraceCall
+        const std::vector<TraceCallStats>& Stats() const;
+
+        // Zeroes the replay timings
+        void ResetStats();
+
+    private:
+        std::vector<unsigned char> data;
+        std::vector<size_t> frameOffsets;
+        std::vector<float> fontSizes;
+        std::vector<TraceCallStats> stats;
+    };
+
+} // Draw
+
+#endif //DRAWTRACE_H
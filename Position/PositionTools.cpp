@@ -13,6 +13,8 @@
 #include "PositionTools.h"
 #include "ImVec2Operators.h"
 
+#include "DrawTrace.h"
+
 namespace Position {
 
     // Function:    RightAlign
@@ -35,6 +37,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the aligned object
     ImVec2 RightAlign(ImVec2 origin, float documentWidth, float lineHeight, int line, ImVec2 objectDimensions)
     {
+        Draw::TraceScope trace(Draw::TraceCall::RightAlign, origin, documentWidth, lineHeight, line, objectDimensions);
         return origin + ImVec2(documentWidth, line * lineHeight) - objectDimensions;
     }
 
@@ -58,6 +61,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the aligned object
     ImVec2 LeftAlign(ImVec2 origin, float lineHeight, int line, ImVec2 objectDimensions)
     {
+        Draw::TraceScope trace(Draw::TraceCall::LeftAlign, origin, lineHeight, line, objectDimensions);
         return origin - ImVec2(0, lineHeight * line) - ImVec2( 0, objectDimensions.y);
     }
 
@@ -80,6 +84,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the aligned object
     ImVec2 CenterAlign(ImVec2 origin, float documentWidth, float lineHeight, int line, ImVec2 objectDimensions)
     {
+        Draw::TraceScope trace(Draw::TraceCall::CenterAlign, origin, documentWidth, lineHeight, line, objectDimensions);
         float x = origin.x + ((documentWidth - objectDimensions.x) / 2) ;
         float y = origin.y + line * lineHeight;
         return ImVec2(x, y);
@@ -103,6 +108,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the centered object
     ImVec2 Center2D(ImVec2 origin, ImVec2 targetObjectDimensions, ImVec2 centeredObjectDimensions)
     {
+        Draw::TraceScope trace(Draw::TraceCall::Center2D, origin, targetObjectDimensions, centeredObjectDimensions);
         return origin + ImVec2((targetObjectDimensions.x - centeredObjectDimensions.x) / 2,
                                (targetObjectDimensions.y - centeredObjectDimensions.y) / 2);
     }
@@ -125,6 +131,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the centered object
     ImVec2 CenterOnLeftSide(ImVec2 targetObjectOrigin, ImVec2 targetObjectDimensions, ImVec2 centeredObjectDimensions, float distanceApart)
     {
+        Draw::TraceScope trace(Draw::TraceCall::CenterOnLeftSide, targetObjectOrigin, targetObjectDimensions, centeredObjectDimensions, distanceApart);
         float x = targetObjectOrigin.x - distanceApart - centeredObjectDimensions.x;
         float y = targetObjectOrigin.y + (targetObjectDimensions.y - centeredObjectDimensions.y) / 2.0f;
         return ImVec2(x, y);
@@ -151,6 +158,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the centered object
     ImVec2 CenterAbove(ImVec2 targetObjectOrigin, ImVec2 targetObjectDimensions, ImVec2 centeredObjectDimensions, float distanceApart)
     {
+        Draw::TraceScope trace(Draw::TraceCall::CenterAbove, targetObjectOrigin, targetObjectDimensions, centeredObjectDimensions, distanceApart);
         ImVec2 absoluteCenter = Center2D(targetObjectOrigin, targetObjectDimensions, centeredObjectDimensions);
         return absoluteCenter - ImVec2(0, distanceApart + targetObjectDimensions.y / 2.0f);
     }
@@ -173,6 +181,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the centered object
     ImVec2 CenterOnRightSide(ImVec2 targetObjectOrigin, ImVec2 targetObjectDimensions, ImVec2 centeredObjectDimensions, float distanceApart)
     {
+        Draw::TraceScope trace(Draw::TraceCall::CenterOnRightSide, targetObjectOrigin, targetObjectDimensions, centeredObjectDimensions, distanceApart);
         float x = targetObjectOrigin.x + targetObjectDimensions.x + distanceApart ;
         float y = targetObjectOrigin.y + (targetObjectDimensions.y - centeredObjectDimensions.y) / 2.0f;
         return ImVec2(x, y);
@@ -196,6 +205,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the centered object
     ImVec2 BottomAlignOnRightSide(ImVec2 targetObjectOrigin, ImVec2 targetObjectDimensions, ImVec2 alignedObjectDimensions, float distanceApart)
     {
+        Draw::TraceScope trace(Draw::TraceCall::BottomAlignOnRightSide, targetObjectOrigin, targetObjectDimensions, alignedObjectDimensions, distanceApart);
         float x = targetObjectOrigin.x + targetObjectDimensions.x + distanceApart;
         float y = targetObjectOrigin.y + (targetObjectDimensions.y - alignedObjectDimensions.y);
         return ImVec2(x, y);
@@ -217,6 +227,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the centered object
     ImVec2 TopAlignOnRightSide(ImVec2 targetObjectOrigin, ImVec2 targetObjectDimensions, float distanceApart)
     {
+        Draw::TraceScope trace(Draw::TraceCall::TopAlignOnRightSide, targetObjectOrigin, targetObjectDimensions, distanceApart);
         float x = targetObjectOrigin.x + targetObjectDimensions.x + distanceApart;
         float y = targetObjectOrigin.y;
         return ImVec2(x, y);
@@ -240,6 +251,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the centered object
     ImVec2 InnerAlignCenterLeft(ImVec2 targetObjectOrigin, ImVec2 targetObjectDimensions, ImVec2 centeredObjectDimensions)
     {
+        Draw::TraceScope trace(Draw::TraceCall::InnerAlignCenterLeft, targetObjectOrigin, targetObjectDimensions, centeredObjectDimensions);
 
         float centeringDisplacement = (targetObjectDimensions.y - centeredObjectDimensions.y) / 2;
         float y = targetObjectOrigin.y + centeringDisplacement;
@@ -266,6 +278,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the centered object
     ImVec2 InnerAlignCenterRight(ImVec2 targetObjectOrigin, ImVec2 targetObjectDimensions, ImVec2 centeredObjectDimensions)
     {
+        Draw::TraceScope trace(Draw::TraceCall::InnerAlignCenterRight, targetObjectOrigin, targetObjectDimensions, centeredObjectDimensions);
         float centeringDisplacement = (targetObjectDimensions.y - centeredObjectDimensions.y) / 2;
         float y = targetObjectOrigin.y + centeringDisplacement;
         float x = targetObjectOrigin.x + targetObjectDimensions.x - centeredObjectDimensions.x - centeringDisplacement;
@@ -292,6 +305,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the aligned object
     ImVec2 InnerAlignBottomRight(ImVec2 targetObjectOrigin, ImVec2 targetObjectDimensions, ImVec2 alignedObjectDimensions, float gap)
     {
+        Draw::TraceScope trace(Draw::TraceCall::InnerAlignBottomRight, targetObjectOrigin, targetObjectDimensions, alignedObjectDimensions, gap);
         float x = targetObjectOrigin.x + targetObjectDimensions.x - alignedObjectDimensions.x - gap;
         float y = targetObjectOrigin.y + targetObjectDimensions.y - gap - alignedObjectDimensions.y;
 
@@ -315,6 +329,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the aligned object
     ImVec2 InnerAlignTopLeft(ImVec2 targetObjectOrigin, float gap)
     {
+        Draw::TraceScope trace(Draw::TraceCall::InnerAlignTopLeft, targetObjectOrigin, gap);
         float x = targetObjectOrigin.x + gap;
         float y = targetObjectOrigin.y + gap;
 
@@ -333,6 +348,7 @@ namespace Position {
     // Returns the coordinates of the upper left corner of the aligned object
     ImVec2 InnerAlignBottomLeft(ImVec2 targetObjectOrigin, ImVec2 targetObjectDimensions, ImVec2 alignedObjectDimensions, float gap)
     {
+        Draw::TraceScope trace(Draw::TraceCall::InnerAlignBottomLeft, targetObjectOrigin, targetObjectDimensions, alignedObjectDimensions, gap);
         float x = targetObjectOrigin.x + gap;
         float y = targetObjectOrigin.y + targetObjectDimensions.y - gap - alignedObjectDimensions.y;
 
@@ -358,6 +374,7 @@ namespace Position {
     ImVec2 InnerAlignBottomCenter(ImVec2 targetObjectOrigin, ImVec2 targetObjectDimensions,
                                   ImVec2 alignedObjectDimensions, float gap)
     {
+        Draw::TraceScope trace(Draw::TraceCall::InnerAlignBottomCenter, targetObjectOrigin, targetObjectDimensions, alignedObjectDimensions, gap);
         float x = targetObjectOrigin.x + (targetObjectDimensions.x - alignedObjectDimensions.x) / 2;
         float y = targetObjectOrigin.y + targetObjectDimensions.y - alignedObjectDimensions.y - gap;
 
@@ -386,6 +403,7 @@ namespace Position {
     // Returns the coordinates to the upper left corner of the chosen cell, just inside the gridline borders
     ImVec2 GridTranslocatedOrigin(ImVec2 origin, float cellWidth, float cellHeight, float gridlineWidth, int columns, int rows, int cellNumber)
     {
+        Draw::TraceScope trace(Draw::TraceCall::GridTranslocatedOrigin, origin, cellWidth, cellHeight, gridlineWidth, columns, rows, cellNumber);
         origin = origin + ImVec2(gridlineWidth, gridlineWidth);
 
         float horizontalDisplacement = cellWidth + gridlineWidth;
@@ -405,6 +423,7 @@ namespace Position {
     // Finds the best fit
     ImVec2 FrameWithin(ImVec2 outerFrame, ImVec2 innerFrame, float padding)
     {
+        Draw::TraceScope trace(Draw::TraceCall::FrameWithin, outerFrame, innerFrame, padding);
         float innerAspectRatio = innerFrame.x / innerFrame.y;
         float outerAspectRatio = outerFrame.x / outerFrame.y;
 
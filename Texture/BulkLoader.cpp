@@ -0,0 +1,405 @@
+/*
+ * BulkLoader.cpp
+ *
+ * Source file implementation of a pipelined loader for galleries of thousands of images.
+ * Each stage keeps an ordered queue of (priority, index) keys under a single mutex; the
+ * file reads and decodes run unlocked. Reader threads stop once a bounded number of files
+ * are waiting to be decoded, so memory stays proportional to the number of decode workers
+ * rather than to the size of the gallery.
+ */
+#include "BulkLoader.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <filesystem>
+
+#include "../CacheTools.h"
+
+namespace Texture
+{
+    // Constructor: BulkLoader
+    // ------------------------
+    // Starts the reader and decoder threads, which sleep until images are queued
+    //
+    // int workerCount:     decode threads, 0 for one per hardware thread
+    // int readerCount:     file reading threads
+    BulkLoader::BulkLoader(int workerCount, int readerCount)
+    {
+        if (workerCount <= 0)
+            workerCount = (int)std::max(1u, std::thread::hardware_concurrency());
+        readerCount = std::max(1, readerCount);
+
+        maxReadAhead = workerCount * 2;
+        startTime = std::chrono::steady_clock::now();
+
+        for (int i = 0; i < readerCount; i++)
+            threads.emplace_back(&BulkLoader::readerLoop, this);
+        for (int i = 0; i < workerCount; i++)
+            threads.emplace_back(&BulkLoader::decoderLoop, this);
+    }
+
+    // Destructor:  BulkLoader
+    // ------------------------
+    // Stops every thread; images still in flight are discarded without being uploaded
+    BulkLoader::~BulkLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        readCondition.notify_all();
+        decodeCondition.notify_all();
+        for (std::thread& thread : threads)
+            thread.join();
+    }
+
+    // Function:    Enqueue
+    // --------------------
+    // Queues an image for loading; a .ktx2/.dds copy with the same name is used when present
+    //
+    // string path:     image file to load
+    // int priority:    higher values are served first
+    // int halvings:    number of times to halve the image's resolution after decoding
+    //
+    // Returns the index of the image, reported back in BulkLoadResult::index and free for reuse after that
+    int BulkLoader::Enqueue(const std::string& path, int priority, int halvings)
+    {
+        int index;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cancelled)
+                return -1;
+
+            // Reuse the slot of an image already handed out by Pump, so long-lived loaders stay small
+            if (!freeItems.empty())
+            {
+                index = freeItems.back();
+                freeItems.pop_back();
+                items[index] = Item();
+            }
+            else
+            {
+                index = (int)items.size();
+                items.emplace_back();
+            }
+            items[index].path = path;
+            items[index].priority = priority;
+            items[index].halvings = halvings;
+            readQueue.insert({ -priority, index });
+            progress.total++;
+        }
+        readCondition.notify_one();
+        return index;
+    }
+
+    // Function:    SetPriority
+    // ------------------------
+    // Moves an image within whichever queue it is waiting in
+    // Images already being read, decoded or uploaded keep their place.
+    //
+    // int index:       image returned by Enqueue
+    // int priority:    higher values are served first
+    void BulkLoader::SetPriority(int index, int priority)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index < 0 || index >= (int)items.size())
+            return;
+
+        Item& item = items[index];
+        std::set<QueueKey>* queue = queueFor(item.stage);
+        if (queue != nullptr && item.priority != priority)
+        {
+            queue->erase({ -item.priority, index });
+            queue->insert({ -priority, index });
+        }
+        item.priority = priority;
+    }
+
+    // Function:    Remove
+    // -------------------
+    // Drops an image waiting to be read, decoded or uploaded, freeing its index for reuse
+    // An image being read or decoded cannot be dropped and is still returned by Pump.
+    //
+    // int index:   image returned by Enqueue
+    //
+    // Returns true if the image was dropped and will not be returned by Pump
+    bool BulkLoader::Remove(int index)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (index < 0 || index >= (int)items.size())
+            return false;
+
+        Item& item = items[index];
+        std::set<QueueKey>* queue = queueFor(item.stage);
+        if (queue == nullptr)
+            return false;
+
+        queue->erase({ -item.priority, index });
+        item = Item();
+        item.stage = Stage::Finished;
+        freeItems.push_back(index);
+        progress.total--;
+
+        // A read slot opens up if the image was waiting to be decoded
+        readCondition.notify_one();
+        return true;
+    }
+
+    // Function:    Pump
+    // -----------------
+    // Uploads decoded images on the calling (GL) thread, highest priority first
+    // The first image of a call is always uploaded so that oversized images still make progress.
+    //
+    // size_t uploadBudgetBytes:    stop once this many bytes have been uploaded, 0 for no limit
+    // int maxUploads:              stop after this many textures, 0 for no limit
+    //
+    // Returns the images finished during this call, including failures
+    std::vector<BulkLoadResult> BulkLoader::Pump(size_t uploadBudgetBytes, int maxUploads)
+    {
+        std::vector<BulkLoadResult> results;
+        size_t uploadedBytes = 0;
+        int uploads = 0;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!uploadQueue.empty())
+        {
+            const int index = uploadQueue.begin()->second;
+            Item& item = items[index];
+
+            BulkLoadResult result;
+            result.index = index;
+            result.path = item.path;
+
+            if (item.failed)
+            {
+                uploadQueue.erase(uploadQueue.begin());
+                item.stage = Stage::Finished;
+                freeItems.push_back(index);
+                results.push_back(result);
+                continue;
+            }
+
+            const size_t bytes = item.image.UploadSize();
+            if ((uploadBudgetBytes != 0 && uploads > 0 && uploadedBytes + bytes > uploadBudgetBytes) ||
+                (maxUploads != 0 && uploads >= maxUploads))
+                break;
+
+            uploadQueue.erase(uploadQueue.begin());
+            item.stage = Stage::Finished;
+            DecodedImage image = std::move(item.image);
+            item.image = DecodedImage();
+            freeItems.push_back(index);
+
+            // Upload without holding the lock so workers keep feeding the queue
+            lock.unlock();
+            result.texture = Upload(image);
+            result.succeeded = result.texture.id != 0;
+            result.bytes = result.succeeded ? bytes : 0;
+            lock.lock();
+
+            uploadedBytes += bytes;
+            uploads++;
+            if (result.succeeded)
+                progress.uploaded++;
+            else
+                progress.failed++;
+            results.push_back(result);
+        }
+
+        return results;
+    }
+
+    // Function:    Cancel
+    // -------------------
+    // Drops every image that is still waiting to be read or decoded and rejects new ones
+    // Images already decoded are still handed out by Pump so their memory is reclaimed.
+    void BulkLoader::Cancel()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cancelled = true;
+        progress.cancelled = true;
+
+        for (const QueueKey& key : readQueue)
+            items[key.second].stage = Stage::Finished;
+        for (const QueueKey& key : decodeQueue)
+        {
+            items[key.second].stage = Stage::Finished;
+            items[key.second].fileData = std::vector<unsigned char>();
+        }
+        readQueue.clear();
+        decodeQueue.clear();
+    }
+
+    // Function:    Progress
+    // ---------------------
+    // Returns a snapshot of the pipeline counters
+    BulkLoadProgress BulkLoader::Progress() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        BulkLoadProgress snapshot = progress;
+        snapshot.elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+        return snapshot;
+    }
+
+    // Function:    Done
+    // -----------------
+    // Returns true once no queued image is waiting to be read, decoded or returned by Pump
+    bool BulkLoader::Done() const
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        return std::all_of(items.begin(), items.end(), [](const Item& item) { return item.stage == Stage::Finished; });
+    }
+
+    // Helper Function:    readerLoop
+    // -------------------------------
+    // Reads the highest-priority queued file whenever the decoders have room for it
+    void BulkLoader::readerLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            readCondition.wait(lock, [&]() { return stopping || (!readQueue.empty() && (int)decodeQueue.size() < maxReadAhead); });
+            if (stopping)
+                return;
+
+            const int index = readQueue.begin()->second;
+            readQueue.erase(readQueue.begin());
+            items[index].stage = Stage::Reading;
+            const std::string original = items[index].path;
+            const std::string path = CompressedVariant(original);
+
+            lock.unlock();
+            std::vector<unsigned char> data;
+            bool succeeded = ReadWholeFile(path, data);
+            if (!succeeded && path != original)
+                succeeded = ReadWholeFile(original, data);
+            lock.lock();
+
+            Item& item = items[index];
+            if (cancelled)
+            {
+                item.stage = Stage::Finished;
+                continue;
+            }
+            if (!succeeded)
+            {
+                item.failed = true;
+                moveToStage(index, Stage::Decoded);
+                progress.failed++;
+                continue;
+            }
+
+            item.fileData = std::move(data);
+            moveToStage(index, Stage::Read);
+            progress.read++;
+            decodeCondition.notify_one();
+        }
+    }
+
+    // Helper Function:    decoderLoop
+    // --------------------------------
+    // Decodes the highest-priority file that has been read
+    void BulkLoader::decoderLoop()
+    {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            decodeCondition.wait(lock, [&]() { return stopping || !decodeQueue.empty(); });
+            if (stopping)
+                return;
+
+            const int index = decodeQueue.begin()->second;
+            decodeQueue.erase(decodeQueue.begin());
+            items[index].stage = Stage::Decoding;
+            std::vector<unsigned char> data = std::move(items[index].fileData);
+            items[index].fileData = std::vector<unsigned char>();
+            const int halvings = items[index].halvings;
+
+            // A read slot just opened up
+            readCondition.notify_one();
+
+            lock.unlock();
+            DecodedImage image;
+            const bool succeeded = Decode(data.data(), data.size(), image);
+            data = std::vector<unsigned char>();
+            if (succeeded)
+                Reduce(image, halvings);
+            lock.lock();
+
+            Item& item = items[index];
+            item.failed = !succeeded;
+            item.image = std::move(image);
+            moveToStage(index, Stage::Decoded);
+            if (succeeded)
+                progress.decoded++;
+            else
+                progress.failed++;
+        }
+    }
+
+    // Helper Function:    queueFor
+    // -----------------------------
+    // Returns the queue holding images waiting at a stage, or null for stages without a queue
+    std::set<BulkLoader::QueueKey>* BulkLoader::queueFor(Stage stage)
+    {
+        switch (stage)
+        {
+            case Stage::Queued:  return &readQueue;
+            case Stage::Read:    return &decodeQueue;
+            case Stage::Decoded: return &uploadQueue;
+            default:             return nullptr;
+        }
+    }
+
+    // Helper Function:    moveToStage
+    // --------------------------------
+    // Marks an image as having reached a stage and queues it there, caller holds the lock
+    void BulkLoader::moveToStage(int index, Stage stage)
+    {
+        Item& item = items[index];
+        item.stage = stage;
+        if (std::set<QueueKey>* queue = queueFor(stage))
+            queue->insert({ -item.priority, index });
+    }
+
+    // Function:    LoadMany
+    // ---------------------
+    // Creates a loader and queues a list of images on it
+    //
+    // vector paths:        image files to load
+    // vector priorities:   optional priority per path, higher first
+    //
+    // Returns the loader, whose Pump must be called once per frame on the GL thread
+    std::unique_ptr<BulkLoader> LoadMany(const std::vector<std::string>& paths, const std::vector<int>& priorities)
+    {
+        std::unique_ptr<BulkLoader> loader = std::make_unique<BulkLoader>();
+        for (size_t i = 0; i < paths.size(); i++)
+            loader->Enqueue(paths[i], i < priorities.size() ? priorities[i] : 0);
+        return loader;
+    }
+
+    // Function:    LoadDirectory
+    // --------------------------
+    // Creates a loader and queues every source image in a directory, sorted by file name
+    // Compressed .ktx2/.dds copies are not listed separately; they replace their source when read.
+    //
+    // string directory:    folder containing the images
+    //
+    // Returns the loader, whose Pump must be called once per frame on the GL thread
+    std::unique_ptr<BulkLoader> LoadDirectory(const std::string& directory)
+    {
+        static const char* extensions[] = { ".png", ".jpg", ".jpeg", ".bmp", ".tga", ".qoi" };
+
+        std::vector<std::string> paths;
+        std::error_code error;
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(directory, error))
+        {
+            const std::string extension = entry.path().extension().string();
+            if (entry.is_regular_file() && std::any_of(std::begin(extensions), std::end(extensions), [&](const char* e) { return extension == e; }))
+                paths.push_back(entry.path().string());
+        }
+        std::sort(paths.begin(), paths.end());
+
+        return LoadMany(paths);
+    }
+}
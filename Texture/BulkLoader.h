@@ -0,0 +1,151 @@
+/*
+ * BulkLoader.h
+ *
+ * Header of a pipelined loader for galleries of thousands of images. Files are read by a
+ * small pool of reader threads, decoded by a worker pool sized to the machine's cores and
+ * uploaded on the render thread under a per-frame byte budget. Every stage serves the
+ * highest-priority image first, so cells currently on screen can jump the queue, and results
+ * stream back as soon as they are uploaded.
+ */
+#ifndef BULKLOADER_H
+#define BULKLOADER_H
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "TextureTools.h"
+
+// Structure:   BulkLoadResult
+// ---------------------------
+// One finished image handed back by BulkLoader::Pump
+//
+// int index:           index returned by Enqueue for the image
+// string path:         file the image was loaded from
+// TextureData texture: uploaded texture, id 0 when loading failed
+// size_t bytes:        size of the uploaded pixel data
+// bool succeeded:      whether the image was read, decoded and uploaded
+struct BulkLoadResult
+{
+    int index = -1;
+    std::string path;
+    TextureData texture;
+    size_t bytes = 0;
+    bool succeeded = false;
+};
+
+// Structure:   BulkLoadProgress
+// -----------------------------
+// Snapshot of a BulkLoader's pipeline
+//
+// int total:               images queued
+// int read:                images read from disk
+// int decoded:             images decoded
+// int uploaded:            images uploaded and returned by Pump
+// int failed:              images that could not be read, decoded or uploaded
+// bool cancelled:          whether Cancel was called
+// double elapsedSeconds:   time since the first image was queued
+struct BulkLoadProgress
+{
+    int total = 0;
+    int read = 0;
+    int decoded = 0;
+    int uploaded = 0;
+    int failed = 0;
+    bool cancelled = false;
+    double elapsedSeconds = 0.0;
+
+    // Images uploaded per second so far
+    double ImagesPerSecond() const { return elapsedSeconds > 0.0 ? uploaded / elapsedSeconds : 0.0; }
+};
+
+namespace Texture
+{
+    // Class:   BulkLoader
+    // -------------------
+    // Reads and decodes queued images on background threads and uploads them on the render thread
+    // Higher priority values are served first; ties are served in queue order.
+    class BulkLoader {
+    public:
+        // workerCount of 0 uses one decode thread per hardware thread
+        explicit BulkLoader(int workerCount = 0, int readerCount = 2);
+
+        // Cancels outstanding work and joins every thread
+        ~BulkLoader();
+
+        BulkLoader(const BulkLoader&) = delete;
+        BulkLoader& operator=(const BulkLoader&) = delete;
+
+        // Queues an image, optionally at reduced resolution, and returns its index
+        // Indices are reused for later images once Pump has returned the image holding them or Remove has dropped it.
+        int Enqueue(const std::string& path, int priority = 0, int halvings = 0);
+
+        // Changes the priority of an image that has not been uploaded yet
+        void SetPriority(int index, int priority);
+
+        // Drops one image that is not being read or decoded right now, returns false if it could not be dropped
+        bool Remove(int index);
+
+        // Uploads decoded images, highest priority first, until either limit is reached (0 = no limit)
+        std::vector<BulkLoadResult> Pump(size_t uploadBudgetBytes = 0, int maxUploads = 0);
+
+        // Drops every image that has not been decoded yet
+        void Cancel();
+
+        // Current pipeline counters
+        BulkLoadProgress Progress() const;
+
+        // Whether every queued image has been returned by Pump or dropped
+        bool Done() const;
+
+    private:
+        enum class Stage { Queued, Reading, Read, Decoding, Decoded, Finished };
+
+        struct Item
+        {
+            std::string path;
+            int priority = 0;
+            int halvings = 0;
+            Stage stage = Stage::Queued;
+            bool failed = false;
+            std::vector<unsigned char> fileData;
+            DecodedImage image;
+        };
+
+        // Ordered by priority (highest first), then index
+        using QueueKey = std::pair<int, int>;
+
+        void readerLoop();
+        void decoderLoop();
+        std::set<QueueKey>* queueFor(Stage stage);
+        void moveToStage(int index, Stage stage);
+
+        mutable std::mutex mutex;
+        std::condition_variable readCondition;
+        std::condition_variable decodeCondition;
+        std::vector<Item> items;
+        std::vector<int> freeItems;
+        std::set<QueueKey> readQueue;
+        std::set<QueueKey> decodeQueue;
+        std::set<QueueKey> uploadQueue;
+        std::vector<std::thread> threads;
+        bool stopping = false;
+        bool cancelled = false;
+        int maxReadAhead = 0;
+        BulkLoadProgress progress;
+        std::chrono::steady_clock::time_point startTime;
+    };
+
+    // Queue a list of files on a new loader, priorities default to 0
+    std::unique_ptr<BulkLoader> LoadMany(const std::vector<std::string>& paths, const std::vector<int>& priorities = {});
+
+    // Queue every image in a directory, sorted by file name
+    std::unique_ptr<BulkLoader> LoadDirectory(const std::string& directory);
+}
+
+#endif //BULKLOADER_H
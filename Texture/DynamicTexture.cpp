@@ -0,0 +1,364 @@
+/*
+ * DynamicTexture.cpp
+ *
+ * Source file implementation of a procedural API for textures whose pixels change at runtime.
+ * Every dynamic texture owns a CPU shadow copy of its pixels and 1 to 3 OpenGL textures used
+ * round-robin. Each GPU buffer tracks the union of regions changed since it was last written,
+ * so rotating to an older buffer uploads only what it has missed.
+ */
+#include "DynamicTexture.h"
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+// Not exposed by every platform's GL 1.1 header
+#ifndef GL_BGRA
+#define GL_BGRA 0x80E1
+#endif
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+
+namespace Texture
+{
+    constexpr int MaxBufferCount = 3;
+
+    // Structure:   DirtyRegion
+    // ------------------------
+    // Bounding box of the pixels a GPU buffer has not received yet, empty when x0 >= x1
+    struct DirtyRegion
+    {
+        int x0 = 0, y0 = 0, x1 = 0, y1 = 0;
+
+        bool Empty() const { return x0 >= x1 || y0 >= y1; }
+        size_t Area() const { return Empty() ? 0 : (size_t)(x1 - x0) * (size_t)(y1 - y0); }
+    };
+
+    // Structure:   DynamicTexture
+    // ---------------------------
+    // Bookkeeping for one dynamic texture
+    struct DynamicTexture
+    {
+        bool inUse = false;
+        int width = 0;
+        int height = 0;
+        TextureFormat format = TextureFormat::RGBA8;
+        int bufferCount = 0;
+        GLuint ids[MaxBufferCount] = {};
+        DirtyRegion dirty[MaxBufferCount];
+        int front = 0;                      // Buffer handed out by Get
+        unsigned int lastUploadFrame = 0;   // Frame in which front was last written
+        bool pending = false;               // Has changes waiting on the budget
+        unsigned int pendingSince = 0;      // Frame in which the oldest waiting change was made
+        std::vector<unsigned char> shadow;  // CPU copy of the full image
+    };
+
+    static std::vector<DynamicTexture> textures;
+    static size_t uploadBudget = 0;
+    static unsigned int frameIndex = 1;
+    static TextureUploadStats frameStats;
+
+    // Helper Function:    BytesPerPixel
+    // ----------------------------------
+    // Returns the size of one pixel of a format in bytes
+    static int BytesPerPixel(TextureFormat format)
+    {
+        return format == TextureFormat::RGB8 ? 3 : 4;
+    }
+
+    // Helper Function:    PixelFormat
+    // --------------------------------
+    // Returns the OpenGL client pixel format matching a TextureFormat
+    static GLenum PixelFormat(TextureFormat format)
+    {
+        switch (format)
+        {
+            case TextureFormat::BGRA8: return GL_BGRA;
+            case TextureFormat::RGB8:  return GL_RGB;
+            default:                   return GL_RGBA;
+        }
+    }
+
+    // Helper Function:    Lookup
+    // ---------------------------
+    // Returns the bookkeeping for a handle, or null if the handle is not live
+    static DynamicTexture* Lookup(DynamicHandle handle)
+    {
+        if (handle < 0 || handle >= (int)textures.size() || !textures[handle].inUse)
+            return nullptr;
+        return &textures[handle];
+    }
+
+    // Helper Function:    UploadRegion
+    // ---------------------------------
+    // Copies a region of the shadow image into one GPU buffer
+    static void UploadRegion(const DynamicTexture& texture, GLuint id, const DirtyRegion& region)
+    {
+        glBindTexture(GL_TEXTURE_2D, id);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, texture.width);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, region.x0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, region.y0);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, region.x0, region.y0, region.x1 - region.x0, region.y1 - region.y0,
+                        PixelFormat(texture.format), GL_UNSIGNED_BYTE, texture.shadow.data());
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+        glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    }
+
+    // Helper Function:    TryUpload
+    // ------------------------------
+    // Writes outstanding changes into the next buffer in the rotation if the frame budget allows
+    // A texture rotates at most once per frame; later updates in the same frame rewrite the new
+    // front buffer. The first upload of a frame is always allowed so oversized images still progress.
+    //
+    // Returns true if the texture has no more pending changes
+    static bool TryUpload(DynamicTexture& texture)
+    {
+        const bool rotated = texture.lastUploadFrame == frameIndex;
+        const int target = rotated ? texture.front : (texture.front + 1) % texture.bufferCount;
+        const DirtyRegion region = texture.dirty[target];
+        const size_t bytes = region.Area() * BytesPerPixel(texture.format);
+
+        if (uploadBudget != 0 && frameStats.bytesUploaded != 0 && frameStats.bytesUploaded + bytes > uploadBudget)
+            return false;
+
+        if (!region.Empty())
+        {
+            UploadRegion(texture, texture.ids[target], region);
+            frameStats.bytesUploaded += bytes;
+            frameStats.uploads++;
+        }
+
+        texture.dirty[target] = DirtyRegion();
+        texture.front = target;
+        texture.lastUploadFrame = frameIndex;
+        texture.pending = false;
+        return true;
+    }
+
+    // Function:    CreateDynamic
+    // --------------------------
+    // Allocates the GPU buffers and CPU shadow of a dynamic texture, cleared to zero
+    //
+    // int width:               width of the texture in pixels
+    // int height:              height of the texture in pixels
+    // TextureFormat format:    layout of the pixels passed to Update
+    // int bufferCount:         number of GPU buffers to rotate between, clamped to 1-3
+    //
+    // Returns a handle used by the other dynamic texture functions
+    DynamicHandle CreateDynamic(int width, int height, TextureFormat format, int bufferCount)
+    {
+        // Reuse a released slot before growing the registry
+        DynamicHandle handle = 0;
+        while (handle < (int)textures.size() && textures[handle].inUse)
+            handle++;
+        if (handle == (int)textures.size())
+            textures.emplace_back();
+
+        DynamicTexture& texture = textures[handle];
+        texture = DynamicTexture();
+        texture.inUse = true;
+        texture.width = width;
+        texture.height = height;
+        texture.format = format;
+        texture.bufferCount = std::clamp(bufferCount, 1, MaxBufferCount);
+        texture.shadow.assign((size_t)width * height * BytesPerPixel(format), 0);
+
+        glGenTextures(texture.bufferCount, texture.ids);
+        for (int i = 0; i < texture.bufferCount; i++)
+        {
+            glBindTexture(GL_TEXTURE_2D, texture.ids[i]);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, PixelFormat(format), GL_UNSIGNED_BYTE, texture.shadow.data());
+            glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        }
+
+        return handle;
+    }
+
+    // Function:    DestroyDynamic
+    // ---------------------------
+    // Deletes the GPU buffers of a dynamic texture and frees its handle for reuse
+    //
+    // DynamicHandle handle:    texture to release
+    void DestroyDynamic(DynamicHandle handle)
+    {
+        DynamicTexture* texture = Lookup(handle);
+        if (texture == nullptr)
+            return;
+
+        glDeleteTextures(texture->bufferCount, texture->ids);
+        *texture = DynamicTexture();
+    }
+
+    // Helper Function:    CopyToShadow
+    // ---------------------------------
+    // Copies tightly packed pixels into a region of a texture's shadow image, clipped to the texture
+    //
+    // Returns the region written, empty if the rect lies outside the texture
+    static DirtyRegion CopyToShadow(DynamicTexture& texture, const void* pixels, TextureRect rect)
+    {
+        if (rect.width <= 0 || rect.height <= 0)
+            rect = TextureRect{ 0, 0, texture.width, texture.height };
+
+        // Clip the region to the texture, remembering where the source rows start
+        DirtyRegion region{ std::max(rect.x, 0), std::max(rect.y, 0),
+                            std::min(rect.x + rect.width, texture.width), std::min(rect.y + rect.height, texture.height) };
+        if (region.Empty())
+            return region;
+
+        const int bytesPerPixel = BytesPerPixel(texture.format);
+        const size_t sourcePitch = (size_t)rect.width * bytesPerPixel;
+        const size_t destinationPitch = (size_t)texture.width * bytesPerPixel;
+        const size_t rowBytes = (size_t)(region.x1 - region.x0) * bytesPerPixel;
+        const unsigned char* source = (const unsigned char*)pixels
+                                    + (size_t)(region.y0 - rect.y) * sourcePitch + (size_t)(region.x0 - rect.x) * bytesPerPixel;
+
+        for (int y = region.y0; y < region.y1; y++, source += sourcePitch)
+            memcpy(texture.shadow.data() + y * destinationPitch + (size_t)region.x0 * bytesPerPixel, source, rowBytes);
+        return region;
+    }
+
+    // Helper Function:    MarkDirty
+    // ------------------------------
+    // Grows the dirty region of one GPU buffer to cover a region it has missed
+    static void MarkDirty(DirtyRegion& dirty, const DirtyRegion& region)
+    {
+        dirty = dirty.Empty() ? region : DirtyRegion{ std::min(dirty.x0, region.x0), std::min(dirty.y0, region.y0),
+                                                      std::max(dirty.x1, region.x1), std::max(dirty.y1, region.y1) };
+    }
+
+    // Function:    Update
+    // -------------------
+    // Copies new pixels into a region of the shadow image, marks the region dirty on every GPU
+    // buffer and uploads to the next buffer unless the frame budget is spent
+    //
+    // DynamicHandle handle:    texture to update
+    // const void* pixels:      tightly packed pixels covering rect, in the texture's format
+    // TextureRect rect:        region being replaced, the whole texture when zero-sized
+    void Update(DynamicHandle handle, const void* pixels, TextureRect rect)
+    {
+        DynamicTexture* texture = Lookup(handle);
+        if (texture == nullptr || pixels == nullptr)
+            return;
+
+        const DirtyRegion region = CopyToShadow(*texture, pixels, rect);
+        if (region.Empty())
+            return;
+
+        // Every buffer has now missed this region
+        for (int i = 0; i < texture->bufferCount; i++)
+            MarkDirty(texture->dirty[i], region);
+
+        if (!texture->pending)
+            texture->pendingSince = frameIndex;
+        texture->pending = true;
+        TryUpload(*texture);
+    }
+
+    // Function:    UpdateImmediate
+    // ----------------------------
+    // Copies new pixels into a region of the shadow image and uploads exactly that region to the
+    // buffer Get returns, outside the frame budget and without rotating. Other buffers receive the
+    // region when the rotation next reaches them. For textures whose new pixels are drawn in the
+    // same frame, such as glyph cache pages.
+    //
+    // DynamicHandle handle:    texture to update
+    // const void* pixels:      tightly packed pixels covering rect, in the texture's format
+    // TextureRect rect:        region being replaced, the whole texture when zero-sized
+    void UpdateImmediate(DynamicHandle handle, const void* pixels, TextureRect rect)
+    {
+        DynamicTexture* texture = Lookup(handle);
+        if (texture == nullptr || pixels == nullptr)
+            return;
+
+        const DirtyRegion region = CopyToShadow(*texture, pixels, rect);
+        if (region.Empty())
+            return;
+
+        UploadRegion(*texture, texture->ids[texture->front], region);
+        frameStats.bytesUploaded += region.Area() * BytesPerPixel(texture->format);
+        frameStats.uploads++;
+
+        for (int i = 0; i < texture->bufferCount; i++)
+            if (i != texture->front)
+                MarkDirty(texture->dirty[i], region);
+    }
+
+    // Function:    Get
+    // ----------------
+    // Returns the most recently written buffer of a dynamic texture, for use with DrawTools
+    //
+    // DynamicHandle handle:    texture to draw
+    //
+    // Returns TextureData struct containing information necessary for rendering
+    TextureData Get(DynamicHandle handle)
+    {
+        DynamicTexture* texture = Lookup(handle);
+        if (texture == nullptr)
+            return TextureData{};
+
+        TextureData data;
+        data.id = texture->ids[texture->front];
+        data.width = texture->width;
+        data.height = texture->height;
+        return data;
+    }
+
+    // Function:    SetUploadBudget
+    // ----------------------------
+    // Limits how many bytes dynamic textures may upload per frame
+    //
+    // size_t bytesPerFrame:    byte limit, 0 disables the limit
+    void SetUploadBudget(size_t bytesPerFrame)
+    {
+        uploadBudget = bytesPerFrame;
+    }
+
+    // Function:    BeginFrame
+    // -----------------------
+    // Starts a new upload frame and spends its budget on updates deferred by earlier frames,
+    // those waiting longest first. Call once per frame before drawing.
+    void BeginFrame()
+    {
+        frameIndex++;
+        frameStats = TextureUploadStats();
+
+        // Slots are reused, so slot order says nothing about how long an update has waited
+        static std::vector<DynamicTexture*> waiting;
+        waiting.clear();
+        for (DynamicTexture& texture : textures)
+        {
+            if (texture.inUse && texture.pending)
+                waiting.push_back(&texture);
+        }
+        std::stable_sort(waiting.begin(), waiting.end(), [](const DynamicTexture* a, const DynamicTexture* b)
+        {
+            return a->pendingSince < b->pendingSince;
+        });
+
+        for (DynamicTexture* texture : waiting)
+        {
+            if (!TryUpload(*texture))
+                break;
+        }
+    }
+
+    // Function:    GetUploadStats
+    // ---------------------------
+    // Returns the upload activity of the current frame
+    TextureUploadStats GetUploadStats()
+    {
+        TextureUploadStats stats = frameStats;
+        for (const DynamicTexture& texture : textures)
+            stats.deferred += texture.inUse && texture.pending;
+        return stats;
+    }
+}
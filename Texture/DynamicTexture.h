@@ -0,0 +1,84 @@
+/*
+ * DynamicTexture.h
+ *
+ * Header of a procedural API for textures whose pixels change at runtime, such as live
+ * camera previews and generated heatmaps. Each dynamic texture keeps a CPU copy of its
+ * pixels and rotates between up to three OpenGL textures, so a frame never writes into the
+ * texture the GPU may still be sampling from the previous one. Updates accumulate as dirty
+ * rectangles and are uploaded under a per-frame byte budget.
+ */
+#ifndef DYNAMICTEXTURE_H
+#define DYNAMICTEXTURE_H
+#include <cstddef>
+
+#include "TextureTools.h"
+
+// Enum:    TextureFormat
+// ----------------------
+// Layout of the pixels handed to Texture::Update, 8 bits per channel
+enum class TextureFormat
+{
+    RGBA8,
+    BGRA8,
+    RGB8
+};
+
+// Structure:   TextureRect
+// ------------------------
+// Region of a texture in pixels, a zero-sized rect covers the whole texture
+//
+// int x, y:            upper left corner of the region
+// int width, height:   size of the region
+struct TextureRect
+{
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+};
+
+// Structure:   TextureUploadStats
+// -------------------------------
+// Upload activity since the last Texture::BeginFrame
+//
+// size_t bytesUploaded:    bytes sent to the GPU this frame
+// int uploads:             number of glTexSubImage2D calls this frame
+// int deferred:            dynamic textures still waiting on the budget
+struct TextureUploadStats
+{
+    size_t bytesUploaded = 0;
+    int uploads = 0;
+    int deferred = 0;
+};
+
+namespace Texture
+{
+    // Identifies a dynamic texture, -1 is never a valid handle
+    using DynamicHandle = int;
+
+    // Create a dynamic texture with 1 to 3 GPU buffers
+    DynamicHandle CreateDynamic(int width, int height, TextureFormat format, int bufferCount = 2);
+
+    // Release every GPU buffer of a dynamic texture
+    void DestroyDynamic(DynamicHandle handle);
+
+    // Copy tightly packed pixels into a region of a dynamic texture and upload them when the budget allows
+    void Update(DynamicHandle handle, const void* pixels, TextureRect rect = {});
+
+    // Copy tightly packed pixels into a region of a dynamic texture and upload that region to its current buffer at once
+    void UpdateImmediate(DynamicHandle handle, const void* pixels, TextureRect rect = {});
+
+    // The most recently completed buffer, for use with the DrawTools functions
+    TextureData Get(DynamicHandle handle);
+
+    // Limit the bytes uploaded per frame across all dynamic textures, 0 for no limit
+    void SetUploadBudget(size_t bytesPerFrame);
+
+    // Reset the frame budget and upload updates deferred by earlier frames
+    void BeginFrame();
+
+    // Upload activity of the current frame
+    TextureUploadStats GetUploadStats();
+}
+
+#endif //DYNAMICTEXTURE_H
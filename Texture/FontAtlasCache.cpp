@@ -0,0 +1,532 @@
+/*
+ * FontAtlasCache.cpp
+ *
+ * Source file implementation of the on-disk font atlas cache. A cache file holds a header,
+ * one record per font, every font's glyph table, the atlas's custom rects and line UVs, and
+ * finally the packed atlas pixels, all at fixed offsets so a mapped file is read in place.
+ * A hit rebuilds the ImFont glyph tables from the records and copies the pixels into the
+ * atlas once, with no rasterization or rect packing. Files are written under a temporary
+ * name and renamed when complete, as the tile cache does, so a partial file is never read.
+ */
+#include "FontAtlasCache.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <functional>
+#include <thread>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#include "../CacheTools.h"
+
+#include "imgui_internal.h"
+
+namespace Texture
+{
+    // Structure:   FontAtlasCacheHeader
+    // ---------------------------------
+    // First bytes of a font atlas cache file
+    struct FontAtlasCacheHeader
+    {
+        char magic[4] = { 'F', 'N', 'T', 'C' };
+        uint32_t version = 1;
+        uint64_t key = 0;
+        uint32_t texWidth = 0;
+        uint32_t texHeight = 0;
+        uint32_t bytesPerPixel = 0;
+        uint32_t fontCount = 0;
+        uint32_t glyphCount = 0;
+        uint32_t rectCount = 0;
+        uint32_t lineCount = 0;
+        int32_t packIdMouseCursors = -1;
+        int32_t packIdLines = -1;
+        float whitePixelU = 0.0f;
+        float whitePixelV = 0.0f;
+    };
+
+    // Structure:   CachedFontRecord
+    // -----------------------------
+    // Metrics of one ImFont and the range of its glyphs in the glyph table
+    struct CachedFontRecord
+    {
+        float fontSize = 0.0f;
+        float ascent = 0.0f;
+        float descent = 0.0f;
+        uint32_t firstGlyph = 0;
+        uint32_t glyphCount = 0;
+        uint32_t fallbackChar = 0;
+        uint32_t ellipsisChar = 0;
+        char name[40] = {};
+    };
+
+    // Structure:   CachedGlyphRecord
+    // ------------------------------
+    // One ImFontGlyph with its final advance, after spacing and snapping were applied
+    struct CachedGlyphRecord
+    {
+        uint32_t codepoint = 0;
+        uint32_t colored = 0;
+        float advanceX = 0.0f;
+        float x0 = 0.0f, y0 = 0.0f, x1 = 0.0f, y1 = 0.0f;
+        float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+    };
+
+    // Structure:   CachedRectRecord
+    // -----------------------------
+    // One ImFontAtlasCustomRect, such as the mouse cursors and the baked line textures
+    struct CachedRectRecord
+    {
+        uint16_t width = 0, height = 0, x = 0, y = 0;
+        uint32_t glyphId = 0;
+        float glyphAdvanceX = 0.0f;
+        float glyphOffsetX = 0.0f, glyphOffsetY = 0.0f;
+        int32_t font = -1;
+    };
+
+    // Structure:   MappedFile
+    // -----------------------
+    // A read-only view of a whole file
+    struct MappedFile
+    {
+        const unsigned char* data = nullptr;
+        size_t size = 0;
+#ifdef _WIN32
+        HANDLE file = INVALID_HANDLE_VALUE;
+        HANDLE mapping = NULL;
+#endif
+    };
+
+    // Helper Function:    MapFile
+    // ---------------------------
+    // Maps a whole file into memory for reading
+    //
+    // Returns false if the file cannot be opened or is empty
+    static bool MapFile(const std::string& path, MappedFile& mapped)
+    {
+#ifdef _WIN32
+        mapped.file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+        if (mapped.file == INVALID_HANDLE_VALUE)
+            return false;
+
+        LARGE_INTEGER size;
+        if (!GetFileSizeEx(mapped.file, &size) || size.QuadPart == 0 ||
+            (mapped.mapping = CreateFileMappingA(mapped.file, NULL, PAGE_READONLY, 0, 0, NULL)) == NULL)
+        {
+            CloseHandle(mapped.file);
+            mapped.file = INVALID_HANDLE_VALUE;
+            return false;
+        }
+        mapped.data = (const unsigned char*)MapViewOfFile(mapped.mapping, FILE_MAP_READ, 0, 0, 0);
+        mapped.size = (size_t)size.QuadPart;
+#else
+        const int file = open(path.c_str(), O_RDONLY);
+        if (file < 0)
+            return false;
+
+        struct stat status;
+        if (fstat(file, &status) != 0 || status.st_size == 0)
+        {
+            close(file);
+            return false;
+        }
+        void* data = mmap(nullptr, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+        close(file);
+        mapped.data = data != MAP_FAILED ? (const unsigned char*)data : nullptr;
+        mapped.size = (size_t)status.st_size;
+#endif
+        return mapped.data != nullptr;
+    }
+
+    // Helper Function:    UnmapFile
+    // -----------------------------
+    // Releases a view created by MapFile
+    static void UnmapFile(MappedFile& mapped)
+    {
+#ifdef _WIN32
+        if (mapped.data != nullptr)
+            UnmapViewOfFile(mapped.data);
+        if (mapped.mapping != NULL)
+            CloseHandle(mapped.mapping);
+        if (mapped.file != INVALID_HANDLE_VALUE)
+            CloseHandle(mapped.file);
+#else
+        if (mapped.data != nullptr)
+            munmap((void*)mapped.data, mapped.size);
+#endif
+        mapped = MappedFile();
+    }
+
+    // Helper Function:    HashFontSettings
+    // ------------------------------------
+    // Hashes everything that changes the built atlas: font file contents, sizes, glyph ranges,
+    // oversampling, the atlas's own settings and the ImGui version. A second hash of the font
+    // paths and sizes alone identifies the atlas across those changes, so a new build can find
+    // the files it supersedes.
+    //
+    // ImFontAtlas* atlas:      atlas the fonts will be built into
+    // vector fonts:            fonts to bake
+    // uint64_t outIdentity:    hash of the font paths and sizes
+    // uint64_t outKey:         hash of everything the built atlas depends on
+    // vector outFontData:      contents of each font file, in the order of fonts
+    //
+    // Returns false if a font file cannot be read
+    static bool HashFontSettings(ImFontAtlas* atlas, const std::vector<FontAtlasFont>& fonts, uint64_t& outIdentity, uint64_t& outKey,
+                                 std::vector<std::vector<unsigned char>>& outFontData)
+    {
+        const int32_t settings[] = { IMGUI_VERSION_NUM, atlas->Flags, atlas->TexDesiredWidth, atlas->TexGlyphPadding };
+        uint64_t key = HashBytes(settings, sizeof(settings));
+        const uint32_t fontCount = (uint32_t)fonts.size();
+        uint64_t identity = HashBytes(&fontCount, sizeof(fontCount));
+
+        outFontData.resize(fonts.size());
+        for (size_t i = 0; i < fonts.size(); i++)
+        {
+            const FontAtlasFont& font = fonts[i];
+            std::vector<unsigned char>& data = outFontData[i];
+            if (!ReadWholeFile(font.path, data) || data.empty())
+                return false;
+            key = HashBytes(data.data(), data.size(), key);
+            identity = HashBytes(font.path.c_str(), font.path.size() + 1, identity);
+            identity = HashBytes(font.sizes.data(), font.sizes.size() * sizeof(float), identity);
+
+            const int32_t options[] = { font.oversampleH, font.oversampleV, font.pixelSnapH ? 1 : 0, (int32_t)font.sizes.size() };
+            key = HashBytes(options, sizeof(options), key);
+            key = HashBytes(font.sizes.data(), font.sizes.size() * sizeof(float), key);
+
+            const ImWchar* ranges = font.glyphRanges != nullptr ? font.glyphRanges : atlas->GetGlyphRangesDefault();
+            size_t rangeCount = 0;
+            while (ranges[rangeCount] != 0)
+                rangeCount++;
+            key = HashBytes(ranges, rangeCount * sizeof(ImWchar), key);
+        }
+
+        outIdentity = identity;
+        outKey = key;
+        return true;
+    }
+
+    // Helper Function:    FillAtlas
+    // -----------------------------
+    // Recreates an atlas's fonts, custom rects and pixels from the contents of a cache file
+    // Each font's config holds its font file and settings as AddFontFromFileTTF would have left
+    // them, so the atlas can still be rebuilt, for example after adding a font or when
+    // GetTexDataAsAlpha8 is asked for pixels the cache stored as RGBA.
+    //
+    // ImFontAtlas* atlas:      atlas to fill, cleared only once the file has been validated
+    // unsigned char* data:     mapped cache file
+    // size_t size:             size of the mapped file
+    // uint64_t key:            key the file must have been written with
+    // vector fonts:            fonts the atlas was built from
+    // vector fontData:         contents of each font file, copied into the atlas's configs
+    //
+    // Returns false if the file is stale, truncated or from another version
+    static bool FillAtlas(ImFontAtlas* atlas, const unsigned char* data, size_t size, uint64_t key,
+                          const std::vector<FontAtlasFont>& fonts, const std::vector<std::vector<unsigned char>>& fontData)
+    {
+        FontAtlasCacheHeader header;
+        const FontAtlasCacheHeader expected;
+        if (size < sizeof(header))
+            return false;
+        memcpy(&header, data, sizeof(header));
+        if (memcmp(header.magic, expected.magic, 4) != 0 || header.version != expected.version || header.key != key ||
+            (header.bytesPerPixel != 1 && header.bytesPerPixel != 4) || header.fontCount == 0 ||
+            header.lineCount != (uint32_t)IM_ARRAYSIZE(atlas->TexUvLines) || header.texWidth == 0 || header.texHeight == 0)
+            return false;
+
+        // Every section sits at a fixed offset; the pixels end the file
+        const size_t fontsOffset = sizeof(FontAtlasCacheHeader);
+        const size_t glyphsOffset = fontsOffset + header.fontCount * sizeof(CachedFontRecord);
+        const size_t rectsOffset = glyphsOffset + header.glyphCount * sizeof(CachedGlyphRecord);
+        const size_t linesOffset = rectsOffset + header.rectCount * sizeof(CachedRectRecord);
+        const size_t pixelsOffset = linesOffset + header.lineCount * sizeof(ImVec4);
+        const size_t pixelBytes = (size_t)header.texWidth * header.texHeight * header.bytesPerPixel;
+        if (size != pixelsOffset + pixelBytes)
+            return false;
+
+        const CachedFontRecord* fontRecords = (const CachedFontRecord*)(data + fontsOffset);
+        const CachedGlyphRecord* glyphRecords = (const CachedGlyphRecord*)(data + glyphsOffset);
+        const CachedRectRecord* rectRecords = (const CachedRectRecord*)(data + rectsOffset);
+        for (uint32_t i = 0; i < header.fontCount; i++)
+            if ((size_t)fontRecords[i].firstGlyph + fontRecords[i].glyphCount > header.glyphCount)
+                return false;
+
+        size_t sizeCount = 0;
+        for (const FontAtlasFont& font : fonts)
+            sizeCount += font.sizes.size();
+        if (sizeCount != header.fontCount || fontData.size() != fonts.size())
+            return false;
+
+        atlas->Clear();
+
+        // Configs are added first, so the fonts can point at them once the vector stops growing
+        uint32_t record = 0;
+        for (size_t f = 0; f < fonts.size(); f++)
+        {
+            const FontAtlasFont& font = fonts[f];
+            for (size_t s = 0; s < font.sizes.size(); s++, record++)
+            {
+                ImFontConfig config;
+                config.FontData = IM_ALLOC(fontData[f].size());
+                memcpy(config.FontData, fontData[f].data(), fontData[f].size());
+                config.FontDataSize = (int)fontData[f].size();
+                config.FontDataOwnedByAtlas = true;
+                config.SizePixels = fontRecords[record].fontSize;
+                config.OversampleH = font.oversampleH;
+                config.OversampleV = font.oversampleV;
+                config.PixelSnapH = font.pixelSnapH;
+                config.GlyphRanges = font.glyphRanges != nullptr ? font.glyphRanges : atlas->GetGlyphRangesDefault();
+                memcpy(config.Name, fontRecords[record].name, sizeof(config.Name));
+                config.Name[sizeof(config.Name) - 1] = '\0';
+                atlas->ConfigData.push_back(config);
+            }
+        }
+
+        for (uint32_t i = 0; i < header.fontCount; i++)
+        {
+            const CachedFontRecord& record = fontRecords[i];
+            ImFont* font = IM_NEW(ImFont)();
+            atlas->Fonts.push_back(font);
+            atlas->ConfigData[i].DstFont = font;
+
+            font->ContainerAtlas = atlas;
+            font->ConfigData = &atlas->ConfigData[i];
+            font->ConfigDataCount = 1;
+            font->FontSize = record.fontSize;
+            font->Ascent = record.ascent;
+            font->Descent = record.descent;
+            font->FallbackChar = (ImWchar)record.fallbackChar;
+            font->EllipsisChar = (ImWchar)record.ellipsisChar;
+
+            // Advances were final when stored, so no config is passed to adjust them again
+            font->Glyphs.reserve((int)record.glyphCount);
+            for (uint32_t g = record.firstGlyph; g < record.firstGlyph + record.glyphCount; g++)
+            {
+                const CachedGlyphRecord& glyph = glyphRecords[g];
+                font->AddGlyph(nullptr, (ImWchar)glyph.codepoint, glyph.x0, glyph.y0, glyph.x1, glyph.y1, glyph.u0, glyph.v0, glyph.u1, glyph.v1, glyph.advanceX);
+                font->Glyphs.back().Colored = glyph.colored != 0;
+            }
+            font->BuildLookupTable();
+        }
+
+        for (uint32_t i = 0; i < header.rectCount; i++)
+        {
+            const CachedRectRecord& record = rectRecords[i];
+            ImFontAtlasCustomRect rect;
+            rect.Width = record.width;
+            rect.Height = record.height;
+            rect.X = record.x;
+            rect.Y = record.y;
+            rect.GlyphID = record.glyphId;
+            rect.GlyphAdvanceX = record.glyphAdvanceX;
+            rect.GlyphOffset = ImVec2(record.glyphOffsetX, record.glyphOffsetY);
+            rect.Font = record.font >= 0 && record.font < atlas->Fonts.Size ? atlas->Fonts[record.font] : nullptr;
+            atlas->CustomRects.push_back(rect);
+        }
+        atlas->PackIdMouseCursors = header.packIdMouseCursors;
+        atlas->PackIdLines = header.packIdLines;
+
+        // The atlas owns and frees its pixel buffers, so the mapped pixels are copied out once
+        atlas->TexWidth = (int)header.texWidth;
+        atlas->TexHeight = (int)header.texHeight;
+        atlas->TexUvScale = ImVec2(1.0f / atlas->TexWidth, 1.0f / atlas->TexHeight);
+        atlas->TexUvWhitePixel = ImVec2(header.whitePixelU, header.whitePixelV);
+        memcpy(atlas->TexUvLines, data + linesOffset, header.lineCount * sizeof(ImVec4));
+        if (header.bytesPerPixel == 1)
+        {
+            atlas->TexPixelsAlpha8 = (unsigned char*)IM_ALLOC(pixelBytes);
+            memcpy(atlas->TexPixelsAlpha8, data + pixelsOffset, pixelBytes);
+        }
+        else
+        {
+            atlas->TexPixelsRGBA32 = (unsigned int*)IM_ALLOC(pixelBytes);
+            memcpy(atlas->TexPixelsRGBA32, data + pixelsOffset, pixelBytes);
+        }
+        atlas->TexPixelsUseColors = header.bytesPerPixel == 4;
+        atlas->TexReady = true;
+        return true;
+    }
+
+    // Helper Function:    WriteCache
+    // ------------------------------
+    // Stores a built atlas's glyph tables, custom rects and pixels for later launches
+    //
+    // ImFontAtlas* atlas:      built atlas
+    // string path:             cache file to write
+    // uint64_t key:            hash of the settings the atlas was built from
+    // size_t outBytes:         size of the written file
+    //
+    // Returns false if the file could not be written
+    static bool WriteCache(ImFontAtlas* atlas, const std::string& path, uint64_t key, size_t& outBytes)
+    {
+        // Atlases with colored glyphs only have RGBA pixels; the rest are stored at a quarter of the size
+        const unsigned char* pixels = atlas->TexPixelsAlpha8;
+        int bytesPerPixel = 1;
+        if (pixels == nullptr || atlas->TexPixelsUseColors)
+        {
+            unsigned char* rgba = nullptr;
+            int width = 0;
+            int height = 0;
+            atlas->GetTexDataAsRGBA32(&rgba, &width, &height);
+            pixels = rgba;
+            bytesPerPixel = 4;
+        }
+        if (pixels == nullptr)
+            return false;
+
+        FontAtlasCacheHeader header;
+        header.key = key;
+        header.texWidth = (uint32_t)atlas->TexWidth;
+        header.texHeight = (uint32_t)atlas->TexHeight;
+        header.bytesPerPixel = (uint32_t)bytesPerPixel;
+        header.fontCount = (uint32_t)atlas->Fonts.Size;
+        header.rectCount = (uint32_t)atlas->CustomRects.Size;
+        header.lineCount = (uint32_t)IM_ARRAYSIZE(atlas->TexUvLines);
+        header.packIdMouseCursors = atlas->PackIdMouseCursors;
+        header.packIdLines = atlas->PackIdLines;
+        header.whitePixelU = atlas->TexUvWhitePixel.x;
+        header.whitePixelV = atlas->TexUvWhitePixel.y;
+
+        std::vector<CachedFontRecord> fontRecords;
+        std::vector<CachedGlyphRecord> glyphRecords;
+        for (const ImFont* font : atlas->Fonts)
+        {
+            CachedFontRecord record;
+            record.fontSize = font->FontSize;
+            record.ascent = font->Ascent;
+            record.descent = font->Descent;
+            record.firstGlyph = (uint32_t)glyphRecords.size();
+            record.glyphCount = (uint32_t)font->Glyphs.Size;
+            record.fallbackChar = font->FallbackChar;
+            record.ellipsisChar = font->EllipsisChar;
+            if (font->ConfigData != nullptr)
+                memcpy(record.name, font->ConfigData->Name, ImMin(sizeof(record.name), sizeof(font->ConfigData->Name)));
+            fontRecords.push_back(record);
+
+            for (const ImFontGlyph& glyph : font->Glyphs)
+                glyphRecords.push_back({ glyph.Codepoint, glyph.Colored, glyph.AdvanceX, glyph.X0, glyph.Y0, glyph.X1, glyph.Y1, glyph.U0, glyph.V0, glyph.U1, glyph.V1 });
+        }
+        header.glyphCount = (uint32_t)glyphRecords.size();
+
+        std::vector<CachedRectRecord> rectRecords;
+        for (const ImFontAtlasCustomRect& rect : atlas->CustomRects)
+        {
+            CachedRectRecord record;
+            record.width = rect.Width;
+            record.height = rect.Height;
+            record.x = rect.X;
+            record.y = rect.Y;
+            record.glyphId = rect.GlyphID;
+            record.glyphAdvanceX = rect.GlyphAdvanceX;
+            record.glyphOffsetX = rect.GlyphOffset.x;
+            record.glyphOffsetY = rect.GlyphOffset.y;
+            record.font = rect.Font != nullptr ? atlas->Fonts.index_from_ptr(std::find(atlas->Fonts.begin(), atlas->Fonts.end(), rect.Font)) : -1;
+            rectRecords.push_back(record);
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(path).parent_path(), error);
+        const std::string temporaryPath = path + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        FILE* file = fopen(temporaryPath.c_str(), "wb");
+        if (file == NULL)
+            return false;
+
+        const size_t pixelBytes = (size_t)atlas->TexWidth * atlas->TexHeight * bytesPerPixel;
+        bool succeeded = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                         fwrite(fontRecords.data(), sizeof(CachedFontRecord), fontRecords.size(), file) == fontRecords.size() &&
+                         fwrite(glyphRecords.data(), sizeof(CachedGlyphRecord), glyphRecords.size(), file) == glyphRecords.size() &&
+                         fwrite(rectRecords.data(), sizeof(CachedRectRecord), rectRecords.size(), file) == rectRecords.size() &&
+                         fwrite(atlas->TexUvLines, sizeof(ImVec4), header.lineCount, file) == header.lineCount &&
+                         fwrite(pixels, 1, pixelBytes, file) == pixelBytes;
+
+        succeeded = fclose(file) == 0 && succeeded;
+        if (succeeded)
+            std::filesystem::rename(temporaryPath, path, error);
+        if (!succeeded || error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        outBytes = std::filesystem::file_size(path, error);
+        return true;
+    }
+
+    // Function:    BuildFontAtlas
+    // ---------------------------
+    // Fills an atlas from a matching cache file, or adds every font at every size, builds the
+    // atlas and writes the cache for the next launch. A cache file that is missing, stale or
+    // damaged is ignored and replaced. Cache files are named after the font paths and sizes, then
+    // everything else the atlas depends on, and a new file removes older builds of the same fonts.
+    //
+    // ImFontAtlas* atlas:      atlas to build, usually ImGui::GetIO().Fonts
+    // vector fonts:            fonts to bake, in the order they appear in atlas->Fonts
+    // string cacheDirectory:   folder holding cached atlases
+    //
+    // Returns whether the atlas was built, whether the cache was used, and the time taken
+    FontAtlasCacheResult BuildFontAtlas(ImFontAtlas* atlas, const std::vector<FontAtlasFont>& fonts, const std::string& cacheDirectory)
+    {
+        FontAtlasCacheResult result;
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+
+        uint64_t identity = 0;
+        uint64_t key = 0;
+        std::vector<std::vector<unsigned char>> fontData;
+        const bool keyed = HashFontSettings(atlas, fonts, identity, key, fontData);
+        if (keyed)
+        {
+            std::error_code error;
+            const std::filesystem::path directory = cacheDirectory.empty() ? std::filesystem::temp_directory_path(error) / "imguiutils_fonts" : std::filesystem::path(cacheDirectory);
+            char name[48];
+            snprintf(name, sizeof(name), "%016llx-%016llx.fontatlas", (unsigned long long)identity, (unsigned long long)key);
+            result.cachePath = (directory / name).string();
+
+            MappedFile file;
+            if (MapFile(result.cachePath, file))
+            {
+                result.cacheHit = FillAtlas(atlas, file.data, file.size, key, fonts, fontData);
+                result.cacheBytes = result.cacheHit ? file.size : 0;
+            }
+            UnmapFile(file);
+        }
+
+        if (result.cacheHit)
+        {
+            result.succeeded = true;
+        }
+        else
+        {
+            atlas->Clear();
+            result.succeeded = !fonts.empty();
+            for (const FontAtlasFont& font : fonts)
+            {
+                for (float size : font.sizes)
+                {
+                    ImFontConfig config;
+                    config.OversampleH = font.oversampleH;
+                    config.OversampleV = font.oversampleV;
+                    config.PixelSnapH = font.pixelSnapH;
+                    result.succeeded = result.succeeded && atlas->AddFontFromFileTTF(font.path.c_str(), size, &config, font.glyphRanges) != nullptr;
+                }
+            }
+            result.succeeded = result.succeeded && atlas->Build();
+
+            if (result.succeeded && keyed && WriteCache(atlas, result.cachePath, key, result.cacheBytes))
+                RemoveStaleCaches(result.cachePath);
+        }
+
+        result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        return result;
+    }
+}
@@ -0,0 +1,67 @@
+/*
+ * FontAtlasCache.h
+ *
+ * Header of an on-disk cache for built ImGui font atlases. Baking several fonts at every size
+ * a 4K layout uses rasterizes and packs thousands of glyphs on each launch. The first build
+ * stores the packed atlas pixels and glyph tables in a single file; later launches map that
+ * file and fill the atlas from it directly, skipping rasterization and packing entirely.
+ * The cache is keyed by a hash of each font file's contents, the sizes, glyph ranges and
+ * oversampling settings, and the ImGui version, so any change builds and stores a new atlas
+ * and removes the file it replaces. A cached atlas keeps its font files in memory as a built one
+ * does, so it can be rebuilt like any other.
+ */
+#ifndef FONTATLASCACHE_H
+#define FONTATLASCACHE_H
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+
+// Structure:   FontAtlasFont
+// --------------------------
+// One font file baked at one or more sizes
+//
+// string path:             .ttf/.otf file to bake
+// vector sizes:            pixel sizes, each added to the atlas as its own ImFont
+// ImWchar* glyphRanges:    pairs of codepoints ending in 0, null for ImGui's default ranges
+// int oversampleH:         horizontal oversampling, as ImFontConfig::OversampleH
+// int oversampleV:         vertical oversampling, as ImFontConfig::OversampleV
+// bool pixelSnapH:         snap glyph advances to whole pixels, as ImFontConfig::PixelSnapH
+struct FontAtlasFont
+{
+    std::string path;
+    std::vector<float> sizes;
+    const ImWchar* glyphRanges = nullptr;
+    int oversampleH = 2;
+    int oversampleV = 1;
+    bool pixelSnapH = false;
+};
+
+// Structure:   FontAtlasCacheResult
+// ---------------------------------
+// Outcome of Texture::BuildFontAtlas
+//
+// bool succeeded:      whether the atlas is built, from the cache or from the font files
+// bool cacheHit:       whether the atlas was filled from an existing cache file
+// double seconds:      time spent building or loading the atlas
+// size_t cacheBytes:   size of the cache file read or written, 0 if none
+// string cachePath:    cache file used for these settings
+struct FontAtlasCacheResult
+{
+    bool succeeded = false;
+    bool cacheHit = false;
+    double seconds = 0.0;
+    size_t cacheBytes = 0;
+    std::string cachePath;
+};
+
+namespace Texture
+{
+    // Builds an atlas from a list of fonts, reusing a cached build when one matches
+    // The atlas is cleared first; its fonts follow the list's order, each font's sizes in turn.
+    // cacheDirectory defaults to a folder in the system temporary directory.
+    FontAtlasCacheResult BuildFontAtlas(ImFontAtlas* atlas, const std::vector<FontAtlasFont>& fonts, const std::string& cacheDirectory = "");
+}
+
+#endif //FONTATLASCACHE_H
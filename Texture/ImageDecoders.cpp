@@ -0,0 +1,401 @@
+/*
+ * ImageDecoders.cpp
+ *
+ * Source file implementation of the image decoder registry. Decoders are held in a list under
+ * a mutex that is released while decoding, so worker threads decode in parallel. The QOI
+ * decoder follows the reference specification at qoiformat.org and validates every read
+ * against the end of the buffer. The optional libspng and libjpeg-turbo backends compile in
+ * only when their build flags are set.
+ */
+#include "ImageDecoders.h"
+#include "stb_image.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+
+#ifdef IMGUIUTILS_HAS_SPNG
+#include <spng.h>
+#endif
+#ifdef IMGUIUTILS_HAS_TURBOJPEG
+#include <turbojpeg.h>
+#endif
+
+namespace Texture
+{
+    // Structure:   RegisteredDecoder
+    // ------------------------------
+    // A decoder and its counters
+    struct RegisteredDecoder
+    {
+        DecoderMatchFunction matches = nullptr;
+        DecoderFunction decode = nullptr;
+        DecoderStats stats;
+    };
+
+    // Helper Function:    IsQOI
+    // -------------------------
+    // Matches the QOI magic and a complete header
+    static bool IsQOI(const unsigned char* data, size_t size)
+    {
+        return size >= 14 && memcmp(data, "qoif", 4) == 0;
+    }
+
+    // Helper Function:    MatchAny
+    // ----------------------------
+    // Accepts every file, used by the stb_image fallback
+    static bool MatchAny(const unsigned char*, size_t)
+    {
+        return true;
+    }
+
+    // Helper Function:    DecodeQOI
+    // -----------------------------
+    // Decodes a QOI image into RGBA pixels
+    // Three channel images decode with opaque alpha, as every op carries an alpha value.
+    static bool DecodeQOI(const unsigned char* data, size_t size, DecodedImage& outImage)
+    {
+        auto readBigEndian = [&](size_t offset) {
+            return (uint32_t)data[offset] << 24 | (uint32_t)data[offset + 1] << 16 | (uint32_t)data[offset + 2] << 8 | data[offset + 3];
+        };
+
+        const uint32_t width = readBigEndian(4);
+        const uint32_t height = readBigEndian(8);
+        const unsigned char channels = data[12];
+        if (width == 0 || height == 0 || width > 32768 || height > 32768 || (channels != 3 && channels != 4))
+            return false;
+
+        const size_t pixelCount = (size_t)width * height;
+        unsigned char* pixels = (unsigned char*)malloc(pixelCount * 4);
+        if (pixels == nullptr)
+            return false;
+
+        unsigned char index[64][4] = {};
+        unsigned char pixel[4] = { 0, 0, 0, 255 };
+        size_t position = 14;
+        int run = 0;
+
+        for (size_t i = 0; i < pixelCount; i++)
+        {
+            if (run > 0)
+                run--;
+            else
+            {
+                if (position >= size)
+                {
+                    free(pixels);
+                    return false;
+                }
+
+                const unsigned char op = data[position++];
+                if (op == 0xFE || op == 0xFF)
+                {
+                    // QOI_OP_RGB / QOI_OP_RGBA
+                    const size_t length = op == 0xFE ? 3 : 4;
+                    if (position + length > size)
+                    {
+                        free(pixels);
+                        return false;
+                    }
+                    memcpy(pixel, data + position, length);
+                    position += length;
+                }
+                else if ((op & 0xC0) == 0x00)
+                {
+                    // QOI_OP_INDEX
+                    memcpy(pixel, index[op], 4);
+                }
+                else if ((op & 0xC0) == 0x40)
+                {
+                    // QOI_OP_DIFF
+                    pixel[0] += ((op >> 4) & 0x03) - 2;
+                    pixel[1] += ((op >> 2) & 0x03) - 2;
+                    pixel[2] += (op & 0x03) - 2;
+                }
+                else if ((op & 0xC0) == 0x80)
+                {
+                    // QOI_OP_LUMA
+                    if (position >= size)
+                    {
+                        free(pixels);
+                        return false;
+                    }
+                    const unsigned char second = data[position++];
+                    const int greenDifference = (op & 0x3F) - 32;
+                    pixel[0] += greenDifference - 8 + ((second >> 4) & 0x0F);
+                    pixel[1] += greenDifference;
+                    pixel[2] += greenDifference - 8 + (second & 0x0F);
+                }
+                else
+                {
+                    // QOI_OP_RUN, this pixel plus the remaining count
+                    run = op & 0x3F;
+                }
+
+                memcpy(index[(pixel[0] * 3 + pixel[1] * 5 + pixel[2] * 7 + pixel[3] * 11) % 64], pixel, 4);
+            }
+
+            memcpy(pixels + i * 4, pixel, 4);
+        }
+
+        outImage.width = (int)width;
+        outImage.height = (int)height;
+        outImage.pixels = std::shared_ptr<unsigned char>(pixels, free);
+        return true;
+    }
+
+#ifdef IMGUIUTILS_HAS_SPNG
+    // Helper Function:    IsPNG
+    // -------------------------
+    // Matches the 8 byte PNG signature
+    static bool IsPNG(const unsigned char* data, size_t size)
+    {
+        static const unsigned char signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+        return size >= 8 && memcmp(data, signature, 8) == 0;
+    }
+
+    // Helper Function:    DecodeSPNG
+    // ------------------------------
+    // Decodes a PNG with libspng, expanding every color type and tRNS chunk to RGBA8
+    static bool DecodeSPNG(const unsigned char* data, size_t size, DecodedImage& outImage)
+    {
+        spng_ctx* context = spng_ctx_new(0);
+        if (context == nullptr)
+            return false;
+
+        spng_ihdr header;
+        size_t decodedSize = 0;
+        unsigned char* pixels = nullptr;
+        bool succeeded = spng_set_png_buffer(context, data, size) == 0 &&
+                         spng_get_ihdr(context, &header) == 0 &&
+                         spng_decoded_image_size(context, SPNG_FMT_RGBA8, &decodedSize) == 0 &&
+                         (pixels = (unsigned char*)malloc(decodedSize)) != nullptr &&
+                         spng_decode_image(context, pixels, decodedSize, SPNG_FMT_RGBA8, SPNG_DECODE_TRNS) == 0;
+        spng_ctx_free(context);
+
+        if (!succeeded)
+        {
+            free(pixels);
+            return false;
+        }
+
+        outImage.width = (int)header.width;
+        outImage.height = (int)header.height;
+        outImage.pixels = std::shared_ptr<unsigned char>(pixels, free);
+        return true;
+    }
+#endif
+
+#ifdef IMGUIUTILS_HAS_TURBOJPEG
+    // Helper Function:    IsJPEG
+    // --------------------------
+    // Matches the JPEG start of image marker
+    static bool IsJPEG(const unsigned char* data, size_t size)
+    {
+        return size >= 3 && data[0] == 0xFF && data[1] == 0xD8 && data[2] == 0xFF;
+    }
+
+    // Helper Function:    DecodeTurboJPEG
+    // -----------------------------------
+    // Decodes a JPEG with libjpeg-turbo's SIMD decoder straight into RGBA
+    static bool DecodeTurboJPEG(const unsigned char* data, size_t size, DecodedImage& outImage)
+    {
+        tjhandle handle = tjInitDecompress();
+        if (handle == nullptr)
+            return false;
+
+        int width = 0, height = 0, subsampling = 0, colorspace = 0;
+        unsigned char* pixels = nullptr;
+        bool succeeded = tjDecompressHeader3(handle, data, (unsigned long)size, &width, &height, &subsampling, &colorspace) == 0 &&
+                         (pixels = (unsigned char*)malloc((size_t)width * height * 4)) != nullptr &&
+                         tjDecompress2(handle, data, (unsigned long)size, pixels, width, 0, height, TJPF_RGBA, TJFLAG_FASTDCT) == 0;
+        tjDestroy(handle);
+
+        if (!succeeded)
+        {
+            free(pixels);
+            return false;
+        }
+
+        outImage.width = width;
+        outImage.height = height;
+        outImage.pixels = std::shared_ptr<unsigned char>(pixels, free);
+        return true;
+    }
+#endif
+
+    // Helper Function:    DecodeSTB
+    // -----------------------------
+    // Decodes any format stb_image supports into RGBA
+    static bool DecodeSTB(const unsigned char* data, size_t size, DecodedImage& outImage)
+    {
+        int width = 0;
+        int height = 0;
+        unsigned char* pixels = stbi_load_from_memory(data, (int)size, &width, &height, NULL, 4);
+        if (pixels == NULL)
+            return false;
+
+        outImage.width = width;
+        outImage.height = height;
+        outImage.pixels = std::shared_ptr<unsigned char>(pixels, stbi_image_free);
+        return true;
+    }
+
+    static std::mutex registryMutex;
+
+    // Helper Function:    Registry
+    // ----------------------------
+    // Returns the decoder list in the order they are tried, built-ins last and stb_image at the end
+    // Callers hold registryMutex.
+    static std::vector<RegisteredDecoder>& Registry()
+    {
+        static std::vector<RegisteredDecoder> decoders = []() {
+            std::vector<RegisteredDecoder> builtIn;
+            auto add = [&](const char* name, DecoderMatchFunction matches, DecoderFunction decode) {
+                builtIn.push_back(RegisteredDecoder{ matches, decode, DecoderStats{ name } });
+            };
+            add("qoi", IsQOI, DecodeQOI);
+#ifdef IMGUIUTILS_HAS_SPNG
+            add("spng", IsPNG, DecodeSPNG);
+#endif
+#ifdef IMGUIUTILS_HAS_TURBOJPEG
+            add("turbojpeg", IsJPEG, DecodeTurboJPEG);
+#endif
+            add("stb_image", MatchAny, DecodeSTB);
+            return builtIn;
+        }();
+        return decoders;
+    }
+
+    // Helper Function:    RunDecoder
+    // ------------------------------
+    // Decodes with the decoder at a registry position and adds the work to its counters
+    static bool RunDecoder(size_t position, const unsigned char* data, size_t size, DecodedImage& outImage)
+    {
+        DecoderFunction decode;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            decode = Registry()[position].decode;
+        }
+
+        outImage = DecodedImage();
+        const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+        const bool succeeded = decode(data, size, outImage);
+        const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::lock_guard<std::mutex> lock(registryMutex);
+        DecoderStats& stats = Registry()[position].stats;
+        stats.seconds += seconds;
+        stats.inputBytes += size;
+        if (succeeded)
+        {
+            stats.images++;
+            stats.outputBytes += (size_t)outImage.width * outImage.height * 4;
+        }
+        else
+            stats.failures++;
+        return succeeded;
+    }
+
+    // Function:    RegisterDecoder
+    // ----------------------------
+    // Adds a decoder ahead of every decoder already registered
+    // Register decoders at startup, before any loading thread runs.
+    //
+    // string name:                 name reported in DecoderStats and used by DecodeImageWith
+    // DecoderMatchFunction matches: checks the magic bytes of a file
+    // DecoderFunction decode:      decodes a matching file into RGBA pixels
+    void RegisterDecoder(const std::string& name, DecoderMatchFunction matches, DecoderFunction decode)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::vector<RegisteredDecoder>& decoders = Registry();
+        decoders.insert(decoders.begin(), RegisteredDecoder{ matches, decode, DecoderStats{ name } });
+    }
+
+    // Function:    DecodeImage
+    // ------------------------
+    // Decodes a file with the first decoder whose signature matches
+    // If that decoder fails, stb_image gets a second attempt unless it was the one that failed.
+    //
+    // const void* data:        pointer to the encoded file in memory
+    // size_t size:             size of the file in bytes
+    // DecodedImage outImage:   receives the RGBA pixels
+    //
+    // Returns true if the image was decoded
+    bool DecodeImage(const void* data, size_t size, DecodedImage& outImage)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        size_t chosen = 0, fallback = 0;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            const std::vector<RegisteredDecoder>& decoders = Registry();
+            while (chosen + 1 < decoders.size() && !decoders[chosen].matches(bytes, size))
+                chosen++;
+            fallback = decoders.size() - 1;
+        }
+
+        if (RunDecoder(chosen, bytes, size, outImage))
+            return true;
+        return chosen != fallback && RunDecoder(fallback, bytes, size, outImage);
+    }
+
+    // Function:    DecodeImageWith
+    // ----------------------------
+    // Decodes a file with a named decoder, whether or not its signature matches
+    //
+    // string name:             decoder to use
+    // const void* data:        pointer to the encoded file in memory
+    // size_t size:             size of the file in bytes
+    // DecodedImage outImage:   receives the RGBA pixels
+    //
+    // Returns true if the decoder exists and decoded the image
+    bool DecodeImageWith(const std::string& name, const void* data, size_t size, DecodedImage& outImage)
+    {
+        size_t position = 0;
+        {
+            std::lock_guard<std::mutex> lock(registryMutex);
+            const std::vector<RegisteredDecoder>& decoders = Registry();
+            while (position < decoders.size() && decoders[position].stats.name != name)
+                position++;
+            if (position == decoders.size())
+                return false;
+        }
+        return RunDecoder(position, (const unsigned char*)data, size, outImage);
+    }
+
+    // Function:    MatchingDecoders
+    // -----------------------------
+    // Lists the decoders whose signature accepts a file, including the stb_image fallback
+    std::vector<std::string> MatchingDecoders(const void* data, size_t size)
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::vector<std::string> names;
+        for (const RegisteredDecoder& decoder : Registry())
+            if (decoder.matches((const unsigned char*)data, size))
+                names.push_back(decoder.stats.name);
+        return names;
+    }
+
+    // Function:    GetDecoderStats
+    // ----------------------------
+    // Returns a copy of every decoder's throughput counters
+    std::vector<DecoderStats> GetDecoderStats()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        std::vector<DecoderStats> stats;
+        for (const RegisteredDecoder& decoder : Registry())
+            stats.push_back(decoder.stats);
+        return stats;
+    }
+
+    // Function:    ResetDecoderStats
+    // ------------------------------
+    // Zeroes every decoder's throughput counters
+    void ResetDecoderStats()
+    {
+        std::lock_guard<std::mutex> lock(registryMutex);
+        for (RegisteredDecoder& decoder : Registry())
+            decoder.stats = DecoderStats{ decoder.stats.name };
+    }
+}
@@ -0,0 +1,68 @@
+/*
+ * ImageDecoders.h
+ *
+ * Header of a registry of image decoders chosen by the magic bytes at the start of a file.
+ * QOI is decoded natively; PNG and JPEG use libspng and libjpeg-turbo when the build defines
+ * IMGUIUTILS_HAS_SPNG / IMGUIUTILS_HAS_TURBOJPEG, and stb_image handles everything else.
+ * Applications can register their own decoders, which are tried before the built-in ones.
+ * Every decoder keeps throughput counters so backends can be compared on real assets.
+ */
+#ifndef IMAGEDECODERS_H
+#define IMAGEDECODERS_H
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#include "TextureTools.h"
+
+// Structure:   DecoderStats
+// -------------------------
+// Work done by one decoder since the last Texture::ResetDecoderStats
+//
+// string name:         name the decoder was registered under
+// int images:          images decoded successfully
+// int failures:        images the decoder accepted but could not decode
+// size_t inputBytes:   encoded bytes consumed
+// size_t outputBytes:  RGBA bytes produced
+// double seconds:      time spent decoding, summed across threads
+struct DecoderStats
+{
+    std::string name;
+    int images = 0;
+    int failures = 0;
+    size_t inputBytes = 0;
+    size_t outputBytes = 0;
+    double seconds = 0.0;
+
+    // Decoded RGBA megabytes produced per second of decoding
+    double MegabytesPerSecond() const { return seconds > 0.0 ? outputBytes / 1e6 / seconds : 0.0; }
+};
+
+namespace Texture
+{
+    // Checks whether a decoder understands the file starting at data
+    using DecoderMatchFunction = bool (*)(const unsigned char* data, size_t size);
+
+    // Decodes a whole file into RGBA pixels, safe to call from any thread
+    using DecoderFunction = bool (*)(const unsigned char* data, size_t size, DecodedImage& outImage);
+
+    // Register a decoder, tried before every decoder registered earlier and the built-in ones
+    void RegisterDecoder(const std::string& name, DecoderMatchFunction matches, DecoderFunction decode);
+
+    // Decode with the first decoder whose signature matches, falling back to stb_image
+    bool DecodeImage(const void* data, size_t size, DecodedImage& outImage);
+
+    // Decode with a specific decoder by name, for comparing backends
+    bool DecodeImageWith(const std::string& name, const void* data, size_t size, DecodedImage& outImage);
+
+    // Names of the decoders that accept a file, in the order DecodeImage tries them
+    std::vector<std::string> MatchingDecoders(const void* data, size_t size);
+
+    // Throughput counters of every registered decoder
+    std::vector<DecoderStats> GetDecoderStats();
+
+    // Zero the throughput counters
+    void ResetDecoderStats();
+}
+
+#endif //IMAGEDECODERS_H
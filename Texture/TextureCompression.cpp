@@ -0,0 +1,582 @@
+/*
+ * TextureCompression.cpp
+ *
+ * Source file implementation of helpers for GPU block-compressed textures. Containers are
+ * parsed without any external dependency; BC1/BC3 decoding follows the S3TC specification and
+ * the encoder uses a bounding-box ("range fit") endpoint search, which is fast enough to batch
+ * convert an asset directory and close to the quality of slower cluster-fit encoders on photos.
+ */
+#include "TextureCompression.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstdio>
+#include <cstring>
+
+namespace Texture
+{
+    // Helper Function:    ReadU32
+    // ----------------------------
+    // Reads a little-endian 32-bit value from an unaligned address
+    static uint32_t ReadU32(const unsigned char* p)
+    {
+        return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+    }
+
+    // Helper Function:    ReadU64
+    // ----------------------------
+    // Reads a little-endian 64-bit value from an unaligned address
+    static uint64_t ReadU64(const unsigned char* p)
+    {
+        return (uint64_t)ReadU32(p) | ((uint64_t)ReadU32(p + 4) << 32);
+    }
+
+    // Helper Function:    WriteU32
+    // -----------------------------
+    // Writes a little-endian 32-bit value to an unaligned address
+    static void WriteU32(unsigned char* p, uint32_t value)
+    {
+        p[0] = (unsigned char)value;
+        p[1] = (unsigned char)(value >> 8);
+        p[2] = (unsigned char)(value >> 16);
+        p[3] = (unsigned char)(value >> 24);
+    }
+
+    // Container signatures and identifiers
+    static const unsigned char KTX2Identifier[12] = { 0xAB, 'K', 'T', 'X', ' ', '2', '0', 0xBB, '\r', '\n', 0x1A, '\n' };
+    constexpr uint32_t FourCC_DDS  = 0x20534444; // "DDS "
+    constexpr uint32_t FourCC_DXT1 = 0x31545844; // "DXT1"
+    constexpr uint32_t FourCC_DXT5 = 0x35545844; // "DXT5"
+    constexpr uint32_t FourCC_DX10 = 0x30315844; // "DX10"
+
+    // Helper Function:    AppendLevels
+    // ---------------------------------
+    // Fills in the level table of an image whose levels are stored back to back, largest first
+    //
+    // Returns false if the data is too short for the declared levels
+    static bool AppendLevels(CompressedImage& image, const unsigned char* blocks, size_t available, int width, int height, int levelCount)
+    {
+        const size_t blockSize = CompressedBlockSize(image.format);
+        size_t offset = 0;
+
+        for (int level = 0; level < levelCount; level++)
+        {
+            CompressedLevel entry;
+            entry.width = std::max(1, width >> level);
+            entry.height = std::max(1, height >> level);
+            entry.offset = offset;
+            entry.size = (size_t)((entry.width + 3) / 4) * (size_t)((entry.height + 3) / 4) * blockSize;
+            if (offset + entry.size > available)
+                break;
+            image.levels.push_back(entry);
+            offset += entry.size;
+        }
+
+        image.data.assign(blocks, blocks + offset);
+        return !image.levels.empty();
+    }
+
+    // Helper Function:    ParseDDS
+    // -----------------------------
+    // Reads a DDS container holding DXT1, DXT5 or DX10 BC1/BC3/BC7 data
+    static bool ParseDDS(const unsigned char* bytes, size_t dataSize, CompressedImage& outImage)
+    {
+        if (dataSize < 128)
+            return false;
+
+        const unsigned char* header = bytes + 4;
+        const int height = (int)ReadU32(header + 8);
+        const int width = (int)ReadU32(header + 12);
+        const int levelCount = std::max(1, (int)ReadU32(header + 24));
+        const uint32_t pixelFormatFlags = ReadU32(header + 76);
+        const uint32_t fourCC = ReadU32(header + 80);
+        size_t dataOffset = 128;
+
+        if ((pixelFormatFlags & 0x4) == 0) // DDPF_FOURCC
+            return false;
+
+        if (fourCC == FourCC_DXT1)
+            outImage.format = CompressedFormat::BC1;
+        else if (fourCC == FourCC_DXT5)
+            outImage.format = CompressedFormat::BC3;
+        else if (fourCC == FourCC_DX10 && dataSize >= 148)
+        {
+            const uint32_t dxgiFormat = ReadU32(bytes + 128);
+            switch (dxgiFormat)
+            {
+                case 71: case 72: outImage.format = CompressedFormat::BC1; break;
+                case 77: case 78: outImage.format = CompressedFormat::BC3; break;
+                case 98: case 99: outImage.format = CompressedFormat::BC7; break;
+                default: return false;
+            }
+            outImage.srgb = dxgiFormat == 72 || dxgiFormat == 78 || dxgiFormat == 99;
+            dataOffset = 148;
+        }
+        else
+            return false;
+
+        return AppendLevels(outImage, bytes + dataOffset, dataSize - dataOffset, width, height, levelCount);
+    }
+
+    // Helper Function:    ParseKTX2
+    // ------------------------------
+    // Reads a KTX2 container holding a single 2D BC1/BC3/BC7/ETC2 image without supercompression
+    static bool ParseKTX2(const unsigned char* bytes, size_t dataSize, CompressedImage& outImage)
+    {
+        if (dataSize < 80)
+            return false;
+
+        const uint32_t vkFormat = ReadU32(bytes + 12);
+        const int width = (int)ReadU32(bytes + 20);
+        const int height = (int)ReadU32(bytes + 24);
+        const uint32_t depth = ReadU32(bytes + 28);
+        const uint32_t layerCount = ReadU32(bytes + 32);
+        const uint32_t faceCount = ReadU32(bytes + 36);
+        const int levelCount = std::max(1, (int)ReadU32(bytes + 40));
+        const uint32_t supercompression = ReadU32(bytes + 44);
+
+        if (depth > 1 || layerCount > 1 || faceCount != 1 || supercompression != 0)
+            return false;
+
+        switch (vkFormat)
+        {
+            case 131: case 132: case 133: case 134: outImage.format = CompressedFormat::BC1; break;
+            case 137: case 138:                     outImage.format = CompressedFormat::BC3; break;
+            case 145: case 146:                     outImage.format = CompressedFormat::BC7; break;
+            case 147: case 148:                     outImage.format = CompressedFormat::ETC2_RGB8; break;
+            case 151: case 152:                     outImage.format = CompressedFormat::ETC2_RGBA8; break;
+            default: return false;
+        }
+        outImage.srgb = vkFormat == 132 || vkFormat == 134 || vkFormat == 138 || vkFormat == 146 || vkFormat == 148 || vkFormat == 152;
+        outImage.alpha = vkFormat != 131 && vkFormat != 132; // BC1_RGB blocks are opaque
+
+        if (dataSize < 80 + (size_t)levelCount * 24)
+            return false;
+
+        // KTX2 stores levels smallest first with explicit offsets, gather them largest first
+        const size_t blockSize = CompressedBlockSize(outImage.format);
+        for (int level = 0; level < levelCount; level++)
+        {
+            const unsigned char* entry = bytes + 80 + level * 24;
+            const uint64_t offset = ReadU64(entry);
+            const uint64_t length = ReadU64(entry + 8);
+
+            CompressedLevel levelInfo;
+            levelInfo.width = std::max(1, width >> level);
+            levelInfo.height = std::max(1, height >> level);
+            levelInfo.size = (size_t)((levelInfo.width + 3) / 4) * (size_t)((levelInfo.height + 3) / 4) * blockSize;
+            levelInfo.offset = outImage.data.size();
+            // Compared without adding, so a huge offset cannot wrap past the check
+            if (offset > dataSize || length > dataSize - offset || length < levelInfo.size)
+                break;
+
+            outImage.data.insert(outImage.data.end(), bytes + offset, bytes + offset + levelInfo.size);
+            outImage.levels.push_back(levelInfo);
+        }
+
+        return !outImage.levels.empty();
+    }
+
+    // Function:    IsCompressedContainer
+    // ----------------------------------
+    // Checks the first bytes of a file for a DDS or KTX2 signature
+    //
+    // const void* data:     pointer to the file contents
+    // size_t dataSize:      size of the file contents in bytes
+    //
+    // Returns true if the data should be handed to ParseCompressedContainer
+    bool IsCompressedContainer(const void* data, size_t dataSize)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        if (dataSize >= 4 && ReadU32(bytes) == FourCC_DDS)
+            return true;
+        return dataSize >= sizeof(KTX2Identifier) && memcmp(bytes, KTX2Identifier, sizeof(KTX2Identifier)) == 0;
+    }
+
+    // Function:    ParseCompressedContainer
+    // -------------------------------------
+    // Reads the block format, mip levels and block data out of a DDS or KTX2 file
+    //
+    // const void* data:            pointer to the file contents
+    // size_t dataSize:             size of the file contents in bytes
+    // CompressedImage outImage:    receives the parsed image
+    //
+    // Returns true if the container holds a supported 2D image
+    bool ParseCompressedContainer(const void* data, size_t dataSize, CompressedImage& outImage)
+    {
+        const unsigned char* bytes = (const unsigned char*)data;
+        outImage = CompressedImage();
+
+        if (dataSize >= 4 && ReadU32(bytes) == FourCC_DDS)
+            return ParseDDS(bytes, dataSize, outImage);
+        if (IsCompressedContainer(data, dataSize))
+            return ParseKTX2(bytes, dataSize, outImage);
+        return false;
+    }
+
+    // Function:    CompressedBlockSize
+    // --------------------------------
+    // Returns the size in bytes of one 4x4 block of a format
+    int CompressedBlockSize(CompressedFormat format)
+    {
+        return (format == CompressedFormat::BC1 || format == CompressedFormat::ETC2_RGB8) ? 8 : 16;
+    }
+
+    // Function:    CompressedGLFormat
+    // -------------------------------
+    // Returns the OpenGL internal format passed to glCompressedTexImage2D for a block format
+    // sRGB blocks map to the *_SRGB formats so the GPU linearizes them when sampling, and BC1
+    // without alpha maps to the RGB DXT1 formats so its fourth palette entry stays opaque black
+    unsigned int CompressedGLFormat(CompressedFormat format, bool srgb, bool alpha)
+    {
+        if (format == CompressedFormat::BC1 && !alpha)
+            return srgb ? 0x8C4C : 0x83F0; // GL_COMPRESSED_SRGB_S3TC_DXT1_EXT, GL_COMPRESSED_RGB_S3TC_DXT1_EXT
+
+        if (srgb)
+        {
+            switch (format)
+            {
+                case CompressedFormat::BC1:        return 0x8C4D; // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT
+                case CompressedFormat::BC3:        return 0x8C4F; // GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT
+                case CompressedFormat::BC7:        return 0x8E8D; // GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM
+                case CompressedFormat::ETC2_RGB8:  return 0x9275; // GL_COMPRESSED_SRGB8_ETC2
+                case CompressedFormat::ETC2_RGBA8: return 0x9279; // GL_COMPRESSED_SRGB8_ALPHA8_ETC2_EAC
+            }
+            return 0;
+        }
+
+        switch (format)
+        {
+            case CompressedFormat::BC1:        return 0x83F1; // GL_COMPRESSED_RGBA_S3TC_DXT1_EXT
+            case CompressedFormat::BC3:        return 0x83F3; // GL_COMPRESSED_RGBA_S3TC_DXT5_EXT
+            case CompressedFormat::BC7:        return 0x8E8C; // GL_COMPRESSED_RGBA_BPTC_UNORM
+            case CompressedFormat::ETC2_RGB8:  return 0x9274; // GL_COMPRESSED_RGB8_ETC2
+            case CompressedFormat::ETC2_RGBA8: return 0x9278; // GL_COMPRESSED_RGBA8_ETC2_EAC
+        }
+        return 0;
+    }
+
+    // Helper Function:    Expand565
+    // ------------------------------
+    // Expands a 5:6:5 color to 8 bits per channel, writing opaque RGBA
+    static void Expand565(uint16_t color, unsigned char* rgba)
+    {
+        const int r = (color >> 11) & 31;
+        const int g = (color >> 5) & 63;
+        const int b = color & 31;
+        rgba[0] = (unsigned char)((r << 3) | (r >> 2));
+        rgba[1] = (unsigned char)((g << 2) | (g >> 4));
+        rgba[2] = (unsigned char)((b << 3) | (b >> 2));
+        rgba[3] = 255;
+    }
+
+    // Helper Function:    BuildColorPalette
+    // ----------------------------------------
+    // Derives the four palette entries of a BC1 color block
+    // BC3 color blocks always use four colors regardless of endpoint order
+    static void BuildColorPalette(uint16_t color0, uint16_t color1, bool forceFourColors, unsigned char palette[4][4])
+    {
+        Expand565(color0, palette[0]);
+        Expand565(color1, palette[1]);
+
+        for (int channel = 0; channel < 3; channel++)
+        {
+            const int a = palette[0][channel];
+            const int b = palette[1][channel];
+            if (color0 > color1 || forceFourColors)
+            {
+                palette[2][channel] = (unsigned char)((2 * a + b) / 3);
+                palette[3][channel] = (unsigned char)((a + 2 * b) / 3);
+            }
+            else
+            {
+                palette[2][channel] = (unsigned char)((a + b) / 2);
+                palette[3][channel] = 0;
+            }
+        }
+        palette[2][3] = 255;
+        palette[3][3] = (color0 > color1 || forceFourColors) ? 255 : 0;
+    }
+
+    // Helper Function:    BuildAlphaPalette
+    // --------------------------------------
+    // Derives the eight alpha values of a BC3 alpha block
+    static void BuildAlphaPalette(int alpha0, int alpha1, unsigned char palette[8])
+    {
+        palette[0] = (unsigned char)alpha0;
+        palette[1] = (unsigned char)alpha1;
+        if (alpha0 > alpha1)
+        {
+            for (int i = 1; i < 7; i++)
+                palette[i + 1] = (unsigned char)(((7 - i) * alpha0 + i * alpha1) / 7);
+        }
+        else
+        {
+            for (int i = 1; i < 5; i++)
+                palette[i + 1] = (unsigned char)(((5 - i) * alpha0 + i * alpha1) / 5);
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    // Function:    DecodeCompressed
+    // -----------------------------
+    // Decodes one mip level of a BC1 or BC3 image to 8-bit RGBA on the CPU
+    // Used when the GL context cannot sample the format and by headless tools
+    //
+    // CompressedImage image:   parsed compressed image
+    // int level:               mip level to decode
+    // vector outPixels:        receives width * height * 4 bytes
+    //
+    // Returns false for formats without a CPU decoder (BC7, ETC2)
+    bool DecodeCompressed(const CompressedImage& image, int level, std::vector<unsigned char>& outPixels)
+    {
+        if (level < 0 || level >= (int)image.levels.size())
+            return false;
+        if (image.format != CompressedFormat::BC1 && image.format != CompressedFormat::BC3)
+            return false;
+
+        const CompressedLevel& info = image.levels[level];
+        const bool hasAlphaBlock = image.format == CompressedFormat::BC3;
+        const bool opaque = image.format == CompressedFormat::BC1 && !image.alpha;
+        const int blocksWide = (info.width + 3) / 4;
+        const int blocksHigh = (info.height + 3) / 4;
+        const unsigned char* block = image.data.data() + info.offset;
+
+        outPixels.assign((size_t)info.width * info.height * 4, 0);
+
+        for (int blockY = 0; blockY < blocksHigh; blockY++)
+        {
+            for (int blockX = 0; blockX < blocksWide; blockX++, block += CompressedBlockSize(image.format))
+            {
+                unsigned char alphas[8] = {};
+                uint64_t alphaBits = 0;
+                const unsigned char* colorBlock = block;
+                if (hasAlphaBlock)
+                {
+                    BuildAlphaPalette(block[0], block[1], alphas);
+                    for (int i = 0; i < 6; i++)
+                        alphaBits |= (uint64_t)block[2 + i] << (8 * i);
+                    colorBlock = block + 8;
+                }
+
+                unsigned char palette[4][4];
+                const uint16_t color0 = (uint16_t)(colorBlock[0] | (colorBlock[1] << 8));
+                const uint16_t color1 = (uint16_t)(colorBlock[2] | (colorBlock[3] << 8));
+                BuildColorPalette(color0, color1, hasAlphaBlock, palette);
+                const uint32_t colorBits = ReadU32(colorBlock + 4);
+
+                for (int pixel = 0; pixel < 16; pixel++)
+                {
+                    const int x = blockX * 4 + (pixel & 3);
+                    const int y = blockY * 4 + (pixel >> 2);
+                    if (x >= info.width || y >= info.height)
+                        continue;
+
+                    unsigned char* out = outPixels.data() + ((size_t)y * info.width + x) * 4;
+                    memcpy(out, palette[(colorBits >> (2 * pixel)) & 3], 4);
+                    if (hasAlphaBlock)
+                        out[3] = alphas[(alphaBits >> (3 * pixel)) & 7];
+                    else if (opaque)
+                        out[3] = 255;
+                }
+            }
+        }
+
+        return true;
+    }
+
+    // Helper Function:    To565
+    // --------------------------
+    // Quantizes an 8-bit RGB color to 5:6:5 with rounding
+    static uint16_t To565(int r, int g, int b)
+    {
+        return (uint16_t)(((r * 31 + 127) / 255) << 11 | ((g * 63 + 127) / 255) << 5 | ((b * 31 + 127) / 255));
+    }
+
+    // Helper Function:    EncodeColorBlock
+    // -------------------------------------
+    // Encodes 16 RGBA pixels to an 8-byte four-color BC1 block
+    // Endpoints are the per-channel bounding box inset by 1/16 of its size; every pixel then
+    // picks the closest palette entry
+    static void EncodeColorBlock(const unsigned char pixels[16][4], unsigned char* out)
+    {
+        int minimum[3] = { 255, 255, 255 };
+        int maximum[3] = { 0, 0, 0 };
+        for (int pixel = 0; pixel < 16; pixel++)
+        {
+            for (int channel = 0; channel < 3; channel++)
+            {
+                minimum[channel] = std::min(minimum[channel], (int)pixels[pixel][channel]);
+                maximum[channel] = std::max(maximum[channel], (int)pixels[pixel][channel]);
+            }
+        }
+        for (int channel = 0; channel < 3; channel++)
+        {
+            const int inset = (maximum[channel] - minimum[channel]) / 16;
+            minimum[channel] += inset;
+            maximum[channel] -= inset;
+        }
+
+        uint16_t color0 = To565(maximum[0], maximum[1], maximum[2]);
+        uint16_t color1 = To565(minimum[0], minimum[1], minimum[2]);
+        if (color0 < color1)
+            std::swap(color0, color1);
+
+        unsigned char palette[4][4];
+        BuildColorPalette(color0, color1, true, palette);
+
+        uint32_t bits = 0;
+        if (color0 != color1)
+        {
+            for (int pixel = 0; pixel < 16; pixel++)
+            {
+                int best = 0;
+                int bestDistance = 1 << 30;
+                for (int entry = 0; entry < 4; entry++)
+                {
+                    int distance = 0;
+                    for (int channel = 0; channel < 3; channel++)
+                    {
+                        const int delta = (int)pixels[pixel][channel] - palette[entry][channel];
+                        distance += delta * delta;
+                    }
+                    if (distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        best = entry;
+                    }
+                }
+                bits |= (uint32_t)best << (2 * pixel);
+            }
+        }
+
+        out[0] = (unsigned char)color0;
+        out[1] = (unsigned char)(color0 >> 8);
+        out[2] = (unsigned char)color1;
+        out[3] = (unsigned char)(color1 >> 8);
+        WriteU32(out + 4, bits);
+    }
+
+    // Helper Function:    EncodeAlphaBlock
+    // -------------------------------------
+    // Encodes the alpha of 16 pixels to an 8-byte BC3 alpha block using the eight-value mode
+    static void EncodeAlphaBlock(const unsigned char pixels[16][4], unsigned char* out)
+    {
+        int alpha0 = 0;
+        int alpha1 = 255;
+        for (int pixel = 0; pixel < 16; pixel++)
+        {
+            alpha0 = std::max(alpha0, (int)pixels[pixel][3]);
+            alpha1 = std::min(alpha1, (int)pixels[pixel][3]);
+        }
+
+        unsigned char palette[8];
+        BuildAlphaPalette(alpha0, alpha1, palette);
+
+        uint64_t bits = 0;
+        if (alpha0 != alpha1)
+        {
+            for (int pixel = 0; pixel < 16; pixel++)
+            {
+                int best = 0;
+                for (int entry = 1; entry < 8; entry++)
+                {
+                    if (std::abs(pixels[pixel][3] - palette[entry]) < std::abs(pixels[pixel][3] - palette[best]))
+                        best = entry;
+                }
+                bits |= (uint64_t)best << (3 * pixel);
+            }
+        }
+
+        out[0] = (unsigned char)alpha0;
+        out[1] = (unsigned char)alpha1;
+        for (int i = 0; i < 6; i++)
+            out[2 + i] = (unsigned char)(bits >> (8 * i));
+    }
+
+    // Function:    EncodeCompressed
+    // -----------------------------
+    // Encodes an RGBA image to BC1 or BC3 blocks, replicating edge pixels into partial blocks
+    //
+    // const unsigned char* rgbaPixels: tightly packed 8-bit RGBA pixels
+    // int width:                       width of the image in pixels
+    // int height:                      height of the image in pixels
+    // CompressedFormat format:         BC1 or BC3
+    //
+    // Returns the encoded blocks, empty for unsupported formats
+    std::vector<unsigned char> EncodeCompressed(const unsigned char* rgbaPixels, int width, int height, CompressedFormat format)
+    {
+        if (format != CompressedFormat::BC1 && format != CompressedFormat::BC3)
+            return {};
+
+        const int blockSize = CompressedBlockSize(format);
+        const int blocksWide = (width + 3) / 4;
+        const int blocksHigh = (height + 3) / 4;
+        std::vector<unsigned char> blocks((size_t)blocksWide * blocksHigh * blockSize);
+        unsigned char* out = blocks.data();
+
+        for (int blockY = 0; blockY < blocksHigh; blockY++)
+        {
+            for (int blockX = 0; blockX < blocksWide; blockX++, out += blockSize)
+            {
+                unsigned char pixels[16][4];
+                for (int pixel = 0; pixel < 16; pixel++)
+                {
+                    const int x = std::min(blockX * 4 + (pixel & 3), width - 1);
+                    const int y = std::min(blockY * 4 + (pixel >> 2), height - 1);
+                    memcpy(pixels[pixel], rgbaPixels + ((size_t)y * width + x) * 4, 4);
+                }
+
+                if (format == CompressedFormat::BC3)
+                {
+                    EncodeAlphaBlock(pixels, out);
+                    EncodeColorBlock(pixels, out + 8);
+                }
+                else
+                    EncodeColorBlock(pixels, out);
+            }
+        }
+
+        return blocks;
+    }
+
+    // Function:    WriteDDS
+    // ---------------------
+    // Writes BC1 or BC3 blocks to disk as a single-level DDS file
+    //
+    // string path:             destination file
+    // const unsigned char*:    encoded blocks
+    // size_t blocksSize:       size of the encoded blocks in bytes
+    // int width, height:       dimensions of the image in pixels
+    // CompressedFormat format: BC1 or BC3
+    //
+    // Returns true if the file was written completely
+    bool WriteDDS(const std::string& path, const unsigned char* blocks, size_t blocksSize, int width, int height, CompressedFormat format)
+    {
+        if (format != CompressedFormat::BC1 && format != CompressedFormat::BC3)
+            return false;
+
+        unsigned char header[128] = {};
+        WriteU32(header, FourCC_DDS);
+        WriteU32(header + 4, 124);                                      // dwSize
+        WriteU32(header + 8, 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000); // CAPS, HEIGHT, WIDTH, PIXELFORMAT, MIPMAPCOUNT, LINEARSIZE
+        WriteU32(header + 12, (uint32_t)height);
+        WriteU32(header + 16, (uint32_t)width);
+        WriteU32(header + 20, (uint32_t)blocksSize);                    // dwPitchOrLinearSize
+        WriteU32(header + 28, 1);                                       // dwMipMapCount
+        WriteU32(header + 76, 32);                                      // ddspf.dwSize
+        WriteU32(header + 80, 0x4);                                     // DDPF_FOURCC
+        WriteU32(header + 84, format == CompressedFormat::BC1 ? FourCC_DXT1 : FourCC_DXT5);
+        WriteU32(header + 108, 0x1000);                                 // DDSCAPS_TEXTURE
+
+        FILE* f = fopen(path.c_str(), "wb");
+        if (f == NULL)
+            return false;
+        const bool written = fwrite(header, 1, sizeof(header), f) == sizeof(header)
+                          && fwrite(blocks, 1, blocksSize, f) == blocksSize;
+        fclose(f);
+        return written;
+    }
+}
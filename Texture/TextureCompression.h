@@ -0,0 +1,84 @@
+/*
+ * TextureCompression.h
+ *
+ * Header of helpers for GPU block-compressed textures. They parse pre-compressed DDS and
+ * KTX2 containers (BC1, BC3, BC7, ETC2), decode BC1/BC3 blocks on the CPU for contexts that
+ * cannot sample them natively, and encode RGBA images to BC1/BC3 for offline transcoding.
+ */
+#ifndef TEXTURECOMPRESSION_H
+#define TEXTURECOMPRESSION_H
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Enum:    CompressedFormat
+// -------------------------
+// Block-compressed pixel formats understood by the texture loader
+enum class CompressedFormat
+{
+    BC1,        // 4x4 blocks of 8 bytes, RGB with 1-bit alpha
+    BC3,        // 4x4 blocks of 16 bytes, RGB with interpolated alpha
+    BC7,        // 4x4 blocks of 16 bytes, high quality RGBA
+    ETC2_RGB8,  // 4x4 blocks of 8 bytes, RGB
+    ETC2_RGBA8  // 4x4 blocks of 16 bytes, RGB with EAC alpha
+};
+
+// Structure:   CompressedLevel
+// ----------------------------
+// One mip level of a compressed image
+//
+// int width:       width of the level in pixels
+// int height:      height of the level in pixels
+// size_t offset:   start of the level's blocks within CompressedImage::data
+// size_t size:     size of the level's blocks in bytes
+struct CompressedLevel
+{
+    int width = 0;
+    int height = 0;
+    size_t offset = 0;
+    size_t size = 0;
+};
+
+// Structure:   CompressedImage
+// ----------------------------
+// A block-compressed image and its mip chain, as stored in a DDS or KTX2 container
+//
+// CompressedFormat format:         block format of every level
+// bool srgb:                       whether the blocks hold sRGB-encoded color
+// bool alpha:                      whether BC1 blocks carry 1-bit alpha, false for opaque BC1
+// vector levels:                   mip levels, largest first
+// vector data:                     block data of every level
+struct CompressedImage
+{
+    CompressedFormat format = CompressedFormat::BC1;
+    bool srgb = false;
+    bool alpha = true;
+    std::vector<CompressedLevel> levels;
+    std::vector<unsigned char> data;
+};
+
+namespace Texture
+{
+    // Whether a block of memory starts with a DDS or KTX2 signature
+    bool IsCompressedContainer(const void* data, size_t dataSize);
+
+    // Parse a DDS or KTX2 container
+    bool ParseCompressedContainer(const void* data, size_t dataSize, CompressedImage& outImage);
+
+    // Size in bytes of one 4x4 block
+    int CompressedBlockSize(CompressedFormat format);
+
+    // OpenGL internal format enum of a block format, the *_SRGB variant when srgb is set and the RGB variant of BC1 without alpha
+    unsigned int CompressedGLFormat(CompressedFormat format, bool srgb = false, bool alpha = true);
+
+    // Decode one level to tightly packed RGBA, supported for BC1 and BC3
+    bool DecodeCompressed(const CompressedImage& image, int level, std::vector<unsigned char>& outPixels);
+
+    // Encode tightly packed RGBA pixels to BC1 or BC3 blocks
+    std::vector<unsigned char> EncodeCompressed(const unsigned char* rgbaPixels, int width, int height, CompressedFormat format);
+
+    // Write a single-level BC1 or BC3 image as a DDS file
+    bool WriteDDS(const std::string& path, const unsigned char* blocks, size_t blocksSize, int width, int height, CompressedFormat format);
+}
+
+#endif //TEXTURECOMPRESSION_H
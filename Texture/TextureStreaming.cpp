@@ -0,0 +1,302 @@
+/*
+ * TextureStreaming.cpp
+ *
+ * Source file implementation of a streaming manager for virtualized image grids. Loads go
+ * through a BulkLoader whose queue is reprioritized every frame by distance from the visible
+ * range, with cells behind the scroll direction counting double. Only cells inside the
+ * prefetch window are loaded at full resolution, and full loads still waiting when their cell
+ * leaves the window are dropped. Cells outside it are downgraded to a
+ * reduced copy under memory pressure and are evicted only when no downgrade is left.
+ */
+#include "TextureStreaming.h"
+
+#include <algorithm>
+
+namespace Texture
+{
+    // Constructor: StreamingManager
+    // -----------------------------
+    // Registers a list of images; nothing is loaded until the first visible range is reported
+    //
+    // vector paths:            image files, one per grid cell
+    // size_t memoryBudgetBytes: GPU memory the resident textures should stay within
+    // int reducedHalvings:     times each dimension of a downgraded texture is halved
+    // int workerCount:         decode threads, 0 for one per hardware thread
+    StreamingManager::StreamingManager(const std::vector<std::string>& paths, size_t memoryBudgetBytes, int reducedHalvings, int workerCount)
+        : loader(std::make_unique<BulkLoader>(workerCount)),
+          memoryBudget(memoryBudgetBytes),
+          reducedHalvings(std::max(1, reducedHalvings))
+    {
+        entries.resize(paths.size());
+        for (size_t i = 0; i < paths.size(); i++)
+            entries[i].path = paths[i];
+    }
+
+    // Destructor:  StreamingManager
+    // -----------------------------
+    // Stops the loader, then deletes every resident texture
+    StreamingManager::~StreamingManager()
+    {
+        loader.reset();
+        for (Entry& entry : entries)
+        {
+            release(entry.full, entry.fullBytes);
+            release(entry.reduced, entry.reducedBytes);
+        }
+    }
+
+    // Function:    Count
+    // ------------------
+    // Returns the number of images managed
+    int StreamingManager::Count() const
+    {
+        return (int)entries.size();
+    }
+
+    // Function:    SetVisibleRange
+    // ----------------------------
+    // Records the cells on screen this frame; the change from the previous range sets the scroll direction
+    //
+    // int first:   index of the first visible cell
+    // int last:    one past the index of the last visible cell
+    void StreamingManager::SetVisibleRange(int first, int last)
+    {
+        first = std::clamp(first, 0, Count());
+        last = std::clamp(last, first, Count());
+
+        if (first != visibleFirst)
+            scrollDirection = first > visibleFirst ? 1 : -1;
+        visibleFirst = first;
+        visibleLast = last;
+    }
+
+    // Function:    Update
+    // -------------------
+    // Queues full resolution loads for the prefetch window, reprioritizes pending loads, drops full
+    // resolution loads whose cells have left the window, uploads finished images and brings resident
+    // memory back within budget
+    //
+    // size_t uploadBudgetBytes:    bytes uploaded to the GPU this frame, 0 for no limit
+    void StreamingManager::Update(size_t uploadBudgetBytes)
+    {
+        // Load every cell of the prefetch window at full resolution
+        const int screen = std::max(1, visibleLast - visibleFirst);
+        const int windowFirst = std::max(0, visibleFirst - (scrollDirection > 0 ? screen / 2 : screen));
+        const int windowLast = std::min(Count(), visibleLast + (scrollDirection < 0 ? screen / 2 : screen));
+        for (int i = windowFirst; i < windowLast; i++)
+        {
+            const Entry& entry = entries[i];
+            if (!entry.fullFailed && entry.full.id == 0 && entry.fullRequest < 0)
+                request(i, true);
+        }
+
+        // Queued loads follow the screen as it scrolls; loader indices are reused, so free slots have no entry
+        for (int index = 0; index < (int)requests.size(); index++)
+        {
+            Request& pending = requests[index];
+            if (pending.entry < 0)
+                continue;
+
+            // A fast fling passes over cells that are never shown, so their full loads are dropped
+            // unless already being read or decoded. Reduced loads serve downgrades and are kept.
+            if (pending.full && !inPrefetchWindow(pending.entry) && loader->Remove(index))
+            {
+                entries[pending.entry].fullRequest = -1;
+                pending = Request{};
+                pendingRequests--;
+                stats.cancellations++;
+                continue;
+            }
+
+            const int newPriority = priority(pending.entry, pending.full);
+            if (newPriority != pending.priority)
+            {
+                loader->SetPriority(index, newPriority);
+                pending.priority = newPriority;
+            }
+        }
+
+        for (const BulkLoadResult& result : loader->Pump(uploadBudgetBytes))
+        {
+            const Request finished = requests[result.index];
+            requests[result.index] = Request{};
+            pendingRequests--;
+            Entry& entry = entries[finished.entry];
+            (finished.full ? entry.fullRequest : entry.reducedRequest) = -1;
+
+            // Only the failed resolution is given up on, the other can still load
+            if (!result.succeeded)
+            {
+                (finished.full ? entry.fullFailed : entry.reducedFailed) = true;
+                continue;
+            }
+
+            if (finished.full)
+            {
+                entry.full = result.texture;
+                entry.fullBytes = result.bytes;
+            }
+            else
+            {
+                entry.reduced = result.texture;
+                entry.reducedBytes = result.bytes;
+            }
+            stats.residentBytes += result.bytes;
+        }
+
+        enforceBudget();
+    }
+
+    // Function:    Get
+    // ----------------
+    // Returns the full resolution texture of an image, its reduced copy, or an empty texture
+    //
+    // int index:   cell of the image
+    TextureData StreamingManager::Get(int index) const
+    {
+        if (index < 0 || index >= Count())
+            return TextureData{};
+
+        const Entry& entry = entries[index];
+        return entry.full.id != 0 ? entry.full : entry.reduced;
+    }
+
+    // Function:    SetMemoryBudget
+    // ----------------------------
+    // Changes the GPU memory the resident textures should stay within
+    void StreamingManager::SetMemoryBudget(size_t bytes)
+    {
+        memoryBudget = bytes;
+    }
+
+    // Function:    Stats
+    // ------------------
+    // Returns the residency counters
+    StreamingStats StreamingManager::Stats() const
+    {
+        StreamingStats snapshot = stats;
+        snapshot.fullDetail = (int)std::count_if(entries.begin(), entries.end(), [](const Entry& entry) { return entry.full.id != 0; });
+        snapshot.reducedDetail = (int)std::count_if(entries.begin(), entries.end(), [](const Entry& entry) { return entry.full.id == 0 && entry.reduced.id != 0; });
+        snapshot.pending = pendingRequests;
+        return snapshot;
+    }
+
+    // Helper Function:    distance
+    // ----------------------------
+    // Returns how many cells an image lies from the visible range, doubled behind the scroll direction
+    int StreamingManager::distance(int index) const
+    {
+        if (index >= visibleFirst && index < visibleLast)
+            return 0;
+        if (index >= visibleLast)
+            return (index - visibleLast + 1) * (scrollDirection < 0 ? 2 : 1);
+        return (visibleFirst - index) * (scrollDirection > 0 ? 2 : 1);
+    }
+
+    // Helper Function:    priority
+    // ----------------------------
+    // Returns the loader priority of an image; reduced copies queue behind every full resolution load
+    int StreamingManager::priority(int index, bool full) const
+    {
+        return full ? -distance(index) : -distance(index) - 2 * Count() - 1;
+    }
+
+    // Helper Function:    inPrefetchWindow
+    // ------------------------------------
+    // Whether an image lies within the range loaded at full resolution
+    bool StreamingManager::inPrefetchWindow(int index) const
+    {
+        const int screen = std::max(1, visibleLast - visibleFirst);
+        const int before = scrollDirection > 0 ? screen / 2 : screen;
+        const int after = scrollDirection < 0 ? screen / 2 : screen;
+        return index >= visibleFirst - before && index < visibleLast + after;
+    }
+
+    // Helper Function:    request
+    // ---------------------------
+    // Queues a full resolution or reduced load of an image on the loader
+    void StreamingManager::request(int index, bool full)
+    {
+        Entry& entry = entries[index];
+        const int requestPriority = priority(index, full);
+        const int loaderIndex = loader->Enqueue(entry.path, requestPriority, full ? 0 : reducedHalvings);
+        if (loaderIndex < 0)
+            return;
+
+        if (loaderIndex >= (int)requests.size())
+            requests.resize(loaderIndex + 1);
+        requests[loaderIndex] = Request{ index, full, requestPriority };
+        (full ? entry.fullRequest : entry.reducedRequest) = loaderIndex;
+        pendingRequests++;
+    }
+
+    // Helper Function:    enforceBudget
+    // ---------------------------------
+    // Releases full resolution textures outside the prefetch window, farthest first, once each has a
+    // reduced copy to fall back on. Reduced copies are evicted only when no downgrade is pending.
+    void StreamingManager::enforceBudget()
+    {
+        if (stats.residentBytes <= memoryBudget)
+            return;
+
+        auto farthestFirst = [&](int a, int b) { return distance(a) > distance(b); };
+
+        std::vector<int> candidates;
+        for (int i = 0; i < Count(); i++)
+            if (entries[i].full.id != 0 && !inPrefetchWindow(i))
+                candidates.push_back(i);
+        std::sort(candidates.begin(), candidates.end(), farthestFirst);
+
+        bool awaitingReduced = false;
+        for (int index : candidates)
+        {
+            if (stats.residentBytes <= memoryBudget)
+                return;
+
+            Entry& entry = entries[index];
+            if (entry.reduced.id != 0 || entry.reducedFailed)
+            {
+                release(entry.full, entry.fullBytes);
+                stats.downgrades++;
+            }
+            else
+            {
+                // Keep the full texture until its reduced copy arrives
+                if (entry.reducedRequest < 0)
+                    request(index, false);
+                awaitingReduced = true;
+            }
+        }
+
+        if (stats.residentBytes <= memoryBudget || awaitingReduced)
+            return;
+
+        candidates.clear();
+        for (int i = 0; i < Count(); i++)
+            if (entries[i].full.id == 0 && entries[i].reduced.id != 0 && !inPrefetchWindow(i))
+                candidates.push_back(i);
+        std::sort(candidates.begin(), candidates.end(), farthestFirst);
+
+        for (int index : candidates)
+        {
+            if (stats.residentBytes <= memoryBudget)
+                return;
+
+            Entry& entry = entries[index];
+            release(entry.reduced, entry.reducedBytes);
+            stats.evictions++;
+        }
+    }
+
+    // Helper Function:    release
+    // ---------------------------
+    // Deletes a resident texture and removes its memory from the total
+    void StreamingManager::release(TextureData& texture, size_t& bytes)
+    {
+        if (texture.id != 0)
+            glDeleteTextures(1, &texture.id);
+        stats.residentBytes -= bytes;
+        texture = TextureData{};
+        bytes = 0;
+    }
+}
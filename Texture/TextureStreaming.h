@@ -0,0 +1,118 @@
+/*
+ * TextureStreaming.h
+ *
+ * Header of a streaming manager for virtualized image grids holding more textures than fit in
+ * GPU memory. The grid reports which cells are on screen every frame. The manager loads those
+ * cells first and prefetches one screen ahead in the scroll direction. When the memory budget
+ * is exceeded, cells far from the screen are downgraded to a reduced-resolution copy rather
+ * than dropped, so fast scrolling shows a low detail preview instead of an empty cell.
+ */
+#ifndef TEXTURESTREAMING_H
+#define TEXTURESTREAMING_H
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "BulkLoader.h"
+#include "TextureTools.h"
+
+// Structure:   StreamingStats
+// ---------------------------
+// Residency of a StreamingManager's textures
+//
+// int fullDetail:          textures resident at full resolution
+// int reducedDetail:       textures resident only at reduced resolution
+// int pending:             loads queued or in flight
+// size_t residentBytes:    GPU memory held by resident textures
+// int downgrades:          full resolution textures released to meet the budget so far
+// int evictions:           reduced textures released as a last resort so far
+// int cancellations:       full resolution loads dropped after their cell left the prefetch window so far
+struct StreamingStats
+{
+    int fullDetail = 0;
+    int reducedDetail = 0;
+    int pending = 0;
+    size_t residentBytes = 0;
+    int downgrades = 0;
+    int evictions = 0;
+    int cancellations = 0;
+};
+
+namespace Texture
+{
+    // Class:   StreamingManager
+    // -------------------------
+    // Keeps the textures of the cells around the visible range of a grid resident within a memory budget
+    // Call SetVisibleRange while drawing and Update once per frame on the GL thread.
+    class StreamingManager {
+    public:
+        // reducedHalvings sets the resolution of downgraded textures, each halving quarters their memory
+        explicit StreamingManager(const std::vector<std::string>& paths, size_t memoryBudgetBytes = 256 * 1024 * 1024, int reducedHalvings = 3, int workerCount = 0);
+
+        // Releases every texture the manager owns
+        ~StreamingManager();
+
+        StreamingManager(const StreamingManager&) = delete;
+        StreamingManager& operator=(const StreamingManager&) = delete;
+
+        // Number of images managed
+        int Count() const;
+
+        // Reports the cells on screen this frame, first inclusive and last exclusive
+        void SetVisibleRange(int first, int last);
+
+        // Reprioritizes the load queue, cancels loads scrolled past, uploads finished images and enforces the memory budget
+        void Update(size_t uploadBudgetBytes = 16 * 1024 * 1024);
+
+        // Best resident texture of an image, id 0 while nothing is loaded
+        TextureData Get(int index) const;
+
+        // Changes the GPU memory budget, applied on the next Update
+        void SetMemoryBudget(size_t bytes);
+
+        // Current residency counters
+        StreamingStats Stats() const;
+
+    private:
+        struct Entry
+        {
+            std::string path;
+            TextureData full;
+            TextureData reduced;
+            size_t fullBytes = 0;
+            size_t reducedBytes = 0;
+            int fullRequest = -1;
+            int reducedRequest = -1;
+            bool fullFailed = false;
+            bool reducedFailed = false;
+        };
+
+        struct Request
+        {
+            int entry = -1;
+            bool full = false;
+            int priority = 0;
+        };
+
+        int distance(int index) const;
+        int priority(int index, bool full) const;
+        bool inPrefetchWindow(int index) const;
+        void request(int index, bool full);
+        void enforceBudget();
+        void release(TextureData& texture, size_t& bytes);
+
+        std::unique_ptr<BulkLoader> loader;
+        std::vector<Entry> entries;
+        std::vector<Request> requests;
+        int pendingRequests = 0;
+        size_t memoryBudget = 0;
+        int reducedHalvings = 0;
+        int visibleFirst = 0;
+        int visibleLast = 0;
+        int scrollDirection = 0;
+        StreamingStats stats;
+    };
+}
+
+#endif //TEXTURESTREAMING_H
@@ -9,12 +9,224 @@
  * and returns a Texture struct containing the texture ID and dimensions.
  */
 #include "TextureTools.h"
+#include "TextureCompression.h"
+#include "ImageDecoders.h"
 #include "imgui.h"
-#include "stb_image.h"
+#include <GLFW/glfw3.h>
+#include <algorithm>
+#include <cstdlib>
+#include <filesystem>
 #include <iostream>
+#include <vector>
+
+// Not exposed by every platform's GL 1.1 header
+#ifndef GL_CLAMP_TO_EDGE
+#define GL_CLAMP_TO_EDGE 0x812F
+#endif
+#ifndef GL_TEXTURE_MAX_LEVEL
+#define GL_TEXTURE_MAX_LEVEL 0x813D
+#endif
+
+// glCompressedTexImage2D is GL 1.3, past what Windows' opengl32 exports, so it is loaded through GLFW
+typedef void (APIENTRY* CompressedTexImage2DProc)(GLenum target, GLint level, GLenum internalFormat, GLsizei width, GLsizei height,
+                                                  GLint border, GLsizei imageSize, const void* data);
 
 namespace Texture
 {
+    // Function:    Decode
+    // -------------------
+    // Decodes an image from a block of memory on the CPU without touching OpenGL, so it can run
+    // on worker threads. DDS/KTX2 containers are parsed and kept block-compressed; everything
+    // else goes through the decoder registry and is converted to RGBA.
+    //
+    // const void* data:        pointer to the raw image data in memory
+    // size_t data_size:        size of the image data in bytes
+    // DecodedImage outImage:   receives the decoded image
+    //
+    // Returns true if the image was successfully decoded, false otherwise.
+    bool Decode(const void* data, size_t data_size, DecodedImage& outImage)
+    {
+        outImage = DecodedImage();
+
+        // Pre-compressed containers skip the image decoders entirely
+        if (IsCompressedContainer(data, data_size))
+        {
+            if (!ParseCompressedContainer(data, data_size, outImage.compressed))
+                return false;
+            outImage.isCompressed = true;
+            outImage.width = outImage.compressed.levels[0].width;
+            outImage.height = outImage.compressed.levels[0].height;
+            return true;
+        }
+
+        return DecodeImage(data, data_size, outImage);
+    }
+
+    // Helper Function:    LoadCompressedTexImage2D
+    // ---------------------------------------------
+    // Looks up glCompressedTexImage2D in the current context the first time it is needed
+    //
+    // Returns the entry point, or null if the context does not provide it
+    static CompressedTexImage2DProc LoadCompressedTexImage2D()
+    {
+        static CompressedTexImage2DProc compressedTexImage2D = nullptr;
+        if (compressedTexImage2D == nullptr)
+            compressedTexImage2D = (CompressedTexImage2DProc)glfwGetProcAddress("glCompressedTexImage2D");
+        return compressedTexImage2D;
+    }
+
+    // Helper Function:    UploadCompressed
+    // -------------------------------------
+    // Uploads every mip level of a block-compressed image with glCompressedTexImage2D. If the
+    // context lacks the entry point or rejects the block format, the levels are decoded on the
+    // CPU and uploaded as RGBA.
+    //
+    // CompressedImage image:   parsed compressed image
+    // GLuint image_texture:    texture receiving the levels, bound to GL_TEXTURE_2D
+    //
+    // Returns true if every level was uploaded
+    bool UploadCompressed(const CompressedImage& image, GLuint image_texture)
+    {
+        glBindTexture(GL_TEXTURE_2D, image_texture);
+        const int levelCount = (int)image.levels.size();
+
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, levelCount > 1 ? GL_LINEAR_MIPMAP_LINEAR : GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAX_LEVEL, levelCount - 1);
+
+        const CompressedTexImage2DProc compressedTexImage2D = LoadCompressedTexImage2D();
+        if (compressedTexImage2D != nullptr)
+        {
+            // Clear stale errors so the check below only sees the upload
+            while (glGetError() != GL_NO_ERROR) {}
+
+            for (int level = 0; level < levelCount; level++)
+            {
+                const CompressedLevel& info = image.levels[level];
+                compressedTexImage2D(GL_TEXTURE_2D, level, CompressedGLFormat(image.format, image.srgb, image.alpha), info.width, info.height, 0,
+                                     (GLsizei)info.size, image.data.data() + info.offset);
+            }
+
+            if (glGetError() == GL_NO_ERROR)
+                return true;
+        }
+
+        // The context cannot sample this format, fall back to a CPU decode
+        // sRGB blocks decode to sRGB-encoded pixels, so they keep an sRGB internal format
+        const GLint internalFormat = image.srgb ? 0x8C43 : GL_RGBA; // GL_SRGB8_ALPHA8
+        std::vector<unsigned char> pixels;
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        for (int level = 0; level < levelCount; level++)
+        {
+            if (!DecodeCompressed(image, level, pixels))
+                return false;
+            glTexImage2D(GL_TEXTURE_2D, level, internalFormat, image.levels[level].width, image.levels[level].height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels.data());
+        }
+        return true;
+    }
+
+    // Function:    Upload
+    // -------------------
+    // Creates an OpenGL texture from an image produced by Decode
+    // Must be called on the thread that owns the GL context
+    //
+    // DecodedImage image:  decoded image
+    //
+    // Returns TextureData struct containing information necessary for rendering, with id 0 on failure
+    TextureData Upload(const DecodedImage& image)
+    {
+        // Create a OpenGL texture identifier
+        GLuint image_texture;
+        glGenTextures(1, &image_texture);
+        glBindTexture(GL_TEXTURE_2D, image_texture);
+
+        if (image.isCompressed)
+        {
+            if (!UploadCompressed(image.compressed, image_texture))
+            {
+                glDeleteTextures(1, &image_texture);
+                return TextureData{};
+            }
+        }
+        else
+        {
+            // Setup filtering parameters for display
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+            glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+
+            // Upload pixels into texture
+            glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+            glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image.width, image.height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image.pixels.get());
+        }
+
+        return TextureData{ image_texture, image.width, image.height };
+    }
+
+    // Function:    Reduce
+    // -------------------
+    // Lowers the resolution of a decoded image by a power of two
+    // RGBA images are box filtered; compressed images drop their largest mip levels, keeping at
+    // least the smallest level they contain.
+    //
+    // DecodedImage image:  image to reduce in place
+    // int halvings:        number of times to halve each dimension
+    void Reduce(DecodedImage& image, int halvings)
+    {
+        if (halvings <= 0)
+            return;
+
+        if (image.isCompressed)
+        {
+            CompressedImage& compressed = image.compressed;
+            const int dropped = std::min(halvings, (int)compressed.levels.size() - 1);
+            if (dropped <= 0)
+                return;
+
+            const size_t firstByte = compressed.levels[dropped].offset;
+            compressed.levels.erase(compressed.levels.begin(), compressed.levels.begin() + dropped);
+            for (CompressedLevel& level : compressed.levels)
+                level.offset -= firstByte;
+            compressed.data.erase(compressed.data.begin(), compressed.data.begin() + firstByte);
+            image.width = compressed.levels[0].width;
+            image.height = compressed.levels[0].height;
+            return;
+        }
+
+        const int factor = 1 << std::min(halvings, 15);
+        const int width = std::max(1, image.width / factor);
+        const int height = std::max(1, image.height / factor);
+        unsigned char* reduced = (unsigned char*)malloc((size_t)width * height * 4);
+        const unsigned char* source = image.pixels.get();
+
+        for (int y = 0; y < height; y++)
+        {
+            for (int x = 0; x < width; x++)
+            {
+                // Average the source block, clipped to the image for odd sizes
+                unsigned int sum[4] = { 0, 0, 0, 0 };
+                unsigned int count = 0;
+                for (int sy = y * factor; sy < std::min((y + 1) * factor, image.height); sy++)
+                {
+                    for (int sx = x * factor; sx < std::min((x + 1) * factor, image.width); sx++, count++)
+                    {
+                        const unsigned char* pixel = source + ((size_t)sy * image.width + sx) * 4;
+                        sum[0] += pixel[0];
+                        sum[1] += pixel[1];
+                        sum[2] += pixel[2];
+                        sum[3] += pixel[3];
+                    }
+                }
+                unsigned char* out = reduced + ((size_t)y * width + x) * 4;
+                for (int channel = 0; channel < 4; channel++)
+                    out[channel] = (unsigned char)(sum[channel] / count);
+            }
+        }
+
+        image.width = width;
+        image.height = height;
+        image.pixels = std::shared_ptr<unsigned char>(reduced, free);
+    }
+
     // Helper Function:    LoadTextureFromMemory
     // -----------------------------------------
     // Loads an image from a block of memory into an OpenGL texture for rendering.
@@ -28,30 +240,17 @@ namespace Texture
     // Returns true if the image was successfully loaded and converted into a texture, false otherwise.
     bool LoadTextureFromMemory(const void* data, size_t data_size, GLuint* out_texture, int* out_width, int* out_height)
     {
-        // Load from file
-        int image_width = 0;
-        int image_height = 0;
-        unsigned char* image_data = stbi_load_from_memory((const unsigned char*)data, (int)data_size, &image_width, &image_height, NULL, 4);
-        if (image_data == NULL)
+        DecodedImage image;
+        if (!Decode(data, data_size, image))
             return false;
 
-        // Create a OpenGL texture identifier
-        GLuint image_texture;
-        glGenTextures(1, &image_texture);
-        glBindTexture(GL_TEXTURE_2D, image_texture);
-
-        // Setup filtering parameters for display
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-
-        // Upload pixels into texture
-        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, image_width, image_height, 0, GL_RGBA, GL_UNSIGNED_BYTE, image_data);
-        stbi_image_free(image_data);
+        TextureData texture = Upload(image);
+        if (texture.id == 0)
+            return false;
 
-        *out_texture = image_texture;
-        *out_width = image_width;
-        *out_height = image_height;
+        *out_texture = texture.id;
+        *out_width = texture.width;
+        *out_height = texture.height;
 
         return true;
     }
@@ -87,10 +286,41 @@ namespace Texture
         return ret;
     }
 
+    // Helper Function:    CompressedVariant
+    // --------------------------------------
+    // Looks for a pre-compressed copy of an image next to it, e.g. photo.ktx2 or photo.dds for photo.png
+    // A copy older than the image it was made from is stale and ignored.
+    //
+    // string path: path to the image file requested by the caller
+    //
+    // Returns the path of the compressed copy if an up-to-date one exists, otherwise the original path
+    std::string CompressedVariant(const std::string& path)
+    {
+        std::error_code error;
+        const std::filesystem::file_time_type sourceTime = std::filesystem::last_write_time(path, error);
+        const bool sourceExists = !error;
+
+        for (const char* extension : { ".ktx2", ".dds" })
+        {
+            std::filesystem::path candidate = std::filesystem::path(path).replace_extension(extension);
+            if (candidate == std::filesystem::path(path))
+                continue;
+
+            const std::filesystem::file_time_type candidateTime = std::filesystem::last_write_time(candidate, error);
+            if (error)
+                continue;
+            if (!sourceExists || candidateTime >= sourceTime)
+                return candidate.string();
+        }
+        return path;
+    }
+
     // Function:    Load
     // -----------------
     // Loads a .png image file from a disk, converts it into an OpenGL texture, and
     // returns it as a texture object
+    // An up-to-date .ktx2 or .dds file with the same name takes precedence over the original
+    // image; if it cannot be loaded, the original image is loaded instead.
     //
     // string path: path to the image file to load
     //
@@ -100,7 +330,15 @@ namespace Texture
         GLuint texture_id = 0;
         int width = 0, height = 0;
 
-        if (!LoadTextureFromFile(path.c_str(), &texture_id, &width, &height))
+        const std::string variant = CompressedVariant(path);
+        bool loaded = LoadTextureFromFile(variant.c_str(), &texture_id, &width, &height);
+        if (!loaded && variant != path)
+        {
+            std::cerr << "TextureLoader.LoadTexture: Failed to load compressed copy, using original: " << variant << std::endl;
+            loaded = LoadTextureFromFile(path.c_str(), &texture_id, &width, &height);
+        }
+
+        if (!loaded)
         {
             std::cerr << "TextureLoader.LoadTexture: Failed to load texture: " << path << std::endl;
             throw std::runtime_error("TextureLoader.LoadTexture: Failed to load texture"); // Throw a standard exception
@@ -114,4 +352,48 @@ namespace Texture
         };
     }
 
+    // Function:    FromPixels
+    // -----------------------
+    // Uploads a block of tightly packed 8-bit RGBA pixels into a new OpenGL texture
+    // Used for images generated at runtime rather than read from disk
+    //
+    // const void* rgbaPixels:  pixel data, width * height * 4 bytes
+    // int width:               width of the image in pixels
+    // int height:              height of the image in pixels
+    // bool smoothFiltering:    linear filtering when true, nearest-neighbour when false
+    //
+    // Returns TextureData struct containing information necessary for rendering
+    TextureData FromPixels(const void* rgbaPixels, int width, int height, bool smoothFiltering)
+    {
+        GLuint texture_id = 0;
+        glGenTextures(1, &texture_id);
+        glBindTexture(GL_TEXTURE_2D, texture_id);
+
+        GLint filter = smoothFiltering ? GL_LINEAR : GL_NEAREST;
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, filter);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, rgbaPixels);
+
+        return TextureData{ texture_id, width, height };
+    }
+
+    // Function:    UpdatePixels
+    // -------------------------
+    // Overwrites every pixel of an existing texture without reallocating its storage
+    //
+    // TextureData texture:     texture previously returned by FromPixels
+    // const void* rgbaPixels:  pixel data, texture.width * texture.height * 4 bytes
+    void UpdatePixels(const TextureData& texture, const void* rgbaPixels)
+    {
+        glBindTexture(GL_TEXTURE_2D, texture.id);
+        glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+        glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+        glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, texture.width, texture.height, GL_RGBA, GL_UNSIGNED_BYTE, rgbaPixels);
+    }
+
 }
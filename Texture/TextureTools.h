@@ -12,9 +12,12 @@
 #pragma once
 #ifndef TEXTURELOADER_H
 #define TEXTURELOADER_H
+#include <memory>
 #include <string>
 #include <GL/gl.h>
 
+#include "TextureCompression.h"
+
 // Structure:   Texture
 // --------------------
 // Represents a texture, sprite, or image; used by DrawTools to draw
@@ -30,10 +33,49 @@ struct TextureData
     int height = 0;
 };
 
+// Structure:   DecodedImage
+// -------------------------
+// An image decoded on the CPU and waiting to be uploaded to the GPU
+//
+// int width:                   width of the image in pixels
+// int height:                  height of the image in pixels
+// shared_ptr pixels:           RGBA pixels, when the source was not block-compressed
+// CompressedImage compressed:  block data and mip levels, when loaded from a DDS/KTX2 container
+// bool isCompressed:           which of the two representations is in use
+struct DecodedImage
+{
+    int width = 0;
+    int height = 0;
+    std::shared_ptr<unsigned char> pixels;
+    CompressedImage compressed;
+    bool isCompressed = false;
+
+    // Bytes that Upload will send to the GPU
+    size_t UploadSize() const { return isCompressed ? compressed.data.size() : (size_t)width * height * 4; }
+};
+
 namespace Texture
 {
-    // Load a Texture from a .png image's filepath
+    // Load a Texture from a .png image's filepath, preferring an up-to-date .ktx2/.dds copy with the same name
     TextureData Load(const std::string& path);
+
+    // Returns the path of a .ktx2/.dds copy of an image if one exists and is not older than the image, otherwise the path itself
+    std::string CompressedVariant(const std::string& path);
+
+    // Decode an image file held in memory, safe to call from any thread
+    bool Decode(const void* data, size_t dataSize, DecodedImage& outImage);
+
+    // Create an OpenGL texture from a decoded image, on the GL thread
+    TextureData Upload(const DecodedImage& image);
+
+    // Halve a decoded image's resolution a number of times, safe to call from any thread
+    void Reduce(DecodedImage& image, int halvings);
+
+    // Create a Texture from a block of tightly packed RGBA pixels
+    TextureData FromPixels(const void* rgbaPixels, int width, int height, bool smoothFiltering = true);
+
+    // Replace the full contents of a Texture created by FromPixels
+    void UpdatePixels(const TextureData& texture, const void* rgbaPixels);
 }
 
 #endif //TEXTURELOADER_H
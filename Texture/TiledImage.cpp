@@ -0,0 +1,575 @@
+/*
+ * TiledImage.cpp
+ *
+ * Source file implementation of tiled, region-of-interest loading for very large images.
+ * The disk cache holds a short header followed by every level's tiles in row-major order.
+ * Each tile is a full 512x512 RGBA block, with edge tiles padded by repeating their last row
+ * and column, so any tile can be found by offset and uploaded without repacking. A single
+ * background thread builds the cache and then serves tile reads, newest requests first.
+ * Requests that have not been renewed for a few frames are dropped.
+ */
+#include "TiledImage.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+
+#include "../CacheTools.h"
+
+namespace Texture
+{
+    // Structure:   TileCacheHeader
+    // ----------------------------
+    // First bytes of a tile cache file
+    struct TileCacheHeader
+    {
+        char magic[4] = { 'T', 'I', 'L', 'C' };
+        uint32_t version = 1;
+        uint32_t width = 0;
+        uint32_t height = 0;
+        uint32_t levels = 0;
+        uint32_t tileSize = ImageTileSize;
+    };
+
+    constexpr size_t TileBytes = (size_t)ImageTileSize * ImageTileSize * 4;
+
+    // Helper Function:    MakeTileKey
+    // -------------------------------
+    // Packs a tile's level and position into one integer
+    static uint64_t MakeTileKey(int level, int tileX, int tileY)
+    {
+        return (uint64_t)level << 48 | (uint64_t)tileY << 24 | (uint64_t)tileX;
+    }
+
+    // Helper Functions:   TileKeyLevel, TileKeyX, TileKeyY
+    // ----------------------------------------------------
+    // Unpack the fields of a tile key
+    static int TileKeyLevel(uint64_t key) { return (int)(key >> 48); }
+    static int TileKeyX(uint64_t key) { return (int)(key & 0xFFFFFF); }
+    static int TileKeyY(uint64_t key) { return (int)((key >> 24) & 0xFFFFFF); }
+
+    // Helper Function:    SeekTo
+    // --------------------------
+    // Seeks to a 64-bit offset, since level 0 of a large scan is over 2 GB on some platforms' long
+    static bool SeekTo(FILE* file, size_t offset)
+    {
+#ifdef _WIN32
+        return _fseeki64(file, (long long)offset, SEEK_SET) == 0;
+#else
+        return fseeko(file, (off_t)offset, SEEK_SET) == 0;
+#endif
+    }
+
+    // Constructor: TiledImage
+    // -----------------------
+    // Starts the tile thread, which reuses a cached pyramid of the image or builds one
+    // The cache file is named after the source's path, then its size and modification time, so
+    // an edited image gets a new pyramid that replaces the old one.
+    //
+    // string path:             image file to display
+    // size_t gpuBudgetBytes:   GPU memory the resident tiles should stay within
+    // string cacheDirectory:   folder holding tile pyramids
+    TiledImage::TiledImage(const std::string& path, size_t gpuBudgetBytes, const std::string& cacheDirectory)
+        : sourcePath(path), gpuBudget(gpuBudgetBytes)
+    {
+        std::error_code error;
+        const std::filesystem::path directory = cacheDirectory.empty() ? std::filesystem::temp_directory_path(error) / "imguiutils_tiles" : std::filesystem::path(cacheDirectory);
+        const std::string source = std::filesystem::absolute(path, error).string();
+        const std::string version = std::to_string(std::filesystem::file_size(path, error)) + "|" +
+                                    std::to_string(std::filesystem::last_write_time(path, error).time_since_epoch().count());
+
+        char name[48];
+        snprintf(name, sizeof(name), "%016llx-%016llx.tiles", (unsigned long long)HashBytes(source.data(), source.size()), (unsigned long long)HashBytes(version.data(), version.size()));
+        cachePath = (directory / name).string();
+
+        worker = std::thread(&TiledImage::workerLoop, this);
+    }
+
+    // Destructor:  TiledImage
+    // -----------------------
+    // Stops the tile thread, abandoning a cache still being built, and deletes every tile texture
+    TiledImage::~TiledImage()
+    {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        requestCondition.notify_all();
+        worker.join();
+
+        while (!recentlyUsed.empty())
+            release(recentlyUsed.front());
+    }
+
+    // Function:    Ready
+    // ------------------
+    // Returns true once the tile pyramid can be drawn
+    bool TiledImage::Ready() const
+    {
+        return state == State::Ready;
+    }
+
+    // Function:    Failed
+    // -------------------
+    // Returns true if the image could not be decoded or its cache could not be written
+    bool TiledImage::Failed() const
+    {
+        return state == State::Failed;
+    }
+
+    // Function:    Width
+    // ------------------
+    // Returns the full resolution width in pixels, 0 until Ready
+    int TiledImage::Width() const
+    {
+        return Ready() ? width : 0;
+    }
+
+    // Function:    Height
+    // -------------------
+    // Returns the full resolution height in pixels, 0 until Ready
+    int TiledImage::Height() const
+    {
+        return Ready() ? height : 0;
+    }
+
+    // Function:    LevelCount
+    // -----------------------
+    // Returns the number of pyramid levels, 0 until Ready
+    int TiledImage::LevelCount() const
+    {
+        return Ready() ? levels : 0;
+    }
+
+    // Function:    LevelForScale
+    // --------------------------
+    // Returns the coarsest pyramid level with at least one texel per screen pixel
+    //
+    // float screenScale:   screen pixels per full resolution image pixel
+    int TiledImage::LevelForScale(float screenScale) const
+    {
+        if (!Ready())
+            return 0;
+
+        int level = screenScale > 0.0f ? (int)std::floor(std::log2(1.0f / screenScale)) : levels - 1;
+        return std::clamp(level, 0, levels - 1);
+    }
+
+    // Function:    CollectTiles
+    // -------------------------
+    // Lists the tiles needed to draw a region of the image at the level matching the screen scale
+    //
+    // float x0, y0, x1, y1:    region to draw, in full resolution image pixels
+    // float screenScale:       screen pixels per full resolution image pixel
+    // vector outTiles:         receives the tiles to draw, in no particular order
+    void TiledImage::CollectTiles(float x0, float y0, float x1, float y1, float screenScale, std::vector<ImageTile>& outTiles)
+    {
+        CollectLevelTiles(x0, y0, x1, y1, LevelForScale(screenScale), outTiles);
+    }
+
+    // Function:    CollectLevelTiles
+    // ------------------------------
+    // Lists the tiles covering a region of the image at one pyramid level
+    // Missing tiles are requested and covered meanwhile by the nearest resident coarser tile, so
+    // the region is never left empty once the single-tile top level has loaded. Such stand-ins
+    // report their own level in ImageTile::level.
+    //
+    // float x0, y0, x1, y1:    region to draw, in full resolution image pixels
+    // int level:               pyramid level to draw, 0 is full resolution
+    // vector outTiles:         receives the tiles to draw, in no particular order
+    // bool requestMissing:     queue loads for tiles of the level that are not resident
+    void TiledImage::CollectLevelTiles(float x0, float y0, float x1, float y1, int level, std::vector<ImageTile>& outTiles, bool requestMissing)
+    {
+        outTiles.clear();
+        if (!Ready())
+            return;
+
+        x0 = std::max(x0, 0.0f);
+        y0 = std::max(y0, 0.0f);
+        x1 = std::min(x1, (float)width);
+        y1 = std::min(y1, (float)height);
+        if (x0 >= x1 || y0 >= y1)
+            return;
+
+        level = std::clamp(level, 0, levels - 1);
+        if (requestMissing)
+            stats.level = level;
+
+        const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        std::vector<uint64_t> missing;
+        const uint64_t topKey = MakeTileKey(levels - 1, 0, 0);
+        if (touch(topKey) == nullptr && requestMissing)
+            missing.push_back(topKey);
+
+        const float span = (float)(ImageTileSize << level);
+        for (int tileY = (int)(y0 / span); tileY * span < y1; tileY++)
+        {
+            for (int tileX = (int)(x0 / span); tileX * span < x1; tileX++)
+            {
+                ImageTile tile;
+                tile.x0 = std::max(x0, tileX * span);
+                tile.y0 = std::max(y0, tileY * span);
+                tile.x1 = std::min(x1, (tileX + 1) * span);
+                tile.y1 = std::min(y1, (tileY + 1) * span);
+
+                for (int source = level; source < levels; source++)
+                {
+                    // Levels round their size down, so the last pixels can fall past the last tile
+                    const int shift = source - level;
+                    const int keyX = std::min(tileX >> shift, (levelWidth(source) - 1) / ImageTileSize);
+                    const int keyY = std::min(tileY >> shift, (levelHeight(source) - 1) / ImageTileSize);
+                    const uint64_t key = MakeTileKey(source, keyX, keyY);
+                    const ResidentTile* found = touch(key);
+                    if (found == nullptr)
+                    {
+                        if (source == level && requestMissing)
+                            missing.push_back(key);
+                        continue;
+                    }
+
+                    // Map the area into the source tile's texture coordinates
+                    const float sourceSpan = (float)(ImageTileSize << source);
+                    const float originX = keyX * sourceSpan;
+                    const float originY = keyY * sourceSpan;
+                    tile.texture = found->texture;
+                    tile.level = source;
+                    tile.age = std::chrono::duration<float>(now - found->uploadTime).count();
+                    tile.u0 = (tile.x0 - originX) / sourceSpan;
+                    tile.v0 = (tile.y0 - originY) / sourceSpan;
+                    tile.u1 = (tile.x1 - originX) / sourceSpan;
+                    tile.v1 = (tile.y1 - originY) / sourceSpan;
+                    outTiles.push_back(tile);
+                    break;
+                }
+            }
+        }
+
+        if (missing.empty())
+            return;
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            for (uint64_t key : missing)
+            {
+                // A tile that could not be read stays covered by its coarser stand-in
+                if (failedTiles.count(key) != 0)
+                    continue;
+
+                auto request = requests.find(key);
+                if (request == requests.end())
+                    requests[key] = frame;
+                else if (request->second >= 0)
+                    request->second = frame;
+            }
+        }
+        requestCondition.notify_one();
+    }
+
+    // Function:    Update
+    // -------------------
+    // Uploads tiles read by the tile thread, then releases the least recently drawn tiles until the
+    // budget is met. Tiles drawn during the previous frame and the top level are never released.
+    //
+    // size_t uploadBudgetBytes:    bytes uploaded to the GPU this frame, 0 for no limit
+    void TiledImage::Update(size_t uploadBudgetBytes)
+    {
+        const int current = ++frame;
+
+        std::vector<LoadedTile> ready;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            size_t count = loaded.size();
+            if (uploadBudgetBytes != 0)
+                count = std::min(count, std::max<size_t>(1, uploadBudgetBytes / TileBytes));
+            ready.assign(std::make_move_iterator(loaded.begin()), std::make_move_iterator(loaded.begin() + count));
+            loaded.erase(loaded.begin(), loaded.begin() + count);
+            for (const LoadedTile& tile : ready)
+                requests.erase(tile.key);
+        }
+
+        for (const LoadedTile& tile : ready)
+        {
+            recentlyUsed.push_front(tile.key);
+            ResidentTile& entry = resident[tile.key];
+            entry.texture = FromPixels(tile.pixels.data(), ImageTileSize, ImageTileSize);
+            entry.position = recentlyUsed.begin();
+            entry.lastFrame = current;
+            entry.uploadTime = std::chrono::steady_clock::now();
+            stats.residentBytes += TileBytes;
+            stats.tilesLoaded++;
+        }
+
+        std::list<uint64_t>::iterator position = recentlyUsed.end();
+        while (stats.residentBytes > gpuBudget && position != recentlyUsed.begin())
+        {
+            const uint64_t key = *std::prev(position);
+            if (resident[key].lastFrame >= current - 1)
+                break;
+            if (TileKeyLevel(key) == levels - 1)
+            {
+                --position;
+                continue;
+            }
+            release(key);
+            stats.tilesEvicted++;
+        }
+    }
+
+    // Function:    Stats
+    // ------------------
+    // Returns the tile cache counters
+    TiledImageStats TiledImage::Stats() const
+    {
+        TiledImageStats snapshot = stats;
+        snapshot.residentTiles = (int)resident.size();
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot.pendingTiles = (int)requests.size();
+        snapshot.failedTiles = (int)failedTiles.size();
+        return snapshot;
+    }
+
+    // Helper Function:    workerLoop
+    // ------------------------------
+    // Opens or builds the tile cache, then reads requested tiles until the image is destroyed
+    // A tile that cannot be read is marked failed rather than read from disk again every frame.
+    void TiledImage::workerLoop()
+    {
+        if (!readHeader() && !buildCache())
+        {
+            state = State::Failed;
+            return;
+        }
+
+        FILE* file = fopen(cachePath.c_str(), "rb");
+        if (file == NULL)
+        {
+            state = State::Failed;
+            return;
+        }
+        state = State::Ready;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true)
+        {
+            requestCondition.wait(lock, [&]() { return stopping || std::any_of(requests.begin(), requests.end(), [](const auto& request) { return request.second >= 0; }); });
+            if (stopping)
+                break;
+
+            // Serve the most recently drawn region first and forget regions scrolled away from
+            const int current = frame;
+            uint64_t key = 0;
+            int newest = -1;
+            for (auto request = requests.begin(); request != requests.end();)
+            {
+                if (request->second >= 0 && request->second < current - 2)
+                {
+                    request = requests.erase(request);
+                    continue;
+                }
+                if (request->second > newest)
+                {
+                    newest = request->second;
+                    key = request->first;
+                }
+                ++request;
+            }
+            if (newest < 0)
+                continue;
+
+            // Marked in flight so CollectTiles does not request it again
+            requests[key] = -1;
+
+            lock.unlock();
+            LoadedTile tile;
+            tile.key = key;
+            const bool succeeded = readTile(file, key, tile.pixels);
+            lock.lock();
+
+            if (succeeded)
+                loaded.push_back(std::move(tile));
+            else
+            {
+                requests.erase(key);
+                failedTiles.insert(key);
+            }
+        }
+
+        fclose(file);
+    }
+
+    // Helper Function:    buildCache
+    // ------------------------------
+    // Decodes the source image once and writes every level of its tile pyramid to the cache
+    // The file is written under a temporary name and renamed when complete, so an interrupted
+    // build never leaves a truncated cache behind.
+    bool TiledImage::buildCache()
+    {
+        std::ifstream stream(sourcePath, std::ios::binary);
+        const std::vector<unsigned char> data((std::istreambuf_iterator<char>(stream)), std::istreambuf_iterator<char>());
+
+        DecodedImage image;
+        if (data.empty() || !Decode(data.data(), data.size(), image) || image.isCompressed)
+            return false;
+
+        width = image.width;
+        height = image.height;
+        levels = 1;
+        while (std::max(levelWidth(levels - 1), levelHeight(levels - 1)) > ImageTileSize)
+            levels++;
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(cachePath).parent_path(), error);
+        const std::string temporaryPath = cachePath + "." + std::to_string(std::hash<std::thread::id>()(std::this_thread::get_id())) + ".tmp";
+        FILE* file = fopen(temporaryPath.c_str(), "wb");
+        if (file == NULL)
+            return false;
+
+        TileCacheHeader header;
+        header.width = (uint32_t)width;
+        header.height = (uint32_t)height;
+        header.levels = (uint32_t)levels;
+        bool succeeded = fwrite(&header, sizeof(header), 1, file) == 1;
+
+        std::vector<unsigned char> tile(TileBytes);
+        for (int level = 0; level < levels && succeeded && !stopping; level++)
+        {
+            const int w = image.width;
+            const int h = image.height;
+            const unsigned char* pixels = image.pixels.get();
+
+            // Level 0 of a large scan takes seconds to write, so a destroyed image stops between tiles
+            for (int tileY = 0; tileY * ImageTileSize < h && succeeded && !stopping; tileY++)
+            {
+                for (int tileX = 0; tileX * ImageTileSize < w && succeeded && !stopping; tileX++)
+                {
+                    // Copy the tile's rows, repeating the image's last row and column into the padding
+                    const int columns = std::min(ImageTileSize, w - tileX * ImageTileSize);
+                    for (int y = 0; y < ImageTileSize; y++)
+                    {
+                        const int sourceY = std::min(tileY * ImageTileSize + y, h - 1);
+                        unsigned char* row = tile.data() + (size_t)y * ImageTileSize * 4;
+                        memcpy(row, pixels + ((size_t)sourceY * w + (size_t)tileX * ImageTileSize) * 4, (size_t)columns * 4);
+                        for (int x = columns; x < ImageTileSize; x++)
+                            memcpy(row + x * 4, row + (columns - 1) * 4, 4);
+                    }
+                    succeeded = fwrite(tile.data(), 1, TileBytes, file) == TileBytes;
+                }
+            }
+
+            if (level + 1 < levels && !stopping)
+                Reduce(image, 1);
+        }
+
+        succeeded = fclose(file) == 0 && succeeded && !stopping;
+        if (succeeded)
+            std::filesystem::rename(temporaryPath, cachePath, error);
+        if (!succeeded || error)
+        {
+            std::filesystem::remove(temporaryPath, error);
+            return false;
+        }
+
+        RemoveStaleCaches(cachePath);
+        return true;
+    }
+
+    // Helper Function:    readHeader
+    // ------------------------------
+    // Loads the image size from an existing cache file, checking that the file is complete
+    bool TiledImage::readHeader()
+    {
+        FILE* file = fopen(cachePath.c_str(), "rb");
+        if (file == NULL)
+            return false;
+
+        TileCacheHeader header;
+        const TileCacheHeader expected;
+        const bool complete = fread(&header, sizeof(header), 1, file) == 1;
+        fclose(file);
+        if (!complete || memcmp(header.magic, expected.magic, 4) != 0 || header.version != expected.version ||
+            header.tileSize != expected.tileSize || header.levels == 0 || header.levels > 16)
+            return false;
+
+        width = (int)header.width;
+        height = (int)header.height;
+        levels = (int)header.levels;
+
+        std::error_code error;
+        return std::filesystem::file_size(cachePath, error) == tileOffset(levels, 0, 0) && !error;
+    }
+
+    // Helper Function:    readTile
+    // ----------------------------
+    // Reads one tile's pixels from the cache file
+    bool TiledImage::readTile(FILE* file, uint64_t key, std::vector<unsigned char>& outPixels) const
+    {
+        outPixels.resize(TileBytes);
+        return SeekTo(file, tileOffset(TileKeyLevel(key), TileKeyX(key), TileKeyY(key))) &&
+               fread(outPixels.data(), 1, TileBytes, file) == TileBytes;
+    }
+
+    // Helper Function:    tileOffset
+    // ------------------------------
+    // Returns the byte offset of a tile in the cache file; tile (0, 0) of level LevelCount() is the file size
+    size_t TiledImage::tileOffset(int level, int tileX, int tileY) const
+    {
+        size_t offset = sizeof(TileCacheHeader);
+        for (int previous = 0; previous < level; previous++)
+        {
+            const size_t tilesX = (levelWidth(previous) + ImageTileSize - 1) / ImageTileSize;
+            const size_t tilesY = (levelHeight(previous) + ImageTileSize - 1) / ImageTileSize;
+            offset += tilesX * tilesY * TileBytes;
+        }
+
+        const size_t tilesX = (levelWidth(level) + ImageTileSize - 1) / ImageTileSize;
+        return offset + ((size_t)tileY * tilesX + tileX) * TileBytes;
+    }
+
+    // Helper Function:    levelWidth
+    // ------------------------------
+    // Returns the width of a pyramid level, matching the rounding of Texture::Reduce
+    int TiledImage::levelWidth(int level) const
+    {
+        return std::max(1, width >> level);
+    }
+
+    // Helper Function:    levelHeight
+    // -------------------------------
+    // Returns the height of a pyramid level, matching the rounding of Texture::Reduce
+    int TiledImage::levelHeight(int level) const
+    {
+        return std::max(1, height >> level);
+    }
+
+    // Helper Function:    touch
+    // -------------------------
+    // Looks up a resident tile and marks it as drawn this frame
+    const TiledImage::ResidentTile* TiledImage::touch(uint64_t key)
+    {
+        auto found = resident.find(key);
+        if (found == resident.end())
+            return nullptr;
+
+        recentlyUsed.splice(recentlyUsed.begin(), recentlyUsed, found->second.position);
+        found->second.lastFrame = frame;
+        return &found->second;
+    }
+
+    // Helper Function:    release
+    // ---------------------------
+    // Deletes a resident tile's texture and forgets it
+    void TiledImage::release(uint64_t key)
+    {
+        auto found = resident.find(key);
+        if (found == resident.end())
+            return;
+
+        glDeleteTextures(1, &found->second.texture.id);
+        recentlyUsed.erase(found->second.position);
+        resident.erase(found);
+        stats.residentBytes -= TileBytes;
+    }
+}
@@ -0,0 +1,167 @@
+/*
+ * TiledImage.h
+ *
+ * Header of a tiled representation for very large images, such as 16k scans, that are too big
+ * to keep on the GPU in one piece. The first time an image is opened it is decoded once on a
+ * background thread and written to a disk cache as a pyramid of 512 pixel tiles, each level
+ * half the size of the one below. Afterwards only the tiles covering the displayed region, at
+ * the level matching the zoom, are read back and uploaded. They are kept in an LRU cache
+ * under a GPU memory budget, so memory follows what is on screen rather than the image size.
+ */
+#ifndef TILEDIMAGE_H
+#define TILEDIMAGE_H
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <list>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "TextureTools.h"
+
+// Structure:   ImageTile
+// ----------------------
+// One tile to draw, covering part of the requested region
+// The texture may belong to a coarser level than requested while the matching tile loads.
+//
+// TextureData texture:     tile texture
+// int level:               pyramid level the texture belongs to
+// float age:               seconds since the texture was uploaded, for fading tiles in
+// float x0, y0, x1, y1:    area covered, in full resolution image pixels
+// float u0, v0, u1, v1:    texture coordinates of that area
+struct ImageTile
+{
+    TextureData texture;
+    int level = 0;
+    float age = 0.0f;
+    float x0 = 0.0f, y0 = 0.0f, x1 = 0.0f, y1 = 0.0f;
+    float u0 = 0.0f, v0 = 0.0f, u1 = 0.0f, v1 = 0.0f;
+};
+
+// Structure:   TiledImageStats
+// ----------------------------
+// Tile cache activity of a TiledImage
+//
+// int level:               pyramid level used by the last CollectTiles, 0 is full resolution
+// int residentTiles:       tiles uploaded to the GPU
+// size_t residentBytes:    GPU memory held by resident tiles
+// int pendingTiles:        tiles requested but not uploaded yet
+// int tilesLoaded:         tiles read from the cache and uploaded so far
+// int tilesEvicted:        tiles released to meet the budget so far
+// int failedTiles:         tiles that could not be read from the cache and are no longer requested
+struct TiledImageStats
+{
+    int level = 0;
+    int residentTiles = 0;
+    size_t residentBytes = 0;
+    int pendingTiles = 0;
+    int tilesLoaded = 0;
+    int tilesEvicted = 0;
+    int failedTiles = 0;
+};
+
+namespace Texture
+{
+    // Edge length of a tile in pixels
+    constexpr int ImageTileSize = 512;
+
+    // Class:   TiledImage
+    // -------------------
+    // A large image streamed to the GPU tile by tile, drawn with the TiledImage overloads of Draw::Image and Draw::Crop
+    // Call Update once per frame on the GL thread.
+    class TiledImage {
+    public:
+        // cacheDirectory defaults to a folder in the system temporary directory
+        explicit TiledImage(const std::string& path, size_t gpuBudgetBytes = 128 * 1024 * 1024, const std::string& cacheDirectory = "");
+
+        // Stops the tile thread and releases every tile
+        ~TiledImage();
+
+        TiledImage(const TiledImage&) = delete;
+        TiledImage& operator=(const TiledImage&) = delete;
+
+        // Whether the tile pyramid is available
+        bool Ready() const;
+
+        // Whether the image could not be decoded or cached
+        bool Failed() const;
+
+        // Full resolution size in pixels, 0 until Ready
+        int Width() const;
+        int Height() const;
+
+        // Number of pyramid levels, the last holds the whole image in a single tile
+        int LevelCount() const;
+
+        // Coarsest pyramid level whose resolution meets a number of screen pixels per image pixel
+        int LevelForScale(float screenScale) const;
+
+        // Returns the tiles covering a region drawn at a given number of screen pixels per image pixel, requesting missing ones
+        void CollectTiles(float x0, float y0, float x1, float y1, float screenScale, std::vector<ImageTile>& outTiles);
+
+        // Returns the tiles covering a region at a specific pyramid level, optionally requesting missing ones
+        void CollectLevelTiles(float x0, float y0, float x1, float y1, int level, std::vector<ImageTile>& outTiles, bool requestMissing = true);
+
+        // Uploads tiles read since the last frame and evicts unused tiles over the budget
+        void Update(size_t uploadBudgetBytes = 8 * 1024 * 1024);
+
+        // Current cache counters
+        TiledImageStats Stats() const;
+
+    private:
+        enum class State { Building, Ready, Failed };
+
+        struct ResidentTile
+        {
+            TextureData texture;
+            std::list<uint64_t>::iterator position;
+            int lastFrame = 0;
+            std::chrono::steady_clock::time_point uploadTime;
+        };
+
+        struct LoadedTile
+        {
+            uint64_t key = 0;
+            std::vector<unsigned char> pixels;
+        };
+
+        void workerLoop();
+        bool buildCache();
+        bool readHeader();
+        bool readTile(FILE* file, uint64_t key, std::vector<unsigned char>& outPixels) const;
+        size_t tileOffset(int level, int tileX, int tileY) const;
+        int levelWidth(int level) const;
+        int levelHeight(int level) const;
+        const ResidentTile* touch(uint64_t key);
+        void release(uint64_t key);
+
+        std::string sourcePath;
+        std::string cachePath;
+        size_t gpuBudget = 0;
+        int width = 0;
+        int height = 0;
+        int levels = 0;
+        std::atomic<State> state{ State::Building };
+        std::atomic<int> frame{ 0 };
+
+        mutable std::mutex mutex;
+        std::condition_variable requestCondition;
+        std::unordered_map<uint64_t, int> requests;
+        std::unordered_set<uint64_t> failedTiles;
+        std::vector<LoadedTile> loaded;
+        std::atomic<bool> stopping{ false };
+        std::thread worker;
+
+        std::unordered_map<uint64_t, ResidentTile> resident;
+        std::list<uint64_t> recentlyUsed;
+        TiledImageStats stats;
+    };
+}
+
+#endif //TILEDIMAGE_H
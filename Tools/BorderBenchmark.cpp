@@ -0,0 +1,220 @@
+/*
+ * BorderBenchmark.cpp
+ *
+ * Command line tool that compares the geometry and CPU time of bordered grids drawn the way
+ * Draw::BoxAround and Draw::BoxAroundWithStroke did before pixel-aligned borders were
+ * snapped to hard-edged rings, one AddRect per outline and 33 per stroked outline, with the
+ * current functions. Each grid is drawn in a headless ImGui context under ImGui's three line
+ * styles: textured anti-aliased lines (the default), anti-aliased lines without texture, and
+ * aliased lines. Aligned grids use whole-pixel borders at integer positions; unaligned grids
+ * sit a quarter pixel off, which keeps the AddRect path.
+ *
+ * Usage: BorderBenchmark [--columns N] [--rows N] [--frames N]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+#include "imgui.h"
+#include "imgui_internal.h"
+#include "DrawStats.h"
+#include "DrawTools.h"
+#include "../ImVec2Operators.h"
+
+// Structure:   GridCase
+// ---------------------
+// One bordered grid configuration
+//
+// const char* name:    label printed for the case
+// bool stroked:        whether each cell uses BoxAroundWithStroke rather than BoxAround
+// float offset:        sub-pixel offset added to every cell position
+// float width:         border width in pixels
+struct GridCase
+{
+    const char* name;
+    bool stroked;
+    float offset;
+    float width;
+};
+
+// Structure:   GridResult
+// -----------------------
+// Geometry and time of one grid draw, averaged over the measured frames
+struct GridResult
+{
+    int vertices = 0;
+    int indices = 0;
+    double milliseconds = 0.0;
+};
+
+// Helper Function:    LegacyBoxAround
+// -----------------------------------
+// BoxAround as it was before aligned borders were snapped: one AddRect stroke
+static void LegacyBoxAround(ImVec2 size, ImVec2 position, float width, ImU32 color, float transparency)
+{
+    ImU32 colorWithAlpha = (color & 0x00FFFFFF) | (ImU32)(transparency * 255.0f) << 24;
+    ImGui::GetWindowDrawList()->AddRect(position - ImVec2(width, width), position + size + ImVec2(width, width), colorWithAlpha, 0.0f, 0, width);
+}
+
+// Helper Function:    LegacyBoxAroundWithStroke
+// ---------------------------------------------
+// BoxAroundWithStroke as it was before aligned borders were snapped: 32 offset copies and the box
+static void LegacyBoxAroundWithStroke(ImVec2 size, ImVec2 offset, float width, ImU32 color, float strokeWidth, ImU32 strokeColor, float transparency)
+{
+    constexpr int segments = 32;
+    const float step = 2.0f * IM_PI / segments;
+    for (int i = 0; i < segments; ++i)
+    {
+        const float angle = step * i;
+        LegacyBoxAround(size, offset + ImVec2(cosf(angle), sinf(angle)) * strokeWidth, width, strokeColor, transparency);
+    }
+    LegacyBoxAround(size, offset, width, color, transparency);
+}
+
+// Helper Function:    DrawGrid
+// ----------------------------
+// Draws one frame of a bordered grid and measures it
+//
+// GridCase test:   grid configuration
+// bool legacy:     draw with the pre-snapping code paths instead of the Draw:: functions
+// int columns:     cells per row
+// int rows:        rows of cells
+//
+// Returns the vertices, indices and time the grid added to the window's draw list
+static GridResult DrawGrid(const GridCase& test, bool legacy, int columns, int rows)
+{
+    const ImVec2 cellSize = ImVec2(40.0f, 30.0f);
+    const ImVec2 spacing = ImVec2(50.0f, 40.0f);
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    const int vertexStart = drawList->VtxBuffer.Size;
+    const int indexStart = drawList->IdxBuffer.Size;
+
+    auto start = std::chrono::steady_clock::now();
+    for (int row = 0; row < rows; row++)
+    {
+        for (int column = 0; column < columns; column++)
+        {
+            const ImVec2 position = ImVec2(8.0f + column * spacing.x + test.offset, 8.0f + row * spacing.y + test.offset);
+            if (test.stroked && legacy)
+                LegacyBoxAroundWithStroke(cellSize, position, test.width, IM_COL32(240, 240, 240, 255), 2.0f, IM_COL32_BLACK, 1.0f);
+            else if (test.stroked)
+                Draw::BoxAroundWithStroke(cellSize, position, test.width, IM_COL32(240, 240, 240, 255), 2.0f, IM_COL32_BLACK, 1.0f, 0.0f, 0);
+            else if (legacy)
+                LegacyBoxAround(cellSize, position, test.width, IM_COL32(240, 240, 240, 255), 1.0f);
+            else
+                Draw::BoxAround(cellSize, position, test.width, IM_COL32(240, 240, 240, 255), 1.0f, 0.0f, 0);
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    GridResult result;
+    result.vertices = drawList->VtxBuffer.Size - vertexStart;
+    result.indices = drawList->IdxBuffer.Size - indexStart;
+    result.milliseconds = std::chrono::duration<double, std::milli>(end - start).count();
+    return result;
+}
+
+// Helper Function:    Measure
+// ---------------------------
+// Draws a grid over several frames, each in a fresh window, and averages the frames after the first
+static GridResult Measure(const GridCase& test, bool legacy, int columns, int rows, int frames)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    GridResult total;
+    for (int frame = 0; frame < frames; frame++)
+    {
+        ImGui::NewFrame();
+        ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+        ImGui::SetNextWindowSize(io.DisplaySize);
+        ImGui::Begin("Borders", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoSavedSettings);
+
+        // The first frame grows the draw list's buffers
+        GridResult result = DrawGrid(test, legacy, columns, rows);
+        if (frame > 0)
+        {
+            total.vertices = result.vertices;
+            total.indices = result.indices;
+            total.milliseconds += result.milliseconds;
+        }
+
+        ImGui::End();
+        ImGui::Render();
+    }
+    total.milliseconds /= (frames - 1);
+    return total;
+}
+
+int main(int argc, char** argv)
+{
+    int columns = 76;
+    int rows = 53;
+    int frames = 20;
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--columns") == 0 && i + 1 < argc)
+            columns = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--rows") == 0 && i + 1 < argc)
+            rows = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc)
+            frames = std::max(2, atoi(argv[++i]));
+    }
+
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(3840.0f, 2160.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    io.Fonts->AddFontDefault();
+
+    unsigned char* atlasPixels = nullptr;
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    io.Fonts->GetTexDataAsRGBA32(&atlasPixels, &atlasWidth, &atlasHeight);
+    io.Fonts->SetTexID((ImTextureID)1);
+
+    const GridCase cases[] = {
+        { "BoxAround aligned 1px", false, 0.0f, 1.0f },
+        { "BoxAround aligned 3px", false, 0.0f, 3.0f },
+        { "BoxAround unaligned 2px", false, 0.25f, 2.0f },
+        { "WithStroke aligned 1px", true, 0.0f, 1.0f },
+        { "WithStroke unaligned 2px", true, 0.25f, 2.0f },
+    };
+
+    struct LineStyle
+    {
+        const char* name;
+        bool antiAliased;
+        bool textured;
+    };
+    const LineStyle styles[] = {
+        { "textured AA lines", true, true },
+        { "AA lines", true, false },
+        { "aliased lines", false, false },
+    };
+
+    printf("%d x %d cells, %d frames\n", columns, rows, frames);
+    for (const LineStyle& style : styles)
+    {
+        ImGui::GetStyle().AntiAliasedLines = style.antiAliased;
+        ImGui::GetStyle().AntiAliasedLinesUseTex = style.textured;
+
+        printf("\n%s\n", style.name);
+        printf("%-26s %12s %12s %10s %12s %12s %10s %10s\n", "grid", "vtx before", "idx before", "ms before",
+               "vtx after", "idx after", "ms after", "snapped");
+        for (const GridCase& test : cases)
+        {
+            const GridResult before = Measure(test, true, columns, rows, frames);
+            Draw::ResetStats();
+            const GridResult after = Measure(test, false, columns, rows, frames);
+            printf("%-26s %12d %12d %10.3f %12d %12d %10.3f %10d\n", test.name, before.vertices, before.indices, before.milliseconds,
+                   after.vertices, after.indices, after.milliseconds, Draw::Stats().snappedBorders / frames);
+        }
+    }
+
+    ImGui::DestroyContext();
+    return 0;
+}
@@ -0,0 +1,122 @@
+/*
+ * BulkLoadBenchmark.cpp
+ *
+ * Command line tool that measures how BulkLoader throughput scales with the number of decode
+ * threads. Every source image in a directory is loaded through the full pipeline, read, decode
+ * and upload into a hidden OpenGL context, once per decoder count from 1 up to the maximum,
+ * doubling each time. An untimed pass first warms the operating system's file cache so every
+ * run reads from memory.
+ *
+ * Usage: BulkLoadBenchmark <image directory> [--max-decoders N] [--readers N]
+ */
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "BulkLoader.h"
+
+// Helper Function:    RunLoader
+// ------------------------------
+// Loads every queued image through a BulkLoader, deleting each texture as soon as it is returned
+//
+// vector paths:    images to load
+// int decoders:    decode threads
+// int readers:     reader threads
+//
+// Returns the loader's counters once every image has been returned
+static BulkLoadProgress RunLoader(const std::vector<std::string>& paths, int decoders, int readers)
+{
+    Texture::BulkLoader loader(decoders, readers);
+    for (const std::string& path : paths)
+        loader.Enqueue(path);
+
+    while (!loader.Done())
+    {
+        std::vector<BulkLoadResult> results = loader.Pump();
+        for (const BulkLoadResult& result : results)
+            if (result.texture.id != 0)
+                glDeleteTextures(1, &result.texture.id);
+        if (results.empty())
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+    }
+    glFinish();
+    return loader.Progress();
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <image directory> [--max-decoders N] [--readers N]\n", argv[0]);
+        return 1;
+    }
+
+    int maxDecoders = 32;
+    int readers = 2;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--max-decoders") == 0 && i + 1 < argc)
+            maxDecoders = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--readers") == 0 && i + 1 < argc)
+            readers = std::max(1, atoi(argv[++i]));
+    }
+
+    // Lists images as Texture::LoadDirectory does, which always uses the default decoder count
+    std::vector<std::string> paths;
+    static const char* extensions[] = { ".png", ".jpg", ".jpeg", ".bmp", ".tga", ".qoi" };
+    std::error_code error;
+    for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator(argv[1], error))
+    {
+        const std::string extension = entry.path().extension().string();
+        if (entry.is_regular_file() && std::any_of(std::begin(extensions), std::end(extensions), [&](const char* e) { return extension == e; }))
+            paths.push_back(entry.path().string());
+    }
+    std::sort(paths.begin(), paths.end());
+    if (error || paths.empty())
+    {
+        fprintf(stderr, "BulkLoadBenchmark: no images found in %s\n", argv[1]);
+        return 1;
+    }
+
+    if (!glfwInit())
+    {
+        fprintf(stderr, "BulkLoadBenchmark: failed to initialize GLFW\n");
+        return 1;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    GLFWwindow* window = glfwCreateWindow(64, 64, "BulkLoadBenchmark", nullptr, nullptr);
+    if (window == nullptr)
+    {
+        fprintf(stderr, "BulkLoadBenchmark: failed to create an OpenGL context\n");
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+
+    RunLoader(paths, 0, readers);
+
+    printf("%s, %d images, %d readers, %u hardware threads\n", (const char*)glGetString(GL_RENDERER),
+           (int)paths.size(), readers, std::thread::hardware_concurrency());
+    printf("%8s %8s %8s %10s %10s\n", "decoders", "loaded", "failed", "seconds", "images/s");
+
+    int failures = 0;
+    for (int decoders = 1; decoders <= maxDecoders; decoders *= 2)
+    {
+        BulkLoadProgress progress = RunLoader(paths, decoders, readers);
+        printf("%8d %8d %8d %10.3f %10.1f\n", decoders, progress.uploaded, progress.failed,
+               progress.elapsedSeconds, progress.ImagesPerSecond());
+        failures += progress.failed;
+    }
+
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+/*
+ * GridOverflowTest.cpp
+ *
+ * Command line check that Draw::Grid and Draw::PopulateGrid stay valid past the 65,535
+ * vertices a 16-bit index can address. Each function emits a million quads into a window of
+ * a headless ImGui context whose renderer reports VtxOffset support. The tool then walks the
+ * window's draw commands and checks four things: every index resolves to a vertex inside the
+ * buffer, each VtxOffset change starts a new command, every quad sits where the grid puts
+ * it, and each cell uses its texture. It prints the command and split counts and exits
+ * nonzero on the first mismatch.
+ *
+ * Usage: GridOverflowTest [--quads N]
+ */
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <vector>
+
+#include "imgui.h"
+#include "DrawStats.h"
+#include "DrawTools.h"
+#include "../ImVec2Operators.h"
+
+// Structure:   ExpectedQuad
+// -------------------------
+// Corners and texture a quad written by a grid function must have
+struct ExpectedQuad
+{
+    ImVec2 min;
+    ImVec2 max;
+    ImTextureID texture;
+};
+
+// Structure:   QuadCheck
+// ----------------------
+// What a call wrote into its draw list, as found by CheckQuads
+//
+// int commands:    draw commands holding the call's indices
+// int offsets:     distinct VtxOffset values among those commands
+// int quads:       quads found
+// bool valid:      whether every quad matched and every index was in range
+struct QuadCheck
+{
+    int commands = 0;
+    int offsets = 0;
+    int quads = 0;
+    bool valid = true;
+};
+
+// Helper Function:    Near
+// ------------------------
+// Compares two positions with a tolerance for float rounding far from the origin
+static bool Near(const ImVec2& a, const ImVec2& b)
+{
+    const float tolerance = 0.01f * std::max(1.0f, std::max(std::fabs(b.x), std::fabs(b.y)) / 1000.0f);
+    return std::fabs(a.x - b.x) <= tolerance && std::fabs(a.y - b.y) <= tolerance;
+}
+
+// Helper Function:    CheckQuads
+// -----------------------------
+// Walks the indices a call appended to a draw list, six per quad as PrimRect writes them, and
+// compares each quad's top-left and bottom-right corners and texture with the expected ones
+//
+// ImDrawList list:     draw list the call wrote into
+// int firstIndex:      size of the list's index buffer before the call
+// int quadCount:       quads the call should have written
+// function expected:   expected corners and texture of a quad
+//
+// Returns the counts found, with valid cleared and the first mismatch printed on failure
+static QuadCheck CheckQuads(const ImDrawList* list, int firstIndex, int quadCount, const std::function<ExpectedQuad(int)>& expected)
+{
+    QuadCheck check;
+    unsigned int lastOffset = ~0u;
+    for (const ImDrawCmd& cmd : list->CmdBuffer)
+    {
+        const int begin = std::max((int)cmd.IdxOffset, firstIndex);
+        const int end = (int)(cmd.IdxOffset + cmd.ElemCount);
+        if (cmd.UserCallback != nullptr || end <= begin)
+            continue;
+
+        check.commands++;
+        if (cmd.VtxOffset != lastOffset)
+        {
+            check.offsets++;
+            lastOffset = cmd.VtxOffset;
+        }
+        if ((end - begin) % 6 != 0)
+        {
+            printf("  command at index %d holds %d indices, not whole quads\n", begin, end - begin);
+            check.valid = false;
+            return check;
+        }
+
+        for (int index = begin; index < end; index += 6, check.quads++)
+        {
+            for (int corner = 0; corner < 6; corner++)
+            {
+                const unsigned int vertex = cmd.VtxOffset + list->IdxBuffer[index + corner];
+                if (vertex >= (unsigned int)list->VtxBuffer.Size)
+                {
+                    printf("  quad %d: index resolves to vertex %u past the %d-vertex buffer\n", check.quads, vertex, list->VtxBuffer.Size);
+                    check.valid = false;
+                    return check;
+                }
+            }
+            if (check.quads >= quadCount)
+                continue;
+
+            const ExpectedQuad quad = expected(check.quads);
+            const ImVec2 topLeft = list->VtxBuffer[cmd.VtxOffset + list->IdxBuffer[index]].pos;
+            const ImVec2 bottomRight = list->VtxBuffer[cmd.VtxOffset + list->IdxBuffer[index + 2]].pos;
+            if (!Near(topLeft, quad.min) || !Near(bottomRight, quad.max) || cmd.GetTexID() != quad.texture)
+            {
+                printf("  quad %d: (%.2f, %.2f)-(%.2f, %.2f) texture %llu, expected (%.2f, %.2f)-(%.2f, %.2f) texture %llu\n", check.quads,
+                       topLeft.x, topLeft.y, bottomRight.x, bottomRight.y, (unsigned long long)(intptr_t)cmd.GetTexID(),
+                       quad.min.x, quad.min.y, quad.max.x, quad.max.y, (unsigned long long)(intptr_t)quad.texture);
+                check.valid = false;
+                return check;
+            }
+        }
+    }
+
+    if (check.quads != quadCount)
+    {
+        printf("  found %d quads, expected %d\n", check.quads, quadCount);
+        check.valid = false;
+    }
+    return check;
+}
+
+// Helper Function:    RunCase
+// ---------------------------
+// Calls a grid function alone in a frame's window and checks what it wrote
+//
+// Returns true if the call wrote exactly the expected quads with valid indices
+static bool RunCase(const char* name, int quadCount, const std::function<void()>& draw, const std::function<ExpectedQuad(int)>& expected)
+{
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui::NewFrame();
+    ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowSize(io.DisplaySize);
+    ImGui::Begin(name, nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoSavedSettings);
+
+    ImDrawList* list = ImGui::GetWindowDrawList();
+    const int firstIndex = list->IdxBuffer.Size;
+    Draw::ResetStats();
+    draw();
+    const Draw::DrawStats stats = Draw::Stats();
+    const QuadCheck check = CheckQuads(list, firstIndex, quadCount, expected);
+
+    ImGui::End();
+    ImGui::Render();
+
+    // Every VtxOffset after the first must come from a split the library counted
+    const bool splitsMatch = check.offsets - 1 == stats.vtxOffsetSplits;
+    const bool passed = check.valid && stats.droppedItems == 0 && splitsMatch;
+    printf("%-14s %10d %10d %10d %10d %10d  %s\n", name, check.quads, check.commands, check.offsets, stats.vtxOffsetSplits,
+           stats.droppedItems, passed ? "ok" : "FAILED");
+    if (!splitsMatch)
+        printf("  %d VtxOffset values but %d splits counted\n", check.offsets, stats.vtxOffsetSplits);
+    return passed;
+}
+
+int main(int argc, char** argv)
+{
+    int quads = 1000000;
+    for (int i = 1; i < argc; i++)
+        if (strcmp(argv[i], "--quads") == 0 && i + 1 < argc)
+            quads = std::max(4, atoi(argv[++i]));
+
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(3840.0f, 2160.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+    io.BackendFlags |= ImGuiBackendFlags_RendererHasVtxOffset;
+    ImGui::GetStyle().WindowBorderSize = 0.0f;
+    io.Fonts->AddFontDefault();
+
+    unsigned char* atlasPixels = nullptr;
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    io.Fonts->GetTexDataAsRGBA32(&atlasPixels, &atlasWidth, &atlasHeight);
+    io.Fonts->SetTexID((ImTextureID)1);
+
+    printf("%d-byte indices, %d quads per case\n", (int)sizeof(ImDrawIdx), quads);
+    printf("%-14s %10s %10s %10s %10s %10s\n", "case", "quads", "commands", "offsets", "splits", "dropped");
+
+    bool passed = true;
+
+    // Grid: as many gridlines as quads, half vertical and half horizontal
+    {
+        const int columns = quads / 2 - 1;
+        const int rows = quads - quads / 2 - 1;
+        const ImVec2 origin = ImVec2(4.0f, 4.0f);
+        const float cell = 2.0f;
+        const float line = 1.0f;
+        const float width = (columns + 1) * line + cell * columns;
+        const float height = (rows + 1) * line + cell * rows;
+
+        passed &= RunCase("Grid", columns + 1 + rows + 1,
+            [&]() { Draw::Grid(origin, columns, rows, cell, cell, line, IM_COL32_WHITE); },
+            [&](int quad)
+            {
+                if (quad <= columns)
+                {
+                    const ImVec2 anchor = origin + ImVec2((cell + line) * quad, 0.0f);
+                    return ExpectedQuad{ anchor, anchor + ImVec2(line, height), (ImTextureID)1 };
+                }
+                const ImVec2 anchor = origin + ImVec2(0.0f, (cell + line) * (quad - columns - 1));
+                return ExpectedQuad{ anchor, anchor + ImVec2(width, line), (ImTextureID)1 };
+            });
+    }
+
+    // PopulateGrid: a 1000-column grid of cells in runs of three textures, so splits fall both inside and between runs
+    {
+        const int columns = 1000;
+        const int rows = (quads + columns - 1) / columns;
+        const ImVec2 origin = ImVec2(4.0f, 4.0f);
+        const float cell = 3.0f;
+        const float line = 1.0f;
+
+        std::vector<TextureData> images(quads);
+        for (int i = 0; i < quads; i++)
+        {
+            images[i].id = (GLuint)(10 + (i / 100000) % 3);
+            images[i].width = 64;
+            images[i].height = 64;
+        }
+
+        passed &= RunCase("PopulateGrid", quads,
+            [&]() { Draw::PopulateGrid(images, origin, columns, rows, cell, cell, line); },
+            [&](int quad)
+            {
+                const ImVec2 anchor = origin + ImVec2(line, line) + ImVec2((quad % columns) * (cell + line), (quad / columns) * (cell + line));
+                return ExpectedQuad{ anchor, anchor + ImVec2(cell, cell), (ImTextureID)(intptr_t)images[quad].id };
+            });
+    }
+
+    ImGui::DestroyContext();
+    return passed ? 0 : 1;
+}
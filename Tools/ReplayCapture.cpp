@@ -0,0 +1,351 @@
+/*
+ * ReplayCapture.cpp
+ *
+ * Command line tool that replays frame captures written by Capture::SaveFrame through the
+ * OpenGL 3 renderer backend, so heavy frames recorded in the field become repeatable renderer
+ * benchmarks. Each capture is rendered in a loop into a framebuffer object sized to its
+ * DisplaySize times FramebufferScale, so no window or screen size limits the replay. The tool
+ * reports the CPU time spent submitting the frame separately from the time the GPU, or
+ * llvmpipe with --software, takes to finish rasterizing it.
+ *
+ * Usage: ReplayCapture <capture file or directory> [--iterations N] [--software]
+ */
+#include <GLFW/glfw3.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+#include "imgui_impl_opengl3.h"
+#include "FrameCapture.h"
+
+namespace fs = std::filesystem;
+
+// Framebuffer object entry points are not in every platform's GL headers, so they are loaded through GLFW
+#ifndef GL_FRAMEBUFFER
+#define GL_FRAMEBUFFER              0x8D40
+#define GL_RENDERBUFFER             0x8D41
+#define GL_COLOR_ATTACHMENT0        0x8CE0
+#define GL_FRAMEBUFFER_COMPLETE     0x8CD5
+#endif
+#ifndef GL_RGBA8
+#define GL_RGBA8                    0x8058
+#endif
+
+typedef void (APIENTRY* GenObjectsProc)(GLsizei count, GLuint* ids);
+typedef void (APIENTRY* DeleteObjectsProc)(GLsizei count, const GLuint* ids);
+typedef void (APIENTRY* BindObjectProc)(GLenum target, GLuint id);
+typedef void (APIENTRY* RenderbufferStorageProc)(GLenum target, GLenum format, GLsizei width, GLsizei height);
+typedef void (APIENTRY* FramebufferRenderbufferProc)(GLenum target, GLenum attachment, GLenum renderbufferTarget, GLuint renderbuffer);
+typedef GLenum (APIENTRY* CheckFramebufferStatusProc)(GLenum target);
+
+// Structure:   FramebufferFunctions
+// ---------------------------------
+// GL 3.0 framebuffer object functions used to render offscreen
+struct FramebufferFunctions
+{
+    GenObjectsProc genFramebuffers = nullptr;
+    DeleteObjectsProc deleteFramebuffers = nullptr;
+    BindObjectProc bindFramebuffer = nullptr;
+    GenObjectsProc genRenderbuffers = nullptr;
+    DeleteObjectsProc deleteRenderbuffers = nullptr;
+    BindObjectProc bindRenderbuffer = nullptr;
+    RenderbufferStorageProc renderbufferStorage = nullptr;
+    FramebufferRenderbufferProc framebufferRenderbuffer = nullptr;
+    CheckFramebufferStatusProc checkFramebufferStatus = nullptr;
+};
+
+// Structure:   OffscreenTarget
+// ----------------------------
+// A framebuffer object with one RGBA8 color renderbuffer
+struct OffscreenTarget
+{
+    GLuint framebuffer = 0;
+    GLuint color = 0;
+};
+
+// Helper Function:    LoadFramebufferFunctions
+// --------------------------------------------
+// Looks up the framebuffer object functions in the current context
+//
+// Returns true if every function was found
+static bool LoadFramebufferFunctions(FramebufferFunctions& gl)
+{
+    gl.genFramebuffers = (GenObjectsProc)glfwGetProcAddress("glGenFramebuffers");
+    gl.deleteFramebuffers = (DeleteObjectsProc)glfwGetProcAddress("glDeleteFramebuffers");
+    gl.bindFramebuffer = (BindObjectProc)glfwGetProcAddress("glBindFramebuffer");
+    gl.genRenderbuffers = (GenObjectsProc)glfwGetProcAddress("glGenRenderbuffers");
+    gl.deleteRenderbuffers = (DeleteObjectsProc)glfwGetProcAddress("glDeleteRenderbuffers");
+    gl.bindRenderbuffer = (BindObjectProc)glfwGetProcAddress("glBindRenderbuffer");
+    gl.renderbufferStorage = (RenderbufferStorageProc)glfwGetProcAddress("glRenderbufferStorage");
+    gl.framebufferRenderbuffer = (FramebufferRenderbufferProc)glfwGetProcAddress("glFramebufferRenderbuffer");
+    gl.checkFramebufferStatus = (CheckFramebufferStatusProc)glfwGetProcAddress("glCheckFramebufferStatus");
+    return gl.genFramebuffers && gl.deleteFramebuffers && gl.bindFramebuffer && gl.genRenderbuffers && gl.deleteRenderbuffers &&
+           gl.bindRenderbuffer && gl.renderbufferStorage && gl.framebufferRenderbuffer && gl.checkFramebufferStatus;
+}
+
+// Helper Function:    CreateOffscreenTarget
+// -----------------------------------------
+// Creates and binds a framebuffer of the given size, so replayed frames are rasterized at the
+// capture's own resolution whatever the window system allows
+//
+// Returns true if the framebuffer is complete
+static bool CreateOffscreenTarget(const FramebufferFunctions& gl, int width, int height, OffscreenTarget& target)
+{
+    gl.genRenderbuffers(1, &target.color);
+    gl.bindRenderbuffer(GL_RENDERBUFFER, target.color);
+    gl.renderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, width, height);
+
+    gl.genFramebuffers(1, &target.framebuffer);
+    gl.bindFramebuffer(GL_FRAMEBUFFER, target.framebuffer);
+    gl.framebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, target.color);
+    return gl.checkFramebufferStatus(GL_FRAMEBUFFER) == GL_FRAMEBUFFER_COMPLETE;
+}
+
+// Helper Function:    DestroyOffscreenTarget
+// ------------------------------------------
+// Rebinds the default framebuffer and deletes an offscreen target
+static void DestroyOffscreenTarget(const FramebufferFunctions& gl, OffscreenTarget& target)
+{
+    gl.bindFramebuffer(GL_FRAMEBUFFER, 0);
+    gl.deleteFramebuffers(1, &target.framebuffer);
+    gl.deleteRenderbuffers(1, &target.color);
+    target = OffscreenTarget{};
+}
+
+// Structure:   TimingSummary
+// --------------------------
+// Distribution of one measurement over the replay iterations, in milliseconds
+struct TimingSummary
+{
+    double mean = 0.0;
+    double median = 0.0;
+    double p95 = 0.0;
+};
+
+// Helper Function:    Summarize
+// -----------------------------
+// Computes mean, median and 95th percentile of a list of samples
+static TimingSummary Summarize(std::vector<double> samples)
+{
+    TimingSummary summary;
+    if (samples.empty())
+        return summary;
+
+    std::sort(samples.begin(), samples.end());
+    for (double sample : samples)
+        summary.mean += sample;
+    summary.mean /= samples.size();
+    summary.median = samples[samples.size() / 2];
+    summary.p95 = samples[std::min(samples.size() - 1, (size_t)(samples.size() * 0.95))];
+    return summary;
+}
+
+// Helper Function:    UploadCapturedTexture
+// -----------------------------------------
+// Creates a GL texture for a captured texture, or a checkerboard stand-in when its pixels were not embedded
+static GLuint UploadCapturedTexture(const CapturedTexture& texture)
+{
+    int width = texture.width > 0 ? texture.width : 8;
+    int height = texture.height > 0 ? texture.height : 8;
+
+    std::vector<unsigned char> checker;
+    const unsigned char* pixels = texture.pixels;
+    if (pixels == nullptr)
+    {
+        checker.resize((size_t)width * height * 4);
+        for (int y = 0; y < height; y++)
+            for (int x = 0; x < width; x++)
+            {
+                unsigned char value = ((x / 8 + y / 8) & 1) ? 200 : 80;
+                unsigned char* p = &checker[((size_t)y * width + x) * 4];
+                p[0] = p[1] = p[2] = value;
+                p[3] = 255;
+            }
+        pixels = checker.data();
+    }
+
+    GLuint id = 0;
+    glGenTextures(1, &id);
+    glBindTexture(GL_TEXTURE_2D, id);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA, width, height, 0, GL_RGBA, GL_UNSIGNED_BYTE, pixels);
+    return id;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <capture file or directory> [--iterations N] [--software]\n", argv[0]);
+        return 1;
+    }
+
+    int iterations = 200;
+    bool software = false;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--software") == 0)
+            software = true;
+    }
+
+    std::vector<fs::path> captures;
+    std::error_code error;
+    if (fs::is_directory(argv[1], error))
+    {
+        for (const fs::directory_entry& entry : fs::directory_iterator(argv[1], error))
+            if (entry.is_regular_file() && entry.path().extension() == ".imcap")
+                captures.push_back(entry.path());
+        std::sort(captures.begin(), captures.end());
+    }
+    else
+    {
+        captures.push_back(argv[1]);
+    }
+    if (captures.empty())
+    {
+        fprintf(stderr, "ReplayCapture: no captures found in %s\n", argv[1]);
+        return 1;
+    }
+
+    // Mesa's llvmpipe stands in for the GPU when asked to, so results do not depend on the driver
+    if (software)
+    {
+#ifdef _WIN32
+        _putenv_s("LIBGL_ALWAYS_SOFTWARE", "1");
+#else
+        setenv("LIBGL_ALWAYS_SOFTWARE", "1", 1);
+#endif
+    }
+
+    if (!glfwInit())
+    {
+        fprintf(stderr, "ReplayCapture: failed to initialize GLFW\n");
+        return 1;
+    }
+    glfwWindowHint(GLFW_VISIBLE, GLFW_FALSE);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);
+    glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+    glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+#ifdef __APPLE__
+    glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GLFW_TRUE);
+#endif
+    // The window only provides the context; frames are rendered into a framebuffer object
+    GLFWwindow* window = glfwCreateWindow(64, 64, "ReplayCapture", nullptr, nullptr);
+    if (window == nullptr)
+    {
+        fprintf(stderr, "ReplayCapture: failed to create an OpenGL 3.3 context\n");
+        glfwTerminate();
+        return 1;
+    }
+    glfwMakeContextCurrent(window);
+    glfwSwapInterval(0);
+
+    FramebufferFunctions gl;
+    if (!LoadFramebufferFunctions(gl))
+    {
+        fprintf(stderr, "ReplayCapture: the OpenGL context lacks framebuffer objects\n");
+        glfwDestroyWindow(window);
+        glfwTerminate();
+        return 1;
+    }
+
+    ImGui::CreateContext();
+    ImGui::GetIO().IniFilename = nullptr;
+    ImGui_ImplOpenGL3_Init("#version 330");
+    ImGui_ImplOpenGL3_NewFrame();
+
+    printf("%s, %d iterations\n", (const char*)glGetString(GL_RENDERER), iterations);
+    printf("%-32s %6s %9s %9s %9s %9s %9s %9s %9s %9s\n", "capture", "lists", "commands", "vertices",
+           "submit", "med", "p95", "raster", "med", "p95");
+
+    int failures = 0;
+    for (const fs::path& path : captures)
+    {
+        Capture::CaptureFile capture;
+        if (!capture.Open(path.string()))
+        {
+            fprintf(stderr, "ReplayCapture: %s is not a valid capture\n", path.string().c_str());
+            failures++;
+            continue;
+        }
+
+        std::vector<GLuint> textures;
+        std::vector<ImTextureID> textureIds;
+        for (const CapturedTexture& texture : capture.Textures())
+        {
+            textures.push_back(UploadCapturedTexture(texture));
+            textureIds.push_back((ImTextureID)(intptr_t)textures.back());
+        }
+
+        std::vector<std::unique_ptr<ImDrawList>> lists;
+        ImDrawData drawData;
+        capture.BuildDrawData(textureIds, lists, drawData);
+
+        int commandCount = 0;
+        for (const CapturedDrawList& list : capture.DrawLists())
+            commandCount += list.commandCount;
+
+        int framebufferWidth = std::max(1, (int)(drawData.DisplaySize.x * drawData.FramebufferScale.x));
+        int framebufferHeight = std::max(1, (int)(drawData.DisplaySize.y * drawData.FramebufferScale.y));
+
+        OffscreenTarget target;
+        if (!CreateOffscreenTarget(gl, framebufferWidth, framebufferHeight, target))
+        {
+            fprintf(stderr, "ReplayCapture: cannot create a %dx%d framebuffer for %s\n", framebufferWidth, framebufferHeight, path.string().c_str());
+            DestroyOffscreenTarget(gl, target);
+            glDeleteTextures((GLsizei)textures.size(), textures.data());
+            failures++;
+            continue;
+        }
+
+        // One untimed frame warms up shader and buffer state
+        std::vector<double> submitTimes;
+        std::vector<double> rasterTimes;
+        for (int i = -1; i < iterations; i++)
+        {
+            glViewport(0, 0, framebufferWidth, framebufferHeight);
+            glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
+            glClear(GL_COLOR_BUFFER_BIT);
+            glFinish();
+
+            auto start = std::chrono::steady_clock::now();
+            ImGui_ImplOpenGL3_RenderDrawData(&drawData);
+            auto submitted = std::chrono::steady_clock::now();
+            glFinish();
+            auto finished = std::chrono::steady_clock::now();
+
+            if (i >= 0)
+            {
+                submitTimes.push_back(std::chrono::duration<double, std::milli>(submitted - start).count());
+                rasterTimes.push_back(std::chrono::duration<double, std::milli>(finished - submitted).count());
+            }
+        }
+
+        TimingSummary submit = Summarize(submitTimes);
+        TimingSummary raster = Summarize(rasterTimes);
+        printf("%-32s %6d %9d %9d %9.3f %9.3f %9.3f %9.3f %9.3f %9.3f\n", path.filename().string().c_str(),
+               drawData.CmdListsCount, commandCount, drawData.TotalVtxCount,
+               submit.mean, submit.median, submit.p95, raster.mean, raster.median, raster.p95);
+
+        DestroyOffscreenTarget(gl, target);
+        glDeleteTextures((GLsizei)textures.size(), textures.data());
+    }
+
+    ImGui_ImplOpenGL3_Shutdown();
+    ImGui::DestroyContext();
+    glfwDestroyWindow(window);
+    glfwTerminate();
+    return failures == 0 ? 0 : 1;
+}
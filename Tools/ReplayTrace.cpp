@@ -0,0 +1,124 @@
+/*
+ * ReplayTrace.cpp
+ *
+ * Command line tool that replays a library call trace recorded with Draw::BeginTrace in a
+ * headless ImGui context. No window or GPU is needed, since only the library code is timed:
+ * draw lists are built as usual and then discarded. The tool reports the time per frame and
+ * the time spent in each kind of call, along with the vertices the frames produced and the
+ * Draw:: geometry counters, so changes to the library's internals can be compared on recorded
+ * production frames.
+ *
+ * Usage: ReplayTrace <trace file> [--iterations N] [--font file.ttf]
+ */
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "imgui.h"
+#include "DrawStats.h"
+#include "DrawTrace.h"
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <trace file> [--iterations N] [--font file.ttf]\n", argv[0]);
+        return 1;
+    }
+
+    int iterations = 20;
+    const char* fontPath = nullptr;
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--font") == 0 && i + 1 < argc)
+            fontPath = argv[++i];
+    }
+
+    Draw::Trace trace;
+    if (!trace.Load(argv[1]) || trace.FrameCount() == 0)
+    {
+        fprintf(stderr, "ReplayTrace: %s is not a valid trace\n", argv[1]);
+        return 1;
+    }
+
+    // Headless context, with an atlas holding a font of each recorded size
+    ImGui::CreateContext();
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.DisplaySize = ImVec2(3840.0f, 2160.0f);
+    io.DeltaTime = 1.0f / 60.0f;
+
+    std::vector<ImFont*> fonts;
+    for (float size : trace.FontSizes())
+    {
+        ImFontConfig config;
+        config.SizePixels = size;
+        ImFont* font = fontPath != nullptr ? io.Fonts->AddFontFromFileTTF(fontPath, size) : io.Fonts->AddFontDefault(&config);
+        fonts.push_back(font);
+    }
+    if (fonts.empty())
+        io.Fonts->AddFontDefault();
+
+    unsigned char* atlasPixels = nullptr;
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    io.Fonts->GetTexDataAsRGBA32(&atlasPixels, &atlasWidth, &atlasHeight);
+    io.Fonts->SetTexID((ImTextureID)1);
+
+    std::vector<double> frameTimes;
+    long long totalVertices = 0;
+    long long totalIndices = 0;
+    Draw::ResetStats();
+    for (int iteration = 0; iteration < iterations; iteration++)
+    {
+        for (int frame = 0; frame < trace.FrameCount(); frame++)
+        {
+            ImGui::NewFrame();
+            ImGui::SetNextWindowPos(ImVec2(0.0f, 0.0f));
+            ImGui::SetNextWindowSize(io.DisplaySize);
+            ImGui::Begin("Trace", nullptr, ImGuiWindowFlags_NoDecoration | ImGuiWindowFlags_NoBackground | ImGuiWindowFlags_NoSavedSettings);
+
+            auto start = std::chrono::steady_clock::now();
+            trace.ReplayFrame(frame, fonts);
+            frameTimes.push_back(std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count());
+
+            ImGui::End();
+            ImGui::Render();
+            totalVertices += ImGui::GetDrawData()->TotalVtxCount;
+            totalIndices += ImGui::GetDrawData()->TotalIdxCount;
+        }
+    }
+
+    std::sort(frameTimes.begin(), frameTimes.end());
+    double total = 0.0;
+    for (double time : frameTimes)
+        total += time;
+
+    printf("%d frames x %d iterations\n", trace.FrameCount(), iterations);
+    printf("frame ms: mean %.3f, median %.3f, p95 %.3f, max %.3f\n", total / frameTimes.size(),
+           frameTimes[frameTimes.size() / 2], frameTimes[std::min(frameTimes.size() - 1, (size_t)(frameTimes.size() * 0.95))], frameTimes.back());
+    printf("per frame: %.0f vertices, %.0f indices\n", (double)totalVertices / frameTimes.size(), (double)totalIndices / frameTimes.size());
+
+    const Draw::DrawStats& drawStats = Draw::Stats();
+    printf("snapped borders %d (%d vertices saved), fused text calls %d, rich text layouts %d, VtxOffset splits %d, dropped shapes %d\n\n", drawStats.snappedBorders,
+           drawStats.borderVerticesSaved, drawStats.fusedTextCalls, drawStats.richTextLayouts, drawStats.vtxOffsetSplits, drawStats.droppedItems);
+
+    printf("%-40s %10s %12s %12s %10s %10s\n", "call", "calls", "total ms", "us/call", "culled", "emitted");
+    const std::vector<Draw::TraceCallStats>& stats = trace.Stats();
+    for (size_t i = 0; i < stats.size(); i++)
+    {
+        if (stats[i].calls == 0)
+            continue;
+        printf("%-40s %10d %12.3f %12.3f %10d %10d\n", Draw::TraceCallName((Draw::TraceCall)i), stats[i].calls,
+               stats[i].seconds * 1e3, stats[i].seconds * 1e6 / stats[i].calls, drawStats.culledCalls[i], drawStats.emittedCalls[i]);
+    }
+
+    ImGui::DestroyContext();
+    return 0;
+}
@@ -0,0 +1,144 @@
+/*
+ * TextureTranscoder.cpp
+ *
+ * Command line tool that batch converts a directory of .png assets into BC1/BC3 .dds files
+ * placed next to the originals, where Texture::Load picks them up automatically. Images are
+ * encoded in parallel, one file per worker at a time.
+ *
+ * Usage: TextureTranscoder <asset directory> [--format auto|bc1|bc3] [--threads N] [--force]
+ *   auto (default) writes BC3 for images with any transparency and BC1 otherwise.
+ *   Existing .dds files newer than their source are skipped unless --force is given.
+ */
+#define STB_IMAGE_IMPLEMENTATION
+#include "stb_image.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "TextureCompression.h"
+
+namespace fs = std::filesystem;
+
+// Enum:    FormatChoice
+// ---------------------
+// Output format requested on the command line
+enum class FormatChoice
+{
+    Auto,
+    BC1,
+    BC3
+};
+
+// Function:    HasTransparency
+// ----------------------------
+// Checks whether any pixel of an RGBA image is not fully opaque
+static bool HasTransparency(const unsigned char* pixels, size_t pixelCount)
+{
+    for (size_t i = 0; i < pixelCount; i++)
+        if (pixels[i * 4 + 3] != 255)
+            return true;
+    return false;
+}
+
+// Function:    TranscodeFile
+// --------------------------
+// Decodes one image and writes its compressed copy next to it
+//
+// Returns true if the .dds file was written
+static bool TranscodeFile(const fs::path& source, FormatChoice choice)
+{
+    int width = 0, height = 0;
+    unsigned char* pixels = stbi_load(source.string().c_str(), &width, &height, NULL, 4);
+    if (pixels == NULL)
+    {
+        fprintf(stderr, "TextureTranscoder: failed to decode %s (%s)\n", source.string().c_str(), stbi_failure_reason());
+        return false;
+    }
+
+    CompressedFormat format = CompressedFormat::BC1;
+    if (choice == FormatChoice::BC3 || (choice == FormatChoice::Auto && HasTransparency(pixels, (size_t)width * height)))
+        format = CompressedFormat::BC3;
+
+    std::vector<unsigned char> blocks = Texture::EncodeCompressed(pixels, width, height, format);
+    stbi_image_free(pixels);
+
+    fs::path destination = fs::path(source).replace_extension(".dds");
+    if (!Texture::WriteDDS(destination.string(), blocks.data(), blocks.size(), width, height, format))
+    {
+        fprintf(stderr, "TextureTranscoder: failed to write %s\n", destination.string().c_str());
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2)
+    {
+        fprintf(stderr, "Usage: %s <asset directory> [--format auto|bc1|bc3] [--threads N] [--force]\n", argv[0]);
+        return 1;
+    }
+
+    const fs::path root = argv[1];
+    FormatChoice choice = FormatChoice::Auto;
+    unsigned int threadCount = std::max(1u, std::thread::hardware_concurrency());
+    bool force = false;
+
+    for (int i = 2; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--format") == 0 && i + 1 < argc)
+        {
+            const char* value = argv[++i];
+            choice = strcmp(value, "bc1") == 0 ? FormatChoice::BC1 : strcmp(value, "bc3") == 0 ? FormatChoice::BC3 : FormatChoice::Auto;
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = std::max(1, atoi(argv[++i]));
+        else if (strcmp(argv[i], "--force") == 0)
+            force = true;
+    }
+
+    // Collect the sources that need (re)encoding
+    std::vector<fs::path> sources;
+    std::error_code error;
+    for (const fs::directory_entry& entry : fs::recursive_directory_iterator(root, error))
+    {
+        if (!entry.is_regular_file() || entry.path().extension() != ".png")
+            continue;
+
+        fs::path destination = fs::path(entry.path()).replace_extension(".dds");
+        if (!force && fs::exists(destination) && fs::last_write_time(destination) >= entry.last_write_time())
+            continue;
+        sources.push_back(entry.path());
+    }
+    if (error)
+    {
+        fprintf(stderr, "TextureTranscoder: cannot read %s: %s\n", root.string().c_str(), error.message().c_str());
+        return 1;
+    }
+
+    // Workers pull the next file index until the list is exhausted
+    std::atomic<size_t> next{ 0 };
+    std::atomic<int> failures{ 0 };
+    std::vector<std::thread> workers;
+    threadCount = std::min<unsigned int>(threadCount, std::max<size_t>(1, sources.size()));
+    for (unsigned int t = 0; t < threadCount; t++)
+    {
+        workers.emplace_back([&]()
+        {
+            for (size_t i = next++; i < sources.size(); i = next++)
+                if (!TranscodeFile(sources[i], choice))
+                    failures++;
+        });
+    }
+    for (std::thread& worker : workers)
+        worker.join();
+
+    printf("TextureTranscoder: %zu converted, %d failed, %u threads\n", sources.size() - failures, failures.load(), threadCount);
+    return failures == 0 ? 0 : 2;
+}
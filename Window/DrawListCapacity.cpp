@@ -0,0 +1,116 @@
+/*
+ * DrawListCapacity.cpp
+ *
+ * Source file implementation of the per-window draw list capacity predictor.
+ * Buffers are shrunk by copying into a right-sized vector and swapping, because ImVector never
+ * gives capacity back on its own.
+ */
+
+#include "DrawListCapacity.h"
+
+#include <cstring>
+
+// Counts the reallocations ImVector would make growing from one capacity to another
+static int growthSteps(int capacity, int target)
+{
+    int steps = 0;
+    while (capacity < target)
+    {
+        capacity = capacity ? capacity + capacity / 2 : 8;
+        steps++;
+    }
+    return steps;
+}
+
+// Reallocates a vector to a smaller capacity, returning the bytes released
+template<typename T>
+static size_t shrinkBuffer(ImVector<T>& buffer, int capacity)
+{
+    if (capacity < buffer.Size)
+        capacity = buffer.Size;
+    if (buffer.Capacity <= capacity)
+        return 0;
+
+    ImVector<T> copy;
+    copy.reserve(capacity);
+    copy.resize(buffer.Size);
+    if (buffer.Size > 0)
+        std::memcpy(copy.Data, buffer.Data, buffer.size_in_bytes());
+
+    size_t released = (size_t)(buffer.Capacity - copy.Capacity) * sizeof(T);
+    buffer.swap(copy);
+    return released;
+}
+
+// Reserves one buffer from its predicted usage, or trims it after sustained excess capacity
+template<typename T>
+void DrawListCapacity::reserveBuffer(ImVector<T>& buffer, BufferHistory& history)
+{
+    int target = (int)(history.peak * headroom);
+
+    if (target > buffer.Capacity)
+    {
+        stats.reallocationsAvoided += growthSteps(buffer.Capacity, target);
+        stats.reservations++;
+        buffer.reserve(target);
+        history.lowFrames = 0;
+    }
+    else if (buffer.Capacity > target * trimRatio && buffer.Capacity > 1024)
+    {
+        if (++history.lowFrames >= trimAfterFrames)
+        {
+            stats.bytesReclaimed += shrinkBuffer(buffer, target);
+            stats.trims++;
+            history.lowFrames = 0;
+        }
+    }
+    else
+    {
+        history.lowFrames = 0;
+    }
+
+    history.reservedCapacity = buffer.Capacity;
+}
+
+// Grows the window's buffers to the predicted size before draw() fills them
+void DrawListCapacity::reserve(ImDrawList* drawList)
+{
+    reserveBuffer(drawList->VtxBuffer, vertices);
+    reserveBuffer(drawList->IdxBuffer, indices);
+    reserveBuffer(drawList->CmdBuffer, commands);
+
+    // Begin may already have written geometry, keep the write cursors valid after a reallocation
+    drawList->_VtxWritePtr = drawList->VtxBuffer.Data + drawList->VtxBuffer.Size;
+    drawList->_IdxWritePtr = drawList->IdxBuffer.Data + drawList->IdxBuffer.Size;
+
+    stats.reservedBytes = (size_t)drawList->VtxBuffer.Capacity * sizeof(ImDrawVert)
+        + (size_t)drawList->IdxBuffer.Capacity * sizeof(ImDrawIdx)
+        + (size_t)drawList->CmdBuffer.Capacity * sizeof(ImDrawCmd);
+}
+
+// Folds this frame's buffer sizes into the decaying peaks
+void DrawListCapacity::observe(const ImDrawList* drawList)
+{
+    BufferHistory* histories[3] = { &vertices, &indices, &commands };
+    const int sizes[3] = { drawList->VtxBuffer.Size, drawList->IdxBuffer.Size, drawList->CmdBuffer.Size };
+    const int capacities[3] = { drawList->VtxBuffer.Capacity, drawList->IdxBuffer.Capacity, drawList->CmdBuffer.Capacity };
+
+    bool grew = false;
+    for (int i = 0; i < 3; i++)
+    {
+        BufferHistory& history = *histories[i];
+        float decayed = history.peak * decay;
+        history.peak = (float)sizes[i] > decayed ? (float)sizes[i] : decayed;
+        grew |= capacities[i] > history.reservedCapacity;
+    }
+
+    if (grew)
+        stats.growthFrames++;
+}
+
+// Accessors
+const DrawListCapacityStats& DrawListCapacity::getStats() const { return this->stats; }
+
+// Mutators
+void DrawListCapacity::setDecay(float perFrame) { this->decay = perFrame; }
+void DrawListCapacity::setTrimAfterFrames(int frames) { this->trimAfterFrames = frames; }
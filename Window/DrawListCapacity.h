@@ -0,0 +1,78 @@
+/*
+ * DrawListCapacity.h
+ *
+ * Header for a capacity predictor attached to each Window's draw list. ImGui clears a window's
+ * vertex, index and command buffers every frame but keeps their capacity. A grid-heavy frame
+ * therefore grows them through several reallocations, and after the spike they stay that size
+ * for good. The predictor tracks a decaying maximum of recent usage. It reserves that much
+ * before draw() so a busy frame grows its buffers at most once, and it shrinks buffers that
+ * have stayed far larger than recent usage for a while.
+ */
+
+#pragma once
+#ifndef DRAWLISTCAPACITY_H
+#define DRAWLISTCAPACITY_H
+#include <cstddef>
+
+#include "imgui.h"
+
+// Structure:   DrawListCapacityStats
+// ----------------------------------
+// Running totals of a DrawListCapacity predictor
+//
+// int reservations:            buffers grown ahead of draw() from the prediction
+// int reallocationsAvoided:    ImVector growth steps those reservations replaced
+// int growthFrames:            frames whose usage still outgrew the reservation
+// int trims:                   buffers shrunk after sustained low usage
+// size_t bytesReclaimed:       memory released by trims
+// size_t reservedBytes:        capacity currently held by the three buffers
+struct DrawListCapacityStats
+{
+    int reservations = 0;
+    int reallocationsAvoided = 0;
+    int growthFrames = 0;
+    int trims = 0;
+    size_t bytesReclaimed = 0;
+    size_t reservedBytes = 0;
+};
+
+class DrawListCapacity {
+private:
+    // Usage history of one buffer
+    struct BufferHistory
+    {
+        float peak = 0.0f;          // Decaying maximum of recent frames
+        int reservedCapacity = 0;   // Capacity right after reserve()
+        int lowFrames = 0;          // Consecutive frames with capacity far above the peak
+    };
+
+    BufferHistory vertices;
+    BufferHistory indices;
+    BufferHistory commands;
+    DrawListCapacityStats stats;
+
+    // Tuning
+    float decay = 0.98f;        // Peak retained per frame, a spike halves in about 35 frames
+    float headroom = 1.1f;      // Reserved capacity relative to the peak
+    float trimRatio = 2.0f;     // Capacity over the peak that counts as excess
+    int trimAfterFrames = 180;  // Frames of excess capacity before a buffer is shrunk
+
+    template<typename T>
+    void reserveBuffer(ImVector<T>& buffer, BufferHistory& history);
+
+public:
+    // Grows or trims the buffers from recent usage, call after ImGui::Begin and before drawing
+    void reserve(ImDrawList* drawList);
+
+    // Records this frame's usage, call after drawing and before ImGui::End
+    void observe(const ImDrawList* drawList);
+
+    // Accessors
+    const DrawListCapacityStats& getStats() const;
+
+    // Mutators
+    void setDecay(float perFrame);
+    void setTrimAfterFrames(int frames);
+};
+
+#endif //DRAWLISTCAPACITY_H
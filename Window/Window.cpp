@@ -34,6 +34,7 @@ float Window::getScaleX() const { return this->scaleX; }
 float Window::getScaleY() const { return this->scaleY; }
 float Window::getScaleAvg() const { return this->scaleAvg; }
 ImVec4 Window::getBackgroundColor() const { return this->backgroundColor; }
+const DrawListCapacityStats& Window::getDrawListStats() const { return this->drawListCapacity.getStats(); }
 
 // Mutators
 void Window::setBackgroundColor(const ImVec4& color) { this->backgroundColor = color; }
@@ -113,6 +114,12 @@ void Window::render()
     this->currentTime = ImGui::GetTime();
 
     this->buildStart();
+
+    // Size the draw list buffers for this frame up front instead of growing them while drawing
+    ImDrawList* drawList = ImGui::GetWindowDrawList();
+    this->drawListCapacity.reserve(drawList);
     this->draw();
+    this->drawListCapacity.observe(drawList);
+
     this->buildEnd();
 }
\ No newline at end of file
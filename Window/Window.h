@@ -13,6 +13,7 @@
 #define WINDOW_H
 #include "imgui.h"
 #include "ColorTools.h"
+#include "DrawListCapacity.h"
 #include <string>
 
 // Default value macros
@@ -69,6 +70,9 @@ protected:
     ImVec4 backgroundColor = DEFAULT_BG;
     ImGuiWindowFlags flags = 0;
 
+    // Predicts draw list buffer sizes from recent frames
+    DrawListCapacity drawListCapacity;
+
     // Internal helper functions
     virtual void updateScale();
 
@@ -103,6 +107,9 @@ public:
     void setBackgroundColor(const ImVec4& color);
     void setBackgroundVisibility(bool visible);
 
+    // Draw list buffers
+    const DrawListCapacityStats& getDrawListStats() const;
+
     // Lifecycle functions
     virtual void render();      // Calls all the internal lifecycle functions
     virtual void init() = 0;    // Initializes any context-specific variables